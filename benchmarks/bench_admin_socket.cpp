@@ -0,0 +1,135 @@
+#include <logger.hpp>
+#include "config.hpp"
+#include "cdr_logger.hpp"
+#include "session_manager.hpp"
+#include "http_server.hpp"
+#include "admin_socket.hpp"
+#include "admin_client.hpp"
+#include <httplib.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Пропускная способность проверок абонентов с того же хоста: HTTP /check_subscriber
+// (одно соединение keep-alive, запрос на IMSI) против административного сокета — по одному IMSI
+// на запрос и пачками по batch IMSI с window запросами без ответа. Половина IMSI активна.
+// HTTP медленнее на порядки, поэтому для него достаточно первых http_queries IMSI.
+// Использование: bench_admin_socket [sessions] [queries] [batch] [window] [http_queries]
+
+namespace {
+
+std::string imsi_of(int i) {
+    return std::to_string(100000000000000LL + i);
+}
+
+void print(const char* name, int queries, double seconds, double baseline_rate) {
+    double rate = queries / seconds;
+    std::cout << name << " queries=" << queries << " time=" << seconds << "s rate=" << static_cast<long long>(rate)
+              << "/s";
+    if (baseline_rate > 0) {
+        std::cout << " vs_http=" << rate / baseline_rate << "x";
+    }
+    std::cout << "\n";
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    int sessions = (argc > 1) ? std::stoi(argv[1]) : 100000;
+    int queries = (argc > 2) ? std::stoi(argv[2]) : 200000;
+    size_t batch = (argc > 3) ? std::stoul(argv[3]) : AdminClient::DEFAULT_BATCH;
+    size_t window = (argc > 4) ? std::stoul(argv[4]) : AdminClient::DEFAULT_WINDOW;
+    int http_queries = std::min(queries, (argc > 5) ? std::stoi(argv[5]) : 10000);
+
+    std::ofstream config_file("bench_admin_config.json");
+    config_file << R"({
+        "session_timeout_sec": 3600,
+        "cdr_file": "bench_admin_cdr.log",
+        "http_port": 18097,
+        "admin_socket_path": "bench_admin.sock",
+        "graceful_shutdown_rate": 0,
+        "log_file": "bench_admin.log",
+        "log_level": "ERROR",
+        "blacklist": []
+    })";
+    config_file.close();
+
+    Logger::init("bench_admin.log", "ERROR");
+    Config config("bench_admin_config.json");
+    auto cdr_logger = std::make_shared<CDRLogger>(config, Logger::get());
+    auto session_manager = std::make_shared<SessionManager>(config, cdr_logger);
+
+    // Таблица заполняется восстановлением: без CDR
+    std::vector<SessionRecord> records(sessions);
+    int64_t now_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    for (int i = 0; i < sessions; ++i) {
+        records[i].imsi = imsi_of(2 * i);
+        records[i].creation_time_ms = now_ms;
+    }
+    session_manager->restore_sessions(std::move(records));
+
+    std::atomic<bool> running{ true };
+    HTTPServer http_server(config, Logger::get(), session_manager, []() {}, running);
+    http_server.run();
+    AdminSocket admin_socket(config, session_manager, Logger::get());
+    admin_socket.run();
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+
+    std::vector<std::string> imsis(queries);
+    for (int i = 0; i < queries; ++i) {
+        imsis[i] = imsi_of(i % (2 * sessions));
+    }
+
+    // HTTP: запрос на каждый IMSI
+    httplib::Client http("127.0.0.1", config.get_http_port());
+    http.set_keep_alive(true);
+    size_t http_active = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < http_queries; ++i) {
+        auto res = http.Get("/check_subscriber?imsi=" + imsis[i]);
+        if (res && res->body == "active") {
+            ++http_active;
+        }
+    }
+    double http_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    // Сокет: сначала запрос на IMSI с ожиданием ответа, затем конвейер пачек
+    AdminClient admin(config.get_admin_socket_path());
+    start = std::chrono::steady_clock::now();
+    auto single = admin.check(imsis, 1, 1);
+    double single_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    start = std::chrono::steady_clock::now();
+    auto batched = admin.check(imsis, batch, window);
+    double batched_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    // Ответы сверяются на общей части запросов
+    size_t single_active = 0;
+    size_t batched_active = 0;
+    for (int i = 0; i < http_queries; ++i) {
+        single_active += single[i] == admin::CHECK_ACTIVE ? 1 : 0;
+        batched_active += batched[i] == admin::CHECK_ACTIVE ? 1 : 0;
+    }
+
+    double http_rate = http_queries / http_seconds;
+    std::cout << "sessions=" << sessions << " batch=" << batch << " window=" << window << "\n";
+    print("http check_subscriber: ", http_queries, http_seconds, 0);
+    print("admin socket single:   ", queries, single_seconds, http_rate);
+    print("admin socket batched:  ", queries, batched_seconds, http_rate);
+    if (http_active != single_active || http_active != batched_active) {
+        std::cout << "mismatch: http_active=" << http_active << " single_active=" << single_active
+                  << " batched_active=" << batched_active << "\n";
+    }
+
+    admin_socket.stop();
+    http_server.stop();
+    std::remove("bench_admin_config.json");
+    std::remove("bench_admin_cdr.log");
+    return 0;
+}
@@ -0,0 +1,93 @@
+#include "teid_allocator.hpp"
+#include "ip_pool.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Бенчмарк аллокаторов TEID и адресов: каждый поток держит небольшое окно выделенных
+// значений и циклически освобождает самое старое и выделяет новое.
+// Использование: bench_allocators [cycles_per_thread] [threads]
+
+namespace {
+
+constexpr size_t WINDOW = 16;
+
+// Запускает потоки и возвращает суммарную пропускную способность (циклов/с)
+template <typename F>
+double run_threads(int threads, long long cycles, F&& body) {
+    std::vector<std::thread> workers;
+    auto start = std::chrono::steady_clock::now();
+    for (int t = 0; t < threads; ++t) {
+        workers.emplace_back([&]() { body(cycles); });
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return static_cast<double>(cycles) * threads / seconds;
+}
+
+void report(const std::string& name, int threads, long long cycles, double rate, long long failures) {
+    std::cout << name << ": threads=" << threads << " cycles=" << cycles * threads
+              << " throughput=" << static_cast<long long>(rate) << " cycles/s"
+              << " (" << 1e9 / rate * threads << " ns/cycle per thread)"
+              << " failures=" << failures << std::endl;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    long long cycles = (argc > 1) ? std::stoll(argv[1]) : 4000000;
+    int max_threads = (argc > 2) ? std::stoi(argv[2]) : static_cast<int>(std::thread::hardware_concurrency());
+
+    std::vector<int> thread_counts;
+    for (int threads = 1; threads < max_threads; threads *= 2) {
+        thread_counts.push_back(threads);
+    }
+    thread_counts.push_back(std::max(max_threads, 1));
+
+    for (int threads : thread_counts) {
+        TEIDAllocator teids(1u << 20);
+        std::atomic<long long> failures{ 0 };
+        double rate = run_threads(threads, cycles, [&](long long n) {
+            uint32_t window[WINDOW] = {};
+            for (long long i = 0; i < n; ++i) {
+                uint32_t& slot = window[i % WINDOW];
+                if (slot) {
+                    teids.release(slot);
+                }
+                slot = teids.allocate();
+                if (!slot) {
+                    ++failures;
+                }
+            }
+        });
+        report("teid", threads, cycles, rate, failures);
+
+        for (const char* cidr : { "10.0.0.0/16", "2001:db8::/48" }) {
+            IPPool pool(cidr);
+            failures = 0;
+            rate = run_threads(threads, cycles, [&](long long n) {
+                IPAddress window[WINDOW];
+                bool used[WINDOW] = {};
+                for (long long i = 0; i < n; ++i) {
+                    size_t slot = static_cast<size_t>(i % WINDOW);
+                    if (used[slot]) {
+                        pool.release(window[slot]);
+                    }
+                    used[slot] = pool.allocate(window[slot]);
+                    if (!used[slot]) {
+                        ++failures;
+                    }
+                }
+            });
+            report(std::string("ip_pool ") + cidr, threads, cycles, rate, failures);
+        }
+    }
+    return 0;
+}
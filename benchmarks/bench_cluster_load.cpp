@@ -0,0 +1,93 @@
+#include "udp_client.hpp"
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Генератор нагрузки на один или несколько узлов pgw_server (режим bcd).
+// Каждый поток держит окно неподтверждённых запросов Create по уникальным IMSI
+// к своему узлу и считает полученные ответы; итог — суммарная скорость по всем узлам.
+// Использование: bench_cluster_load <ip:port[,ip:port...]> [seconds] [threads_per_node] [window]
+
+namespace {
+
+struct sockaddr_in parse_endpoint(const std::string& endpoint) {
+    size_t colon = endpoint.rfind(':');
+    struct sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(static_cast<uint16_t>(std::stoi(endpoint.substr(colon + 1))));
+    inet_pton(AF_INET, endpoint.substr(0, colon).c_str(), &addr.sin_addr);
+    return addr;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        std::cerr << "Usage: bench_cluster_load <ip:port[,ip:port...]> [seconds] [threads_per_node] [window]" << std::endl;
+        return 1;
+    }
+    std::vector<struct sockaddr_in> endpoints;
+    std::stringstream list(argv[1]);
+    std::string endpoint;
+    while (std::getline(list, endpoint, ',')) {
+        endpoints.push_back(parse_endpoint(endpoint));
+    }
+    int seconds = (argc > 2) ? std::stoi(argv[2]) : 5;
+    int threads_per_node = (argc > 3) ? std::stoi(argv[3]) : 2;
+    int window = (argc > 4) ? std::stoi(argv[4]) : 64;
+
+    std::atomic<bool> running(true);
+    std::atomic<uint64_t> sent(0), received(0);
+    std::vector<std::thread> threads;
+    int num_threads = static_cast<int>(endpoints.size()) * threads_per_node;
+    for (int t = 0; t < num_threads; ++t) {
+        threads.emplace_back([&, t]() {
+            int fd = socket(AF_INET, SOCK_DGRAM, 0);
+            struct timeval tv = { 0, 50000 };
+            setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+            const struct sockaddr_in& target = endpoints[t % endpoints.size()];
+            // У каждого потока свой диапазон IMSI, повторов нет
+            long long next_imsi = 200000000000000LL + static_cast<long long>(t) * 10000000000LL;
+            int in_flight = 0;
+            char buffer[512];
+            while (running) {
+                while (in_flight < window) {
+                    std::string bcd = encode_imsi_bcd(std::to_string(next_imsi++));
+                    sendto(fd, bcd.data(), bcd.size(), 0, (const struct sockaddr*)&target, sizeof(target));
+                    ++in_flight;
+                    ++sent;
+                }
+                if (recv(fd, buffer, sizeof(buffer), 0) > 0) {
+                    --in_flight;
+                    ++received;
+                }
+                else {
+                    // Ответы потеряны (лимит или перегрузка) — окно открывается заново
+                    in_flight = 0;
+                }
+            }
+            close(fd);
+        });
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    std::this_thread::sleep_for(std::chrono::seconds(seconds));
+    running = false;
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::cout << "nodes=" << endpoints.size() << " threads=" << num_threads << " window=" << window << "\n";
+    std::cout << "sent=" << sent.load() << " received=" << received.load() << "\n";
+    std::cout << "throughput=" << static_cast<uint64_t>(received.load() / elapsed) << " req/s" << std::endl;
+    return 0;
+}
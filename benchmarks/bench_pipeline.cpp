@@ -0,0 +1,113 @@
+#include <logger.hpp>
+#include "config.hpp"
+#include "cdr_logger.hpp"
+#include "session_manager.hpp"
+#include "udp_server.hpp"
+#include "udp_client.hpp"
+#include <arpa/inet.h>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Пропускная способность пути обработки pgw_server без сетевого стека ядра:
+// UDPServer получает датаграммы из LoopbackTransport, генератор держит окно запросов
+// Create по уникальным IMSI (режим bcd). В измерение входят декодирование, допуск,
+// очередь и рабочие потоки, создание сессии и запись CDR — но не recvmsg/sendto.
+// capture: off — захват выключен, all — сохраняются все датаграммы, imsi — фильтр по префиксу IMSI,
+// под который попадают лишь первые 10 IMSI: фильтр проверяется на каждом разобранном запросе.
+// recorder: on — бортовой самописец пишет события приёма, очереди, сессий, CDR и отправки, off — выключен.
+// Использование: bench_pipeline [requests] [window] [workers] [capture] [recorder]
+
+int main(int argc, char* argv[]) {
+    int requests = (argc > 1) ? std::stoi(argv[1]) : 200000;
+    int window = (argc > 2) ? std::stoi(argv[2]) : 256;
+    int workers = (argc > 3) ? std::stoi(argv[3]) : 2;
+    std::string capture = (argc > 4) ? argv[4] : "off";
+    std::string recorder = (argc > 5) ? argv[5] : "off";
+
+    // Пул адресов /8, чтобы все запросы получили адрес и прошли путь создания целиком
+    std::ofstream config_file("bench_pipeline_config.json");
+    config_file << R"({
+        "session_timeout_sec": 3600,
+        "cdr_file": "bench_pipeline_cdr.log",
+        "graceful_shutdown_rate": 0,
+        "log_file": "bench_pipeline.log",
+        "log_level": "ERROR",
+        "ip_pools": ["10.0.0.0/8"],
+        "worker_threads_min": )" << workers << R"(,
+        "worker_threads_max": )" << workers << R"(,
+        "blacklist": []
+    })";
+    config_file.close();
+
+    Logger::init("bench_pipeline.log", "ERROR");
+    Config config("bench_pipeline_config.json");
+    auto cdr_logger = std::make_shared<CDRLogger>(config, Logger::get());
+    auto session_manager = std::make_shared<SessionManager>(config, cdr_logger);
+    auto transport = std::make_shared<LoopbackTransport>();
+    std::atomic<uint64_t> created(0);
+    transport->set_reply_handler([&created](const char* data, size_t length, const struct sockaddr_in&) {
+        if (length == 7 && std::string(data, length) == "created") {
+            created.fetch_add(1, std::memory_order_relaxed);
+        }
+    });
+    UDPServer server(config, session_manager, cdr_logger, transport);
+    if (capture == "all") {
+        server.get_packet_capture()->start("", "");
+    }
+    else if (capture == "imsi") {
+        server.get_packet_capture()->start("", "40000000000000");
+    }
+    if (recorder == "on") {
+        auto flight_recorder = std::make_shared<FlightRecorder>(4096);
+        server.set_flight_recorder(flight_recorder);
+        cdr_logger->set_flight_recorder(flight_recorder);
+        session_manager->set_flight_recorder(flight_recorder);
+    }
+    std::thread server_thread([&server]() { server.run(); });
+
+    // Датаграммы готовятся заранее: генератор не должен быть узким местом
+    std::vector<std::string> datagrams;
+    datagrams.reserve(requests);
+    for (int i = 0; i < requests; ++i) {
+        datagrams.push_back(encode_imsi_bcd(std::to_string(400000000000000LL + i)));
+    }
+    struct sockaddr_in peer = {};
+    peer.sin_family = AF_INET;
+    peer.sin_addr.s_addr = inet_addr("10.255.0.1");
+    peer.sin_port = htons(2123);
+
+    auto start = std::chrono::steady_clock::now();
+    int sent = 0;
+    while (sent < requests) {
+        if (transport->get_injected() - transport->get_replies() >= static_cast<uint64_t>(window)) {
+            std::this_thread::yield();
+            continue;
+        }
+        transport->inject(datagrams[sent].data(), datagrams[sent].size(), peer);
+        ++sent;
+    }
+    while (transport->get_replies() < static_cast<uint64_t>(requests)) {
+        std::this_thread::yield();
+    }
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    server.stop();
+    server_thread.join();
+
+    const LatencyStats& latency = *server.get_latency_stats();
+    std::cout << "requests=" << requests << " window=" << window << " workers=" << workers
+              << " capture=" << capture << " recorder=" << recorder << " created=" << created.load() << " dropped=" << transport->get_dropped() << "\n";
+    std::cout << "requests/s: " << static_cast<long long>(requests / elapsed) << "\n";
+    std::cout << "receive_to_reply_us p50=" << latency.get_socket_to_reply().percentile_us(0.50)
+              << " p99=" << latency.get_socket_to_reply().percentile_us(0.99)
+              << " queue_wait_us p50=" << latency.get_queue_wait().percentile_us(0.50) << std::endl;
+
+    std::remove("bench_pipeline_config.json");
+    std::remove("bench_pipeline_cdr.log");
+    return 0;
+}
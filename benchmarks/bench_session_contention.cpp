@@ -0,0 +1,102 @@
+#include <logger.hpp>
+#include "config.hpp"
+#include "cdr_logger.hpp"
+#include "session_manager.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Бенчмарк конкуренции: UDP-путь (create_session) против HTTP-пути (has_session).
+// Использование: bench_session_contention [creates_per_writer] [writers] [readers]
+
+namespace {
+
+struct Result {
+    double create_rate;
+    double lookup_rate;
+};
+
+Result run(const Config& config, std::shared_ptr<CDRLogger> cdr_logger, int creates_per_writer,
+           int writers, int readers, long long imsi_base) {
+    auto session_manager = std::make_shared<SessionManager>(config, cdr_logger);
+    std::atomic<bool> stop{ false };
+    std::atomic<long long> lookups{ 0 };
+
+    std::vector<std::thread> reader_threads;
+    for (int r = 0; r < readers; ++r) {
+        reader_threads.emplace_back([&, r]() {
+            long long local = 0;
+            long long i = r;
+            while (!stop) {
+                session_manager->has_session(std::to_string(imsi_base + (i % (creates_per_writer * writers))));
+                i += 7;
+                ++local;
+            }
+            lookups += local;
+        });
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> writer_threads;
+    for (int w = 0; w < writers; ++w) {
+        writer_threads.emplace_back([&, w]() {
+            for (int i = 0; i < creates_per_writer; ++i) {
+                session_manager->create_session(std::to_string(imsi_base + w * creates_per_writer + i));
+            }
+        });
+    }
+    for (auto& t : writer_threads) {
+        t.join();
+    }
+    auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    stop = true;
+    for (auto& t : reader_threads) {
+        t.join();
+    }
+
+    Result result;
+    result.create_rate = creates_per_writer * writers / elapsed;
+    result.lookup_rate = lookups.load() / elapsed;
+    return result;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    int creates_per_writer = (argc > 1) ? std::stoi(argv[1]) : 20000;
+    int writers = (argc > 2) ? std::stoi(argv[2]) : 4;
+    int readers = (argc > 3) ? std::stoi(argv[3]) : 4;
+
+    std::ofstream config_file("bench_config.json");
+    config_file << R"({
+        "session_timeout_sec": 3600,
+        "cdr_file": "bench_cdr.log",
+        "graceful_shutdown_rate": 0,
+        "log_file": "bench.log",
+        "log_level": "ERROR",
+        "blacklist": []
+    })";
+    config_file.close();
+
+    Logger::init("bench.log", "ERROR");
+    Config config("bench_config.json");
+    auto cdr_logger = std::make_shared<CDRLogger>(config, Logger::get());
+
+    Result baseline = run(config, cdr_logger, creates_per_writer, writers, 0, 100000000000000LL);
+    Result mixed = run(config, cdr_logger, creates_per_writer, writers, readers, 200000000000000LL);
+
+    std::cout << "writers=" << writers << " readers=" << readers << " creates=" << creates_per_writer * writers << "\n";
+    std::cout << "creates/s without lookups: " << static_cast<long long>(baseline.create_rate) << "\n";
+    std::cout << "creates/s with lookups:    " << static_cast<long long>(mixed.create_rate) << "\n";
+    std::cout << "lookups/s during creates:  " << static_cast<long long>(mixed.lookup_rate) << "\n";
+    std::cout << "create slowdown: " << (baseline.create_rate / mixed.create_rate) << "x" << std::endl;
+
+    std::remove("bench_config.json");
+    std::remove("bench_cdr.log");
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,59 @@
+#include <logger.hpp>
+#include "config.hpp"
+#include "cdr_logger.hpp"
+#include "clock.hpp"
+#include "session_manager.hpp"
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+// Массовое истечение сессий на ручных часах: создаём sessions сессий, сдвигаем часы
+// за таймаут и снимаем все одной очисткой. Ждать таймаут в реальном времени не нужно,
+// поэтому сценарий с миллионом сессий занимает секунды. В CDR пишутся created и deleted.
+// Использование: bench_session_expiry [sessions]
+
+int main(int argc, char* argv[]) {
+    int sessions = (argc > 1) ? std::stoi(argv[1]) : 1000000;
+
+    std::ofstream config_file("bench_expiry_config.json");
+    config_file << R"({
+        "session_timeout_sec": 30,
+        "cdr_file": "bench_expiry_cdr.log",
+        "graceful_shutdown_rate": 0,
+        "log_file": "bench_expiry.log",
+        "log_level": "ERROR",
+        "teid_pool_size": 16777215,
+        "ip_pools": ["10.0.0.0/8"],
+        "blacklist": []
+    })";
+    config_file.close();
+
+    Logger::init("bench_expiry.log", "ERROR");
+    Config config("bench_expiry_config.json");
+    auto clock = std::make_shared<ManualClock>();
+    auto cdr_logger = std::make_shared<CDRLogger>(config, Logger::get(), clock);
+    SessionManager session_manager(config, cdr_logger);
+
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < sessions; ++i) {
+        session_manager.create_session(std::to_string(100000000000000LL + i));
+    }
+    double create_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    clock->advance(std::chrono::seconds(config.get_session_timeout_sec() + 1));
+    start = std::chrono::steady_clock::now();
+    size_t expired = session_manager.cleanup_expired_sessions();
+    double expiry_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::cout << "sessions=" << sessions << " expired=" << expired
+              << " remaining=" << session_manager.get_session_count() << "\n";
+    std::cout << "create: " << create_seconds << " s (" << static_cast<long long>(sessions / create_seconds) << "/s)\n";
+    std::cout << "expiry: " << expiry_seconds << " s (" << static_cast<long long>(expired / expiry_seconds) << "/s)"
+              << std::endl;
+
+    std::remove("bench_expiry_config.json");
+    std::remove("bench_expiry_cdr.log");
+    return expired == static_cast<size_t>(sessions) ? 0 : 1;
+}
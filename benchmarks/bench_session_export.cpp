@@ -0,0 +1,129 @@
+#include <logger.hpp>
+#include "config.hpp"
+#include "cdr_logger.hpp"
+#include "session_manager.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Выгрузка таблицы сессий рядом с подключениями: таблица из sessions сессий выгружается
+// постранично (как /sessions/export), а отдельный поток создаёт attaches сессий и измеряет
+// задержку каждого create_session. Сравниваются перцентили без выгрузки и во время неё.
+// Использование: bench_session_export [sessions] [attaches] [page_limit]
+
+namespace {
+
+struct Percentiles {
+    double p50_us;
+    double p99_us;
+    double p999_us;
+    double max_us;
+};
+
+Percentiles percentiles(std::vector<double> latencies_us) {
+    std::sort(latencies_us.begin(), latencies_us.end());
+    auto at = [&latencies_us](double p) {
+        return latencies_us[std::min(latencies_us.size() - 1, static_cast<size_t>(p * latencies_us.size()))];
+    };
+    return { at(0.5), at(0.99), at(0.999), latencies_us.back() };
+}
+
+// Создаёт attaches сессий начиная с imsi_base и возвращает задержки в мкс
+std::vector<double> attach(SessionManager& session_manager, int attaches, long long imsi_base) {
+    std::vector<double> latencies_us;
+    latencies_us.reserve(attaches);
+    for (int i = 0; i < attaches; ++i) {
+        auto start = std::chrono::steady_clock::now();
+        session_manager.create_session(std::to_string(imsi_base + i));
+        latencies_us.push_back(std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count());
+    }
+    return latencies_us;
+}
+
+void print(const char* name, const Percentiles& p) {
+    std::cout << name << " p50=" << p.p50_us << "us p99=" << p.p99_us << "us p99.9=" << p.p999_us
+              << "us max=" << p.max_us << "us\n";
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    int sessions = (argc > 1) ? std::stoi(argv[1]) : 1000000;
+    int attaches = (argc > 2) ? std::stoi(argv[2]) : 20000;
+    size_t page_limit = (argc > 3) ? std::stoul(argv[3]) : 10000;
+
+    std::ofstream config_file("bench_export_config.json");
+    config_file << R"({
+        "session_timeout_sec": 3600,
+        "cdr_file": "bench_export_cdr.log",
+        "graceful_shutdown_rate": 0,
+        "log_file": "bench_export.log",
+        "log_level": "ERROR",
+        "teid_pool_size": 16777215,
+        "blacklist": []
+    })";
+    config_file.close();
+
+    Logger::init("bench_export.log", "ERROR");
+    Config config("bench_export_config.json");
+    auto cdr_logger = std::make_shared<CDRLogger>(config, Logger::get());
+    SessionManager session_manager(config, cdr_logger);
+
+    // Таблица заполняется восстановлением: без CDR, чтобы не ждать записи миллионов строк
+    std::vector<SessionRecord> records(sessions);
+    int64_t now_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    for (int i = 0; i < sessions; ++i) {
+        records[i].imsi = std::to_string(100000000000000LL + i);
+        records[i].creation_time_ms = now_ms;
+    }
+    session_manager.restore_sessions(std::move(records));
+
+    Percentiles baseline = percentiles(attach(session_manager, attaches, 200000000000000LL));
+
+    // Выгрузка по кругу, пока идут подключения; время каждой страницы — верхняя граница удержания мьютекса
+    std::atomic<bool> exporting{ true };
+    size_t exported = 0;
+    size_t full_exports = 0;
+    double export_seconds = 0;
+    double max_page_us = 0;
+    std::thread exporter([&]() {
+        while (exporting) {
+            auto start = std::chrono::steady_clock::now();
+            for (size_t cursor = 0; cursor < SessionManager::SHARDS && exporting;) {
+                auto page_start = std::chrono::steady_clock::now();
+                auto page = session_manager.export_sessions(cursor, page_limit);
+                max_page_us = std::max(max_page_us,
+                    std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - page_start).count());
+                exported += page.sessions.size();
+                cursor = page.next_cursor;
+                if (cursor >= SessionManager::SHARDS) {
+                    ++full_exports;
+                    export_seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+                }
+            }
+        }
+    });
+    Percentiles during_export = percentiles(attach(session_manager, attaches, 300000000000000LL));
+    exporting = false;
+    exporter.join();
+
+    std::cout << "sessions=" << sessions << " attaches=" << attaches << " page_limit=" << page_limit << "\n";
+    print("attach without export:", baseline);
+    print("attach during export: ", during_export);
+    std::cout << "exported=" << exported << " full_exports=" << full_exports;
+    if (full_exports > 0) {
+        std::cout << " full_export_time=" << export_seconds / full_exports << "s";
+    }
+    std::cout << " max_page=" << max_page_us << "us" << std::endl;
+
+    std::remove("bench_export_config.json");
+    std::remove("bench_export_cdr.log");
+    return 0;
+}
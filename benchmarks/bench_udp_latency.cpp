@@ -0,0 +1,71 @@
+#include "udp_client.hpp"
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Задержка ответа pgw_server (режим bcd) на петлевом интерфейсе.
+// Один запрос Create в полёте: следующий уходит после ответа на предыдущий и паузы interval_us,
+// поэтому в задержку не попадает ожидание в очереди за другими запросами — только путь
+// сокет, поток приёма, рабочий поток, ответ. Итог — перцентили времени запрос-ответ.
+// Использование: bench_udp_latency <ip:port> [requests] [interval_us]
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        std::cerr << "Usage: bench_udp_latency <ip:port> [requests] [interval_us]" << std::endl;
+        return 1;
+    }
+    std::string endpoint = argv[1];
+    size_t colon = endpoint.rfind(':');
+    struct sockaddr_in target = {};
+    target.sin_family = AF_INET;
+    target.sin_port = htons(static_cast<uint16_t>(std::stoi(endpoint.substr(colon + 1))));
+    inet_pton(AF_INET, endpoint.substr(0, colon).c_str(), &target.sin_addr);
+    int requests = (argc > 2) ? std::stoi(argv[2]) : 10000;
+    int interval_us = (argc > 3) ? std::stoi(argv[3]) : 100;
+
+    int fd = socket(AF_INET, SOCK_DGRAM, 0);
+    struct timeval tv = { 1, 0 };
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    connect(fd, (const struct sockaddr*)&target, sizeof(target));
+
+    std::vector<double> latencies_us;
+    latencies_us.reserve(requests);
+    int lost = 0;
+    long long next_imsi = 300000000000000LL + static_cast<long long>(getpid()) * 100000LL;
+    char buffer[512];
+    for (int i = 0; i < requests; ++i) {
+        std::string bcd = encode_imsi_bcd(std::to_string(next_imsi++));
+        auto sent = std::chrono::steady_clock::now();
+        send(fd, bcd.data(), bcd.size(), 0);
+        if (recv(fd, buffer, sizeof(buffer), 0) > 0) {
+            latencies_us.push_back(std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - sent).count());
+        }
+        else {
+            ++lost;
+        }
+        if (interval_us > 0) {
+            std::this_thread::sleep_for(std::chrono::microseconds(interval_us));
+        }
+    }
+    close(fd);
+
+    if (latencies_us.empty()) {
+        std::cerr << "No responses received" << std::endl;
+        return 1;
+    }
+    std::sort(latencies_us.begin(), latencies_us.end());
+    auto percentile = [&](double p) {
+        return latencies_us[std::min(latencies_us.size() - 1, static_cast<size_t>(p * latencies_us.size()))];
+    };
+    std::cout << "requests=" << requests << " lost=" << lost << " interval_us=" << interval_us << "\n";
+    std::cout << "p50_us=" << percentile(0.50) << " p90_us=" << percentile(0.90) << " p99_us=" << percentile(0.99)
+              << " p999_us=" << percentile(0.999) << " max_us=" << latencies_us.back() << std::endl;
+    return 0;
+}
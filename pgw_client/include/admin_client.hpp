@@ -0,0 +1,46 @@
+#pragma once
+#include "admin_protocol.hpp" // Протокол из pgw_server/include
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Клиент административного сокета сервера (admin_socket_path): проверки IMSI пачками,
+// выгрузка сессий и счётчики. Вызовы блокирующие; check() шлёт несколько пачек подряд,
+// не дожидаясь ответов, поэтому задержка сокета не ограничивает пропускную способность.
+// Ошибки соединения и ответы ERROR — std::runtime_error
+class AdminClient {
+public:
+    static constexpr size_t DEFAULT_BATCH = 256;    // IMSI в одном запросе CHECK
+    static constexpr size_t DEFAULT_WINDOW = 16;    // Запросов CHECK без ответа
+
+    // Подключается к сокету path; timeout — предел ожидания ответа и отправки
+    explicit AdminClient(const std::string& path, std::chrono::milliseconds timeout = std::chrono::milliseconds(5000));
+    ~AdminClient();
+
+    // Запрещаем копирование для предотвращения дублирования дескриптора
+    AdminClient(const AdminClient&) = delete;
+    AdminClient& operator=(const AdminClient&) = delete;
+
+    // Состояние каждого IMSI (admin::CheckStatus), в порядке imsis. batch — IMSI в запросе
+    // (до admin::MAX_CHECK_BATCH), window — сколько запросов держать без ответа
+    std::vector<uint8_t> check(const std::vector<std::string>& imsis, size_t batch = DEFAULT_BATCH,
+        size_t window = DEFAULT_WINDOW);
+
+    // Страница выгрузки сессий; выгрузка закончена, когда next_cursor равен числу шардов сервера
+    admin::ExportPage export_sessions(uint32_t cursor, uint32_t limit);
+
+    // Счётчики сервера
+    admin::Counters counters();
+
+private:
+    // Отправляет данные целиком
+    void send_all(const std::string& data);
+
+    // Ждёт ответ на запрос id; ответ ERROR или другого типа — std::runtime_error
+    admin::Frame receive(uint8_t type, uint32_t id);
+
+    int fd = -1;
+    uint32_t next_id = 1;
+    std::string input;          // Принятые байты, ещё не разобранные в кадры
+};
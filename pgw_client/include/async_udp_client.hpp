@@ -0,0 +1,154 @@
+#pragma once
+
+#include "interfaces.hpp" // Включаем interfaces.hpp из pgw_server/include
+#include "client_config.hpp"
+#include "udp_client.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+// Итог запроса асинхронного клиента
+struct ClientResult {
+    std::string imsi;
+    bool ok = false;            // Ответ получен
+    std::string response;       // created, rejected, not found...; в GTPv2-C — по значению Cause
+    uint8_t cause = 0;          // Cause ответа GTPv2-C; 0 в режиме BCD
+    int attempts = 0;           // Отправок, включая повторы
+    std::chrono::microseconds latency{ 0 };    // От первой отправки до ответа
+    std::string error;          // Причина неудачи: timeout, stopped, send failed
+};
+
+using ClientCallback = std::function<void(const ClientResult&)>;
+
+// Колесо таймеров: срок округляется до тика, постановка и срабатывание — O(1).
+// Сроки дальше оборота колеса ждут нужного оборота в своей ячейке.
+// Отмены нет: владелец таймера при срабатывании сам проверяет, актуален ли он
+class TimerWheel {
+public:
+    TimerWheel(std::chrono::milliseconds tick, size_t slots, std::chrono::steady_clock::time_point now);
+
+    // Ставит таймер id на момент deadline (не раньше следующего тика)
+    void schedule(uint64_t id, std::chrono::steady_clock::time_point deadline);
+
+    // Продвигает колесо до now и вызывает expired для сработавших таймеров
+    void advance(std::chrono::steady_clock::time_point now, const std::function<void(uint64_t)>& expired);
+
+    size_t size() const { return count; }
+
+private:
+    struct Entry {
+        uint64_t id;
+        uint64_t expires_tick;
+    };
+
+    // Номер тика момента time
+    uint64_t tick_of(std::chrono::steady_clock::time_point time) const;
+
+    const std::chrono::milliseconds tick;
+    const std::chrono::steady_clock::time_point origin;
+    std::vector<std::vector<Entry>> slots;
+    uint64_t current_tick = 0;     // Все тики до него обработаны
+    size_t count = 0;
+};
+
+// Неблокирующий клиент: много запросов одновременно на одном сокете.
+// Запросы ставятся в очередь из любого потока; отдельный поток ввода-вывода отправляет их,
+// пока без ответа меньше max_in_flight, сопоставляет ответы по номеру последовательности
+// GTPv2-C и повторяет запросы по таймауту колеса таймеров. Повтор идёт с тем же номером,
+// поэтому сервер отвечает на него из кэша ретрансмиссий.
+// В режиме BCD в ответе нет номера запроса: без ответа остаётся не больше одного запроса,
+// и конвейера нет. Обработчики вызываются в потоке ввода-вывода и не должны блокироваться
+class AsyncUDPClient {
+public:
+    AsyncUDPClient(const ClientConfig& config, std::shared_ptr<ILogger> logger);
+    ~AsyncUDPClient();
+
+    // Запрещаем копирование
+    AsyncUDPClient(const AsyncUDPClient&) = delete;
+    AsyncUDPClient& operator=(const AsyncUDPClient&) = delete;
+
+    // Ставит запрос создания сессии в очередь; callback получит ответ или ошибку.
+    // Некорректный IMSI — std::invalid_argument сразу, без вызова callback
+    void send_imsi(const std::string& imsi, ClientCallback callback);
+
+    // То же с результатом через future
+    std::future<ClientResult> send_imsi(const std::string& imsi);
+
+    // Отправляет все IMSI конвейером и ждёт итогов; результаты в порядке imsis
+    std::vector<ClientResult> send_imsis(const std::vector<std::string>& imsis);
+
+    // Запросов без ответа и в очереди
+    size_t get_in_flight() const { return in_flight.load(); }
+    size_t get_queued() const;
+
+    // Останавливает поток ввода-вывода; незавершённые запросы получают ошибку stopped
+    void stop();
+
+private:
+    struct Pending {
+        std::string imsi;
+        std::string datagram;
+        ClientCallback callback;
+        int attempts = 0;
+        std::chrono::steady_clock::time_point first_sent;
+        std::chrono::steady_clock::time_point deadline;
+    };
+
+    // Цикл потока ввода-вывода
+    void io_loop();
+
+    // Отправляет запросы из очереди, пока есть место в окне
+    void send_queued();
+
+    // Отправляет датаграмму запроса и ставит таймер попытки
+    void transmit(uint32_t sequence, Pending& pending);
+
+    // Сопоставляет ответ с запросом и завершает его
+    void handle_reply(const char* buffer, size_t length);
+
+    // Повторяет запрос или завершает его по таймауту
+    void handle_timeout(uint64_t sequence);
+
+    // Завершает запрос и вызывает обработчик
+    void complete(uint32_t sequence, ClientResult result);
+
+    // Датаграмма запроса создания в протоколе клиента
+    std::string encode_request(const std::string& imsi, uint32_t sequence) const;
+
+    // Следующий свободный номер последовательности (24 бита)
+    uint32_t next_sequence();
+
+    const ClientConfig& config;
+    std::shared_ptr<ILogger> logger;
+    ClientSocket socket;
+    struct sockaddr_in server_addr;
+    bool gtp_mode;
+    size_t window;                      // Наибольшее число запросов без ответа
+    std::chrono::milliseconds timeout;
+    int wake_fd;                        // eventfd: новые запросы и остановка будят поток ввода-вывода
+    std::atomic<bool> running{ true };
+    std::atomic<size_t> in_flight{ 0 };
+    mutable std::mutex queue_mutex;
+    std::deque<Pending> queue;          // Ещё не отправленные; под queue_mutex
+
+    // Состояние потока ввода-вывода
+    std::unordered_map<uint32_t, Pending> pending;
+    TimerWheel wheel;
+    uint32_t last_sequence = 0;
+    std::thread io_thread;
+
+    static constexpr size_t BUFFER_SIZE = 2048;
+    static constexpr std::chrono::milliseconds WHEEL_TICK{ 5 };
+    static constexpr size_t WHEEL_SLOTS = 1024;
+    static constexpr uint32_t SEQUENCE_MASK = 0xFFFFFF;
+    static constexpr size_t MAX_WINDOW = 65536;     // Оставляет свободные номера последовательности
+};
@@ -1,29 +1,41 @@
-#pragma once
-
-#include <nlohmann/json.hpp>
-#include <string>
-
-// Класс для хранения конфигурации клиента, загружаемой из JSON
-class ClientConfig {
-public:
-    // Конструктор: загружает конфигурацию из файла
-    explicit ClientConfig(const std::string& config_file);
-
-    // Геттеры для параметров конфигурации
-    std::string get_server_ip() const { return server_ip; }
-    int get_server_port() const { return server_port; }
-    std::string get_log_file() const { return log_file; }
-    std::string get_log_level() const { return log_level; }
-
-private:
-    // Значения по умолчанию
-    static constexpr const char* DEFAULT_SERVER_IP = "127.0.0.1";
-    static constexpr int DEFAULT_SERVER_PORT = 9000;
-    static constexpr const char* DEFAULT_LOG_FILE = "client.log";
-    static constexpr const char* DEFAULT_LOG_LEVEL = "INFO";
-
-    std::string server_ip;
-    int server_port;
-    std::string log_file;
-    std::string log_level;
+#pragma once
+
+#include <nlohmann/json.hpp>
+#include <string>
+
+// Класс для хранения конфигурации клиента, загружаемой из JSON
+class ClientConfig {
+public:
+    // Конструктор: загружает конфигурацию из файла
+    explicit ClientConfig(const std::string& config_file);
+
+    // Геттеры для параметров конфигурации
+    std::string get_server_ip() const { return server_ip; }
+    int get_server_port() const { return server_port; }
+    std::string get_log_file() const { return log_file; }
+    std::string get_log_level() const { return log_level; }
+    std::string get_protocol() const { return protocol; }
+    int get_request_timeout_ms() const { return request_timeout_ms; }
+    int get_request_retries() const { return request_retries; }
+    int get_max_in_flight() const { return max_in_flight; }
+
+private:
+    // Значения по умолчанию
+    static constexpr const char* DEFAULT_SERVER_IP = "127.0.0.1";
+    static constexpr int DEFAULT_SERVER_PORT = 9000;
+    static constexpr const char* DEFAULT_LOG_FILE = "client.log";
+    static constexpr const char* DEFAULT_LOG_LEVEL = "INFO";
+    static constexpr const char* DEFAULT_PROTOCOL = "bcd";
+    static constexpr int DEFAULT_REQUEST_TIMEOUT_MS = 1000;
+    static constexpr int DEFAULT_REQUEST_RETRIES = 3;
+    static constexpr int DEFAULT_MAX_IN_FLIGHT = 256;
+
+    std::string server_ip;
+    int server_port;
+    std::string log_file;
+    std::string log_level;
+    std::string protocol;       // bcd или gtpv2c, как у сервера
+    int request_timeout_ms;     // Ожидание ответа на одну попытку асинхронного клиента
+    int request_retries;        // Попыток на запрос, включая первую
+    int max_in_flight;          // Запросов без ответа на сокете асинхронного клиента
 };
\ No newline at end of file
@@ -0,0 +1,103 @@
+#pragma once
+
+#include "interfaces.hpp" // Включаем interfaces.hpp из pgw_server/include
+#include "client_config.hpp"
+#include <chrono>
+#include <cstdint>
+#include <istream>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Запрос трассы: датаграмма и момент её отправки от начала трассы
+struct TraceRecord {
+    int64_t offset_ns = 0;
+    std::string datagram;
+};
+
+// Формат файла трассы
+enum class TraceFormat {
+    Pcap,   // Захват tcpdump или /capture/pcap: датаграммы UDP к порту сервера, как есть
+    Csv,    // Строки "время_с,IMSI[,create|delete]"
+    Cdr     // cdr.log сервера: "YYYY-MM-DD HH:MM:SS,IMSI,действие"
+};
+
+// Чтение трасс для воспроизведения. Все разборщики возвращают записи по возрастанию offset_ns,
+// первая запись — в момент 0; ошибка формата — std::runtime_error с номером строки или записи
+class TraceLoader {
+public:
+    // Формат по содержимому: магическое число pcap, метка времени CDR в первой строке, иначе CSV
+    static TraceFormat detect_format(const std::string& path);
+
+    // Загружает трассу; server_port — порт назначения запросов в pcap, protocol — кодирование
+    // запросов CSV и CDR (bcd или gtpv2c, ключ protocol клиента). pcap воспроизводится как есть
+    static std::vector<TraceRecord> load(const std::string& path, uint16_t server_port,
+        const std::string& protocol = "bcd");
+
+    // pcap (микро- и наносекундные метки, оба порядка байт; Ethernet, Linux SLL, сырой IPv4).
+    // Берутся датаграммы UDP к server_port: ответы сервера и чужой трафик пропускаются
+    static std::vector<TraceRecord> parse_pcap(const std::string& data, uint16_t server_port);
+
+    // CSV: время в секундах (дробное, от любой точки отсчёта), IMSI и необязательное действие.
+    // Строка заголовка и пустые строки пропускаются
+    static std::vector<TraceRecord> parse_csv(std::istream& in, const std::string& protocol = "bcd");
+
+    // CDR: created и rejected воспроизводятся запросом создания (повторный attach тоже),
+    // deleted — запросом удаления, включая удаления по таймауту. Метки CDR секундные, поэтому
+    // записи одной секунды распределяются по ней равномерно, без искусственных пачек.
+    // Сводная строка повторов отказа ("; repeated=N; first=...; last=...") даёт N запросов от first до last
+    static std::vector<TraceRecord> parse_cdr(std::istream& in, const std::string& protocol = "bcd");
+
+    // Датаграмма запроса. bcd: IMSI в BCD, для удаления с префиксом 0xFF.
+    // gtpv2c: Create или Delete Session Request с номером sequence; у каждой записи трассы свой
+    // номер, иначе сервер принял бы повторные attach за ретрансмиссии. Неверный IMSI — std::invalid_argument
+    static std::string encode_request(const std::string& imsi, bool delete_session,
+        const std::string& protocol = "bcd", uint32_t sequence = 1);
+};
+
+// Итоги воспроизведения: сколько отправлено и насколько отправка отстала от трассы
+struct ReplayReport {
+    size_t records = 0;
+    size_t sent = 0;
+    size_t send_errors = 0;
+    size_t replies = 0;
+    double speed = 1.0;
+    double intended_ms = 0;     // Длительность трассы с учётом ускорения
+    double achieved_ms = 0;     // Фактическое время от первой до последней отправки
+    double lateness_mean_us = 0;
+    double lateness_p50_us = 0;
+    double lateness_p99_us = 0;
+    double lateness_p999_us = 0;
+    double lateness_max_us = 0;
+    size_t late_over_1ms = 0;   // Отправок, опоздавших больше чем на 1 мс
+};
+
+// Воспроизведение трассы с исходными интервалами между запросами, ускоренными в speed раз.
+// Отправка не ждёт ответов (открытая нагрузка, как у реальных пиров); ответы считает отдельный поток.
+// Каждый запрос ждёт своего срока: сон clock_nanosleep по абсолютному времени до SPIN_WINDOW
+// перед сроком, затем опрос часов. Опоздание считается от запланированного срока, поэтому
+// задержка одной отправки не сдвигает расписание остальных
+class TraceReplayer {
+public:
+    TraceReplayer(const ClientConfig& config, std::shared_ptr<ILogger> logger);
+
+    // Запрещаем копирование
+    TraceReplayer(const TraceReplayer&) = delete;
+    TraceReplayer& operator=(const TraceReplayer&) = delete;
+
+    // Отправляет записи серверу из конфигурации; после последней ждёт ответы не дольше drain
+    ReplayReport replay(const std::vector<TraceRecord>& records, double speed,
+        std::chrono::milliseconds drain = std::chrono::milliseconds(1000));
+
+    // Итоги в формате key=value
+    static std::string format_report(const ReplayReport& report);
+
+private:
+    // Ждёт момента deadline по CLOCK_MONOTONIC
+    static void sleep_until(std::chrono::steady_clock::time_point deadline);
+
+    const ClientConfig& config;
+    std::shared_ptr<ILogger> logger;
+    static constexpr std::chrono::microseconds SPIN_WINDOW{ 200 };
+    static constexpr size_t BUFFER_SIZE = 2048;
+};
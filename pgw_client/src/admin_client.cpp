@@ -0,0 +1,145 @@
+#include "admin_client.hpp"
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+
+// Подключается к административному сокету
+AdminClient::AdminClient(const std::string& path, std::chrono::milliseconds timeout) {
+    struct sockaddr_un addr = {};
+    addr.sun_family = AF_UNIX;
+    if (path.empty() || path.size() >= sizeof(addr.sun_path)) {
+        throw std::runtime_error("Invalid admin socket path: " + path);
+    }
+    std::memcpy(addr.sun_path, path.c_str(), path.size());
+    fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        throw std::runtime_error("Failed to create admin client socket: " + std::string(strerror(errno)));
+    }
+    struct timeval tv;
+    tv.tv_sec = static_cast<time_t>(timeout.count() / 1000);
+    tv.tv_usec = static_cast<suseconds_t>((timeout.count() % 1000) * 1000);
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
+    if (connect(fd, (struct sockaddr*)&addr, sizeof(addr)) < 0) {
+        std::string error = strerror(errno);
+        close(fd);
+        throw std::runtime_error("Failed to connect to admin socket " + path + ": " + error);
+    }
+}
+
+AdminClient::~AdminClient() {
+    close(fd);
+}
+
+// Пачки IMSI идут подряд: новая отправляется по ответу на самую старую из window
+std::vector<uint8_t> AdminClient::check(const std::vector<std::string>& imsis, size_t batch, size_t window) {
+    batch = std::max<size_t>(1, std::min(batch, admin::MAX_CHECK_BATCH));
+    window = std::max<size_t>(1, window);
+    std::vector<uint8_t> result;
+    result.reserve(imsis.size());
+    size_t sent = 0;                // IMSI в отправленных запросах
+    size_t requests_in_flight = 0;
+    uint32_t first_id = next_id;    // Ответы приходят в порядке запросов
+    while (result.size() < imsis.size()) {
+        std::string frames;
+        while (sent < imsis.size() && requests_in_flight < window) {
+            size_t end = std::min(sent + batch, imsis.size());
+            admin::append_frame(frames, admin::MSG_CHECK, next_id++, admin::encode_check_request(imsis, sent, end));
+            sent = end;
+            ++requests_in_flight;
+        }
+        if (!frames.empty()) {
+            send_all(frames);
+        }
+        admin::Frame response = receive(admin::MSG_CHECK, first_id++);
+        --requests_in_flight;
+        std::vector<uint8_t> status;
+        size_t expected = std::min(batch, imsis.size() - result.size());
+        if (!admin::decode_check_response(response.payload, status) || status.size() != expected) {
+            throw std::runtime_error("Malformed admin CHECK response");
+        }
+        result.insert(result.end(), status.begin(), status.end());
+    }
+    return result;
+}
+
+// Запрашивает страницу выгрузки
+admin::ExportPage AdminClient::export_sessions(uint32_t cursor, uint32_t limit) {
+    uint32_t id = next_id++;
+    std::string frame;
+    admin::append_frame(frame, admin::MSG_EXPORT, id, admin::encode_export_request(cursor, limit));
+    send_all(frame);
+    admin::ExportPage page;
+    if (!admin::decode_export_response(receive(admin::MSG_EXPORT, id).payload, page)) {
+        throw std::runtime_error("Malformed admin EXPORT response");
+    }
+    return page;
+}
+
+// Запрашивает счётчики
+admin::Counters AdminClient::counters() {
+    uint32_t id = next_id++;
+    std::string frame;
+    admin::append_frame(frame, admin::MSG_COUNTERS, id, "");
+    send_all(frame);
+    admin::Counters result;
+    if (!admin::decode_counters_response(receive(admin::MSG_COUNTERS, id).payload, result)) {
+        throw std::runtime_error("Malformed admin COUNTERS response");
+    }
+    return result;
+}
+
+// Отправляет данные, повторяя частичные записи
+void AdminClient::send_all(const std::string& data) {
+    size_t offset = 0;
+    while (offset < data.size()) {
+        ssize_t n = send(fd, data.data() + offset, data.size() - offset, MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            throw std::runtime_error("Failed to send admin request: " + std::string(strerror(errno)));
+        }
+        offset += static_cast<size_t>(n);
+    }
+}
+
+// Читает до целого кадра и проверяет, что это ответ на запрос id
+admin::Frame AdminClient::receive(uint8_t type, uint32_t id) {
+    admin::Frame frame;
+    while (true) {
+        size_t consumed = admin::parse_frame(input.data(), input.size(), frame);
+        if (consumed > 0) {
+            input.erase(0, consumed);
+            break;
+        }
+        char buffer[64 * 1024];
+        ssize_t n = recv(fd, buffer, sizeof(buffer), 0);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n == 0) {
+            throw std::runtime_error("Admin socket closed by server");
+        }
+        if (n < 0) {
+            throw std::runtime_error("Failed to receive admin response: " + std::string(strerror(errno)));
+        }
+        input.append(buffer, static_cast<size_t>(n));
+    }
+    if (frame.id != id) {
+        throw std::runtime_error("Unexpected admin response id " + std::to_string(frame.id));
+    }
+    if (frame.type == admin::MSG_ERROR) {
+        int code = frame.payload.empty() ? 0 : static_cast<uint8_t>(frame.payload[0]);
+        throw std::runtime_error("Admin request failed with error " + std::to_string(code));
+    }
+    if (frame.type != type) {
+        throw std::runtime_error("Unexpected admin response type " + std::to_string(frame.type));
+    }
+    return frame;
+}
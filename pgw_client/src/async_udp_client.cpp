@@ -0,0 +1,368 @@
+#include "async_udp_client.hpp"
+#include "gtpv2c.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+
+namespace {
+
+// Текст ответа GTPv2-C по Cause, как в ответах режима BCD
+std::string cause_text(uint8_t cause) {
+    switch (cause) {
+    case gtpv2c::CAUSE_REQUEST_ACCEPTED: return "created";
+    case gtpv2c::CAUSE_REQUEST_REJECTED: return "rejected";
+    case gtpv2c::CAUSE_NO_RESOURCES_AVAILABLE: return "rejected: overload";
+    case gtpv2c::CAUSE_CONTEXT_NOT_FOUND: return "not found";
+    case gtpv2c::CAUSE_MANDATORY_IE_INCORRECT: return "rejected: invalid imsi";
+    default: return "cause " + std::to_string(cause);
+    }
+}
+
+} // namespace
+
+// Конструктор: колесо начинает отсчёт тиков с момента now
+TimerWheel::TimerWheel(std::chrono::milliseconds tick, size_t slots, std::chrono::steady_clock::time_point now)
+    : tick(tick), origin(now), slots(std::max<size_t>(slots, 1)) {
+}
+
+// Номер тика, округлённый вверх: таймер не срабатывает раньше срока
+uint64_t TimerWheel::tick_of(std::chrono::steady_clock::time_point time) const {
+    if (time <= origin) {
+        return 0;
+    }
+    auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(time - origin).count();
+    auto tick_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(tick).count();
+    return static_cast<uint64_t>((elapsed + tick_ns - 1) / tick_ns);
+}
+
+// Кладёт таймер в ячейку его тика
+void TimerWheel::schedule(uint64_t id, std::chrono::steady_clock::time_point deadline) {
+    uint64_t expires = std::max(tick_of(deadline), current_tick + 1);
+    slots[expires % slots.size()].push_back({ id, expires });
+    ++count;
+}
+
+// Обходит ячейки пройденных тиков; таймеры следующих оборотов остаются на месте
+void TimerWheel::advance(std::chrono::steady_clock::time_point now, const std::function<void(uint64_t)>& expired) {
+    uint64_t target = now <= origin ? 0 : static_cast<uint64_t>((now - origin) / tick);
+    // После долгого простоя достаточно одного оборота: дальше ячейки повторяются
+    if (target > current_tick + slots.size()) {
+        current_tick = target - slots.size();
+    }
+    std::vector<uint64_t> fired;
+    while (current_tick < target) {
+        ++current_tick;
+        auto& slot = slots[current_tick % slots.size()];
+        for (size_t i = 0; i < slot.size();) {
+            if (slot[i].expires_tick <= target) {
+                fired.push_back(slot[i].id);
+                slot[i] = slot.back();
+                slot.pop_back();
+                --count;
+            }
+            else {
+                ++i;
+            }
+        }
+    }
+    // Обработчик может ставить новые таймеры, поэтому вызывается после обхода
+    for (uint64_t id : fired) {
+        expired(id);
+    }
+}
+
+// Конструктор: неблокирующий сокет и поток ввода-вывода
+AsyncUDPClient::AsyncUDPClient(const ClientConfig& config, std::shared_ptr<ILogger> logger)
+    : config(config), logger(logger), gtp_mode(config.get_protocol() == "gtpv2c"),
+    window(gtp_mode ? std::min(static_cast<size_t>(config.get_max_in_flight()), MAX_WINDOW) : 1),
+    timeout(config.get_request_timeout_ms()), wake_fd(eventfd(0, EFD_NONBLOCK)),
+    wheel(WHEEL_TICK, WHEEL_SLOTS, std::chrono::steady_clock::now()) {
+    if (wake_fd < 0) {
+        throw std::runtime_error("Failed to create eventfd: " + std::string(strerror(errno)));
+    }
+    int flags = fcntl(socket.get_fd(), F_GETFL, 0);
+    if (flags < 0 || fcntl(socket.get_fd(), F_SETFL, flags | O_NONBLOCK) < 0) {
+        close(wake_fd);
+        throw std::runtime_error("Failed to make client socket non-blocking: " + std::string(strerror(errno)));
+    }
+    // Ответы на тысячи запросов приходят пачкой; ядро может урезать буфер до net.core.rmem_max
+    int buffer_size = 4 * 1024 * 1024;
+    setsockopt(socket.get_fd(), SOL_SOCKET, SO_RCVBUF, &buffer_size, sizeof(buffer_size));
+
+    server_addr = {};
+    server_addr.sin_family = AF_INET;
+    server_addr.sin_addr.s_addr = inet_addr(config.get_server_ip().c_str());
+    server_addr.sin_port = htons(config.get_server_port());
+
+    io_thread = std::thread(&AsyncUDPClient::io_loop, this);
+    logger->info("Async UDP Client initialized for server", config.get_server_ip() + ":" +
+        std::to_string(config.get_server_port()) + " (protocol: " + config.get_protocol() +
+        ", window: " + std::to_string(window) + ")");
+}
+
+// Деструктор: останавливает поток ввода-вывода
+AsyncUDPClient::~AsyncUDPClient() {
+    stop();
+    close(wake_fd);
+}
+
+// Ставит запрос в очередь и будит поток ввода-вывода
+void AsyncUDPClient::send_imsi(const std::string& imsi, ClientCallback callback) {
+    if (imsi.size() != gtpv2c::MAX_IMSI_DIGITS || imsi.find_first_not_of("0123456789") != std::string::npos) {
+        throw std::invalid_argument("Invalid IMSI format: must be 15 digits");
+    }
+    {
+        std::lock_guard<std::mutex> lock(queue_mutex);
+        if (running) {
+            Pending request;
+            request.imsi = imsi;
+            request.callback = std::move(callback);
+            queue.push_back(std::move(request));
+            callback = nullptr;
+        }
+    }
+    if (callback) {
+        ClientResult result;
+        result.imsi = imsi;
+        result.error = "stopped";
+        callback(result);
+        return;
+    }
+    uint64_t one = 1;
+    if (write(wake_fd, &one, sizeof(one)) < 0 && errno != EAGAIN) {
+        logger->error("Failed to wake client I/O thread: {}", strerror(errno));
+    }
+}
+
+// Результат через future: обработчик выполняет обещание
+std::future<ClientResult> AsyncUDPClient::send_imsi(const std::string& imsi) {
+    auto promise = std::make_shared<std::promise<ClientResult>>();
+    auto future = promise->get_future();
+    send_imsi(imsi, [promise](const ClientResult& result) { promise->set_value(result); });
+    return future;
+}
+
+// Ставит все запросы сразу: окно само ограничивает число запросов без ответа
+std::vector<ClientResult> AsyncUDPClient::send_imsis(const std::vector<std::string>& imsis) {
+    std::vector<std::future<ClientResult>> futures;
+    futures.reserve(imsis.size());
+    for (const auto& imsi : imsis) {
+        futures.push_back(send_imsi(imsi));
+    }
+    std::vector<ClientResult> results;
+    results.reserve(imsis.size());
+    for (auto& future : futures) {
+        results.push_back(future.get());
+    }
+    return results;
+}
+
+// Длина очереди неотправленных запросов
+size_t AsyncUDPClient::get_queued() const {
+    std::lock_guard<std::mutex> lock(queue_mutex);
+    return queue.size();
+}
+
+// Останавливает поток ввода-вывода
+void AsyncUDPClient::stop() {
+    {
+        std::lock_guard<std::mutex> lock(queue_mutex);
+        running = false;
+    }
+    uint64_t one = 1;
+    if (write(wake_fd, &one, sizeof(one)) < 0 && errno != EAGAIN) {
+        logger->error("Failed to wake client I/O thread: {}", strerror(errno));
+    }
+    if (io_thread.joinable()) {
+        io_thread.join();
+    }
+}
+
+// Ждёт ответы, новые запросы или тик колеса таймеров
+void AsyncUDPClient::io_loop() {
+    char buffer[BUFFER_SIZE];
+    while (running) {
+        send_queued();
+        struct pollfd fds[2] = { { socket.get_fd(), POLLIN, 0 }, { wake_fd, POLLIN, 0 } };
+        int wait_ms = pending.empty() ? -1 : static_cast<int>(WHEEL_TICK.count());
+        poll(fds, 2, wait_ms);
+        if (fds[1].revents & POLLIN) {
+            uint64_t value;
+            while (read(wake_fd, &value, sizeof(value)) > 0) {
+            }
+        }
+        while (true) {
+            ssize_t n = recvfrom(socket.get_fd(), buffer, sizeof(buffer), 0, nullptr, nullptr);
+            if (n < 0) {
+                if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                    logger->error("Failed to receive response: {}", strerror(errno));
+                }
+                break;
+            }
+            handle_reply(buffer, static_cast<size_t>(n));
+        }
+        wheel.advance(std::chrono::steady_clock::now(), [this](uint64_t id) { handle_timeout(id); });
+    }
+
+    // Остановка: запросы без ответа и неотправленные завершаются ошибкой
+    std::deque<Pending> unsent;
+    {
+        std::lock_guard<std::mutex> lock(queue_mutex);
+        unsent.swap(queue);
+    }
+    std::vector<uint32_t> sequences;
+    for (const auto& entry : pending) {
+        sequences.push_back(entry.first);
+    }
+    for (uint32_t sequence : sequences) {
+        ClientResult result;
+        result.error = "stopped";
+        complete(sequence, result);
+    }
+    for (auto& request : unsent) {
+        ClientResult result;
+        result.imsi = request.imsi;
+        result.error = "stopped";
+        if (request.callback) {
+            request.callback(result);
+        }
+    }
+}
+
+// Переносит запросы из очереди в окно
+void AsyncUDPClient::send_queued() {
+    std::deque<Pending> batch;
+    {
+        std::lock_guard<std::mutex> lock(queue_mutex);
+        while (pending.size() + batch.size() < window && !queue.empty()) {
+            batch.push_back(std::move(queue.front()));
+            queue.pop_front();
+        }
+    }
+    for (auto& request : batch) {
+        uint32_t sequence = next_sequence();
+        request.datagram = encode_request(request.imsi, sequence);
+        auto& stored = pending.emplace(sequence, std::move(request)).first->second;
+        transmit(sequence, stored);
+    }
+    in_flight = pending.size();
+}
+
+// Отправляет попытку; ошибка отправки не завершает запрос — его повторит таймер
+void AsyncUDPClient::transmit(uint32_t sequence, Pending& request) {
+    auto now = std::chrono::steady_clock::now();
+    if (request.attempts == 0) {
+        request.first_sent = now;
+    }
+    ++request.attempts;
+    request.deadline = now + timeout;
+    wheel.schedule(sequence, request.deadline);
+    if (sendto(socket.get_fd(), request.datagram.data(), request.datagram.size(), 0,
+        (struct sockaddr*)&server_addr, sizeof(server_addr)) < 0) {
+        logger->error("Failed to send IMSI: {}", strerror(errno));
+    }
+}
+
+// GTPv2-C: ответ находится по номеру последовательности. BCD: ответ принадлежит единственному запросу окна
+void AsyncUDPClient::handle_reply(const char* buffer, size_t length) {
+    ClientResult result;
+    uint32_t sequence = 0;
+    if (gtp_mode) {
+        gtpv2c::MessageView message;
+        if (gtpv2c::parse(reinterpret_cast<const uint8_t*>(buffer), length, message) != gtpv2c::ParseResult::OK ||
+            message.type != gtpv2c::CREATE_SESSION_RESPONSE) {
+            logger->warn("Dropped malformed response");
+            return;
+        }
+        sequence = message.sequence;
+        if (!gtpv2c::decode_cause(message.cause, result.cause)) {
+            logger->warn("Dropped response without Cause");
+            return;
+        }
+        result.response = cause_text(result.cause);
+    }
+    else {
+        if (pending.size() != 1) {
+            return;
+        }
+        sequence = pending.begin()->first;
+        result.response.assign(buffer, length);
+    }
+    if (pending.find(sequence) == pending.end()) {
+        // Ответ на повтор уже завершённого запроса
+        return;
+    }
+    result.ok = true;
+    complete(sequence, result);
+}
+
+// Срабатывание таймера: устаревшие таймеры (запрос завершён или повторён позже) пропускаются
+void AsyncUDPClient::handle_timeout(uint64_t id) {
+    uint32_t sequence = static_cast<uint32_t>(id);
+    auto it = pending.find(sequence);
+    if (it == pending.end() || it->second.deadline > std::chrono::steady_clock::now()) {
+        return;
+    }
+    if (it->second.attempts < config.get_request_retries()) {
+        logger->debug("Retransmitting IMSI", it->second.imsi);
+        transmit(sequence, it->second);
+        return;
+    }
+    ClientResult result;
+    result.error = "timeout";
+    complete(sequence, result);
+}
+
+// Освобождает место в окне до вызова обработчика: он может поставить новый запрос
+void AsyncUDPClient::complete(uint32_t sequence, ClientResult result) {
+    auto it = pending.find(sequence);
+    if (it == pending.end()) {
+        return;
+    }
+    Pending request = std::move(it->second);
+    pending.erase(it);
+    in_flight = pending.size();
+    result.imsi = request.imsi;
+    result.attempts = request.attempts;
+    if (result.ok) {
+        result.latency = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - request.first_sent);
+    }
+    if (request.callback) {
+        try {
+            request.callback(result);
+        }
+        catch (const std::exception& e) {
+            logger->error("Client callback failed: {}", e.what());
+        }
+    }
+}
+
+// Запрос создания сессии: GTPv2-C с F-TEID отправителя или IMSI в BCD
+std::string AsyncUDPClient::encode_request(const std::string& imsi, uint32_t sequence) const {
+    if (gtp_mode) {
+        uint8_t buffer[128];
+        gtpv2c::FTEID sender;
+        sender.interface_type = gtpv2c::S5S8_SGW_GTPC;
+        sender.teid = sequence;
+        size_t length = gtpv2c::encode_create_session_request(buffer, sizeof(buffer), sequence, imsi.data(), imsi.size(), sender);
+        return std::string(reinterpret_cast<const char*>(buffer), length);
+    }
+    return encode_imsi_bcd(imsi);
+}
+
+// Номер последовательности, не занятый запросом без ответа; 0 не используется
+uint32_t AsyncUDPClient::next_sequence() {
+    do {
+        last_sequence = (last_sequence + 1) & SEQUENCE_MASK;
+    } while (last_sequence == 0 || pending.count(last_sequence) != 0);
+    return last_sequence;
+}
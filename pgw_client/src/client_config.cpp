@@ -1,51 +1,81 @@
-#include "client_config.hpp"
-#include <fstream>
-#include <stdexcept>
-#include <filesystem>
-
-// :    JSON-
-ClientConfig::ClientConfig(const std::string& config_file) {
-    //   
-    if (!std::filesystem::exists(config_file)) {
-        throw std::runtime_error("Client config file does not exist: " + config_file);
-    }
-
-    std::ifstream file(config_file);
-    if (!file.is_open()) {
-        throw std::runtime_error("Failed to open client config file: " + config_file);
-    }
-
-    nlohmann::json json;
-    try {
-        file >> json;
-    }
-    catch (const nlohmann::json::exception& e) {
-        throw std::runtime_error("Failed to parse client config file: " + std::string(e.what()));
-    }
-
-    //     
-    if (json.contains("server_ip") && json["server_ip"].is_string()) {
-        server_ip = json["server_ip"];
-    }
-    else {
-        server_ip = DEFAULT_SERVER_IP;
-    }
-    if (json.contains("server_port") && json["server_port"].is_number_integer()) {
-        server_port = json["server_port"];
-    }
-    else {
-        server_port = DEFAULT_SERVER_PORT;
-    }
-    if (json.contains("log_file") && json["log_file"].is_string()) {
-        log_file = json["log_file"];
-    }
-    else {
-        log_file = DEFAULT_LOG_FILE;
-    }
-    if (json.contains("log_level") && json["log_level"].is_string()) {
-        log_level = json["log_level"];
-    }
-    else {
-        log_level = DEFAULT_LOG_LEVEL;
-    }
+#include "client_config.hpp"
+#include <fstream>
+#include <stdexcept>
+#include <filesystem>
+
+// Конструктор: загружает и парсит JSON-конфигурацию
+ClientConfig::ClientConfig(const std::string& config_file) {
+    // Проверяем существование файла
+    if (!std::filesystem::exists(config_file)) {
+        throw std::runtime_error("Client config file does not exist: " + config_file);
+    }
+
+    std::ifstream file(config_file);
+    if (!file.is_open()) {
+        throw std::runtime_error("Failed to open client config file: " + config_file);
+    }
+
+    nlohmann::json json;
+    try {
+        file >> json;
+    }
+    catch (const nlohmann::json::exception& e) {
+        throw std::runtime_error("Failed to parse client config file: " + std::string(e.what()));
+    }
+
+    // Проверяем типы и устанавливаем значения
+    if (json.contains("server_ip") && json["server_ip"].is_string()) {
+        server_ip = json["server_ip"];
+    }
+    else {
+        server_ip = DEFAULT_SERVER_IP;
+    }
+    if (json.contains("server_port") && json["server_port"].is_number_integer()) {
+        server_port = json["server_port"];
+    }
+    else {
+        server_port = DEFAULT_SERVER_PORT;
+    }
+    if (json.contains("log_file") && json["log_file"].is_string()) {
+        log_file = json["log_file"];
+    }
+    else {
+        log_file = DEFAULT_LOG_FILE;
+    }
+    if (json.contains("log_level") && json["log_level"].is_string()) {
+        log_level = json["log_level"];
+    }
+    else {
+        log_level = DEFAULT_LOG_LEVEL;
+    }
+    if (json.contains("protocol") && json["protocol"].is_string()) {
+        protocol = json["protocol"];
+    }
+    else {
+        protocol = DEFAULT_PROTOCOL;
+    }
+    if (protocol != "bcd" && protocol != "gtpv2c") {
+        throw std::runtime_error("Invalid protocol in client config file: " + protocol);
+    }
+    if (json.contains("request_timeout_ms") && json["request_timeout_ms"].is_number_integer()) {
+        request_timeout_ms = json["request_timeout_ms"];
+    }
+    else {
+        request_timeout_ms = DEFAULT_REQUEST_TIMEOUT_MS;
+    }
+    if (json.contains("request_retries") && json["request_retries"].is_number_integer()) {
+        request_retries = json["request_retries"];
+    }
+    else {
+        request_retries = DEFAULT_REQUEST_RETRIES;
+    }
+    if (json.contains("max_in_flight") && json["max_in_flight"].is_number_integer()) {
+        max_in_flight = json["max_in_flight"];
+    }
+    else {
+        max_in_flight = DEFAULT_MAX_IN_FLIGHT;
+    }
+    if (request_timeout_ms < 1 || request_retries < 1 || max_in_flight < 1) {
+        throw std::runtime_error("Invalid request_timeout_ms/request_retries/max_in_flight in client config file");
+    }
 }
\ No newline at end of file
@@ -1,54 +1,199 @@
-#include "udp_client.hpp"
-#include "client_config.hpp"
-#include "logger.hpp"
-#include <iostream>
-#include <regex>
-
-//   
-int main(int argc, char* argv[]) {
-    try {
-        //    
-        if (argc < 2) {
-            std::cerr << "Usage: " << argv[0] << " <imsi> [config_file]" << std::endl;
-            return 1;
-        }
-
-        std::string imsi = argv[1];
-        //   IMSI
-        if (!std::regex_match(imsi, std::regex("^[0-9]{15}$"))) {
-            std::cerr << "Error: IMSI must be 15 digits" << std::endl;
-            return 1;
-        }
-
-        std::string config_path = (argc > 2) ? argv[2] : "client_config.json";
-        ClientConfig config(config_path);
-
-        //  
-        Logger::init(config.get_log_file(), config.get_log_level());
-        auto logger = Logger::get();
-        logger->info("Starting PGW Client...", ""); //    std::string
-
-        //    
-        UDPClient client(config, logger);
-        std::string response;
-        if (client.send_imsi(imsi, response)) {
-            std::cout << "Response: " << response << std::endl;
-            logger->info("Request sent for IMSI: {}", imsi);
-            return 0;
-        }
-        else {
-            std::cerr << "Error: Failed to receive response" << std::endl;
-            logger->error("Client failed: Failed to receive response for IMSI: {}", imsi);
-            return 1;
-        }
-    }
-    catch (const std::exception& e) {
-        std::cerr << "Error: " << e.what() << std::endl;
-        if (Logger::get()) {
-            Logger::get()->error("Client failed: {}", e.what());
-        }
-        return 1;
-    }
-
-    return 0;
+#include "udp_client.hpp"
+#include "client_config.hpp"
+#include "trace_replay.hpp"
+#include "async_udp_client.hpp"
+#include "admin_client.hpp"
+#include "logger.hpp"
+#include <fstream>
+#include <iostream>
+#include <regex>
+
+// Воспроизводит трассу: pgw_client --replay <trace_file> [speed] [config_file]
+int run_replay(int argc, char* argv[]) {
+    if (argc < 3) {
+        std::cerr << "Usage: " << argv[0] << " --replay <trace_file> [speed] [config_file]" << std::endl;
+        return 1;
+    }
+    std::string trace_path = argv[2];
+    double speed = (argc > 3) ? std::stod(argv[3]) : 1.0;
+    std::string config_path = (argc > 4) ? argv[4] : "client_config.json";
+    ClientConfig config(config_path);
+
+    Logger::init(config.get_log_file(), config.get_log_level());
+    auto logger = Logger::get();
+    auto records = TraceLoader::load(trace_path, static_cast<uint16_t>(config.get_server_port()), config.get_protocol());
+    logger->info("Loaded trace", trace_path + " (" + std::to_string(records.size()) + " requests)");
+
+    TraceReplayer replayer(config, logger);
+    auto report = replayer.replay(records, speed);
+    std::cout << TraceReplayer::format_report(report);
+    return report.send_errors == 0 ? 0 : 1;
+}
+
+// Читает IMSI по одному в строке из файла или stdin ("-"); IMSI не из 15 цифр — std::runtime_error
+std::vector<std::string> read_imsi_list(const std::string& path) {
+    std::ifstream file;
+    if (path != "-") {
+        file.open(path);
+        if (!file.is_open()) {
+            throw std::runtime_error("Failed to open IMSI file: " + path);
+        }
+    }
+    std::istream& in = (path == "-") ? std::cin : file;
+    std::vector<std::string> imsis;
+    std::string line;
+    while (std::getline(in, line)) {
+        if (!line.empty() && line.back() == '\r') {
+            line.pop_back();
+        }
+        if (line.empty()) {
+            continue;
+        }
+        if (!std::regex_match(line, std::regex("^[0-9]{15}$"))) {
+            throw std::runtime_error("IMSI must be 15 digits: " + line);
+        }
+        imsis.push_back(line);
+    }
+    return imsis;
+}
+
+// Пакетный режим: pgw_client --batch <imsi_file|-> [config_file], IMSI по одному в строке.
+// Запросы идут конвейером (в режиме gtpv2c), итоги печатаются в порядке файла
+int run_batch(int argc, char* argv[]) {
+    if (argc < 3) {
+        std::cerr << "Usage: " << argv[0] << " --batch <imsi_file|-> [config_file]" << std::endl;
+        return 1;
+    }
+    std::string path = argv[2];
+    std::string config_path = (argc > 3) ? argv[3] : "client_config.json";
+    ClientConfig config(config_path);
+
+    Logger::init(config.get_log_file(), config.get_log_level());
+    auto logger = Logger::get();
+    auto imsis = read_imsi_list(path);
+
+    AsyncUDPClient client(config, logger);
+    auto start = std::chrono::steady_clock::now();
+    auto results = client.send_imsis(imsis);
+    double elapsed_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    size_t failed = 0;
+    for (const auto& result : results) {
+        if (result.ok) {
+            std::cout << result.imsi << ": " << result.response << std::endl;
+        }
+        else {
+            std::cout << result.imsi << ": error: " << result.error << std::endl;
+            ++failed;
+        }
+    }
+    logger->info("Batch finished", std::to_string(results.size()) + " requests in " +
+        std::to_string(static_cast<long long>(elapsed_ms)) + " ms, failed: " + std::to_string(failed));
+    return failed == 0 ? 0 : 1;
+}
+
+// Административный сокет сервера: pgw_client --admin <socket> check <imsi_file|-> | export | counters
+int run_admin(int argc, char* argv[]) {
+    if (argc < 4) {
+        std::cerr << "Usage: " << argv[0] << " --admin <socket> check <imsi_file|-> | export | counters" << std::endl;
+        return 1;
+    }
+    AdminClient client(argv[2]);
+    std::string command = argv[3];
+    if (command == "check" && argc > 4) {
+        auto imsis = read_imsi_list(argv[4]);
+        auto status = client.check(imsis);
+        for (size_t i = 0; i < imsis.size(); ++i) {
+            const char* state = status[i] == admin::CHECK_ACTIVE ? "active"
+                : status[i] == admin::CHECK_NOT_OWNED ? "not owned by this node" : "not active";
+            std::cout << imsis[i] << ": " << state << std::endl;
+        }
+        return 0;
+    }
+    if (command == "export") {
+        // Страницы до пустой: за последним непустым шардом сервер отдаёт пустую страницу
+        uint32_t cursor = 0;
+        while (true) {
+            auto page = client.export_sessions(cursor, 10000);
+            if (page.sessions.empty()) {
+                break;
+            }
+            for (const auto& session : page.sessions) {
+                std::cout << session.imsi << "," << session.creation_time_ms << "," << session.expires_at_ms << std::endl;
+            }
+            if (page.next_cursor <= cursor) {
+                throw std::runtime_error("Admin export cursor did not advance");
+            }
+            cursor = page.next_cursor;
+        }
+        return 0;
+    }
+    if (command == "counters") {
+        for (const auto& counter : client.counters()) {
+            std::cout << counter.first << "=" << counter.second << std::endl;
+        }
+        return 0;
+    }
+    std::cerr << "Unknown admin command: " << command << std::endl;
+    return 1;
+}
+
+// Точка входа клиента
+int main(int argc, char* argv[]) {
+    try {
+        // Проверяем аргументы командной строки
+        if (argc < 2) {
+            std::cerr << "Usage: " << argv[0] << " <imsi> [config_file]" << std::endl;
+            std::cerr << "       " << argv[0] << " --replay <trace_file> [speed] [config_file]" << std::endl;
+            std::cerr << "       " << argv[0] << " --batch <imsi_file|-> [config_file]" << std::endl;
+            std::cerr << "       " << argv[0] << " --admin <socket> check <imsi_file|-> | export | counters" << std::endl;
+            return 1;
+        }
+        if (std::string(argv[1]) == "--admin") {
+            return run_admin(argc, argv);
+        }
+        if (std::string(argv[1]) == "--batch") {
+            return run_batch(argc, argv);
+        }
+        if (std::string(argv[1]) == "--replay") {
+            return run_replay(argc, argv);
+        }
+
+        std::string imsi = argv[1];
+        // Проверяем формат IMSI
+        if (!std::regex_match(imsi, std::regex("^[0-9]{15}$"))) {
+            std::cerr << "Error: IMSI must be 15 digits" << std::endl;
+            return 1;
+        }
+
+        std::string config_path = (argc > 2) ? argv[2] : "client_config.json";
+        ClientConfig config(config_path);
+
+        // Инициализируем логгер
+        Logger::init(config.get_log_file(), config.get_log_level());
+        auto logger = Logger::get();
+        logger->info("Starting PGW Client...", ""); // Явное преобразование в std::string
+
+        // Создаём и запускаем клиент
+        UDPClient client(config, logger);
+        std::string response;
+        if (client.send_imsi(imsi, response)) {
+            std::cout << "Response: " << response << std::endl;
+            logger->info("Request sent for IMSI: {}", imsi);
+            return 0;
+        }
+        else {
+            std::cerr << "Error: Failed to receive response" << std::endl;
+            logger->error("Client failed: Failed to receive response for IMSI: {}", imsi);
+            return 1;
+        }
+    }
+    catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        if (Logger::get()) {
+            Logger::get()->error("Client failed: {}", e.what());
+        }
+        return 1;
+    }
+
+    return 0;
 }
\ No newline at end of file
@@ -0,0 +1,514 @@
+#include "trace_replay.hpp"
+#include "udp_client.hpp"
+#include "gtpv2c.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cmath>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+namespace {
+
+constexpr uint32_t PCAP_MAGIC_US = 0xa1b2c3d4;
+constexpr uint32_t PCAP_MAGIC_NS = 0xa1b23c4d;
+constexpr uint32_t LINKTYPE_ETHERNET = 1;
+constexpr uint32_t LINKTYPE_RAW = 101;
+constexpr uint32_t LINKTYPE_LINUX_SLL = 113;
+constexpr uint32_t LINKTYPE_IPV4 = 228;
+constexpr uint32_t LINKTYPE_LINUX_SLL2 = 276;
+constexpr uint16_t ETHERTYPE_IPV4 = 0x0800;
+constexpr uint16_t ETHERTYPE_VLAN = 0x8100;
+
+// Читает 32-битное поле заголовка pcap в порядке байт файла
+uint32_t read_u32(const std::string& data, size_t offset, bool swapped) {
+    uint32_t value;
+    std::memcpy(&value, data.data() + offset, sizeof(value));
+    return swapped ? __builtin_bswap32(value) : value;
+}
+
+// Читает 16-битное поле сетевого заголовка (big-endian)
+uint16_t read_be16(const uint8_t* data) {
+    return static_cast<uint16_t>((data[0] << 8) | data[1]);
+}
+
+// Смещение заголовка IPv4 в кадре; npos — кадр не IPv4 или канальный уровень не поддерживается
+size_t ipv4_offset(uint32_t linktype, const uint8_t* frame, size_t length) {
+    switch (linktype) {
+    case LINKTYPE_ETHERNET: {
+        if (length < 14) {
+            return std::string::npos;
+        }
+        size_t offset = 14;
+        uint16_t ethertype = read_be16(frame + 12);
+        if (ethertype == ETHERTYPE_VLAN && length >= 18) {
+            ethertype = read_be16(frame + 16);
+            offset = 18;
+        }
+        return ethertype == ETHERTYPE_IPV4 ? offset : std::string::npos;
+    }
+    case LINKTYPE_LINUX_SLL:
+        return (length >= 16 && read_be16(frame + 14) == ETHERTYPE_IPV4) ? 16 : std::string::npos;
+    case LINKTYPE_LINUX_SLL2:
+        return (length >= 20 && read_be16(frame) == ETHERTYPE_IPV4) ? 20 : std::string::npos;
+    case LINKTYPE_RAW:
+    case LINKTYPE_IPV4:
+        return 0;
+    default:
+        return std::string::npos;
+    }
+}
+
+// Номер последовательности GTPv2-C записи index: 24 бита, 0 не используется
+uint32_t trace_sequence(size_t index) {
+    return static_cast<uint32_t>(index % 0xFFFFFF) + 1;
+}
+
+// Переводит времена в смещения от первой записи
+std::vector<TraceRecord> normalize(std::vector<TraceRecord> records) {
+    std::stable_sort(records.begin(), records.end(),
+        [](const TraceRecord& a, const TraceRecord& b) { return a.offset_ns < b.offset_ns; });
+    if (!records.empty()) {
+        int64_t first = records.front().offset_ns;
+        for (auto& record : records) {
+            record.offset_ns -= first;
+        }
+    }
+    return records;
+}
+
+// Убирает пробелы и \r по краям поля
+std::string trim(const std::string& field) {
+    size_t begin = field.find_first_not_of(" \t\r");
+    if (begin == std::string::npos) {
+        return "";
+    }
+    size_t end = field.find_last_not_of(" \t\r");
+    return field.substr(begin, end - begin + 1);
+}
+
+// Делит строку на поля по запятым
+std::vector<std::string> split_fields(const std::string& line) {
+    std::vector<std::string> fields;
+    std::stringstream ss(line);
+    std::string field;
+    while (std::getline(ss, field, ',')) {
+        fields.push_back(trim(field));
+    }
+    return fields;
+}
+
+// Метка времени CDR "YYYY-MM-DD HH:MM:SS" в секундах местного времени; -1 — не разобрана
+int64_t parse_cdr_time(const std::string& field) {
+    std::tm tm = {};
+    std::istringstream ss(field);
+    ss >> std::get_time(&tm, "%Y-%m-%d %H:%M:%S");
+    if (ss.fail()) {
+        return -1;
+    }
+    tm.tm_isdst = -1;
+    return static_cast<int64_t>(std::mktime(&tm));
+}
+
+// Значение поля "; name=value" сводной строки отказов CDR; пусто — поля нет
+std::string coalesced_field(const std::string& action, const std::string& name) {
+    std::string marker = "; " + name + "=";
+    size_t begin = action.find(marker);
+    if (begin == std::string::npos) {
+        return "";
+    }
+    begin += marker.size();
+    return action.substr(begin, action.find(';', begin) - begin);
+}
+
+} // namespace
+
+// Определяет формат по первым байтам файла
+TraceFormat TraceLoader::detect_format(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        throw std::runtime_error("Failed to open trace file: " + path);
+    }
+    uint32_t magic = 0;
+    file.read(reinterpret_cast<char*>(&magic), sizeof(magic));
+    if (file.gcount() == sizeof(magic) && (magic == PCAP_MAGIC_US || magic == PCAP_MAGIC_NS ||
+        magic == __builtin_bswap32(PCAP_MAGIC_US) || magic == __builtin_bswap32(PCAP_MAGIC_NS))) {
+        return TraceFormat::Pcap;
+    }
+    file.clear();
+    file.seekg(0);
+    std::string line;
+    std::getline(file, line);
+    std::tm tm = {};
+    std::istringstream ss(line);
+    ss >> std::get_time(&tm, "%Y-%m-%d %H:%M:%S");
+    return ss.fail() ? TraceFormat::Csv : TraceFormat::Cdr;
+}
+
+// Загружает трассу в формате, определённом по содержимому
+std::vector<TraceRecord> TraceLoader::load(const std::string& path, uint16_t server_port,
+    const std::string& protocol) {
+    TraceFormat format = detect_format(path);
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        throw std::runtime_error("Failed to open trace file: " + path);
+    }
+    switch (format) {
+    case TraceFormat::Pcap: {
+        std::string data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        return parse_pcap(data, server_port);
+    }
+    case TraceFormat::Cdr:
+        return parse_cdr(file, protocol);
+    default:
+        return parse_csv(file, protocol);
+    }
+}
+
+// Разбирает pcap: оборванная последняя запись (tcpdump остановлен посреди записи) не считается ошибкой
+std::vector<TraceRecord> TraceLoader::parse_pcap(const std::string& data, uint16_t server_port) {
+    if (data.size() < 24) {
+        throw std::runtime_error("Invalid pcap: file is shorter than the global header");
+    }
+    uint32_t magic;
+    std::memcpy(&magic, data.data(), sizeof(magic));
+    bool swapped = magic == __builtin_bswap32(PCAP_MAGIC_US) || magic == __builtin_bswap32(PCAP_MAGIC_NS);
+    uint32_t native_magic = swapped ? __builtin_bswap32(magic) : magic;
+    if (native_magic != PCAP_MAGIC_US && native_magic != PCAP_MAGIC_NS) {
+        throw std::runtime_error("Invalid pcap: unknown magic number");
+    }
+    int64_t fraction_ns = native_magic == PCAP_MAGIC_NS ? 1 : 1000;
+    uint32_t linktype = read_u32(data, 20, swapped) & 0xFFFF;
+    if (linktype != LINKTYPE_ETHERNET && linktype != LINKTYPE_RAW && linktype != LINKTYPE_LINUX_SLL &&
+        linktype != LINKTYPE_IPV4 && linktype != LINKTYPE_LINUX_SLL2) {
+        throw std::runtime_error("Invalid pcap: unsupported link type " + std::to_string(linktype));
+    }
+
+    std::vector<TraceRecord> records;
+    size_t offset = 24;
+    while (offset + 16 <= data.size()) {
+        int64_t seconds = read_u32(data, offset, swapped);
+        int64_t fraction = read_u32(data, offset + 4, swapped);
+        size_t captured = read_u32(data, offset + 8, swapped);
+        offset += 16;
+        if (captured > data.size() - offset) {
+            break;
+        }
+        const uint8_t* frame = reinterpret_cast<const uint8_t*>(data.data()) + offset;
+        offset += captured;
+
+        size_t ip = ipv4_offset(linktype, frame, captured);
+        if (ip == std::string::npos || captured < ip + 20 || (frame[ip] >> 4) != 4) {
+            continue;
+        }
+        size_t header_length = static_cast<size_t>(frame[ip] & 0x0F) * 4;
+        // Только UDP и только целые датаграммы: фрагменты не собираются
+        if (header_length < 20 || frame[ip + 9] != IPPROTO_UDP || (read_be16(frame + ip + 6) & 0x3FFF) != 0 ||
+            captured < ip + header_length + 8) {
+            continue;
+        }
+        const uint8_t* udp = frame + ip + header_length;
+        if (read_be16(udp + 2) != server_port) {
+            continue;
+        }
+        size_t udp_length = read_be16(udp + 4);
+        if (udp_length < 8) {
+            continue;
+        }
+        size_t payload = std::min(udp_length - 8, captured - ip - header_length - 8);
+        TraceRecord record;
+        record.offset_ns = seconds * 1000000000 + fraction * fraction_ns;
+        record.datagram.assign(reinterpret_cast<const char*>(udp + 8), payload);
+        records.push_back(std::move(record));
+    }
+    return normalize(std::move(records));
+}
+
+// Разбирает CSV "время_с,IMSI[,действие]"
+std::vector<TraceRecord> TraceLoader::parse_csv(std::istream& in, const std::string& protocol) {
+    std::vector<TraceRecord> records;
+    std::string line;
+    size_t line_number = 0;
+    bool first = true;
+    while (std::getline(in, line)) {
+        ++line_number;
+        auto fields = split_fields(line);
+        if (fields.empty() || (fields.size() == 1 && fields[0].empty())) {
+            continue;
+        }
+        double seconds;
+        try {
+            size_t parsed = 0;
+            seconds = std::stod(fields[0], &parsed);
+            if (parsed != fields[0].size() || !std::isfinite(seconds)) {
+                throw std::invalid_argument(fields[0]);
+            }
+        }
+        catch (const std::exception&) {
+            if (first) {
+                first = false;  // Заголовок
+                continue;
+            }
+            throw std::runtime_error("Invalid trace time at line " + std::to_string(line_number));
+        }
+        first = false;
+        if (fields.size() < 2) {
+            throw std::runtime_error("Missing IMSI at line " + std::to_string(line_number));
+        }
+        std::string action = fields.size() > 2 ? fields[2] : "create";
+        bool delete_session = action == "delete" || action == "deleted";
+        if (!delete_session && action != "create" && action != "created") {
+            throw std::runtime_error("Invalid trace action at line " + std::to_string(line_number) + ": " + action);
+        }
+        TraceRecord record;
+        record.offset_ns = std::llround(seconds * 1e9);
+        try {
+            record.datagram = encode_request(fields[1], delete_session, protocol, trace_sequence(records.size()));
+        }
+        catch (const std::invalid_argument& e) {
+            throw std::runtime_error(std::string(e.what()) + " at line " + std::to_string(line_number));
+        }
+        records.push_back(std::move(record));
+    }
+    return normalize(std::move(records));
+}
+
+// Разбирает cdr.log; записи одной секунды получают равные доли этой секунды
+std::vector<TraceRecord> TraceLoader::parse_cdr(std::istream& in, const std::string& protocol) {
+    // Запрос кодируется после разворота сводных строк: каждому повтору свой номер последовательности
+    struct Entry {
+        int64_t second;
+        std::string imsi;
+        bool delete_session;
+    };
+    std::vector<Entry> entries;
+    std::string line;
+    size_t line_number = 0;
+    while (std::getline(in, line)) {
+        ++line_number;
+        if (trim(line).empty()) {
+            continue;
+        }
+        auto fields = split_fields(line);
+        int64_t second = parse_cdr_time(fields[0]);
+        if (second < 0 || fields.size() < 3) {
+            throw std::runtime_error("Invalid CDR record at line " + std::to_string(line_number));
+        }
+        const std::string& action = fields[2];
+        bool delete_session = action == "deleted";
+        if (!delete_session && action != "created" && action.rfind("rejected", 0) != 0) {
+            throw std::runtime_error("Invalid CDR action at line " + std::to_string(line_number) + ": " + action);
+        }
+        try {
+            encode_request(fields[1], delete_session, protocol);
+        }
+        catch (const std::invalid_argument& e) {
+            throw std::runtime_error(std::string(e.what()) + " at line " + std::to_string(line_number));
+        }
+        std::string repeated = coalesced_field(action, "repeated");
+        if (repeated.empty()) {
+            entries.push_back({ second, fields[1], delete_session });
+            continue;
+        }
+        // Сводная строка повторов отказа: repeated запросов равномерно от first до last
+        int64_t count = 0;
+        int64_t first = parse_cdr_time(coalesced_field(action, "first"));
+        int64_t last = parse_cdr_time(coalesced_field(action, "last"));
+        try {
+            count = std::stoll(repeated);
+        }
+        catch (const std::exception&) {
+        }
+        if (count < 1 || first < 0 || last < first) {
+            throw std::runtime_error("Invalid coalesced CDR record at line " + std::to_string(line_number));
+        }
+        for (int64_t i = 0; i < count; ++i) {
+            entries.push_back({ first + (count > 1 ? (last - first) * i / (count - 1) : 0), fields[1], delete_session });
+        }
+    }
+    // Сводные строки пишутся при закрытии окна, позже строк с более поздними метками
+    std::stable_sort(entries.begin(), entries.end(),
+        [](const Entry& a, const Entry& b) { return a.second < b.second; });
+
+    // CDR пишется под мьютексом по порядку событий, поэтому порядок строк внутри секунды сохраняется
+    std::vector<TraceRecord> records;
+    records.reserve(entries.size());
+    for (size_t begin = 0; begin < entries.size();) {
+        size_t end = begin;
+        while (end < entries.size() && entries[end].second == entries[begin].second) {
+            ++end;
+        }
+        for (size_t i = begin; i < end; ++i) {
+            TraceRecord record;
+            record.offset_ns = entries[i].second * 1000000000 +
+                static_cast<int64_t>((i - begin) * 1000000000 / (end - begin));
+            record.datagram = encode_request(entries[i].imsi, entries[i].delete_session, protocol, trace_sequence(i));
+            records.push_back(std::move(record));
+        }
+        begin = end;
+    }
+    return normalize(std::move(records));
+}
+
+// Кодирует запрос: GTPv2-C как AsyncUDPClient или IMSI в BCD (TS 29.274 §8.3), как UDPClient;
+// удаление в BCD — маркер 0xFF перед IMSI
+std::string TraceLoader::encode_request(const std::string& imsi, bool delete_session, const std::string& protocol,
+    uint32_t sequence) {
+    if (imsi.size() != 15 || imsi.find_first_not_of("0123456789") != std::string::npos) {
+        throw std::invalid_argument("Invalid IMSI format: " + imsi);
+    }
+    if (protocol == "gtpv2c") {
+        uint8_t buffer[128];
+        size_t length;
+        if (delete_session) {
+            length = gtpv2c::encode_delete_session_request(buffer, sizeof(buffer), 0, sequence, imsi.data(), imsi.size());
+        }
+        else {
+            gtpv2c::FTEID sender;
+            sender.interface_type = gtpv2c::S5S8_SGW_GTPC;
+            sender.teid = sequence;
+            length = gtpv2c::encode_create_session_request(buffer, sizeof(buffer), sequence, imsi.data(), imsi.size(), sender);
+        }
+        return std::string(reinterpret_cast<const char*>(buffer), length);
+    }
+    std::string datagram;
+    if (delete_session) {
+        datagram.push_back(static_cast<char>(0xFF));
+    }
+    datagram += encode_imsi_bcd(imsi);
+    return datagram;
+}
+
+// Конструктор: запоминает адрес сервера из конфигурации
+TraceReplayer::TraceReplayer(const ClientConfig& config, std::shared_ptr<ILogger> logger)
+    : config(config), logger(logger) {
+}
+
+// Отправляет записи по расписанию трассы и считает опоздания
+ReplayReport TraceReplayer::replay(const std::vector<TraceRecord>& records, double speed, std::chrono::milliseconds drain) {
+    if (!(speed > 0) || !std::isfinite(speed)) {
+        throw std::invalid_argument("Replay speed must be a positive number");
+    }
+    ReplayReport report;
+    report.records = records.size();
+    report.speed = speed;
+    if (records.empty()) {
+        return report;
+    }
+
+    struct sockaddr_in server_addr = {};
+    server_addr.sin_family = AF_INET;
+    server_addr.sin_addr.s_addr = inet_addr(config.get_server_ip().c_str());
+    server_addr.sin_port = htons(config.get_server_port());
+
+    ClientSocket socket;
+    socket.set_timeout(100);
+    std::atomic<size_t> replies{ 0 };
+    std::atomic<bool> receiving{ true };
+    std::thread receiver([&socket, &replies, &receiving]() {
+        char buffer[BUFFER_SIZE];
+        while (receiving) {
+            if (recvfrom(socket.get_fd(), buffer, sizeof(buffer), 0, nullptr, nullptr) >= 0) {
+                replies.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+    });
+
+    logger->info("Replaying trace", std::to_string(records.size()) + " requests to " + config.get_server_ip() + ":" +
+        std::to_string(config.get_server_port()) + " at speed " + std::to_string(speed));
+    std::vector<int64_t> lateness_ns;
+    lateness_ns.reserve(records.size());
+    auto start = std::chrono::steady_clock::now();
+    std::chrono::steady_clock::time_point first_sent;
+    std::chrono::steady_clock::time_point last_sent;
+    for (const auto& record : records) {
+        auto intended = start + std::chrono::nanoseconds(std::llround(record.offset_ns / speed));
+        sleep_until(intended);
+        auto sent_at = std::chrono::steady_clock::now();
+        if (lateness_ns.empty()) {
+            first_sent = sent_at;
+        }
+        last_sent = sent_at;
+        lateness_ns.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(sent_at - intended).count());
+        if (sendto(socket.get_fd(), record.datagram.data(), record.datagram.size(), 0,
+            (struct sockaddr*)&server_addr, sizeof(server_addr)) < 0) {
+            ++report.send_errors;
+            logger->error("Failed to send trace request: {}", strerror(errno));
+            continue;
+        }
+        ++report.sent;
+    }
+
+    auto deadline = std::chrono::steady_clock::now() + drain;
+    while (replies.load() < report.sent && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    receiving = false;
+    receiver.join();
+    report.replies = replies.load();
+
+    report.intended_ms = records.back().offset_ns / speed / 1e6;
+    report.achieved_ms = std::chrono::duration<double, std::milli>(last_sent - first_sent).count();
+    double total_us = 0;
+    for (int64_t lateness : lateness_ns) {
+        total_us += lateness / 1e3;
+        if (lateness > 1000000) {
+            ++report.late_over_1ms;
+        }
+    }
+    std::sort(lateness_ns.begin(), lateness_ns.end());
+    auto percentile = [&lateness_ns](double p) {
+        return lateness_ns[std::min(lateness_ns.size() - 1, static_cast<size_t>(p * lateness_ns.size()))] / 1e3;
+    };
+    report.lateness_mean_us = total_us / lateness_ns.size();
+    report.lateness_p50_us = percentile(0.5);
+    report.lateness_p99_us = percentile(0.99);
+    report.lateness_p999_us = percentile(0.999);
+    report.lateness_max_us = lateness_ns.back() / 1e3;
+    logger->info("Trace replay finished", std::to_string(report.sent) + " sent, " + std::to_string(report.replies) + " replies");
+    return report;
+}
+
+// Итоги воспроизведения
+std::string TraceReplayer::format_report(const ReplayReport& report) {
+    std::stringstream ss;
+    ss << std::fixed << std::setprecision(1);
+    ss << "records=" << report.records << "\n"
+       << "sent=" << report.sent << "\n"
+       << "send_errors=" << report.send_errors << "\n"
+       << "replies=" << report.replies << "\n"
+       << "speed=" << report.speed << "\n"
+       << "intended_ms=" << report.intended_ms << "\n"
+       << "achieved_ms=" << report.achieved_ms << "\n"
+       << "lateness_mean_us=" << report.lateness_mean_us << "\n"
+       << "lateness_p50_us=" << report.lateness_p50_us << "\n"
+       << "lateness_p99_us=" << report.lateness_p99_us << "\n"
+       << "lateness_p999_us=" << report.lateness_p999_us << "\n"
+       << "lateness_max_us=" << report.lateness_max_us << "\n"
+       << "late_over_1ms=" << report.late_over_1ms << "\n";
+    return ss.str();
+}
+
+// steady_clock в Linux идёт по CLOCK_MONOTONIC: сон по абсолютному сроку не накапливает
+// погрешность пробуждений, а последние SPIN_WINDOW добираются опросом часов
+void TraceReplayer::sleep_until(std::chrono::steady_clock::time_point deadline) {
+    auto wake = deadline - SPIN_WINDOW;
+    if (std::chrono::steady_clock::now() < wake) {
+        int64_t ns = std::chrono::duration_cast<std::chrono::nanoseconds>(wake.time_since_epoch()).count();
+        struct timespec ts;
+        ts.tv_sec = static_cast<time_t>(ns / 1000000000);
+        ts.tv_nsec = static_cast<long>(ns % 1000000000);
+        while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, nullptr) == EINTR) {
+        }
+    }
+    while (std::chrono::steady_clock::now() < deadline) {
+    }
+}
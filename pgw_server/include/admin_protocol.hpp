@@ -0,0 +1,89 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Двоичный протокол локального административного сокета (Unix domain socket).
+// Кадр: длина (4) остатка кадра, тип (1), номер запроса (4), данные; целые — сетевой порядок байт.
+// Ответ несёт тип и номер запроса, поэтому клиент может слать запросы подряд, не дожидаясь ответов:
+// сервер отвечает на запросы соединения в порядке их прихода.
+//   CHECK    запрос: число IMSI (2), затем IMSI: длина (1), цифры. Ответ: число (2), по байту CheckStatus на IMSI
+//   EXPORT   запрос: курсор (4), предел (4). Ответ: следующий курсор (4; SHARDS — конец), число (4),
+//            сессии: длина IMSI (1), IMSI, время создания в мс (8), время истечения в мс (8)
+//   COUNTERS запрос без данных. Ответ: число (2), счётчики: длина имени (1), имя, значение (8)
+//   ERROR    ответ на ошибочный запрос: код (1)
+namespace admin {
+
+enum MessageType : uint8_t {
+    MSG_CHECK = 1,
+    MSG_EXPORT = 2,
+    MSG_COUNTERS = 3,
+    MSG_ERROR = 127
+};
+
+// Состояние IMSI в ответе CHECK
+enum CheckStatus : uint8_t {
+    CHECK_INACTIVE = 0,         // Сессии нет
+    CHECK_ACTIVE = 1,           // Есть сессия
+    CHECK_NOT_OWNED = 2         // В кластере IMSI принадлежит другому узлу: его сессию этот узел не знает
+};
+
+enum ErrorCode : uint8_t {
+    ERROR_MALFORMED = 1,        // Данные запроса не разобраны или вне пределов
+    ERROR_UNKNOWN_TYPE = 2,
+    ERROR_UNAVAILABLE = 3       // Компонент для запроса не подключён
+};
+
+constexpr size_t LENGTH_SIZE = 4;
+constexpr size_t HEADER_SIZE = 9;               // Длина, тип, номер запроса
+constexpr size_t MAX_FRAME_SIZE = 1 << 24;      // Наибольшая длина кадра без поля длины
+constexpr size_t MAX_CHECK_BATCH = 4096;        // IMSI в одном запросе CHECK
+constexpr uint32_t MAX_EXPORT_LIMIT = 100000;   // Предел запроса EXPORT; ответ больше на остаток шарда
+
+// Кадр без поля длины
+struct Frame {
+    uint8_t type = 0;
+    uint32_t id = 0;
+    std::string payload;
+};
+
+// Сессия в ответе EXPORT
+struct ExportedSession {
+    std::string imsi;
+    int64_t creation_time_ms = 0;
+    int64_t expires_at_ms = 0;
+};
+
+// Страница выгрузки
+struct ExportPage {
+    uint32_t next_cursor = 0;
+    std::vector<ExportedSession> sessions;
+};
+
+using Counters = std::vector<std::pair<std::string, uint64_t>>;
+
+// Дописывает кадр в out
+void append_frame(std::string& out, uint8_t type, uint32_t id, const std::string& payload);
+
+// Выделяет первый кадр из data: число прочитанных байт или 0, если кадр пришёл не целиком.
+// Кадр длиннее MAX_FRAME_SIZE или короче заголовка — std::invalid_argument: поток дальше не разобрать
+size_t parse_frame(const char* data, size_t size, Frame& frame);
+
+// Данные CHECK для imsis[begin, end); разбор — false, если данные испорчены
+std::string encode_check_request(const std::vector<std::string>& imsis, size_t begin, size_t end);
+bool decode_check_request(const std::string& payload, std::vector<std::string>& imsis);
+std::string encode_check_response(const std::vector<uint8_t>& active);
+bool decode_check_response(const std::string& payload, std::vector<uint8_t>& active);
+
+std::string encode_export_request(uint32_t cursor, uint32_t limit);
+bool decode_export_request(const std::string& payload, uint32_t& cursor, uint32_t& limit);
+std::string encode_export_response(const ExportPage& page);
+bool decode_export_response(const std::string& payload, ExportPage& page);
+
+std::string encode_counters_response(const Counters& counters);
+bool decode_counters_response(const std::string& payload, Counters& counters);
+
+} // namespace admin
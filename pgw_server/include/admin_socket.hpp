@@ -0,0 +1,111 @@
+#pragma once
+
+#include "config.hpp"
+#include "interfaces.hpp"
+#include "admin_protocol.hpp"
+#include "admission_control.hpp"
+#include "hash_ring.hpp"
+#include "session_manager.hpp"
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <thread>
+#include <unordered_map>
+
+// Локальный административный интерфейс для агентов на том же хосте: двоичный протокол admin
+// (admin_protocol.hpp) поверх Unix domain socket по пути admin_socket_path.
+// Дешевле HTTP: нет разбора текста и TCP, проверка пачки IMSI — один кадр, запросы
+// соединения можно слать подряд, не дожидаясь ответов. Все соединения обслуживает один поток
+// на epoll с неблокирующими сокетами; пока клиент не забрал ответы, его запросы не читаются
+class AdminSocket {
+public:
+    // Соединений одновременно не больше; лишние закрываются сразу после приёма
+    static constexpr size_t MAX_CONNECTIONS = 64;
+    // Неотправленных ответов соединения больше этого — чтение его запросов приостанавливается
+    static constexpr size_t MAX_PENDING_OUTPUT = 4 << 20;
+
+    // sessions — проверки абонентов. Передаётся локальная таблица, не ClusterSessionManager:
+    // пересылка владельцу заняла бы поток epoll на время обмена, поэтому в кластере CHECK
+    // отвечает только о сессиях этого узла, а для IMSI других узлов — CHECK_NOT_OWNED
+    AdminSocket(const Config& config, std::shared_ptr<ISessionManager> sessions, std::shared_ptr<ILogger> logger);
+    ~AdminSocket();
+
+    // Запрещаем копирование: поток держит указатель на объект
+    AdminSocket(const AdminSocket&) = delete;
+    AdminSocket& operator=(const AdminSocket&) = delete;
+
+    // Создаёт сокет (прежний файл по этому пути удаляется) с правами 0660 и запускает поток.
+    // Ошибка создания — std::runtime_error
+    void run();
+
+    // Останавливает поток, закрывает соединения и удаляет файл сокета
+    void stop();
+
+    // Подключает таблицу сессий для EXPORT и счётчика sessions; без неё EXPORT отвечает ERROR_UNAVAILABLE
+    void set_session_export(std::shared_ptr<SessionManager> session_table);
+
+    // Подключает допуск запросов для счётчиков COUNTERS
+    void set_admission_control(std::shared_ptr<AdmissionControl> admission_control);
+
+    uint64_t get_connections() const { return connections_accepted.load(std::memory_order_relaxed); }
+    uint64_t get_requests() const { return requests.load(std::memory_order_relaxed); }
+    uint64_t get_lookups() const { return lookups.load(std::memory_order_relaxed); }
+    uint64_t get_errors() const { return errors.load(std::memory_order_relaxed); }
+    uint64_t get_not_owned() const { return not_owned.load(std::memory_order_relaxed); }
+
+private:
+    // Соединение клиента; меняется только в потоке сокета
+    struct Connection {
+        int fd = -1;
+        std::string input;          // Принятые байты, ещё не разобранные в кадры
+        std::string output;         // Ответы, ещё не отправленные
+        size_t output_offset = 0;   // Отправленная часть output
+        uint32_t events = 0;        // Интерес в epoll
+    };
+
+    // Цикл потока: приём соединений, чтение запросов, отправка ответов
+    void loop();
+
+    // Принимает ожидающие соединения
+    void accept_connections();
+
+    // Читает, обрабатывает и отправляет; false — соединение закрыто или нарушило протокол
+    bool serve(Connection& connection, bool readable);
+
+    // Обрабатывает кадры из input, пока хватает места для ответов; false — поток не разобрать
+    bool process_input(Connection& connection);
+
+    // Отправляет накопленные ответы до EAGAIN; false — ошибка сокета
+    bool flush_output(Connection& connection);
+
+    // Ответ на запрос
+    void handle(const admin::Frame& request, std::string& output);
+
+    // Текущие счётчики для COUNTERS
+    admin::Counters counters() const;
+
+    void close_connection(int fd);
+
+    const Config& config;
+    std::shared_ptr<ISessionManager> sessions;
+    std::shared_ptr<ILogger> logger;
+    std::shared_ptr<SessionManager> session_table;
+    std::shared_ptr<AdmissionControl> admission_control;
+    std::unique_ptr<HashRing> ring;     // Кольцо кластера; nullptr — без кластера
+    size_t node_id = 0;
+
+    std::string path;
+    int listen_fd = -1;
+    int epoll_fd = -1;
+    int wake_fd = -1;
+    std::thread thread;
+    std::atomic<bool> running{ false };
+    std::unordered_map<int, std::unique_ptr<Connection>> connections;
+
+    std::atomic<uint64_t> connections_accepted{ 0 };
+    std::atomic<uint64_t> requests{ 0 };
+    std::atomic<uint64_t> lookups{ 0 };
+    std::atomic<uint64_t> errors{ 0 };
+    std::atomic<uint64_t> not_owned{ 0 };
+};
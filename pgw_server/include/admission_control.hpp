@@ -0,0 +1,68 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <netinet/in.h>
+
+// Контроль допуска на входе UDP-сервера: токен-бакет на каждый адрес источника
+// и общий предел глубины очереди запросов. Пределы меняются во время работы.
+class AdmissionControl {
+public:
+    // rate_per_sec <= 0 отключает ограничение по пирам, max_queue_depth = 0 — предел очереди
+    AdmissionControl(double rate_per_sec, double burst, size_t max_queue_depth, size_t table_size = 4096);
+
+    // Запрещаем копирование
+    AdmissionControl(const AdmissionControl&) = delete;
+    AdmissionControl& operator=(const AdmissionControl&) = delete;
+
+    // Списывает токен пира; false — пир превысил свою скорость.
+    // Вызывается только из потока приёма, поэтому таблица бакетов без блокировок.
+    bool admit_peer(const struct sockaddr_in& peer, std::chrono::steady_clock::time_point now);
+
+    // Проверяет глубину очереди перед постановкой запроса; false — перегрузка
+    bool admit_queue(size_t queue_depth);
+
+    // Меняет пределы во время работы (из любого потока)
+    void set_limits(double rate_per_sec, double burst, size_t max_queue_depth);
+
+    double get_rate_per_sec() const { return rate_per_sec.load(); }
+    double get_burst() const { return burst.load(); }
+    size_t get_max_queue_depth() const { return max_queue_depth.load(); }
+
+    // Счётчики
+    uint64_t get_admitted() const { return admitted.load(); }
+    uint64_t get_rate_limited() const { return rate_limited.load(); }
+    uint64_t get_overloaded() const { return overloaded.load(); }
+    uint64_t get_evicted_peers() const { return evicted_peers.load(); }
+
+    // Текстовый отчёт для HTTP API
+    std::string report() const;
+
+private:
+    // Бакет пира в компактной хеш-таблице с открытой адресацией
+    struct Bucket {
+        uint32_t addr;      // IPv4-адрес источника (сетевой порядок байт)
+        bool used;
+        double tokens;
+        int64_t last_ns;    // Время последнего пополнения
+    };
+
+    // Число проб при поиске; при неудаче вытесняется самый давний бакет
+    static constexpr size_t MAX_PROBES = 8;
+
+    // Бакет адреса; новый бакет получает capacity токенов — тот же предел, что и при пополнении
+    Bucket& find_bucket(uint32_t addr, double capacity, int64_t now_ns);
+
+    std::unique_ptr<Bucket[]> buckets;
+    size_t mask;
+    std::atomic<double> rate_per_sec;
+    std::atomic<double> burst;
+    std::atomic<size_t> max_queue_depth;
+    std::atomic<uint64_t> admitted{ 0 };
+    std::atomic<uint64_t> rate_limited{ 0 };
+    std::atomic<uint64_t> overloaded{ 0 };
+    std::atomic<uint64_t> evicted_peers{ 0 };
+};
\ No newline at end of file
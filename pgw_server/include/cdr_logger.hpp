@@ -1,32 +1,87 @@
-#pragma once
-
-#include "config.hpp"
-#include <logger.hpp>
-#include <string>
-#include <fstream>
-#include <mutex>
-#include "interfaces.hpp"
-
-// Реализация CDRLogger для записи событий в файл CDR
-class CDRLogger {
-public:
-    // Конструктор принимает конфигурацию и логгер
-    CDRLogger(const Config& config, std::shared_ptr<ILogger> logger);
-    ~CDRLogger();
-
-    // Запрещаем копирование для предотвращения дублирования файловых дескрипторов
-    CDRLogger(const CDRLogger&) = delete;
-    CDRLogger& operator=(const CDRLogger&) = delete;
-
-    // Записывает событие в CDR-файл в формате: timestamp,IMSI,action
-    void log(const std::string& imsi, const std::string& action);
-
-    // Возвращает логгер для диагностики
-    std::shared_ptr<ILogger> get_logger() const { return logger; }
-
-private:
-    const Config& config;               // Конфигурация сервера
-    std::ofstream file;                // Файловый поток для CDR
-    std::mutex mutex;                  // Мьютекс для потокобезопасности
-    std::shared_ptr<ILogger> logger;   // Логгер для диагностики
+#pragma once
+
+#include "config.hpp"
+#include "clock.hpp"
+#include "session_events.hpp"
+#include "flight_recorder.hpp"
+#include "lock_profiler.hpp"
+#include <logger.hpp>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <fstream>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+#include "interfaces.hpp"
+
+// Реализация CDRLogger для записи событий в файл CDR.
+// Повторы одного отказа (одинаковые IMSI и action, начинающийся с "rejected") в течение
+// cdr_reject_coalesce_ms сводятся: первый отказ пишется сразу, остальные — одной строкой при закрытии окна
+class CDRLogger {
+public:
+    // Конструктор принимает конфигурацию и логгер; clock — источник меток CDR (по умолчанию часы процесса)
+    CDRLogger(const Config& config, std::shared_ptr<ILogger> logger, std::shared_ptr<IClock> clock = nullptr);
+    ~CDRLogger();
+
+    // Запрещаем копирование для предотвращения дублирования файловых дескрипторов
+    CDRLogger(const CDRLogger&) = delete;
+    CDRLogger& operator=(const CDRLogger&) = delete;
+
+    // Записывает событие в CDR-файл в формате: timestamp,IMSI,action
+    void log(const std::string& imsi, const std::string& action);
+
+    // Пишет сводные строки окон сведения, которые уже закрылись. Вызывается периодически,
+    // чтобы сводка появлялась и тогда, когда новых записей нет
+    void flush_coalesced();
+
+    // Отказов, не записанных отдельной строкой, за всё время
+    uint64_t get_coalesced_rejects() const { return coalesced_rejects.load(std::memory_order_relaxed); }
+
+    // Возвращает логгер для диагностики
+    std::shared_ptr<ILogger> get_logger() const { return logger; }
+
+    // Часы меток CDR; менеджер сессий по умолчанию берёт их же
+    std::shared_ptr<IClock> get_clock() const { return clock; }
+
+    // Подключает поток событий /session_events: каждая запись CDR публикуется в него
+    void set_event_stream(std::shared_ptr<SessionEventStream> event_stream);
+
+    // Подключает бортовой самописец: запись каждой строки с ожиданием мьютекса. Вызывается до начала обработки
+    void set_flight_recorder(std::shared_ptr<FlightRecorder> flight_recorder);
+
+private:
+    // Окно сведения повторов одного отказа
+    struct CoalescedReject {
+        std::string key;                                    // IMSI и action, ключ в coalesced
+        std::string imsi;
+        std::string action;
+        std::chrono::steady_clock::time_point opened_at;    // Когда записан первый отказ окна
+        std::chrono::system_clock::time_point first;        // Первый и последний повтор
+        std::chrono::system_clock::time_point last;
+        uint64_t repeats = 0;                               // Повторов после первого отказа
+    };
+
+    // Пишет строку CDR и публикует событие; вызывается под mutex
+    void write_line(std::chrono::system_clock::time_point time, const std::string& imsi, const std::string& action);
+
+    // Закрывает окно: сводная строка, если в окне были повторы; вызывается под mutex
+    void close_window(std::list<CoalescedReject>::iterator window);
+
+    // Закрывает окна, открытые раньше now - окно; вызывается под mutex
+    void close_expired_windows(std::chrono::steady_clock::time_point now);
+
+    const Config& config;               // Конфигурация сервера
+    std::ofstream file;                // Файловый поток для CDR
+    ProfiledMutex mutex{ "cdr_logger" };  // Мьютекс для потокобезопасности
+    std::shared_ptr<ILogger> logger;   // Логгер для диагностики
+    std::shared_ptr<IClock> clock;     // Источник времени меток
+    std::shared_ptr<SessionEventStream> event_stream; // Подписчики на события сессий
+    std::shared_ptr<FlightRecorder> flight_recorder;  // nullptr — самописец выключен
+    const std::chrono::milliseconds coalesce_window;  // 0 — без сведения
+    const size_t coalesce_max_windows;                // При переполнении раньше срока закрывается самое старое окно
+    std::list<CoalescedReject> windows;               // Открытые окна в порядке открытия
+    std::unordered_map<std::string, std::list<CoalescedReject>::iterator> coalesced;
+    std::atomic<uint64_t> coalesced_rejects{ 0 };
 };
\ No newline at end of file
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <ctime>
+#include <memory>
+
+// Источник времени для сессий и CDR. Истечение сессий считается по монотонным часам,
+// которые не прыгают при переводе системных; время реального мира нужно только для записей
+// CDR и времени создания в репликации. Подмена часов позволяет проверять истечение без ожидания
+class IClock {
+public:
+    // Монотонное время: по нему истекают сессии
+    virtual std::chrono::steady_clock::time_point monotonic_now() const = 0;
+
+    // Время реального мира: метки CDR и время создания сессий для репликации
+    virtual std::chrono::system_clock::time_point wall_now() const = 0;
+
+    virtual ~IClock() = default;
+};
+
+// Часы процесса: steady_clock и system_clock
+class SystemClock : public IClock {
+public:
+    std::chrono::steady_clock::time_point monotonic_now() const override { return std::chrono::steady_clock::now(); }
+    std::chrono::system_clock::time_point wall_now() const override { return std::chrono::system_clock::now(); }
+};
+
+// Ускоренные часы для длительных прогонов: с момента создания время идёт в scale раз быстрее.
+// Таймаут сессии 30 с при scale = 30 истекает за секунду реального времени
+class ScaledClock : public IClock {
+public:
+    explicit ScaledClock(double scale);
+
+    std::chrono::steady_clock::time_point monotonic_now() const override;
+    std::chrono::system_clock::time_point wall_now() const override;
+
+    double get_scale() const { return scale; }
+
+private:
+    // Прошедшее с создания часов время, умноженное на scale
+    std::chrono::nanoseconds scaled_elapsed() const;
+
+    const double scale;
+    const std::chrono::steady_clock::time_point start_monotonic;
+    const std::chrono::system_clock::time_point start_wall;
+};
+
+// Ручные часы для тестов: стоят, пока их не сдвинут. advance() двигает оба времени,
+// jump_wall() — только время реального мира, как перевод системных часов
+class ManualClock : public IClock {
+public:
+    ManualClock();
+
+    std::chrono::steady_clock::time_point monotonic_now() const override;
+    std::chrono::system_clock::time_point wall_now() const override;
+
+    // Сдвигает время вперёд
+    void advance(std::chrono::nanoseconds delta);
+
+    // Переводит только часы реального мира (в любую сторону)
+    void jump_wall(std::chrono::nanoseconds delta);
+
+private:
+    const std::chrono::steady_clock::time_point start_monotonic;
+    const std::chrono::system_clock::time_point start_wall;
+    std::atomic<int64_t> monotonic_offset_ns{ 0 };
+    std::atomic<int64_t> wall_offset_ns{ 0 };
+};
+
+// Часы по clock_scale из конфигурации: 1 — часы процесса, больше 1 — ускоренные
+std::shared_ptr<IClock> make_clock(double scale);
+
+// Текущее время CLOCK_REALTIME в нс: в этих часах ядро ставит метки SO_TIMESTAMPNS,
+// поэтому задержки от приёма ядром считаются по нему, а не по IClock
+inline int64_t realtime_ns() {
+    struct timespec now;
+    clock_gettime(CLOCK_REALTIME, &now);
+    return static_cast<int64_t>(now.tv_sec) * 1000000000 + now.tv_nsec;
+}
@@ -0,0 +1,147 @@
+#pragma once
+
+#include "config.hpp"
+#include "interfaces.hpp"
+#include "hash_ring.hpp"
+#include "response_cache.hpp"
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include <netinet/in.h>
+
+// Менеджер сессий узла кластера. Пространство IMSI делится между узлами кольцом
+// согласованного хеширования; операции над своими IMSI выполняются локальным
+// менеджером, над чужими — пересылаются владельцу по внутреннему UDP-каналу
+// (адреса узлов — cluster_nodes). UDP- и HTTP-серверы работают с ним через
+// ISessionManager, поэтому /check_subscriber отвечает по всему кластеру.
+// Запрос без ответа повторяется с тем же номером в пределах cluster_timeout_ms; владелец
+// отвечает на повтор сохранённым ответом, не выполняя операцию второй раз.
+// Пересылка занимает вызывающий поток до ответа, поэтому узел после DOWN_AFTER_TIMEOUTS таймаутов
+// подряд считается недоступным: запросы к нему отклоняются сразу, без пересылки, а поток проверки
+// раз в cluster_timeout_ms шлёт ему пробный запрос. Любой кадр от узла возвращает его в строй.
+class ClusterSessionManager : public ISessionManager {
+public:
+    // Конструктор: local — менеджер сессий этого узла
+    ClusterSessionManager(const Config& config, std::shared_ptr<ISessionManager> local, std::shared_ptr<ILogger> logger);
+    ~ClusterSessionManager();
+
+    // Открывает внутренний канал и запускает потоки приёма
+    void run();
+
+    // Останавливает канал и локальный менеджер
+    void stop() override;
+
+    bool create_session(const std::string& imsi, SessionResources* resources = nullptr) override;
+    bool has_session(const std::string& imsi) override;
+    bool delete_session(const std::string& imsi, SessionResources* resources = nullptr) override;
+    bool find_session_by_teid(uint32_t teid, std::string& imsi) override;
+    bool is_reachable(const std::string& imsi) override;
+
+    // Группирует IMSI по владельцам; удалённые узлы обрабатывают свои IMSI параллельно
+    size_t delete_sessions(const std::vector<std::string>& imsis) override;
+
+    // Номер узла-владельца IMSI и номер этого узла
+    size_t owner(const std::string& imsi) const { return ring.owner(imsi); }
+    size_t get_node_id() const { return node_id; }
+
+    // Отчёт в формате key=value: узел, размер кластера и счётчики пересылки
+    std::string report() const;
+
+private:
+    enum Operation : uint8_t {
+        OP_CREATE = 1,
+        OP_DELETE = 2,
+        OP_CHECK = 3
+    };
+
+    // Ответ владельца: результат операции и ресурсы созданной сессии
+    struct Reply {
+        bool ok = false;
+        SessionResources resources;
+    };
+
+    // Пересылаемый запрос, ожидающий ответа; кадр хранится для повторов
+    struct Call {
+        uint32_t id = 0;
+        size_t node = 0;
+        std::string frame;
+        std::chrono::steady_clock::time_point sent_at;
+        std::future<Reply> reply;
+    };
+
+    // Отправок одного запроса за cluster_timeout_ms, включая первую
+    static constexpr int ATTEMPTS = 3;
+    // Ответов, сохранённых для повторов чужих запросов
+    static constexpr size_t REPLY_CACHE_SIZE = 65536;
+    // Таймаутов подряд, после которых узел считается недоступным
+    static constexpr uint32_t DOWN_AFTER_TIMEOUTS = 3;
+
+    // Состояние связи с узлом
+    struct NodeHealth {
+        std::atomic<uint32_t> timeouts{ 0 };    // Таймауты подряд
+        std::atomic<bool> down{ false };
+    };
+
+    // Отправляет запрос узлу-владельцу
+    Call forward(size_t node, Operation operation, const std::string& imsi, uint32_t peer_teid = 0);
+
+    // Отправляет кадр запроса владельцу
+    void send_call(const Call& call);
+
+    // Ждёт ответа не дольше cluster_timeout_ms от первой отправки, повторяя запрос каждую
+    // ATTEMPTS-ю часть таймаута; при таймауте запрос забывается и результат false
+    bool wait(Call& call, Reply& reply);
+
+    // Пересылает запрос и ждёт ответа; к недоступному узлу запрос не отправляется
+    bool call_remote(size_t node, Operation operation, const std::string& imsi, SessionResources* resources = nullptr);
+
+    // Учитывает результат ожидания ответа узла: таймаут или ответ
+    void record_timeout(size_t node);
+
+    // Возвращает в строй узел, от которого пришёл кадр
+    void mark_alive(const struct sockaddr_in& from);
+
+    // Раз в cluster_timeout_ms отправляет пробный запрос недоступным узлам
+    void probe_loop();
+
+    // Принимает запросы других узлов и ответы на свои запросы
+    void receive_loop();
+
+    // Выполняет запрос другого узла на локальном менеджере и отвечает ему.
+    // Повтор уже выполненного запроса (тот же узел и номер) получает сохранённый ответ
+    void handle_request(const uint8_t* data, size_t length, const struct sockaddr_in& from);
+
+    // Завершает ожидающий запрос
+    void handle_response(const uint8_t* data, size_t length);
+
+    const Config& config;
+    std::shared_ptr<ISessionManager> local;
+    std::shared_ptr<ILogger> logger;
+    HashRing ring;
+    size_t node_id;
+    std::vector<struct sockaddr_in> nodes;      // Адреса внутреннего канала по номерам узлов
+    int fd = -1;
+    std::atomic<bool> running{ false };
+    std::vector<std::thread> receivers;
+    std::thread prober;
+    std::unique_ptr<NodeHealth[]> health;       // По номерам узлов
+    std::atomic<uint32_t> down_nodes{ 0 };
+    std::mutex pending_mutex;
+    std::unordered_map<uint32_t, std::promise<Reply>> pending;
+    std::atomic<uint32_t> next_id;              // Начальное значение случайно: номера не повторяются после перезапуска
+    ResponseCache replies;                      // Ответы на запросы других узлов по (адрес узла, номер)
+    std::atomic<uint64_t> forwarded{ 0 };       // Запросы, отправленные владельцам
+    std::atomic<uint64_t> served{ 0 };          // Запросы других узлов, выполненные здесь
+    std::atomic<uint64_t> timeouts{ 0 };        // Запросы без ответа за cluster_timeout_ms
+    std::atomic<uint64_t> retransmits{ 0 };     // Повторные отправки своих запросов
+    std::atomic<uint64_t> duplicates{ 0 };      // Повторы чужих запросов, не выполненные второй раз
+    std::atomic<uint64_t> unreachable{ 0 };     // Запросы, отклонённые без пересылки: владелец недоступен
+    std::atomic<uint64_t> probes{ 0 };          // Пробные запросы недоступным узлам
+    static constexpr size_t NUM_RECEIVERS = 4;
+};
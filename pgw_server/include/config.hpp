@@ -1,44 +1,148 @@
-#pragma once
-
-#include <nlohmann/json.hpp>
-#include <string>
-#include <vector>
-
-// Класс для хранения конфигурации сервера, загружаемой из JSON
-class Config {
-public:
-    // Конструктор: загружает конфигурацию из файла
-    explicit Config(const std::string& config_file);
-
-    // Геттеры для параметров конфигурации
-    std::string get_udp_ip() const { return udp_ip; }
-    int get_udp_port() const { return udp_port; }
-    int get_session_timeout_sec() const { return session_timeout_sec; }
-    std::string get_cdr_file() const { return cdr_file; }
-    int get_http_port() const { return http_port; }
-    int get_graceful_shutdown_rate() const { return graceful_shutdown_rate; }
-    std::string get_log_file() const { return log_file; }
-    std::string get_log_level() const { return log_level; }
-    const std::vector<std::string>& get_blacklist() const { return blacklist; }
-
-private:
-    // Значения по умолчанию
-    static constexpr const char* DEFAULT_UDP_IP = "0.0.0.0";
-    static constexpr int DEFAULT_UDP_PORT = 9000;
-    static constexpr int DEFAULT_SESSION_TIMEOUT = 30;
-    static constexpr const char* DEFAULT_CDR_FILE = "cdr.log";
-    static constexpr int DEFAULT_HTTP_PORT = 8080;
-    static constexpr int DEFAULT_SHUTDOWN_RATE = 10;
-    static constexpr const char* DEFAULT_LOG_FILE = "pgw.log";
-    static constexpr const char* DEFAULT_LOG_LEVEL = "INFO";
-
-    std::string udp_ip;
-    int udp_port;
-    int session_timeout_sec;
-    std::string cdr_file;
-    int http_port;
-    int graceful_shutdown_rate;
-    std::string log_file;
-    std::string log_level;
-    std::vector<std::string> blacklist;
+#pragma once
+
+#include <nlohmann/json.hpp>
+#include <string>
+#include <vector>
+
+// Класс для хранения конфигурации сервера, загружаемой из JSON
+class Config {
+public:
+    // Конструктор: загружает конфигурацию из файла
+    explicit Config(const std::string& config_file);
+
+    // Геттеры для параметров конфигурации
+    std::string get_udp_ip() const { return udp_ip; }
+    int get_udp_port() const { return udp_port; }
+    int get_session_timeout_sec() const { return session_timeout_sec; }
+    std::string get_cdr_file() const { return cdr_file; }
+    int get_http_port() const { return http_port; }
+    int get_graceful_shutdown_rate() const { return graceful_shutdown_rate; }
+    std::string get_log_file() const { return log_file; }
+    std::string get_log_level() const { return log_level; }
+    const std::vector<std::string>& get_blacklist() const { return blacklist; }
+    int get_retransmit_ttl_ms() const { return retransmit_ttl_ms; }
+    int get_retransmit_cache_size() const { return retransmit_cache_size; }
+    int get_rate_limit_per_sec() const { return rate_limit_per_sec; }
+    int get_rate_limit_burst() const { return rate_limit_burst; }
+    int get_max_queue_depth() const { return max_queue_depth; }
+    std::string get_protocol() const { return protocol; }
+    int get_teid_pool_size() const { return teid_pool_size; }
+    const std::vector<std::string>& get_ip_pools() const { return ip_pools; }
+    const std::vector<std::string>& get_cluster_nodes() const { return cluster_nodes; }
+    int get_cluster_node_id() const { return cluster_node_id; }
+    int get_cluster_timeout_ms() const { return cluster_timeout_ms; }
+    std::string get_replication_role() const { return replication_role; }
+    std::string get_replication_address() const { return replication_address; }
+    int get_replication_batch_ms() const { return replication_batch_ms; }
+    int get_replication_checksum_sec() const { return replication_checksum_sec; }
+    int get_replication_takeover_ms() const { return replication_takeover_ms; }
+    int get_worker_threads_min() const { return worker_threads_min; }
+    int get_worker_threads_max() const { return worker_threads_max; }
+    int get_worker_grow_wait_us() const { return worker_grow_wait_us; }
+    int get_worker_shrink_idle_ms() const { return worker_shrink_idle_ms; }
+    bool get_busy_poll() const { return busy_poll; }
+    int get_busy_poll_idle_ms() const { return busy_poll_idle_ms; }
+    int get_busy_poll_cpu() const { return busy_poll_cpu; }
+    int get_busy_poll_socket_us() const { return busy_poll_socket_us; }
+    int get_heavy_hitters_top_k() const { return heavy_hitters_top_k; }
+    int get_heavy_hitters_window_sec() const { return heavy_hitters_window_sec; }
+    double get_clock_scale() const { return clock_scale; }
+    int get_event_stream_buffer() const { return event_stream_buffer; }
+    int get_event_stream_max_subscribers() const { return event_stream_max_subscribers; }
+    int get_capture_ring_slots() const { return capture_ring_slots; }
+    int get_flight_recorder_events() const { return flight_recorder_events; }
+    std::string get_flight_recorder_file() const { return flight_recorder_file; }
+    int get_cdr_reject_coalesce_ms() const { return cdr_reject_coalesce_ms; }
+    int get_cdr_reject_coalesce_max_imsis() const { return cdr_reject_coalesce_max_imsis; }
+    std::string get_admin_socket_path() const { return admin_socket_path; }
+
+private:
+    // Значения по умолчанию
+    static constexpr const char* DEFAULT_UDP_IP = "0.0.0.0";
+    static constexpr int DEFAULT_UDP_PORT = 9000;
+    static constexpr int DEFAULT_SESSION_TIMEOUT = 30;
+    static constexpr const char* DEFAULT_CDR_FILE = "cdr.log";
+    static constexpr int DEFAULT_HTTP_PORT = 8080;
+    static constexpr int DEFAULT_SHUTDOWN_RATE = 10;
+    static constexpr const char* DEFAULT_LOG_FILE = "pgw.log";
+    static constexpr const char* DEFAULT_LOG_LEVEL = "INFO";
+    static constexpr int DEFAULT_RETRANSMIT_TTL_MS = 5000;
+    static constexpr int DEFAULT_RETRANSMIT_CACHE_SIZE = 65536;
+    static constexpr int DEFAULT_RATE_LIMIT_PER_SEC = 0;
+    static constexpr int DEFAULT_RATE_LIMIT_BURST = 0;
+    static constexpr int DEFAULT_MAX_QUEUE_DEPTH = 10000;
+    static constexpr const char* DEFAULT_PROTOCOL = "bcd";
+    static constexpr int DEFAULT_TEID_POOL_SIZE = 1048576;
+    static constexpr const char* DEFAULT_IP_POOL = "10.45.0.0/16";
+    static constexpr int DEFAULT_CLUSTER_NODE_ID = 0;
+    static constexpr int DEFAULT_CLUSTER_TIMEOUT_MS = 200;
+    static constexpr const char* DEFAULT_REPLICATION_ROLE = "none";
+    static constexpr const char* DEFAULT_REPLICATION_ADDRESS = "127.0.0.1:9300";
+    static constexpr int DEFAULT_REPLICATION_BATCH_MS = 5;
+    static constexpr int DEFAULT_REPLICATION_CHECKSUM_SEC = 10;
+    static constexpr int DEFAULT_REPLICATION_TAKEOVER_MS = 1000;
+    static constexpr int DEFAULT_WORKER_THREADS_MIN = 2;
+    static constexpr int DEFAULT_WORKER_THREADS_MAX = 0;
+    static constexpr int DEFAULT_WORKER_GROW_WAIT_US = 1000;
+    static constexpr int DEFAULT_WORKER_SHRINK_IDLE_MS = 2000;
+    static constexpr bool DEFAULT_BUSY_POLL = false;
+    static constexpr int DEFAULT_BUSY_POLL_IDLE_MS = 1000;
+    static constexpr int DEFAULT_BUSY_POLL_CPU = -1;
+    static constexpr int DEFAULT_BUSY_POLL_SOCKET_US = 50;
+    static constexpr int DEFAULT_HEAVY_HITTERS_TOP_K = 10;
+    static constexpr int DEFAULT_HEAVY_HITTERS_WINDOW_SEC = 60;
+    static constexpr double DEFAULT_CLOCK_SCALE = 1.0;
+    static constexpr int DEFAULT_EVENT_STREAM_BUFFER = 4096;
+    static constexpr int DEFAULT_EVENT_STREAM_MAX_SUBSCRIBERS = 4;
+    static constexpr int DEFAULT_CAPTURE_RING_SLOTS = 4096;
+    static constexpr int DEFAULT_FLIGHT_RECORDER_EVENTS = 4096;
+    static constexpr const char* DEFAULT_FLIGHT_RECORDER_FILE = "flight_recorder.json";
+    static constexpr int DEFAULT_CDR_REJECT_COALESCE_MS = 1000;
+    static constexpr int DEFAULT_CDR_REJECT_COALESCE_MAX_IMSIS = 10000;
+    static constexpr const char* DEFAULT_ADMIN_SOCKET_PATH = "";
+
+    std::string udp_ip;
+    int udp_port;
+    int session_timeout_sec;
+    std::string cdr_file;
+    int http_port;
+    int graceful_shutdown_rate;
+    std::string log_file;
+    std::string log_level;
+    std::vector<std::string> blacklist;
+    int retransmit_ttl_ms;
+    int retransmit_cache_size;
+    int rate_limit_per_sec;
+    int rate_limit_burst;
+    int max_queue_depth;
+    std::string protocol;
+    int teid_pool_size;
+    std::vector<std::string> ip_pools;
+    std::vector<std::string> cluster_nodes;   // Адреса внутреннего канала узлов "ip:port"; пусто — без кластера
+    int cluster_node_id;                      // Номер этого узла в cluster_nodes
+    int cluster_timeout_ms;
+    std::string replication_role;             // none, active или standby
+    std::string replication_address;          // Адрес потока репликации "ip:port": active слушает, standby подключается
+    int replication_batch_ms;                 // Наибольшая задержка дельты перед отправкой пачкой
+    int replication_checksum_sec;             // Период контрольной суммы таблицы сессий
+    int replication_takeover_ms;              // Через сколько после потери active standby занимает UDP-порт; 0 — только вручную
+    int worker_threads_min;                   // Рабочих потоков UDP-сервера не меньше
+    int worker_threads_max;                   // и не больше; 0 — по числу ядер
+    int worker_grow_wait_us;                  // Среднее ожидание в очереди, выше которого пул растёт
+    int worker_shrink_idle_ms;                // Сколько пул должен простаивать, прежде чем отдать поток
+    bool busy_poll;                           // Поток приёма опрашивает сокет без сна
+    int busy_poll_idle_ms;                    // Простой, после которого опрос сменяется блокирующим ожиданием
+    int busy_poll_cpu;                        // Ядро для потока приёма; -1 — без привязки
+    int busy_poll_socket_us;                  // SO_BUSY_POLL для сокета; 0 — не задавать
+    int heavy_hitters_top_k;                  // Длина списков самых активных пиров и IMSI
+    int heavy_hitters_window_sec;             // Частоты в списках делятся пополам раз в окно
+    double clock_scale;                       // Ускорение часов сессий и CDR для длительных прогонов; 1 — реальное время
+    int event_stream_buffer;                  // Событий в истории и в кольце каждого подписчика /session_events
+    int event_stream_max_subscribers;         // Одновременных подписчиков /session_events
+    int capture_ring_slots;                   // Датаграмм в кольце захвата /capture
+    int flight_recorder_events;               // Событий в кольце бортового самописца на поток; 0 — самописец выключен
+    std::string flight_recorder_file;         // Куда самописец пишет трассу при аварийном сигнале
+    int cdr_reject_coalesce_ms;               // Окно, в котором повторы одного отказа сводятся в одну строку CDR; 0 — без сведения
+    int cdr_reject_coalesce_max_imsis;        // Одновременно открытых окон сведения не больше
+    std::string admin_socket_path;            // Unix domain socket административного протокола; пусто — выключен
 };
\ No newline at end of file
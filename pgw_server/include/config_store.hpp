@@ -0,0 +1,131 @@
+#pragma once
+
+#include "config.hpp"
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Итог перезагрузки или отката конфигурации
+struct ConfigReloadResult {
+    bool ok = false;
+    uint64_t version = 0;   // Версия, действующая после операции
+    std::string error;      // Причина отказа; пусто при успехе
+};
+
+// Версионированные неизменяемые снимки конфигурации (RCU-подобная схема).
+// Читатели берут текущий снимок без блокировок: отметка в счётчике читателей эпохи и атомарная
+// загрузка указателя. Хранятся только действующий снимок и цель отката; вытесненные снимки
+// освобождаются позже, когда их уже не видит ни один читатель, — как таблицы SubscriberIndex.
+// Перезагрузка меняет только session_timeout_sec, log_level, blacklist, rate_limit_per_sec,
+// rate_limit_burst и max_queue_depth; изменение остальных ключей требует перезапуска и отклоняется
+class ConfigStore {
+public:
+    // Обработчик применения: получает прежний и новый снимки; исключение откатывает перезагрузку
+    using ReloadHook = std::function<void(const Config& previous, const Config& next)>;
+
+    // Снимок у читателя: пока Ref жив, снимок не освобождается. Держать на время одной операции:
+    // вытесненные снимки освобождаются, лишь когда счётчик читателей их эпохи обнулится
+    class Ref {
+    public:
+        // Снимок без учёта читателей: для конфигурации, которая живёт дольше читателя
+        explicit Ref(const Config* config, std::atomic<uint64_t>* readers = nullptr) : config(config), readers(readers) {}
+        Ref(Ref&& other) noexcept : config(other.config), readers(other.readers) { other.readers = nullptr; }
+        Ref(const Ref&) = delete;
+        Ref& operator=(const Ref&) = delete;
+        Ref& operator=(Ref&&) = delete;
+        ~Ref() {
+            if (readers) {
+                readers->fetch_sub(1);
+            }
+        }
+
+        const Config& operator*() const { return *config; }
+        const Config* operator->() const { return config; }
+
+    private:
+        const Config* config;
+        std::atomic<uint64_t>* readers;
+    };
+
+    // initial — конфигурация, с которой запущен сервер (версия 1); path — файл для перезагрузки
+    ConfigStore(const std::string& path, const Config& initial);
+
+    // Запрещаем копирование: читатели держат ссылки на снимки
+    ConfigStore(const ConfigStore&) = delete;
+    ConfigStore& operator=(const ConfigStore&) = delete;
+
+    // Текущий снимок: wait-free, действителен, пока жив Ref
+    Ref current() const;
+
+    uint64_t get_version() const { return current_version.load(std::memory_order_acquire); }
+
+    // Подключает обработчик применения; вызывать до первой перезагрузки
+    void on_reload(ReloadHook hook);
+
+    // Перечитывает файл, проверяет его и публикует новый снимок. При ошибке разбора или изменении
+    // ключей, требующих перезапуска, снимок не меняется; при ошибке обработчика возвращается прежний
+    ConfigReloadResult reload();
+
+    // Возвращает снимок, действовавший до текущего; false, если откатывать некуда.
+    // Откат глубиной в один шаг: после него цели отката нет до следующей перезагрузки
+    ConfigReloadResult rollback();
+
+    // Освобождает вытесненные снимки, которые уже не видит ни один читатель; не ждёт.
+    // Вызывается и при каждой перезагрузке и откате
+    void reclaim();
+
+    // Вытесненные снимки, ждущие освобождения (для диагностики)
+    size_t retired_snapshots() const;
+
+    // Версия, счётчики и действующие значения перезагружаемых ключей в формате key=value
+    std::string report() const;
+
+    // Ключи, которые различаются в снимках и меняются только перезапуском
+    static std::vector<std::string> restart_required_changes(const Config& previous, const Config& next);
+
+private:
+    struct Snapshot {
+        uint64_t version = 0;
+        std::unique_ptr<const Config> config;   // nullptr — снимка нет
+    };
+
+    // Вытесненный снимок; drained[e] — счётчик читателей эпохи e обнулялся после вытеснения
+    struct Retired {
+        std::unique_ptr<const Config> config;
+        bool drained[2];
+    };
+
+    // Публикует снимок и вызывает обработчики; при исключении публикует прежний. Под writer_mutex
+    ConfigReloadResult apply(const Snapshot& previous, const Snapshot& next);
+
+    // Откладывает опубликованный когда-либо снимок до освобождения. Под writer_mutex
+    void retire(Snapshot& snapshot);
+
+    // Тело reclaim. Под writer_mutex
+    void reclaim_retired();
+
+    // Различающиеся в снимках перезагружаемые ключи
+    static std::vector<std::string> reloadable_changes(const Config& previous, const Config& next);
+
+    const std::string path;
+    mutable std::mutex writer_mutex;           // Сериализует перезагрузки и откаты; читатели его не берут
+    Snapshot active;                           // Действующий снимок
+    Snapshot rollback_target;                  // Снимок для отката; config == nullptr — откатывать некуда
+    std::vector<Retired> retired;
+    std::vector<ReloadHook> hooks;
+    std::atomic<const Config*> current_config;
+    std::atomic<uint64_t> current_version;
+    std::atomic<uint32_t> epoch{ 0 };
+    // Счётчики читателей для чётной и нечётной эпохи
+    mutable std::atomic<uint64_t> readers[2];
+    uint64_t last_version = 1;
+    uint64_t reloads = 0;
+    uint64_t unchanged_reloads = 0;
+    uint64_t reload_failures = 0;
+    uint64_t rollbacks = 0;
+    std::string last_error;
+};
@@ -0,0 +1,125 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/types.h>
+
+// RAII-класс для управления UDP-сокетом
+class Socket {
+public:
+    Socket();
+    ~Socket();
+    int get_fd() const { return fd; }
+    void set_non_blocking();
+    void bind(const std::string& ip, int port);
+
+private:
+    int fd;
+};
+
+// Сведения о принятой датаграмме помимо данных
+struct DatagramInfo {
+    int64_t rx_ns = 0;          // Приход в транспорт (CLOCK_REALTIME, нс); 0 — метки нет
+    bool has_drops = false;     // Транспорт сообщил счётчик отброшенных датаграмм
+    uint32_t drops = 0;         // Накопленное число датаграмм, отброшенных при переполнении
+};
+
+// Транспорт датаграмм UDP-сервера: приём и отправка без знания о том, откуда приходят данные.
+// Сервер опрашивает receive() и ждёт готовности get_poll_fd() в poll(), поэтому реализация
+// может быть как сокетом ядра, так и очередью в памяти процесса
+class IDatagramTransport {
+public:
+    // Привязывает транспорт к адресу; бросает std::runtime_error при ошибке
+    virtual void open(const std::string& ip, int port) = 0;
+
+    // Неблокирующий приём: длина датаграммы или -1 с errno = EAGAIN, если датаграмм нет
+    virtual ssize_t receive(char* buffer, size_t capacity, struct sockaddr_in& peer, socklen_t& addr_len,
+        DatagramInfo& info) = 0;
+
+    // Отправляет датаграмму пиру
+    virtual void send(const void* data, size_t length, const struct sockaddr_in& peer, socklen_t addr_len) = 0;
+
+    // Дескриптор, готовый к чтению, когда receive() может вернуть датаграмму
+    virtual int get_poll_fd() const = 0;
+
+    // Включает метки времени прихода и счётчик отброшенных; бросает std::runtime_error, если не удалось
+    virtual void enable_receive_timestamps() {}
+
+    // Включает опрос очереди приёма ядром (SO_BUSY_POLL); бросает std::runtime_error, если не удалось
+    virtual void enable_busy_poll(int socket_us) { (void)socket_us; }
+
+    virtual ~IDatagramTransport() = default;
+};
+
+// Транспорт поверх UDP-сокета ядра: recvmsg с метками SO_TIMESTAMPNS и счётчиком SO_RXQ_OVFL, sendto
+class UDPSocketTransport : public IDatagramTransport {
+public:
+    void open(const std::string& ip, int port) override;
+    ssize_t receive(char* buffer, size_t capacity, struct sockaddr_in& peer, socklen_t& addr_len,
+        DatagramInfo& info) override;
+    void send(const void* data, size_t length, const struct sockaddr_in& peer, socklen_t addr_len) override;
+    int get_poll_fd() const override { return socket.get_fd(); }
+    void enable_receive_timestamps() override;
+    void enable_busy_poll(int socket_us) override;
+
+private:
+    Socket socket;
+};
+
+// Транспорт в памяти процесса: датаграммы кладёт inject() (генератор нагрузки, тест),
+// ответы уходят в обработчик. Путь декодирования, допуска, сессий и CDR проверяется
+// и измеряется без сетевого стека ядра. Как у сокета, очередь приёма ограничена:
+// лишние датаграммы отбрасываются и попадают в счётчик отброшенных
+class LoopbackTransport : public IDatagramTransport {
+public:
+    // Обработчик ответа; вызывается из рабочих потоков сервера
+    using ReplyHandler = std::function<void(const char* data, size_t length, const struct sockaddr_in& peer)>;
+
+    explicit LoopbackTransport(size_t capacity = DEFAULT_CAPACITY);
+    ~LoopbackTransport() override;
+
+    // Запрещаем копирование
+    LoopbackTransport(const LoopbackTransport&) = delete;
+    LoopbackTransport& operator=(const LoopbackTransport&) = delete;
+
+    // Задаётся до запуска сервера
+    void set_reply_handler(ReplyHandler handler) { reply_handler = std::move(handler); }
+
+    // Ставит датаграмму в очередь приёма; false — очередь полна, датаграмма отброшена
+    bool inject(const void* data, size_t length, const struct sockaddr_in& peer);
+
+    size_t get_queued() const;
+    uint64_t get_injected() const { return injected.load(std::memory_order_relaxed); }
+    uint64_t get_dropped() const { return dropped.load(std::memory_order_relaxed); }
+    uint64_t get_replies() const { return replies.load(std::memory_order_relaxed); }
+
+    void open(const std::string& ip, int port) override;
+    ssize_t receive(char* buffer, size_t capacity, struct sockaddr_in& peer, socklen_t& addr_len,
+        DatagramInfo& info) override;
+    void send(const void* data, size_t length, const struct sockaddr_in& peer, socklen_t addr_len) override;
+    int get_poll_fd() const override { return ready_fd; }
+
+    static constexpr size_t DEFAULT_CAPACITY = 65536;
+
+private:
+    struct Datagram {
+        std::string data;
+        struct sockaddr_in peer;
+        int64_t rx_ns;
+    };
+
+    const size_t capacity;
+    int ready_fd;   // eventfd: готов к чтению, пока очередь не пуста
+    mutable std::mutex mutex;
+    std::deque<Datagram> queue;
+    ReplyHandler reply_handler;
+    std::atomic<uint64_t> injected{ 0 };
+    std::atomic<uint64_t> dropped{ 0 };
+    std::atomic<uint64_t> replies{ 0 };
+};
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+// Цикл событий процесса на epoll: сигналы (signalfd), периодические задачи (timerfd)
+// и пробуждение из других потоков (eventfd). Все обработчики выполняются в потоке run(),
+// поэтому состояние, которым владеет main, не требует синхронизации.
+class EventLoop {
+public:
+    EventLoop();
+    ~EventLoop();
+
+    // Запрещаем копирование
+    EventLoop(const EventLoop&) = delete;
+    EventLoop& operator=(const EventLoop&) = delete;
+
+    // Блокирует сигналы в вызывающем потоке и доставляет их обработчику через signalfd.
+    // Вызывается до запуска других потоков: они наследуют маску, и сигнал не уходит мимо цикла
+    void handle_signals(const std::vector<int>& signals, std::function<void(int)> handler);
+
+    // Периодическая задача; первый запуск через period после вызова
+    void add_timer(std::chrono::milliseconds period, std::function<void()> task);
+
+    // Выполняет задачу в потоке цикла (из любого потока)
+    void post(std::function<void()> task);
+
+    // Обрабатывает события, пока не вызван stop()
+    void run();
+
+    // Завершает run() (из любого потока и из обработчиков); повторные вызовы ничего не делают
+    void stop();
+
+    // Момент первого вызова stop(), для замера времени остановки
+    std::chrono::steady_clock::time_point stop_requested_at() const;
+
+private:
+    // Источник событий: дескриптор и действие при его готовности
+    struct Source {
+        int fd;
+        std::function<void()> on_ready;
+    };
+
+    // Регистрирует дескриптор в epoll; цикл закрывает его при разрушении
+    void watch(int fd, std::function<void()> on_ready);
+
+    // Выполняет задачи, накопленные post()
+    void run_posted();
+
+    int epoll_fd = -1;
+    int wake_fd = -1;
+    std::vector<std::unique_ptr<Source>> sources;
+
+    std::mutex posted_mutex;
+    std::vector<std::function<void()>> posted;
+
+    std::atomic<bool> stopping{ false };
+    std::atomic<int64_t> stop_requested_ns{ 0 };
+
+    bool signals_blocked = false;
+    sigset_t previous_mask;                 // Маска потока до handle_signals, восстанавливается в деструкторе
+};
@@ -0,0 +1,135 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+// События конвейера, которые пишет бортовой самописец
+enum class FlightEvent : uint32_t {
+    Receive,        // Датаграмма прочитана из сокета; значение — длина
+    Enqueue,        // Запрос поставлен в очередь рабочих потоков; значение — длина очереди
+    SessionCreate,  // Создание сессии (интервал); значение — 1, если создана
+    SessionDelete,  // Удаление сессии по запросу (интервал); значение — 1, если удалена
+    CdrWrite,       // Запись строки CDR (интервал)
+    Send,           // Ответ отправлен; значение — длина
+    ExpirySweep     // Проход очистки истёкших сессий (интервал); значение — число истёкших
+};
+
+// Бортовой самописец: последние события конвейера в кольцах фиксированного размера, по кольцу на поток.
+// Запись без блокировок и без общих с другими потоками кэш-линий: поток пишет только в своё кольцо,
+// метка времени — счётчик тактов (TSC). Кольцо выделяется при первом событии потока.
+// Чтение не останавливает писателей: событие, которое писатель успел перезаписать во время
+// чтения, отбрасывается. Выгрузка — JSON Chrome trace для chrome://tracing и Perfetto
+class FlightRecorder {
+public:
+    // Наибольшее число потоков с кольцами; события остальных потоков не пишутся
+    static constexpr size_t MAX_THREADS = 256;
+
+    // events_per_thread округляется вверх до степени двойки
+    explicit FlightRecorder(size_t events_per_thread);
+    ~FlightRecorder();
+
+    // Запрещаем копирование: потоки держат указатели на кольца
+    FlightRecorder(const FlightRecorder&) = delete;
+    FlightRecorder& operator=(const FlightRecorder&) = delete;
+
+    // Текущая метка времени в тактах: TSC на x86, иначе наносекунды steady_clock
+    static uint64_t now() {
+#if defined(__x86_64__) || defined(__i386__)
+        return __rdtsc();
+#else
+        return static_cast<uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count());
+#endif
+    }
+
+    // Пишет событие в кольцо текущего потока; end = 0 — мгновенное событие
+    void record(FlightEvent event, uint64_t start, uint64_t end, uint64_t value);
+
+    // Мгновенное событие в текущий момент
+    void instant(FlightEvent event, uint64_t value) { record(event, now(), 0, value); }
+
+    // Трасса Chrome в JSON; last_ms > 0 — только события последних last_ms миллисекунд
+    std::string chrome_trace(int64_t last_ms = 0) const;
+
+    // Пишет трассу в файл без выделения памяти и блокировок: пригодно для обработчика сигнала
+    bool dump(const char* path) const;
+
+    // Сводка key=value: размер колец, число потоков, записанные события
+    std::string report() const;
+
+    size_t get_events_per_thread() const { return capacity; }
+
+    // Ставит обработчики SIGSEGV, SIGBUS, SIGFPE, SIGILL и SIGABRT: перед аварийным завершением
+    // трасса пишется в path, затем сигнал повторяется с обработчиком по умолчанию (дамп памяти сохраняется).
+    // Действует для одного самописца процесса; recorder должен жить до завершения процесса
+    static void install_crash_handler(std::shared_ptr<FlightRecorder> recorder, const std::string& path);
+
+private:
+    // Слот кольца. Поля атомарны (запись relaxed), чтобы чтение во время записи не было гонкой данных
+    struct Slot {
+        std::atomic<uint64_t> start{ 0 };
+        std::atomic<uint64_t> end{ 0 };
+        std::atomic<uint64_t> value{ 0 };
+        std::atomic<uint32_t> event{ 0 };
+    };
+
+    // Кольцо одного потока. claimed растёт до записи слота, published — после:
+    // читатель по claimed узнаёт, какие прочитанные слоты могли быть перезаписаны
+    struct alignas(64) Ring {
+        std::atomic<uint64_t> claimed{ 0 };
+        std::atomic<uint64_t> published{ 0 };
+        int tid = 0;
+        char name[16] = {};
+        std::unique_ptr<Slot[]> slots;
+    };
+
+    // Кольцо текущего потока; первый вызов в потоке регистрирует его под registry_mutex
+    Ring* ring_of_current_thread();
+
+    // Вывод трассы в строку или файловый дескриптор через буфер фиксированного размера
+    class TraceOutput;
+
+    // Пишет трассу; память не выделяется, если вывод идёт в дескриптор
+    void write_trace(TraceOutput& output, int64_t last_ms) const;
+
+    const size_t capacity;              // Степень двойки
+    const uint64_t id;                  // Отличает самописцы в кэше потока, даже если адрес переиспользован
+    const uint64_t start_ticks;         // Отсчёт для перевода тактов в наносекунды
+    const std::chrono::steady_clock::time_point start_time;
+    std::unique_ptr<Ring> rings[MAX_THREADS];
+    std::atomic<size_t> ring_count{ 0 };
+    std::atomic<uint64_t> dropped_threads{ 0 };     // Потоков без кольца: превышен MAX_THREADS
+    std::mutex registry_mutex;
+};
+
+// Интервал для самописца: начало при создании, запись при уничтожении. Без самописца ничего не делает
+class FlightSpan {
+public:
+    FlightSpan(FlightRecorder* recorder, FlightEvent event)
+        : recorder(recorder), event(event), start(recorder ? FlightRecorder::now() : 0) {
+    }
+
+    ~FlightSpan() {
+        if (recorder) {
+            recorder->record(event, start, FlightRecorder::now(), value);
+        }
+    }
+
+    FlightSpan(const FlightSpan&) = delete;
+    FlightSpan& operator=(const FlightSpan&) = delete;
+
+    // Значение события (результат операции), записывается вместе с интервалом
+    void set_value(uint64_t value) { this->value = value; }
+
+private:
+    FlightRecorder* recorder;
+    FlightEvent event;
+    uint64_t start;
+    uint64_t value = 0;
+};
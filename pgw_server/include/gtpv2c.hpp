@@ -0,0 +1,158 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Кодек GTPv2-C (TS 29.274) для Create/Delete Session Request/Response с IE IMSI, Cause и F-TEID.
+// Разбор выполняется без копирования и выделения памяти: результат содержит указатели
+// в буфер приёма и действителен, пока жив этот буфер. Кодирование пишет в заранее
+// выделенный буфер вызывающей стороны.
+namespace gtpv2c {
+
+constexpr uint8_t VERSION = 2;
+constexpr size_t HEADER_SIZE = 12;          // Заголовок с TEID
+constexpr size_t HEADER_SIZE_NO_TEID = 8;   // Заголовок без TEID
+constexpr size_t IE_HEADER_SIZE = 4;
+constexpr size_t MAX_IMSI_DIGITS = 15;
+
+// Типы сообщений (TS 29.274 §6.1)
+enum MessageType : uint8_t {
+    CREATE_SESSION_REQUEST = 32,
+    CREATE_SESSION_RESPONSE = 33,
+    DELETE_SESSION_REQUEST = 36,
+    DELETE_SESSION_RESPONSE = 37
+};
+
+// Типы IE (TS 29.274 §8.1)
+enum IEType : uint8_t {
+    IE_IMSI = 1,
+    IE_CAUSE = 2,
+    IE_PAA = 79,
+    IE_FTEID = 87
+};
+
+// Значения Cause (TS 29.274 §8.4)
+enum Cause : uint8_t {
+    CAUSE_REQUEST_ACCEPTED = 16,
+    CAUSE_CONTEXT_NOT_FOUND = 64,
+    CAUSE_SERVICE_NOT_SUPPORTED = 68,
+    CAUSE_MANDATORY_IE_INCORRECT = 69,
+    CAUSE_MANDATORY_IE_MISSING = 70,
+    CAUSE_NO_RESOURCES_AVAILABLE = 73,
+    CAUSE_REQUEST_REJECTED = 94
+};
+
+// Типы интерфейсов F-TEID (TS 29.274 §8.22)
+enum InterfaceType : uint8_t {
+    S5S8_SGW_GTPC = 6,
+    S5S8_PGW_GTPC = 7
+};
+
+// Ссылка на значение IE внутри пакета
+struct IEView {
+    const uint8_t* value = nullptr;
+    uint16_t length = 0;
+    bool present() const { return value != nullptr; }
+};
+
+// Разобранный F-TEID; IPv6-адрес указывает в пакет (или в буфер вызывающего при кодировании)
+struct FTEID {
+    uint8_t interface_type = 0;
+    uint32_t teid = 0;
+    bool has_ipv4 = false;
+    uint32_t ipv4 = 0;                 // Сетевой порядок байт
+    const uint8_t* ipv6 = nullptr;     // 16 байт или nullptr
+};
+
+// Типы PDN в PAA (TS 29.274 §8.14)
+enum PDNType : uint8_t {
+    PDN_IPV4 = 1,
+    PDN_IPV6 = 2,
+    PDN_IPV4V6 = 3
+};
+
+// Адрес UE (PDN Address Allocation); IPv6-префикс указывает в пакет или в буфер вызывающего
+struct PAA {
+    bool has_ipv4 = false;
+    uint32_t ipv4 = 0;                 // Сетевой порядок байт
+    const uint8_t* ipv6 = nullptr;     // 16 байт или nullptr
+    uint8_t ipv6_prefix_length = 64;
+};
+
+// Разобранное сообщение: заголовок и первые экземпляры (instance 0) нужных IE
+struct MessageView {
+    uint8_t type = 0;
+    bool has_teid = false;
+    uint32_t teid = 0;
+    uint32_t sequence = 0;
+    IEView imsi;
+    IEView cause;
+    IEView fteid;
+    IEView paa;
+    const uint8_t* data = nullptr;     // Начало сообщения
+    size_t length = 0;                 // Длина сообщения с заголовком
+};
+
+enum class ParseResult {
+    OK,
+    TOO_SHORT,      // Датаграмма короче заголовка
+    BAD_VERSION,    // Версия протокола не 2
+    BAD_LENGTH,     // Поле длины не согласуется с размером датаграммы
+    BAD_IE          // IE выходит за границы сообщения
+};
+
+// Разбирает датаграмму без копирования
+ParseResult parse(const uint8_t* data, size_t length, MessageView& message);
+
+// Декодирует TBCD-цифры IMSI в out (без завершающего нуля); 0 — IE некорректен
+size_t decode_imsi(const IEView& ie, char* out, size_t capacity);
+
+// Извлекает значение Cause
+bool decode_cause(const IEView& ie, uint8_t& cause);
+
+// Разбирает F-TEID
+bool decode_fteid(const IEView& ie, FTEID& fteid);
+
+// Разбирает PAA
+bool decode_paa(const IEView& ie, PAA& paa);
+
+// Кодировщик сообщения поверх заранее выделенного буфера.
+// При нехватке места ok() становится false, а finish() возвращает 0.
+class Writer {
+public:
+    Writer(uint8_t* buffer, size_t capacity);
+
+    // Начинает сообщение с TEID в заголовке
+    void begin(uint8_t type, uint32_t teid, uint32_t sequence);
+
+    void add_imsi(const char* digits, size_t count);
+    void add_cause(uint8_t cause);
+    void add_fteid(const FTEID& fteid, uint8_t instance = 0);
+    void add_paa(const PAA& paa);
+
+    // Проставляет длину сообщения и возвращает полный размер
+    size_t finish();
+
+    bool ok() const { return !overflow; }
+
+private:
+    uint8_t* reserve_ie(uint8_t type, uint16_t length, uint8_t instance);
+
+    uint8_t* buffer;
+    size_t capacity;
+    size_t size = 0;
+    bool overflow = false;
+};
+
+// Готовые кодировщики сообщений; возвращают длину или 0 при нехватке места
+size_t encode_create_session_request(uint8_t* buffer, size_t capacity, uint32_t sequence,
+                                     const char* imsi, size_t imsi_length, const FTEID& sender);
+size_t encode_create_session_response(uint8_t* buffer, size_t capacity, uint32_t peer_teid, uint32_t sequence,
+                                      uint8_t cause, const FTEID* pgw_fteid, const PAA* paa = nullptr);
+// Delete Session Request адресуется TEID управления PGW; imsi_length 0 — без IE IMSI, как у SGW
+size_t encode_delete_session_request(uint8_t* buffer, size_t capacity, uint32_t teid, uint32_t sequence,
+                                     const char* imsi, size_t imsi_length);
+size_t encode_delete_session_response(uint8_t* buffer, size_t capacity, uint32_t peer_teid, uint32_t sequence,
+                                      uint8_t cause);
+
+} // namespace gtpv2c
\ No newline at end of file
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Кольцо согласованного хеширования IMSI по узлам кластера.
+// Каждый узел занимает VIRTUAL_NODES точек кольца, вычисленных из его адреса, поэтому
+// все узлы строят одинаковое кольцо независимо от порядка перечисления, а при добавлении
+// узла к нему переезжает лишь около 1/N пространства IMSI.
+class HashRing {
+public:
+    static constexpr size_t VIRTUAL_NODES = 160;
+
+    // Конструктор: nodes — адреса узлов; номер узла — позиция в этом списке
+    explicit HashRing(const std::vector<std::string>& nodes);
+
+    // Номер узла-владельца IMSI
+    size_t owner(const std::string& imsi) const;
+
+    size_t get_node_count() const { return node_count; }
+
+    // Хеш строки (FNV-1a с перемешиванием), общий для IMSI и точек узлов
+    static uint64_t hash(const std::string& key);
+
+private:
+    struct Point {
+        uint64_t position;
+        size_t node;
+    };
+
+    std::vector<Point> points;   // Отсортированы по position
+    size_t node_count;
+};
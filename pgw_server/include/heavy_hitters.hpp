@@ -0,0 +1,123 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include <netinet/in.h>
+
+// Count-min sketch: оценка частоты ключа сверху в фиксированной памяти (DEPTH x WIDTH счётчиков).
+// Обновление консервативное: растут только строки с минимальным значением, что уменьшает переоценку
+class CountMinSketch {
+public:
+    static constexpr size_t DEPTH = 4;
+    static constexpr size_t WIDTH = 4096;   // Степень двойки
+
+    // Учитывает ключ с хешем hash и возвращает новую оценку его частоты
+    uint32_t add(uint64_t hash);
+
+    // Оценка частоты ключа с хешем hash
+    uint32_t estimate(uint64_t hash) const;
+
+    // Сдвигает все счётчики вправо на shift (затухание в 2^shift раз)
+    void decay(unsigned shift);
+
+private:
+    // Номер счётчика ключа в строке row (двойное хеширование из одного 64-битного хеша)
+    static size_t slot(uint64_t hash, size_t row);
+
+    std::array<std::array<uint32_t, WIDTH>, DEPTH> rows{};
+};
+
+// Самые частые ключи потока: space-saving из capacity кандидатов поверх count-min sketch.
+// Частота кандидата — оценка sketch; новый ключ вытесняет самого редкого кандидата,
+// только когда его оценка выше, поэтому поток уникальных ключей не перетряхивает таблицу.
+// Все счётчики раз в window делятся пополам: список показывает недавних, а не исторических лидеров.
+// record() и publish() вызывает один поток (поток приёма UDP) без блокировок;
+// читатели видят снимок, который publish() обновляет под отдельным мьютексом
+class TopKTracker {
+public:
+    TopKTracker(size_t top_k, std::chrono::seconds window);
+
+    // Запрещаем копирование
+    TopKTracker(const TopKTracker&) = delete;
+    TopKTracker& operator=(const TopKTracker&) = delete;
+
+    // Учитывает ключ; снимок обновляется раз в PUBLISH_EVERY записей или PUBLISH_PERIOD
+    void record(const std::string& key, std::chrono::steady_clock::time_point now);
+
+    // Обновляет снимок, если с прошлого были записи или пора затухания
+    void publish(std::chrono::steady_clock::time_point now);
+
+    // Топ из снимка по убыванию частоты с затуханием, накопившимся с момента снимка
+    std::vector<std::pair<std::string, uint64_t>> top(std::chrono::steady_clock::time_point now) const;
+
+    // Число записей с учётом затухания, как у частот в top()
+    uint64_t total(std::chrono::steady_clock::time_point now) const;
+
+    size_t get_top_k() const { return top_k; }
+
+    static constexpr size_t CANDIDATES_PER_TOP = 4;     // Кандидатов space-saving на одно место в топе
+    static constexpr uint64_t PUBLISH_EVERY = 4096;
+    static constexpr std::chrono::milliseconds PUBLISH_PERIOD{ 100 };
+
+private:
+    struct Candidate {
+        std::string key;
+        uint64_t count;
+    };
+
+    // Делит счётчики пополам за каждое целое окно с прошлого затухания
+    void apply_decay(std::chrono::steady_clock::time_point now);
+
+    // Сдвиг затухания для снимка, снятого в decayed_at
+    unsigned pending_shift(std::chrono::steady_clock::time_point now) const;
+
+    const size_t top_k;
+    const size_t capacity;
+    const std::chrono::seconds window;
+
+    // Состояние писателя
+    CountMinSketch sketch;
+    std::vector<Candidate> candidates;
+    std::unordered_map<std::string, size_t> index;  // Ключ -> позиция в candidates
+    uint64_t records = 0;
+    uint64_t unpublished = 0;
+    std::chrono::steady_clock::time_point last_decay;
+    std::chrono::steady_clock::time_point last_publish;
+
+    // Снимок для читателей
+    mutable std::mutex snapshot_mutex;
+    std::vector<std::pair<std::string, uint64_t>> snapshot;
+    uint64_t snapshot_records = 0;
+    std::chrono::steady_clock::time_point snapshot_decayed_at;
+};
+
+// Самые активные источники и IMSI на входе UDP-сервера (для /heavy_hitters).
+// Пир учитывается до ограничения скорости, поэтому видно и того, кого отбрасывают
+class HeavyHitters {
+public:
+    HeavyHitters(size_t top_k, std::chrono::seconds window);
+
+    // Датаграмма от пира (из потока приёма)
+    void record_peer(const struct sockaddr_in& peer, std::chrono::steady_clock::time_point now);
+
+    // Запрос с декодированным IMSI (из потока приёма)
+    void record_imsi(const std::string& imsi, std::chrono::steady_clock::time_point now);
+
+    // Обновляет снимки (из потока приёма, когда он уходит в ожидание)
+    void publish(std::chrono::steady_clock::time_point now);
+
+    // Отчёт в формате key=value по строке на параметр
+    std::string report() const;
+
+private:
+    const std::chrono::seconds window;
+    TopKTracker peers;  // Ключ — 4 байта IPv4-адреса в сетевом порядке
+    TopKTracker imsis;
+};
@@ -1,47 +1,177 @@
-#pragma once
-#include "config.hpp"
-#include "session_manager.hpp"
-#include <httplib.h>
-#include <thread>
-#include <atomic>
-#include <functional>
-#include "interfaces.hpp"
-
-// Абстрактный интерфейс для управления сессиями
-// class ISessionManager {
-// public:
-//     virtual bool has_session(const std::string& imsi) = 0;
-//     virtual void stop() = 0;
-//     virtual ~ISessionManager() = default;
-// };
-
-// HTTP-сервер для обработки запросов /check_subscriber и /stop
-class HTTPServer {
-public:
-    // Конструктор: принимает конфигурацию, логгер, менеджер сессий и функцию остановки
-    HTTPServer(const Config& config, std::shared_ptr<ILogger> logger, std::shared_ptr<ISessionManager> session_manager, 
-               std::function<void()> stop_callback, std::atomic<bool>& running);
-    ~HTTPServer();
-
-    // Запускает HTTP-сервер
-    void run();
-
-    // Останавливает HTTP-сервер
-    void stop();
-
-private:
-    // Обрабатывает запрос /check_subscriber
-    void handle_check_subscriber(const httplib::Request& req, httplib::Response& res);
-
-    // Обрабатывает запрос /stop
-    void handle_stop(const httplib::Request& req, httplib::Response& res);
-
-    const Config& config;
-    std::shared_ptr<ILogger> logger;
-    std::shared_ptr<ISessionManager> session_manager;
-    std::function<void()> stop_callback;
-    std::unique_ptr<httplib::Server> server;
-    std::thread server_thread;
-    std::atomic<bool>& running;
-    bool running_local;
+#pragma once
+#include "config.hpp"
+#include "session_manager.hpp"
+#include "admission_control.hpp"
+#include "cluster.hpp"
+#include "replication.hpp"
+#include "worker_pool_sizer.hpp"
+#include "latency_stats.hpp"
+#include "heavy_hitters.hpp"
+#include "session_events.hpp"
+#include "config_store.hpp"
+#include "packet_capture.hpp"
+#include "flight_recorder.hpp"
+#include <httplib.h>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <functional>
+#include "interfaces.hpp"
+
+// Абстрактный интерфейс для управления сессиями
+// class ISessionManager {
+// public:
+//     virtual bool has_session(const std::string& imsi) = 0;
+//     virtual void stop() = 0;
+//     virtual ~ISessionManager() = default;
+// };
+
+// HTTP-сервер для обработки запросов /check_subscriber и /stop
+class HTTPServer {
+public:
+    // Конструктор: принимает конфигурацию, логгер, менеджер сессий и функцию остановки
+    HTTPServer(const Config& config, std::shared_ptr<ILogger> logger, std::shared_ptr<ISessionManager> session_manager, 
+               std::function<void()> stop_callback, std::atomic<bool>& running);
+    ~HTTPServer();
+
+    // Занимает порт и запускает HTTP-сервер в отдельном потоке; при занятом порте бросает исключение
+    void run();
+
+    // Останавливает HTTP-сервер
+    void stop();
+
+    // Подключает контроль допуска UDP-сервера для /admission
+    void set_admission_control(std::shared_ptr<AdmissionControl> admission_control);
+
+    // Подключает узел кластера для /cluster
+    void set_cluster(std::shared_ptr<ClusterSessionManager> cluster);
+
+    // Подключает сторону репликации для /replication
+    void set_replication(std::shared_ptr<ReplicationEndpoint> replication);
+
+    // Подключает регулятор пула рабочих потоков UDP-сервера для /workers
+    void set_worker_pool_sizer(std::shared_ptr<WorkerPoolSizer> pool_sizer);
+
+    // Подключает задержки UDP-пути по меткам ядра для /latency
+    void set_latency_stats(std::shared_ptr<LatencyStats> latency_stats);
+
+    // Подключает самых активных пиров и IMSI UDP-сервера для /heavy_hitters
+    void set_heavy_hitters(std::shared_ptr<HeavyHitters> heavy_hitters);
+
+    // Подключает поток событий сессий для /session_events
+    void set_session_events(std::shared_ptr<SessionEventStream> session_events);
+
+    // Подключает таблицу сессий этого узла для /sessions/export
+    void set_session_export(std::shared_ptr<SessionManager> session_table);
+
+    // Подключает перезагружаемую конфигурацию для /config, /config/reload и /config/rollback
+    void set_config_store(std::shared_ptr<ConfigStore> config_store);
+
+    // Подключает кольцо захвата UDP-сервера для /capture, /capture/start, /capture/stop и /capture/pcap
+    void set_packet_capture(std::shared_ptr<PacketCapture> packet_capture);
+
+    // Подключает бортовой самописец для /trace и /trace/status
+    void set_flight_recorder(std::shared_ptr<FlightRecorder> flight_recorder);
+
+    // Передаёт /stop владельцу компонентов (циклу событий main) вместо остановки из потока запроса
+    void set_shutdown_handler(std::function<void()> shutdown_handler);
+
+private:
+    // Размер страницы /sessions/export по умолчанию и наибольший
+    static constexpr long long DEFAULT_EXPORT_LIMIT = 10000;
+    static constexpr long long MAX_EXPORT_LIMIT = 100000;
+
+    // Обрабатывает запрос /check_subscriber
+    void handle_check_subscriber(const httplib::Request& req, httplib::Response& res);
+
+    // Обрабатывает запрос /delete_session: удаляет сессию одного абонента
+    void handle_delete_session(const httplib::Request& req, httplib::Response& res);
+
+    // Обрабатывает запрос /delete_sessions: удаляет сессии по списку IMSI
+    void handle_delete_sessions(const httplib::Request& req, httplib::Response& res);
+
+    // Обрабатывает запрос /stop
+    void handle_stop(const httplib::Request& req, httplib::Response& res);
+
+    // Обрабатывает запрос /admission: счётчики и текущие пределы
+    void handle_admission(const httplib::Request& req, httplib::Response& res);
+
+    // Обрабатывает запрос /admission/set: меняет пределы без перезапуска
+    void handle_admission_set(const httplib::Request& req, httplib::Response& res);
+
+    // Обрабатывает запрос /cluster: узел и счётчики пересылки
+    void handle_cluster(const httplib::Request& req, httplib::Response& res);
+
+    // Обрабатывает запрос /replication: роль, отставание и счётчики потока
+    void handle_replication(const httplib::Request& req, httplib::Response& res);
+
+    // Обрабатывает запрос /replication/takeover: ручное переключение резерва
+    void handle_replication_takeover(const httplib::Request& req, httplib::Response& res);
+
+    // Обрабатывает запрос /workers: размер пула, загрузка и ожидание в очереди
+    void handle_workers(const httplib::Request& req, httplib::Response& res);
+
+    // Обрабатывает запрос /latency: гистограммы задержек от сокета до ответа и отброшенные датаграммы
+    void handle_latency(const httplib::Request& req, httplib::Response& res);
+
+    // Обрабатывает запрос /heavy_hitters: самые активные пиры и IMSI за последние окна
+    void handle_heavy_hitters(const httplib::Request& req, httplib::Response& res);
+
+    // Обрабатывает запрос /session_events: поток событий сессий (text/event-stream) с продолжением по номеру
+    void handle_session_events(const httplib::Request& req, httplib::Response& res);
+
+    // Обрабатывает запрос /session_events/stats: номера, подписчики и потерянные события
+    void handle_session_events_stats(const httplib::Request& req, httplib::Response& res);
+
+    // Обрабатывает запрос /sessions/export: страница таблицы сессий по курсору
+    void handle_sessions_export(const httplib::Request& req, httplib::Response& res);
+
+    // Обрабатывает запрос /config: версия снимка, счётчики перезагрузок и действующие значения
+    void handle_config(const httplib::Request& req, httplib::Response& res);
+
+    // Обрабатывает запросы /config/reload и /config/rollback
+    void handle_config_change(const httplib::Request& req, httplib::Response& res, bool rollback);
+
+    // Обрабатывает запрос /capture: состояние, фильтр и счётчики захвата
+    void handle_capture(const httplib::Request& req, httplib::Response& res);
+
+    // Обрабатывает запрос /capture/start?peer=<ip[:port]>&imsi_prefix=<цифры>: новый захват с фильтром
+    void handle_capture_start(const httplib::Request& req, httplib::Response& res);
+
+    // Обрабатывает запрос /capture/stop
+    void handle_capture_stop(const httplib::Request& req, httplib::Response& res);
+
+    // Обрабатывает запрос /capture/pcap: кольцо в формате pcap для Wireshark/tcpdump -r
+    void handle_capture_pcap(const httplib::Request& req, httplib::Response& res);
+
+    // Обрабатывает запрос /trace?ms=<N>: события самописца (последние N мс) в формате Chrome trace
+    void handle_trace(const httplib::Request& req, httplib::Response& res);
+
+    // Обрабатывает запрос /trace/status: размер колец и число записанных событий
+    void handle_trace_status(const httplib::Request& req, httplib::Response& res);
+
+    // Обрабатывает запрос /locks: захваты, ожидание и удержание именованных блокировок
+    void handle_locks(const httplib::Request& req, httplib::Response& res);
+
+    const Config& config;
+    std::shared_ptr<ILogger> logger;
+    std::shared_ptr<ISessionManager> session_manager;
+    std::shared_ptr<AdmissionControl> admission_control;
+    std::shared_ptr<ClusterSessionManager> cluster;
+    std::shared_ptr<ReplicationEndpoint> replication;
+    std::shared_ptr<WorkerPoolSizer> pool_sizer;
+    std::shared_ptr<LatencyStats> latency_stats;
+    std::shared_ptr<HeavyHitters> heavy_hitters;
+    std::shared_ptr<SessionEventStream> session_events;
+    std::shared_ptr<SessionManager> session_table;
+    std::shared_ptr<ConfigStore> config_store;
+    std::shared_ptr<PacketCapture> packet_capture;
+    std::shared_ptr<FlightRecorder> flight_recorder;
+    std::function<void()> stop_callback;
+    std::function<void()> shutdown_handler;
+    std::unique_ptr<httplib::Server> server;
+    std::thread server_thread;
+    std::atomic<bool>& running;
+    std::atomic<bool> running_local;
+    std::mutex stop_mutex;
 };
\ No newline at end of file
@@ -1,24 +1,59 @@
-#pragma once
-
-#include <string>
-
-// Интерфейс логгера для инверсии зависимостей
-class ILogger {
-public:
-    virtual void debug(const std::string& message, const std::string& arg = "") = 0;
-    virtual void info(const std::string& message, const std::string& arg = "") = 0;
-    virtual void warn(const std::string& message, const std::string& arg = "") = 0;
-    virtual void error(const std::string& message, const std::string& arg = "") = 0;
-    virtual void critical(const std::string& message, const std::string& arg = "") = 0;
-    virtual void flush() = 0;
-    virtual ~ILogger() = default;
-};
-
-// Интерфейс для управления сессиями
-class ISessionManager {
-public:
-    virtual bool has_session(const std::string& imsi) = 0;
-    virtual void stop() = 0;
-    virtual bool create_session(const std::string& imsi) = 0; // Добавлено для UDPServer
-    virtual ~ISessionManager() = default;
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Интерфейс логгера для инверсии зависимостей
+class ILogger {
+public:
+    virtual void debug(const std::string& message, const std::string& arg = "") = 0;
+    virtual void info(const std::string& message, const std::string& arg = "") = 0;
+    virtual void warn(const std::string& message, const std::string& arg = "") = 0;
+    virtual void error(const std::string& message, const std::string& arg = "") = 0;
+    virtual void critical(const std::string& message, const std::string& arg = "") = 0;
+    virtual void flush() = 0;
+    virtual ~ILogger() = default;
+};
+
+// Ресурсы, выделенные сессии при создании
+struct SessionResources {
+    uint32_t teid = 0;             // TEID плоскости управления PGW
+    bool has_ipv4 = false;
+    uint32_t ipv4 = 0;             // IPv4-адрес UE, сетевой порядок байт
+    bool has_ipv6 = false;
+    uint8_t ipv6[16] = {};         // IPv6-префикс /64 UE
+    uint32_t peer_teid = 0;        // TEID управления SGW из F-TEID отправителя Create Session Request
+};
+
+// Сессия целиком: для репликации и восстановления на резервном узле
+struct SessionRecord {
+    std::string imsi;
+    int64_t creation_time_ms = 0;  // Время создания, мс от эпохи (system_clock)
+    SessionResources resources;
+};
+
+// Наблюдатель изменений таблицы сессий. Вызывается под мьютексом менеджера сессий,
+// поэтому реализация только ставит событие в очередь и не ждёт ввода-вывода
+class ISessionListener {
+public:
+    virtual void on_session_created(const SessionRecord& record) = 0;
+    // expired — сессия истекла по таймауту, иначе удалена по запросу
+    virtual void on_session_removed(const SessionRecord& record, bool expired) = 0;
+    virtual ~ISessionListener() = default;
+};
+
+// Интерфейс для управления сессиями
+class ISessionManager {
+public:
+    virtual bool has_session(const std::string& imsi) = 0;
+    virtual void stop() = 0;
+    virtual bool create_session(const std::string& imsi, SessionResources* resources = nullptr) = 0; // Добавлено для UDPServer
+    virtual bool delete_session(const std::string& imsi, SessionResources* resources = nullptr) = 0;
+    // IMSI сессии по TEID управления PGW: SGW адресует Delete Session Request этим TEID без IE IMSI
+    virtual bool find_session_by_teid(uint32_t teid, std::string& imsi) = 0;
+    // Узел, хранящий сессию IMSI, доступен; false — запрос отклоняется как перегрузка, не дожидаясь таймаута
+    virtual bool is_reachable(const std::string& imsi) = 0;
+    virtual size_t delete_sessions(const std::vector<std::string>& imsis) = 0;
+    virtual ~ISessionManager() = default;
 };
\ No newline at end of file
@@ -0,0 +1,102 @@
+#pragma once
+
+#include "per_core_cache.hpp"
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Адрес UE: IPv4-адрес или IPv6-префикс /64 (младшие 8 байт нулевые)
+struct IPAddress {
+    bool ipv6 = false;
+    std::array<uint8_t, 16> bytes{};   // IPv4 — первые 4 байта в сетевом порядке
+
+    std::string to_string() const;
+};
+
+// Пул адресов на битовой карте: бит на адрес (IPv4) или на префикс /64 (IPv6).
+// Двухуровневая карта: бит сводки отмечает заполненное 64-битное слово, поэтому поиск
+// свободного адреса просматривает слова сводки, а не все слова пула. Слова меняются
+// CAS без блокировок; перед картой стоят магазины ядер, так что выделение и
+// освобождение в установившемся режиме — O(1) без обращения к общей карте.
+class IPPool {
+public:
+    // cidr: "10.45.0.0/16" (/8../30, без адреса сети и широковещательного)
+    // или "2001:db8::/48" (/40../64, выдаются префиксы /64); иначе std::runtime_error
+    explicit IPPool(const std::string& cidr, size_t cache_slots = 0);
+
+    // Выделяет адрес; false — пул исчерпан
+    bool allocate(IPAddress& address);
+
+    // Возвращает адрес в пул; false — адрес не из пула
+    bool release(const IPAddress& address);
+
+    // Отмечает адрес занятым (восстановление сессий); false — адрес не из пула или уже занят.
+    // Вызывается до первого выделения, пока магазины пусты
+    bool reserve(const IPAddress& address);
+
+    // Проверяет принадлежность адреса пулу
+    bool contains(const IPAddress& address) const;
+
+    bool is_ipv6() const { return ipv6; }
+    const std::string& get_cidr() const { return cidr; }
+    size_t get_size() const { return size; }
+    size_t in_use() const { return static_cast<size_t>(used.load(std::memory_order_relaxed)); }
+
+private:
+    // Находит и занимает свободный бит карты
+    bool take_bit(uint32_t& index);
+
+    // Освобождает бит карты
+    void clear_bit(uint32_t index);
+
+    // Отмечает в сводке заполненное слово и перепроверяет его (гонка с освобождением)
+    void mark_full(size_t word);
+
+    // Собирает индекс из магазинов других ядер, когда карта заполнена
+    bool steal(uint32_t& index);
+
+    // Преобразование между индексом в пуле и адресом
+    IPAddress to_address(uint32_t index) const;
+    bool to_index(const IPAddress& address, uint32_t& index) const;
+
+    std::string cidr;
+    bool ipv6 = false;
+    int prefix_length = 0;
+    std::array<uint8_t, 16> base{};                 // Адрес сети
+    size_t bits = 0;                                // Число битов карты (адресов в диапазоне)
+    size_t size = 0;                                // Число выдаваемых адресов (префиксов)
+    size_t word_count = 0;
+    std::unique_ptr<std::atomic<uint64_t>[]> words;   // Бит 1 — адрес занят
+    std::unique_ptr<std::atomic<uint64_t>[]> summary; // Бит 1 — слово заполнено
+    size_t summary_count = 0;
+    std::atomic<size_t> cursor{ 0 };                // Слово сводки, с которого начинается поиск
+    std::atomic<int64_t> used{ 0 };
+    PerCoreCache cache;
+};
+
+// Набор пулов: выделение идёт из первого непустого пула нужного семейства,
+// освобождение — в пул, которому принадлежит адрес
+class IPPoolSet {
+public:
+    explicit IPPoolSet(const std::vector<std::string>& cidrs, size_t cache_slots = 0);
+
+    // Выделяет IPv4-адрес или IPv6-префикс; false — пулы семейства исчерпаны или не заданы
+    bool allocate(bool ipv6, IPAddress& address);
+
+    // Возвращает адрес в его пул
+    bool release(const IPAddress& address);
+
+    // Отмечает адрес занятым в его пуле
+    bool reserve(const IPAddress& address);
+
+    bool has_ipv4() const { return ipv4_pools > 0; }
+    bool has_ipv6() const { return pools.size() > ipv4_pools; }
+    const std::vector<std::unique_ptr<IPPool>>& get_pools() const { return pools; }
+
+private:
+    std::vector<std::unique_ptr<IPPool>> pools;     // Сначала IPv4, затем IPv6
+    size_t ipv4_pools = 0;
+};
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+// Гистограмма задержек с фиксированными границами 1-2-5 от 1 мкс до 1 с и корзиной переполнения.
+// Запись без блокировок (relaxed-счётчики), поэтому её можно вести из потока приёма и рабочих потоков.
+// Перцентили оцениваются верхней границей корзины (не больше максимума).
+class LatencyHistogram {
+public:
+    static constexpr size_t BUCKETS = 20;
+
+    // Верхние границы корзин в мкс; последняя корзина — всё, что дольше 1 с
+    static constexpr std::array<uint64_t, BUCKETS - 1> BOUNDS_US = {
+        1, 2, 5, 10, 20, 50, 100, 200, 500, 1000, 2000, 5000, 10000, 20000, 50000, 100000, 200000, 500000, 1000000
+    };
+
+    void record(std::chrono::nanoseconds latency);
+
+    uint64_t get_count() const { return count.load(std::memory_order_relaxed); }
+
+    // Оценка перцентиля p (0..1) в мкс: граница корзины, где накопленная доля достигает p, но не больше максимума
+    double percentile_us(double p) const;
+
+    // Строки key=value с префиксом name: число, среднее, максимум, перцентили и накопленные корзины
+    std::string report(const std::string& name) const;
+
+private:
+    std::array<std::atomic<uint64_t>, BUCKETS> buckets{};
+    std::atomic<uint64_t> count{ 0 };
+    std::atomic<uint64_t> sum_ns{ 0 };
+    std::atomic<uint64_t> max_ns{ 0 };
+};
+
+// Задержки UDP-пути по этапам по меткам времени приёма из ядра (SO_TIMESTAMPNS):
+// ожидание в буфере сокета, ожидание в очереди запросов и полный путь от сокета до ответа.
+// Вместе со счётчиком отброшенных ядром датаграмм (SO_RXQ_OVFL) отдаётся по /latency.
+class LatencyStats {
+public:
+    // Датаграмма пришла в сокет и была прочитана потоком приёма через socket_wait
+    void record_socket_wait(std::chrono::nanoseconds latency) { socket_wait.record(latency); }
+
+    // Запрос взят рабочим потоком после queue_wait в очереди
+    void record_queue_wait(std::chrono::nanoseconds latency) { queue_wait.record(latency); }
+
+    // Ответ отправлен через latency после прихода запроса в сокет
+    void record_socket_to_reply(std::chrono::nanoseconds latency) { socket_to_reply.record(latency); }
+
+    // Датаграмма прочитана без метки времени ядра (её задержки не учитываются)
+    void record_untimestamped() { untimestamped.fetch_add(1, std::memory_order_relaxed); }
+
+    // Накопленный ядром счётчик отброшенных при переполнении буфера датаграмм (приходит с каждой датаграммой)
+    void update_socket_drops(uint32_t total) { socket_drops.store(total, std::memory_order_relaxed); }
+
+    uint64_t get_socket_drops() const { return socket_drops.load(std::memory_order_relaxed); }
+    const LatencyHistogram& get_socket_wait() const { return socket_wait; }
+    const LatencyHistogram& get_queue_wait() const { return queue_wait; }
+    const LatencyHistogram& get_socket_to_reply() const { return socket_to_reply; }
+
+    // Отчёт в формате key=value по строке на параметр
+    std::string report() const;
+
+private:
+    LatencyHistogram socket_wait;
+    LatencyHistogram queue_wait;
+    LatencyHistogram socket_to_reply;
+    std::atomic<uint64_t> untimestamped{ 0 };
+    std::atomic<uint32_t> socket_drops{ 0 };
+};
@@ -0,0 +1,129 @@
+#pragma once
+
+#include "latency_stats.hpp"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Счётчики одной именованной блокировки: захваты, захваты с ожиданием, гистограммы ожидания и удержания.
+// Все мьютексы с одним именем (например, по одному на экземпляр компонента) пишут в общие счётчики
+class LockStats {
+public:
+    explicit LockStats(const std::string& name) : name(name) {}
+
+    // Захват; wait — ожидание, если мьютекс был занят (contended)
+    void record_acquire(bool contended, std::chrono::nanoseconds wait);
+
+    // Освобождение после удержания hold
+    void record_release(std::chrono::nanoseconds hold) { hold_time.record(hold); }
+
+    const std::string& get_name() const { return name; }
+    uint64_t get_acquisitions() const { return acquisitions.load(std::memory_order_relaxed); }
+    uint64_t get_contended() const { return contended.load(std::memory_order_relaxed); }
+    const LatencyHistogram& get_wait_time() const { return wait_time; }
+    const LatencyHistogram& get_hold_time() const { return hold_time; }
+
+    // Строки key=value с префиксом имени блокировки
+    std::string report() const;
+
+private:
+    const std::string name;
+    std::atomic<uint64_t> acquisitions{ 0 };
+    std::atomic<uint64_t> contended{ 0 };
+    LatencyHistogram wait_time;     // Только захваты с ожиданием
+    LatencyHistogram hold_time;
+};
+
+// Реестр именованных блокировок процесса для /locks. Счётчики живут до конца процесса,
+// поэтому мьютекс держит на них простой указатель
+class LockRegistry {
+public:
+    static LockRegistry& instance();
+
+    // Счётчики блокировки name; создаются при первом обращении
+    LockStats& get(const std::string& name);
+
+    // Отчёт по всем блокировкам в порядке регистрации
+    std::string report() const;
+
+    // Профилирование вкомпилировано (сборка с PGW_LOCK_PROFILING)
+    static constexpr bool enabled() {
+#ifdef PGW_LOCK_PROFILING
+        return true;
+#else
+        return false;
+#endif
+    }
+
+private:
+    LockRegistry() = default;
+
+    mutable std::mutex mutex;
+    std::vector<std::unique_ptr<LockStats>> locks;
+};
+
+#ifdef PGW_LOCK_PROFILING
+
+// Мьютекс с учётом ожидания и удержания. Захват сначала пробует try_lock: свободный мьютекс
+// стоит одного чтения часов, ожидание измеряется только при конкуренции.
+// Счётчики обновляются под самим мьютексом, поэтому потоки не спорят за их кэш-линии
+class ProfiledMutex {
+public:
+    explicit ProfiledMutex(const char* name) : stats(&LockRegistry::instance().get(name)) {}
+
+    ProfiledMutex(const ProfiledMutex&) = delete;
+    ProfiledMutex& operator=(const ProfiledMutex&) = delete;
+
+    void lock() {
+        if (mutex.try_lock()) {
+            acquired_at = std::chrono::steady_clock::now();
+            stats->record_acquire(false, std::chrono::nanoseconds(0));
+            return;
+        }
+        auto wait_start = std::chrono::steady_clock::now();
+        mutex.lock();
+        acquired_at = std::chrono::steady_clock::now();
+        stats->record_acquire(true, acquired_at - wait_start);
+    }
+
+    bool try_lock() {
+        if (!mutex.try_lock()) {
+            return false;
+        }
+        acquired_at = std::chrono::steady_clock::now();
+        stats->record_acquire(false, std::chrono::nanoseconds(0));
+        return true;
+    }
+
+    void unlock() {
+        stats->record_release(std::chrono::steady_clock::now() - acquired_at);
+        mutex.unlock();
+    }
+
+private:
+    std::mutex mutex;
+    LockStats* stats;
+    std::chrono::steady_clock::time_point acquired_at;   // Под mutex
+};
+
+// Ожидание условия на ProfiledMutex: освобождение и повторный захват при ожидании тоже учитываются
+using ProfiledLock = std::unique_lock<ProfiledMutex>;
+using ProfiledConditionVariable = std::condition_variable_any;
+
+#else
+
+// Без PGW_LOCK_PROFILING (сборка Release) — обычный std::mutex: имя отбрасывается, накладных расходов нет
+class ProfiledMutex : public std::mutex {
+public:
+    explicit ProfiledMutex(const char*) {}
+};
+
+using ProfiledLock = std::unique_lock<std::mutex>;
+using ProfiledConditionVariable = std::condition_variable;
+
+#endif
@@ -0,0 +1,107 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include <netinet/in.h>
+
+// Направление захваченной датаграммы
+enum class CaptureDirection : uint8_t {
+    Request = 0,    // От пира к PGW
+    Reply = 1       // От PGW к пиру
+};
+
+// Датаграмма, прочитанная из кольца захвата
+struct CapturedPacket {
+    int64_t timestamp_ns = 0;   // CLOCK_REALTIME, нс
+    CaptureDirection direction = CaptureDirection::Request;
+    uint32_t peer_addr = 0;     // Адрес пира, сетевой порядок байт
+    uint16_t peer_port = 0;     // Порт пира, сетевой порядок байт
+    uint32_t length = 0;        // Исходная длина датаграммы
+    std::string data;           // Первые SNAPLEN байт датаграммы
+};
+
+// Захват датаграмм в кольцо фиксированного размера внутри процесса — замена tcpdump рядом с PGW.
+// Запись без блокировок: номер слота выдаёт fetch_add общего счётчика, слот защищён seqlock,
+// поэтому поток приёма и рабочие потоки пишут параллельно, а читатель пропускает слоты,
+// которые в момент чтения перезаписываются. Старые датаграммы затираются новыми.
+// Выключенный захват стоит одной relaxed-загрузки флага на датаграмму.
+// Фильтр (пир и/или префикс IMSI) хранится в атомарных словах: смена фильтра не требует блокировок
+class PacketCapture {
+public:
+    // Сколько байт датаграммы сохраняется: запросы GTPv2-C и BCD целиком, с запасом на IE
+    static constexpr size_t SNAPLEN = 512;
+    static constexpr size_t MAX_IMSI_PREFIX = 15;
+
+    // slots — ёмкость кольца; local_addr и local_port (сетевой порядок байт) — адрес PGW в pcap
+    PacketCapture(size_t slots, uint32_t local_addr, uint16_t local_port);
+
+    // Запрещаем копирование
+    PacketCapture(const PacketCapture&) = delete;
+    PacketCapture& operator=(const PacketCapture&) = delete;
+
+    // Включён ли захват; проверяется на каждой датаграмме
+    bool is_enabled() const { return enabled.load(std::memory_order_relaxed); }
+
+    // Начинает новый захват: кольцо логически очищается. peer — "ip" или "ip:port", пусто — любой пир;
+    // imsi_prefix — до 15 цифр, пусто — любой IMSI. Некорректный фильтр — std::invalid_argument
+    void start(const std::string& peer, const std::string& imsi_prefix);
+
+    // Останавливает захват; кольцо сохраняется для выгрузки
+    void stop();
+
+    // Сохраняет запрос, если он проходит фильтр; возвращает true, если сохранён.
+    // imsi — декодированный IMSI; nullptr, пока запрос не разобран: тогда при фильтре по IMSI
+    // запрос не сохраняется. timestamp_ns — метка ядра; 0 — текущее время
+    bool record_request(const void* data, size_t length, const sockaddr_in& peer, int64_t timestamp_ns,
+        const std::string* imsi);
+
+    // Сохраняет ответ на сохранённый запрос
+    void record_reply(const void* data, size_t length, const sockaddr_in& peer);
+
+    // Датаграммы текущего захвата в порядке записи
+    std::vector<CapturedPacket> snapshot() const;
+
+    // Текущий захват в формате pcap
+    std::string pcap() const;
+
+    // Состояние, фильтр и счётчики в формате key=value
+    std::string report() const;
+
+    // Файл pcap (наносекундные метки, LINKTYPE_IPV4): к каждой датаграмме достраиваются
+    // заголовки IPv4 и UDP между пиром и local_addr:local_port
+    static std::string format_pcap(const std::vector<CapturedPacket>& packets, uint32_t local_addr, uint16_t local_port);
+
+private:
+    struct Slot {
+        std::atomic<uint64_t> sequence{ 0 };    // 2*ticket+1 — идёт запись, 2*ticket+2 — слот записан
+        int64_t timestamp_ns = 0;
+        uint32_t peer_addr = 0;
+        uint16_t peer_port = 0;
+        CaptureDirection direction = CaptureDirection::Request;
+        uint32_t length = 0;
+        uint16_t captured = 0;
+        uint8_t data[SNAPLEN];
+    };
+
+    // Пир проходит фильтр
+    bool matches_peer(const sockaddr_in& peer) const;
+
+    // IMSI начинается с префикса из фильтра filter
+    static bool matches_imsi(const std::string& imsi, uint64_t filter);
+
+    // Занимает слот и копирует в него датаграмму
+    void write(CaptureDirection direction, const void* data, size_t length, const sockaddr_in& peer, int64_t timestamp_ns);
+
+    const size_t slot_count;
+    const uint32_t local_addr;
+    const uint16_t local_port;
+    std::unique_ptr<Slot[]> slots;
+    std::atomic<bool> enabled{ false };
+    std::atomic<uint64_t> head{ 0 };            // Следующий билет записи
+    std::atomic<uint64_t> start_ticket{ 0 };    // Первый билет текущего захвата
+    std::atomic<uint64_t> peer_filter{ 0 };     // 0 — любой; иначе 1<<48 | адрес<<16 | порт (0 — любой порт)
+    std::atomic<uint64_t> imsi_filter{ 0 };     // 0 — любой; иначе длина<<56 | значение префикса
+};
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+// Кэши свободных значений по ядрам процессора (магазины) для аллокаторов TEID и адресов.
+// Поток забирает магазин своего ядра атомарным обменом и возвращает его после операции.
+// Если магазин занят другим потоком (поток мигрировал или ядро делят несколько потоков),
+// вызывающий обращается к общему пулу напрямую: блокировок и ожидания нет.
+class PerCoreCache {
+public:
+    static constexpr size_t MAGAZINE_SIZE = 64;
+
+    struct Magazine {
+        size_t slot = 0;                    // Слот, которому принадлежит магазин
+        size_t count = 0;                   // Число значений в items
+        uint32_t items[MAGAZINE_SIZE];
+    };
+
+    // Конструктор: slots = 0 — по числу ядер
+    explicit PerCoreCache(size_t slots = 0);
+
+    // Запрещаем копирование: магазины держатся по указателю
+    PerCoreCache(const PerCoreCache&) = delete;
+    PerCoreCache& operator=(const PerCoreCache&) = delete;
+
+    // Забирает магазин текущего ядра; nullptr — магазин занят
+    Magazine* acquire();
+
+    // Забирает магазин заданного слота (для сбора чужих кэшей при исчерпании пула)
+    Magazine* acquire_slot(size_t slot);
+
+    // Возвращает магазин в его слот
+    void release(Magazine* magazine);
+
+    size_t get_slots() const { return slots; }
+
+private:
+    // Слот выровнен по кэш-линии, чтобы ядра не делили линии
+    struct alignas(64) Slot {
+        std::atomic<Magazine*> magazine{ nullptr };
+        Magazine storage;
+    };
+
+    size_t slots;
+    std::unique_ptr<Slot[]> table;
+};
@@ -0,0 +1,203 @@
+#pragma once
+
+#include "config.hpp"
+#include "interfaces.hpp"
+#include "session_manager.hpp"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+// Протокол потока репликации active → standby поверх TCP.
+// Кадр: тип (1), номер последовательности (8), длина данных (4), данные; целые — сетевой порядок байт.
+// Записи пачки: вид (1), длина IMSI (1), IMSI; у создания далее время создания в мс (8),
+// TEID (4), флаги (1: бит 0 — IPv4, бит 1 — IPv6), IPv4 (4), IPv6 (16), TEID SGW (4).
+namespace replication {
+
+enum FrameType : uint8_t {
+    FRAME_BATCH = 1,            // Пачка дельт
+    FRAME_SNAPSHOT_BEGIN = 2,   // Начало полной копии таблицы: далее пачки создания
+    FRAME_SNAPSHOT_END = 3,     // Конец полной копии: standby заменяет таблицу
+    FRAME_CHECKSUM = 4,         // Число сессий (8) и контрольная сумма (8) после предыдущих кадров
+    FRAME_ACK = 5,              // standby → active: кадр с этим номером применён
+    FRAME_RESYNC = 6            // standby → active: нужна полная копия
+};
+
+enum RecordType : uint8_t {
+    RECORD_CREATE = 1,
+    RECORD_DELETE = 2,
+    RECORD_EXPIRE = 3
+};
+
+constexpr size_t FRAME_HEADER_SIZE = 13;
+constexpr size_t MAX_FRAME_PAYLOAD = 1 << 24;
+
+// Вклад сессии в контрольную сумму таблицы; сумма — XOR вкладов, поэтому не зависит от порядка
+uint64_t record_hash(const SessionRecord& record);
+
+} // namespace replication
+
+// Общая часть обеих сторон репликации для /replication
+class ReplicationEndpoint {
+public:
+    // Отчёт в формате key=value по строке на параметр
+    virtual std::string report() const = 0;
+
+    // Запрос ручного переключения; false — узел не резервный
+    virtual bool request_takeover() { return false; }
+
+    virtual ~ReplicationEndpoint() = default;
+};
+
+// Активная сторона: наблюдатель менеджера сессий, копящий дельты, и поток их отправки.
+// Дельта только ставится в очередь под мьютексом, поэтому репликация не добавляет задержки
+// к созданию сессии; отправка, контрольные суммы и полные копии идут в своих потоках.
+// Подключается один standby; при подключении и по его запросу он получает полную копию.
+class ReplicationSender : public ISessionListener, public ReplicationEndpoint {
+public:
+    // Конструктор: sessions — менеджер, чьи сессии реплицируются (для полных копий)
+    ReplicationSender(const Config& config, SessionManager& sessions, std::shared_ptr<ILogger> logger);
+    ~ReplicationSender();
+
+    // Начинает слушать replication_address и запускает отправку
+    void run();
+    void stop();
+
+    void on_session_created(const SessionRecord& record) override;
+    void on_session_removed(const SessionRecord& record, bool expired) override;
+
+    // Подключение, номера последовательности, отставание standby (кадры и мс)
+    std::string report() const override;
+
+private:
+    struct Delta {
+        replication::RecordType type;
+        SessionRecord record;
+    };
+
+    // Принимает standby и читает его подтверждения до разрыва
+    void accept_loop();
+
+    // Собирает дельты в пачки и отправляет; по запросу — полная копия
+    void send_loop();
+
+    // Отправляет полную копию таблицы сессий
+    bool send_snapshot();
+
+    // Отправляет дельты пачками не больше BATCH_RECORDS
+    bool send_deltas(const std::vector<Delta>& deltas);
+
+    // Отправляет кадр; при ошибке закрывает соединение
+    bool send_frame(replication::FrameType type, const std::vector<uint8_t>& payload);
+
+    // Снимает соединение fd, если оно ещё текущее
+    void disconnect(int fd, const char* reason);
+
+    // Добавляет дельту в очередь, если standby подключён
+    void enqueue(replication::RecordType type, const SessionRecord& record);
+
+    const Config& config;
+    SessionManager& sessions;
+    std::shared_ptr<ILogger> logger;
+    int listen_fd = -1;
+    std::atomic<bool> running{ false };
+    std::thread accept_thread;
+    std::thread send_thread;
+
+    // Очередь дельт и контрольная сумма таблицы; меняются под мьютексом менеджера сессий
+    // (события наблюдателя), queue_mutex защищает от потока отправки
+    mutable std::mutex queue_mutex;
+    std::condition_variable queue_cond;
+    std::vector<Delta> queue;
+    bool connected = false;
+    bool resync_needed = false;
+    uint64_t session_count = 0;
+    uint64_t checksum = 0;
+
+    // Соединение со standby и номера кадров; send_mutex держится на время записи кадра
+    mutable std::mutex send_mutex;
+    int client_fd = -1;
+    uint64_t sequence = 0;                      // Номер последнего отправленного кадра
+    uint64_t acked = 0;                         // Номер последнего подтверждённого кадра
+    std::deque<std::pair<uint64_t, std::chrono::steady_clock::time_point>> unacked;
+
+    std::atomic<uint64_t> deltas_sent{ 0 };
+    std::atomic<uint64_t> snapshots_sent{ 0 };
+    std::atomic<uint64_t> deltas_dropped{ 0 };  // Сброшены при переполнении очереди (standby получит копию)
+
+    static constexpr size_t BATCH_RECORDS = 1024;
+    static constexpr size_t MAX_QUEUE = 1 << 20;
+    static constexpr int HEARTBEAT_MS = 100;   // Пустая пачка при простое, чтобы standby отличал тишину от сбоя
+};
+
+// Резервная сторона: подключается к active, ведёт копию таблицы сессий и проверяет её
+// контрольными суммами. При потере active дольше replication_takeover_ms (или по запросу)
+// выставляет takeover_ready(); main забирает копию take_over() и поднимает UDP-сервер.
+class ReplicationReceiver : public ReplicationEndpoint {
+public:
+    ReplicationReceiver(const Config& config, std::shared_ptr<ILogger> logger);
+    ~ReplicationReceiver();
+
+    // Запускает поток подключения и приёма
+    void run();
+    void stop();
+
+    // Пора ли переключаться: был active и пропал дольше таймаута, или запрошено вручную
+    bool takeover_ready() const;
+
+    // Останавливает приём и отдаёт копию таблицы для restore_sessions
+    std::vector<SessionRecord> take_over();
+
+    bool request_takeover() override;
+
+    // Подключение, размер копии, номер последнего кадра, проверки контрольной суммы
+    std::string report() const override;
+
+private:
+    // Подключается к active и принимает кадры, пока не остановлен
+    void receive_loop();
+
+    // Применяет кадр; false — нарушена последовательность или формат
+    bool apply_frame(uint8_t type, uint64_t frame_sequence, const std::vector<uint8_t>& payload, int fd);
+
+    // Применяет записи пачки к таблице
+    bool apply_batch(const std::vector<uint8_t>& payload);
+
+    // Отправляет active короткий кадр (подтверждение или запрос копии)
+    void send_control(int fd, replication::FrameType type, uint64_t frame_sequence);
+
+    // Копия таблицы сессий с контрольной суммой
+    struct Table {
+        std::unordered_map<std::string, SessionRecord> sessions;
+        uint64_t checksum = 0;
+
+        void put(SessionRecord record);
+        void erase(const std::string& imsi);
+    };
+
+    const Config& config;
+    std::shared_ptr<ILogger> logger;
+    std::atomic<bool> running{ false };
+    std::thread receive_thread;
+
+    mutable std::mutex mutex;
+    Table table;
+    Table staging;                              // Принимаемая полная копия, заменяет table в конце
+    bool in_snapshot = false;
+    uint64_t last_sequence = 0;
+    bool synchronized = false;                  // Получена полная копия в текущем соединении
+    bool connected = false;
+    bool ever_connected = false;
+    bool takeover_requested = false;
+    bool promoted = false;                      // Копия отдана, узел работает как основной
+    std::chrono::steady_clock::time_point last_contact;   // Последний кадр от active (или момент подключения)
+    uint64_t snapshots = 0;
+    uint64_t checksum_checks = 0;
+    uint64_t checksum_mismatches = 0;
+};
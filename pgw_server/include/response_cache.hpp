@@ -0,0 +1,64 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <netinet/in.h>
+
+// Кэш ответов для обнаружения повторных передач (ретрансмиссий) от пиров.
+// Ключ — адрес пира и идентификатор запроса (номер последовательности или
+// содержимое датаграммы). Повтор получает исходный ответ прямо из пути приёма,
+// не затрагивая таблицу сессий и CDR.
+class ResponseCache {
+public:
+    // Результат поиска запроса в кэше
+    enum class Lookup {
+        Miss,     // Новый запрос: зарегистрирован как ожидающий ответа
+        Pending,  // Повтор запроса, который ещё обрабатывается
+        Hit       // Повтор запроса с готовым ответом
+    };
+
+    // Конструктор: ttl = 0 отключает кэш
+    ResponseCache(std::chrono::milliseconds ttl, size_t max_entries);
+
+    // Ищет запрос пира; при промахе регистрирует его, при попадании возвращает ответ
+    Lookup lookup(const struct sockaddr_in& peer, const std::string& request_id, std::string& response);
+
+    // Сохраняет ответ на ранее зарегистрированный запрос
+    void complete(const struct sockaddr_in& peer, const std::string& request_id, const std::string& response);
+
+    // Забывает запрос, на который не будет дан кэшируемый ответ (например, при перегрузке)
+    void forget(const struct sockaddr_in& peer, const std::string& request_id);
+
+    // Счётчики для диагностики
+    uint64_t get_replayed() const { return replayed; }
+    uint64_t get_suppressed() const { return suppressed; }
+    // Число записей; позиция в очереди вытеснения без записи тоже считается
+    size_t size();
+
+private:
+    struct Entry {
+        std::chrono::steady_clock::time_point created;
+        std::string response;
+        bool ready;
+    };
+
+    // Ключ: IPv4-адрес, порт и идентификатор запроса
+    static std::string make_key(const struct sockaddr_in& peer, const std::string& request_id);
+
+    // Удаляет записи старше TTL и лишние записи сверх max_entries
+    void evict(std::chrono::steady_clock::time_point now);
+
+    std::chrono::milliseconds ttl;
+    size_t max_entries;
+    std::unordered_map<std::string, Entry> entries;
+    // Порядок вставки: TTL одинаков для всех, поэтому старые записи всегда в начале
+    std::deque<std::pair<std::chrono::steady_clock::time_point, std::string>> order;
+    std::mutex mutex;
+    std::atomic<uint64_t> replayed{ 0 };    // Повторы, получившие ответ из кэша
+    std::atomic<uint64_t> suppressed{ 0 };  // Повторы, отброшенные до готовности ответа
+};
\ No newline at end of file
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <vector>
+
+// Событие жизненного цикла сессии: та же запись, что строка CDR, плюс номер в потоке
+struct SessionEvent {
+    uint64_t seq;            // Номер события, растёт с 1 с запуска процесса
+    std::string timestamp;   // Метка в формате CDR
+    std::string imsi;
+    std::string action;      // created, deleted, rejected: <причина>
+
+    // Тип события для SSE: действие до двоеточия
+    std::string type() const;
+};
+
+// Очередная порция для подписчика
+struct SessionEventBatch {
+    std::vector<std::shared_ptr<const SessionEvent>> events;
+    uint64_t lost = 0;       // Событий пропущено с прошлой порции: кольцо переполнилось или история не дотянулась
+    bool closed = false;     // Поток закрыт, событий больше не будет
+};
+
+// Подписка на поток: своё ограниченное кольцо событий. Публикация кладёт событие в кольцо
+// и никогда не ждёт читателя: при переполнении вытесняется самое старое событие и растёт lost
+class SessionEventSubscription {
+public:
+    explicit SessionEventSubscription(size_t capacity);
+
+    // Ждёт событий не дольше timeout и забирает все накопленные
+    SessionEventBatch wait(std::chrono::milliseconds timeout);
+
+    uint64_t get_lost() const;
+
+private:
+    friend class SessionEventStream;
+
+    // Кладёт событие, вытесняя самое старое при переполнении
+    void push(std::shared_ptr<const SessionEvent> event);
+
+    // Отмечает пропуск событий до начала подписки
+    void add_lost(uint64_t count);
+
+    // Будит ожидающего читателя, новых событий не будет
+    void close();
+
+    const size_t capacity;
+    mutable std::mutex mutex;
+    std::condition_variable cv;
+    std::deque<std::shared_ptr<const SessionEvent>> ring;
+    uint64_t pending_lost = 0;
+    uint64_t total_lost = 0;
+    bool closed = false;
+};
+
+// Поток событий сессий для /session_events вместо чтения cdr.log. CDRLogger публикует каждую запись;
+// последние события хранятся в истории, чтобы переподключившийся клиент продолжил с последнего
+// полученного номера. Блокировки публикации короткие и не пересекаются с записью в сокет
+class SessionEventStream {
+public:
+    SessionEventStream(size_t capacity, size_t max_subscribers);
+
+    // Публикует событие всем подписчикам и в историю
+    void publish(const std::string& timestamp, const std::string& imsi, const std::string& action);
+
+    // Подписывает на события с номером больше after_seq (из истории) или только на новые, если номер не задан.
+    // При превышении числа подписчиков или закрытом потоке возвращает nullptr
+    std::shared_ptr<SessionEventSubscription> subscribe(std::optional<uint64_t> after_seq = std::nullopt);
+
+    // Отписывает; вызывается, когда клиент отключился
+    void unsubscribe(const std::shared_ptr<SessionEventSubscription>& subscription);
+
+    // Закрывает поток: подписчики получают closed, новые подписки отклоняются
+    void close();
+
+    uint64_t get_last_seq() const;
+    size_t get_subscriber_count() const;
+
+    // Счётчики в формате key=value
+    std::string report() const;
+
+    // Порция в формате text/event-stream: id, event и data (строка CDR) на каждое событие,
+    // пропуски — событием lost, пустая порция — комментарием keepalive
+    static std::string format_sse(const SessionEventBatch& batch);
+
+private:
+    const size_t capacity;
+    const size_t max_subscribers;
+    mutable std::mutex mutex;
+    std::deque<std::shared_ptr<const SessionEvent>> history;
+    std::vector<std::shared_ptr<SessionEventSubscription>> subscribers;
+    uint64_t last_seq = 0;
+    uint64_t rejected_subscriptions = 0;
+    uint64_t lost_by_unsubscribed = 0;
+    bool closed = false;
+};
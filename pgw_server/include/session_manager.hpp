@@ -1,45 +1,147 @@
-#pragma once
-#include "config.hpp"
-#include "cdr_logger.hpp"
-#include "interfaces.hpp"
-#include <map>
-#include <mutex>
-#include <string>
-#include <thread>
-#include <chrono>
-
-// Структура для хранения данных сессии
-struct Session {
-    std::chrono::system_clock::time_point creation_time;
-};
-
-// Класс для управления сессиями абонентов
-class SessionManager : public ISessionManager {
-public:
-    // Конструктор: принимает конфигурацию и логгер CDR
-    SessionManager(const Config& config, std::shared_ptr<CDRLogger> cdr_logger);
-    ~SessionManager();
-
-    // Запускает фоновую очистку истёкших сессий
-    void run();
-
-    // Останавливает менеджер сессий
-    void stop() override;
-
-    // Создаёт сессию для IMSI, если разрешено
-    bool create_session(const std::string& imsi) override;
-
-    // Проверяет наличие активной сессии для IMSI
-    bool has_session(const std::string& imsi) override;
-
-    // Удаляет истёкшие сессии
-    void cleanup_expired_sessions();
-
-private:
-    const Config& config;
-    std::shared_ptr<CDRLogger> cdr_logger;
-    std::map<std::string, Session> sessions;
-    std::mutex mutex;
-    std::thread cleanup_thread;
-    bool running;
+#pragma once
+#include "config.hpp"
+#include "config_store.hpp"
+#include "cdr_logger.hpp"
+#include "flight_recorder.hpp"
+#include "clock.hpp"
+#include "interfaces.hpp"
+#include "subscriber_index.hpp"
+#include "teid_allocator.hpp"
+#include "ip_pool.hpp"
+#include "lock_profiler.hpp"
+#include <list>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+#include <string>
+#include <thread>
+#include <chrono>
+#include <functional>
+
+// Структура для хранения данных сессии
+struct Session {
+    std::chrono::system_clock::time_point creation_time;   // Время реального мира, для CDR и репликации
+    std::chrono::steady_clock::time_point created_at;      // Монотонное время создания, по нему сессия истекает
+    std::list<const std::string*>::iterator expiry;  // Позиция в очереди истечения
+    SessionResources resources;                      // TEID и адреса UE
+};
+
+// Сессия в выгрузке таблицы
+struct SessionExportEntry {
+    std::string imsi;
+    int64_t creation_time_ms = 0;  // Время создания, мс от эпохи (system_clock)
+    int64_t expires_at_ms = 0;     // Когда сессия истечёт по часам реального мира, мс от эпохи
+};
+
+// Страница выгрузки: сессии из шардов [cursor, next_cursor)
+struct SessionExportPage {
+    std::vector<SessionExportEntry> sessions;
+    size_t next_cursor = 0;        // Курсор следующей страницы; SHARDS — выгрузка закончена
+};
+
+// Класс для управления сессиями абонентов
+class SessionManager : public ISessionManager {
+public:
+    // Конструктор: принимает конфигурацию и логгер CDR; clock по умолчанию — часы логгера CDR
+    SessionManager(const Config& config, std::shared_ptr<CDRLogger> cdr_logger, std::shared_ptr<IClock> clock = nullptr);
+    ~SessionManager();
+
+    // Запускает фоновую очистку истёкших сессий
+    void run();
+
+    // Останавливает менеджер сессий
+    void stop() override;
+
+    // Создаёт сессию для IMSI, если разрешено. Из resources берётся peer_teid, сохраняемый с сессией;
+    // выделенные TEID и адреса пишутся в resources
+    bool create_session(const std::string& imsi, SessionResources* resources = nullptr) override;
+
+    // Проверяет наличие активной сессии для IMSI (без блокировок для IMSI до 15 цифр)
+    bool has_session(const std::string& imsi) override;
+
+    // Удаляет сессию по запросу (detach) и пишет CDR "deleted"; ресурсы удалённой сессии пишутся
+    // в resources (peer_teid — для заголовка ответа). false — сессии нет
+    bool delete_session(const std::string& imsi, SessionResources* resources = nullptr) override;
+
+    // Находит IMSI сессии по выданному ей TEID управления PGW
+    bool find_session_by_teid(uint32_t teid, std::string& imsi) override;
+
+    // Локальная таблица доступна всегда
+    bool is_reachable(const std::string&) override { return true; }
+
+    // Удаляет сессии по списку IMSI под одной блокировкой; возвращает число удалённых
+    size_t delete_sessions(const std::vector<std::string>& imsis) override;
+
+    // Удаляет истёкшие сессии; возвращает их число
+    size_t cleanup_expired_sessions();
+
+    size_t get_session_count();
+
+    // Выгружает страницу таблицы: целые шарды начиная с cursor, пока не наберётся limit сессий
+    // (не меньше одного непустого шарда). Мьютекс берётся на каждый шард отдельно, поэтому выгрузка
+    // не останавливает создание сессий; выгрузка — не снимок: шард согласован на момент своего чтения
+    SessionExportPage export_sessions(size_t cursor, size_t limit);
+
+    // Число шардов таблицы сессий и конец курсора выгрузки
+    static constexpr size_t SHARDS = 4096;
+
+    // Подключает наблюдателя изменений (репликация); вызывается до начала обработки запросов
+    void set_listener(std::shared_ptr<ISessionListener> listener);
+
+    // Подключает перезагружаемую конфигурацию: таймаут сессий и чёрный список берутся из её
+    // текущего снимка без блокировок; вызывается до начала обработки запросов
+    void set_config_store(std::shared_ptr<ConfigStore> config_store);
+
+    // Подключает бортовой самописец: проходы очистки истёкших сессий. Вызывается до run()
+    void set_flight_recorder(std::shared_ptr<FlightRecorder> flight_recorder);
+
+    // Передаёт consumer все сессии. consumer вызывается под мьютексом менеджера, поэтому
+    // снимок согласован с событиями наблюдателя: до него — учтённые, после — новые
+    void snapshot(const std::function<void(std::vector<SessionRecord>&)>& consumer);
+
+    // Восстанавливает сессии резервного узла при переключении: занимает их TEID и адреса,
+    // сохраняет время создания. Вызывается на новом менеджере до начала обработки; CDR не пишется
+    size_t restore_sessions(std::vector<SessionRecord> records);
+
+private:
+    // Действующая конфигурация: текущий снимок, если подключено хранилище, иначе стартовая
+    ConfigStore::Ref live_config() const { return config_store ? config_store->current() : ConfigStore::Ref(&config); }
+
+    using SessionTable = std::unordered_map<std::string, Session>;
+
+    // Шард таблицы для IMSI; распределение по шардам не меняется, поэтому курсор выгрузки стабилен
+    SessionTable& shard_of(const std::string& imsi);
+
+    // Удаляет сессию из таблицы, индекса и очереди истечения; вызывается под мьютексом
+    void erase_session(SessionTable& shard, SessionTable::iterator it);
+
+    // Выделяет TEID и адреса из всех настроенных семейств; false — какой-то пул исчерпан
+    bool allocate_resources(SessionResources& resources);
+
+    // Возвращает TEID и адреса в пулы
+    void release_resources(const SessionResources& resources);
+
+    // Запись сессии для наблюдателя
+    static SessionRecord make_record(const std::string& imsi, const Session& session);
+
+    const Config& config;
+    std::shared_ptr<CDRLogger> cdr_logger;
+    std::shared_ptr<IClock> clock;
+    // Таблица сессий, разбитая на SHARDS частей по хешу IMSI; все шарды под общим мьютексом,
+    // разбиение нужно выгрузке, чтобы держать мьютекс на один небольшой шард
+    std::vector<SessionTable> sessions;
+    // Ключи sessions в порядке создания. Таймаут у всех сессий общий, поэтому это и
+    // порядок истечения: очистка снимает голову очереди, удаление вынимает узел за O(1)
+    std::list<const std::string*> expiry_queue;
+    SubscriberIndex index;  // Копия множества IMSI для чтения без блокировок
+    // Ключи sessions по TEID управления PGW; узлы таблицы не перемещаются, указатели стабильны
+    std::unordered_map<uint32_t, const std::string*> teid_sessions;
+    TEIDAllocator teids;    // Выделение без блокировок: вызывается до захвата мьютекса
+    IPPoolSet ip_pools;
+    ProfiledMutex mutex{ "session_manager" };  // Сериализует писателей sessions и index
+    std::thread cleanup_thread;
+    std::shared_ptr<ISessionListener> listener;
+    std::shared_ptr<ConfigStore> config_store;
+    std::shared_ptr<FlightRecorder> flight_recorder;
+    bool running;
 };
\ No newline at end of file
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Индекс активных IMSI для чтения без блокировок (RCU-подобная схема).
+// Писатели (создание и удаление сессий) сериализуются мьютексом SessionManager,
+// читатели (has_session из HTTP) не берут блокировок и никогда не ждут писателей.
+// Писатели тоже не ждут читателей: заменённые таблицы освобождаются позже, в reclaim.
+class SubscriberIndex {
+public:
+    explicit SubscriberIndex(size_t initial_capacity = 1024);
+    ~SubscriberIndex();
+
+    // Запрещаем копирование: читатели держат указатели на таблицы
+    SubscriberIndex(const SubscriberIndex&) = delete;
+    SubscriberIndex& operator=(const SubscriberIndex&) = delete;
+
+    // Упаковывает IMSI (1..15 цифр) в 64-битный ключ; 0, если упаковать нельзя
+    static uint64_t pack(const std::string& imsi);
+
+    // Проверяет наличие ключа: wait-free, число проб ограничено размером таблицы
+    bool contains(uint64_t key) const;
+
+    // Изменяющие операции: вызывать только под мьютексом писателя
+    void insert(uint64_t key);
+    void erase(uint64_t key);
+    void clear();
+
+    // Освобождает заменённые таблицы, которые уже не видит ни один читатель; не ждёт.
+    // Вызывается на каждой записи и из потока очистки; только под мьютексом писателя
+    void reclaim();
+
+    // Количество ключей в индексе (для писателя и диагностики)
+    size_t size() const { return live; }
+
+    // Заменённые таблицы, ждущие освобождения (для диагностики)
+    size_t retired_tables() const { return retired.size(); }
+
+private:
+    // Таблица с открытой адресацией; слоты читаются атомарно
+    struct Table {
+        explicit Table(size_t capacity);
+        size_t mask;
+        std::unique_ptr<std::atomic<uint64_t>[]> slots;
+    };
+
+    static constexpr uint64_t EMPTY = 0;
+    static constexpr uint64_t TOMBSTONE = ~0ULL;
+
+    static size_t hash(uint64_t key);
+
+    // Заменённая таблица; drained[e] — счётчик читателей эпохи e обнулялся после замены
+    struct Retired {
+        Table* table;
+        bool drained[2];
+    };
+
+    // Перестраивает таблицу (с переносом ключей или пустую), публикует её
+    // атомарной заменой указателя и откладывает старую в retired
+    void rebuild(size_t capacity, bool copy_keys);
+
+    std::atomic<Table*> current;
+    std::atomic<uint32_t> epoch{ 0 };
+    // Счётчики активных читателей для чётной и нечётной эпохи
+    mutable std::atomic<uint64_t> readers[2];
+    size_t initial_capacity;
+    size_t live = 0;   // Занятые слоты
+    size_t used = 0;   // Занятые слоты и надгробия
+    std::vector<Retired> retired;
+};
\ No newline at end of file
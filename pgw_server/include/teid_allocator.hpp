@@ -0,0 +1,51 @@
+#pragma once
+
+#include "per_core_cache.hpp"
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// Аллокатор TEID без блокировок. Выдаёт значения 1..capacity (0 в GTP зарезервирован).
+// Путь выделения: магазин ядра → ни разу не выданные TEID → общий стек свободных (стек
+// Трайбера с тегом против ABA). Освобождение кладёт TEID в магазин ядра, переполнение
+// магазина сбрасывается в общий стек. Все операции O(1), кроме исчерпания, когда
+// собираются магазины других ядер.
+class TEIDAllocator {
+public:
+    // Конструктор: cache_slots = 0 — по числу ядер
+    explicit TEIDAllocator(uint32_t capacity, size_t cache_slots = 0);
+
+    // Выделяет TEID; 0 — пул исчерпан
+    uint32_t allocate();
+
+    // Возвращает TEID в пул; вызывающий гарантирует, что TEID был выделен и не освобождён
+    void release(uint32_t teid);
+
+    // Отмечает TEID занятыми (восстановление сессий при переключении на резерв).
+    // Вызывается на новом аллокаторе до первого выделения; неверные и повторные TEID пропускаются
+    void reserve(std::vector<uint32_t> teids);
+
+    uint32_t get_capacity() const { return capacity; }
+    size_t in_use() const { return static_cast<size_t>(used.load(std::memory_order_relaxed)); }
+
+private:
+    // Снимает TEID с общего стека свободных
+    bool pop_free(uint32_t& teid);
+
+    // Кладёт TEID на общий стек свободных
+    void push_free(uint32_t teid);
+
+    // Заполняет магазин: новыми TEID, затем со стека свободных
+    void refill(PerCoreCache::Magazine* magazine);
+
+    // Забирает TEID из магазинов других ядер, когда общий пул пуст
+    bool steal(uint32_t& teid);
+
+    uint32_t capacity;
+    std::unique_ptr<std::atomic<uint32_t>[]> next;  // Связи стека свободных, индекс — TEID
+    std::atomic<uint64_t> head{ 0 };                // (тег << 32) | вершина стека, 0 — пусто
+    std::atomic<uint64_t> fresh{ 1 };               // Следующий ни разу не выданный TEID
+    std::atomic<int64_t> used{ 0 };
+    PerCoreCache cache;
+};
@@ -1,60 +1,156 @@
-#pragma once
-#include "config.hpp"
-#include "interfaces.hpp"
-#include "cdr_logger.hpp"
-#include <string>
-#include <thread>
-#include <vector>
-#include <queue>
-#include <mutex>
-#include <condition_variable>
-#include <sys/socket.h>
-
-// RAII-класс для управления UDP-сокетом
-class Socket {
-public:
-    Socket();
-    ~Socket();
-    int get_fd() const { return fd; }
-    void set_non_blocking();
-    void bind(const std::string& ip, int port);
-
-private:
-    int fd;
-};
-
-// UDP-сервер для обработки запросов с IMSI
-class UDPServer {
-public:
-    // Конструктор: принимает конфигурацию, менеджер сессий и логгер
-    UDPServer(const Config& config, std::shared_ptr<ISessionManager> session_manager, std::shared_ptr<CDRLogger> cdr_logger);
-    ~UDPServer();
-
-    // Запускает сервер и пул потоков
-    void run();
-
-    // Останавливает сервер и потоки
-    void stop();
-
-private:
-    // Обрабатывает запросы из очереди
-    void worker_thread();
-
-    // Обрабатывает запрос IMSI от клиента
-    void process_request(const std::string& imsi, const struct sockaddr_in& client_addr, socklen_t addr_len);
-
-    // Декодирует BCD-кодировку IMSI
-    std::string decode_bcd(const char* buffer, ssize_t length);
-
-    const Config& config;
-    std::shared_ptr<ISessionManager> session_manager;
-    std::shared_ptr<CDRLogger> cdr_logger;
-    Socket socket;
-    bool running;
-    std::vector<std::thread> workers;
-    std::queue<std::tuple<std::string, struct sockaddr_in, socklen_t>> request_queue;
-    std::mutex queue_mutex;
-    std::condition_variable queue_cond;
-    static constexpr size_t NUM_THREADS = 4;
-    static constexpr size_t BUFFER_SIZE = 256;
+#pragma once
+#include "config.hpp"
+#include "interfaces.hpp"
+#include "cdr_logger.hpp"
+#include "response_cache.hpp"
+#include "admission_control.hpp"
+#include "gtpv2c.hpp"
+#include "worker_pool_sizer.hpp"
+#include "latency_stats.hpp"
+#include "datagram_transport.hpp"
+#include "heavy_hitters.hpp"
+#include "packet_capture.hpp"
+#include "flight_recorder.hpp"
+#include "lock_profiler.hpp"
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+#include <queue>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <sys/socket.h>
+
+// Запрос в очереди на обработку
+struct UDPRequest {
+    std::string imsi;                // Декодированный IMSI
+    bool imsi_missing = false;       // В запросе GTPv2-C нет IE IMSI (при испорченном IE imsi просто пуст)
+    struct sockaddr_in client_addr;  // Адрес пира
+    socklen_t addr_len;
+    std::string request_id;          // Идентификатор запроса для кэша ретрансмиссий
+    uint8_t message_type = gtpv2c::CREATE_SESSION_REQUEST;  // Тип запроса (Create или Delete Session Request)
+    uint32_t sequence = 0;           // Номер последовательности GTPv2-C
+    uint32_t peer_teid = 0;          // TEID пира из F-TEID отправителя Create Session Request
+    uint32_t teid = 0;               // TEID из заголовка GTPv2-C: у Delete Session Request — TEID управления PGW
+    std::chrono::steady_clock::time_point enqueued_at;   // Постановка в очередь, для задержки выборки
+    int64_t kernel_rx_ns = 0;        // Приход в сокет по метке ядра (CLOCK_REALTIME, нс); 0 — метки нет
+    bool captured = false;           // Запрос сохранён в кольце захвата: ответ сохраняется тоже
+};
+
+// UDP-сервер для обработки запросов с IMSI
+class UDPServer {
+public:
+    // Первый байт датаграммы удаления в режиме BCD, за ним — BCD IMSI, как в запросе создания
+    static constexpr uint8_t BCD_DELETE_MARKER = 0xFF;
+
+    // Конструктор: принимает конфигурацию, менеджер сессий и логгер.
+    // transport — источник датаграмм; по умолчанию UDP-сокет на udp_ip:udp_port
+    UDPServer(const Config& config, std::shared_ptr<ISessionManager> session_manager, std::shared_ptr<CDRLogger> cdr_logger,
+        std::shared_ptr<IDatagramTransport> transport = nullptr);
+    ~UDPServer();
+
+    // Запускает сервер и пул потоков; on_started вызывается, когда сокет привязан
+    void run(std::function<void()> on_started = nullptr);
+
+    // Останавливает сервер и потоки
+    void stop();
+
+    // Кэш ответов на повторные передачи (для диагностики)
+    const ResponseCache& get_response_cache() const { return response_cache; }
+
+    // Контроль допуска на входе (пределы можно менять во время работы)
+    std::shared_ptr<AdmissionControl> get_admission_control() const { return admission_control; }
+
+    // Регулятор размера пула рабочих потоков (размер и загрузка для /workers)
+    std::shared_ptr<WorkerPoolSizer> get_worker_pool_sizer() const { return pool_sizer; }
+
+    // Задержки по этапам от прихода в сокет и отброшенные ядром датаграммы (для /latency)
+    std::shared_ptr<LatencyStats> get_latency_stats() const { return latency_stats; }
+
+    // Самые активные пиры и IMSI на входе (для /heavy_hitters)
+    std::shared_ptr<HeavyHitters> get_heavy_hitters() const { return heavy_hitters; }
+
+    // Кольцо захвата датаграмм
+    std::shared_ptr<PacketCapture> get_packet_capture() const { return packet_capture; }
+
+    // Подключает бортовой самописец: приём, постановка в очередь, операции с сессиями и отправка.
+    // Вызывается до run()
+    void set_flight_recorder(std::shared_ptr<FlightRecorder> flight_recorder);
+
+    // Сколько раз поток приёма в режиме опроса переходил к блокирующему ожиданию
+    uint64_t get_busy_poll_fallbacks() const { return busy_poll_fallbacks.load(); }
+
+    // Тик регулятора: меняет число активных рабочих потоков по загрузке с прошлого вызова.
+    // Вызывается периодически (в pgw_server — из цикла событий)
+    void adjust_workers();
+
+private:
+    // Обрабатывает запросы из очереди; поток с номером index >= active_workers припаркован
+    void worker_thread(size_t index);
+
+    // Читает датаграмму из транспорта и учитывает её ожидание; kernel_rx_ns — метка прихода (0, если её нет)
+    ssize_t receive_datagram(char* buffer, size_t capacity, struct sockaddr_in& client_addr, socklen_t& addr_len,
+        int64_t& kernel_rx_ns);
+
+    // Включает опрос в транспорте и привязывает поток приёма к busy_poll_cpu
+    void enable_busy_poll();
+
+    // Запускает рабочие потоки до count; вызывается под queue_mutex
+    void spawn_workers(size_t count);
+
+    // Обрабатывает запрос IMSI от клиента
+    void process_request(const UDPRequest& request);
+
+    // Итог обработки запроса, из которого кодируется ответ
+    enum class Outcome { Created, Rejected, Deleted, NotFound, InvalidImsi, MissingImsi, Overload };
+
+    // Забывает кэшированный ответ на противоположный запрос того же пира (создание/удаление)
+    void forget_opposite(const UDPRequest& request);
+
+    // Проверяет IMSI запроса; при ошибке отправляет ответ и возвращает false
+    bool validate_imsi(const UDPRequest& request);
+
+    // Декодирует датаграмму в запрос; false — датаграмма отбрасывается
+    bool decode_request(const char* buffer, ssize_t length, UDPRequest& request);
+
+    // Кодирует ответ в заранее выделенный буфер; возвращает длину.
+    // resources — TEID и адреса созданной сессии для F-TEID и PAA ответа GTPv2-C
+    size_t encode_response(const UDPRequest& request, Outcome outcome, const SessionResources* resources,
+        uint8_t* out, size_t capacity);
+
+    // Отправляет ответ пиру и сохраняет его в кэше ретрансмиссий
+    void send_response(const UDPRequest& request, Outcome outcome, const SessionResources* resources = nullptr);
+
+    // Декодирует BCD-кодировку IMSI
+    std::string decode_bcd(const char* buffer, ssize_t length);
+
+    const Config& config;
+    std::shared_ptr<ISessionManager> session_manager;
+    std::shared_ptr<CDRLogger> cdr_logger;
+    std::shared_ptr<IDatagramTransport> transport;
+    int wake_fd;    // eventfd: stop() будит поток приёма, ждущий в poll
+    std::atomic<bool> running;
+    bool gtp_mode;  // true — GTPv2-C, false — устаревший формат BCD/строки
+    uint32_t gtp_address;  // IPv4-адрес PGW для F-TEID, сетевой порядок байт
+    std::vector<std::thread> workers;
+    ResponseCache response_cache;
+    std::shared_ptr<AdmissionControl> admission_control;
+    std::shared_ptr<LatencyStats> latency_stats;
+    std::shared_ptr<HeavyHitters> heavy_hitters;
+    std::shared_ptr<PacketCapture> packet_capture;
+    std::shared_ptr<FlightRecorder> flight_recorder;    // nullptr — самописец выключен
+    bool busy_poll;                                 // Поток приёма крутится на неблокирующем recvfrom без сна
+    std::chrono::milliseconds busy_poll_idle;       // Простой, после которого опрос сменяется poll()
+    std::atomic<uint64_t> busy_poll_fallbacks{ 0 };
+    std::shared_ptr<WorkerPoolSizer> pool_sizer;
+    std::queue<UDPRequest> request_queue;
+    ProfiledMutex queue_mutex{ "udp_server_queue" };
+    ProfiledConditionVariable queue_cond;
+    ProfiledConditionVariable park_cond;  // Ожидание припаркованных потоков, отдельно от очереди: их не будят запросы
+    size_t active_workers = 0;          // Потоки с меньшими номерами разбирают очередь; под queue_mutex
+    static constexpr size_t BUFFER_SIZE = 2048;
+    static constexpr uint64_t BUSY_POLL_YIELD_EVERY = 64;   // Степень двойки
 };
\ No newline at end of file
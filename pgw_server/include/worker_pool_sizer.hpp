@@ -0,0 +1,69 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string>
+
+// Регулятор размера пула рабочих потоков UDP-сервера.
+// Рабочие потоки сообщают время ожидания запроса в очереди и время обработки;
+// периодический вызов adjust() по этим данным и глубине очереди меняет число активных потоков
+// в пределах [min, max]. Рост — после GROW_AFTER_TICKS подряд интервалов с перегрузкой,
+// сокращение — после shrink_idle простоя с загрузкой ниже SHRINK_UTILIZATION: разные пороги
+// и выдержка не дают пулу колебаться на границе.
+class WorkerPoolSizer {
+public:
+    // max_workers = 0 — по числу ядер (не меньше min_workers)
+    WorkerPoolSizer(size_t min_workers, size_t max_workers, std::chrono::microseconds grow_wait,
+        std::chrono::milliseconds shrink_idle);
+
+    // Запрещаем копирование
+    WorkerPoolSizer(const WorkerPoolSizer&) = delete;
+    WorkerPoolSizer& operator=(const WorkerPoolSizer&) = delete;
+
+    // Запрос взят из очереди после ожидания wait (из рабочих потоков)
+    void record_dequeue(std::chrono::nanoseconds wait);
+
+    // Запрос обработан за busy (из рабочих потоков)
+    void record_busy(std::chrono::nanoseconds busy);
+
+    // Тик регулятора: пересчитывает загрузку за интервал с прошлого тика и возвращает новое число активных потоков
+    size_t adjust(size_t queue_depth, std::chrono::steady_clock::time_point now);
+
+    size_t get_min() const { return min_workers; }
+    size_t get_max() const { return max_workers; }
+    size_t get_target() const { return target.load(); }
+
+    // Размер пула, загрузка и ожидание за последний интервал, счётчики изменений
+    std::string report() const;
+
+    static constexpr size_t GROW_DEPTH_PER_WORKER = 8;   // Глубина очереди на поток, выше которой пул растёт
+    static constexpr int GROW_AFTER_TICKS = 2;
+    static constexpr double SHRINK_UTILIZATION = 0.25;
+
+private:
+    const size_t min_workers;
+    const size_t max_workers;
+    const std::chrono::microseconds grow_wait;
+    const std::chrono::milliseconds shrink_idle;
+    std::atomic<size_t> target;
+
+    // Накопители интервала, сбрасываются в adjust()
+    std::atomic<uint64_t> wait_ns{ 0 };
+    std::atomic<uint64_t> dequeued{ 0 };
+    std::atomic<uint64_t> busy_ns{ 0 };
+
+    // Состояние регулятора; adjust() и report() под mutex
+    mutable std::mutex mutex;
+    std::chrono::steady_clock::time_point last_tick;
+    std::chrono::steady_clock::time_point idle_since;
+    bool idle = false;
+    int pressure_ticks = 0;
+    double utilization = 0;                     // Доля времени активных потоков, занятая обработкой
+    double avg_wait_us = 0;
+    size_t queue_depth = 0;
+    uint64_t grows = 0;
+    uint64_t shrinks = 0;
+    uint64_t processed = 0;
+};
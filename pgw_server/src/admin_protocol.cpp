@@ -0,0 +1,242 @@
+#include "admin_protocol.hpp"
+#include <algorithm>
+#include <stdexcept>
+
+namespace admin {
+
+namespace {
+
+void append_u16(std::string& out, uint16_t value) {
+    out.push_back(static_cast<char>(value >> 8));
+    out.push_back(static_cast<char>(value));
+}
+
+void append_u32(std::string& out, uint32_t value) {
+    for (int shift = 24; shift >= 0; shift -= 8) {
+        out.push_back(static_cast<char>(value >> shift));
+    }
+}
+
+void append_u64(std::string& out, uint64_t value) {
+    for (int shift = 56; shift >= 0; shift -= 8) {
+        out.push_back(static_cast<char>(value >> shift));
+    }
+}
+
+// Дописывает строку с длиной в первом байте; длиннее 255 байт обрезается
+void append_short_string(std::string& out, const std::string& value) {
+    size_t length = std::min<size_t>(value.size(), 255);
+    out.push_back(static_cast<char>(length));
+    out.append(value, 0, length);
+}
+
+// Последовательное чтение данных с проверкой границ: после ошибки все чтения возвращают false
+class Reader {
+public:
+    explicit Reader(const std::string& data) : data(data) {}
+
+    bool u8(uint8_t& value) {
+        if (!need(1)) return false;
+        value = static_cast<uint8_t>(data[offset++]);
+        return true;
+    }
+
+    bool u16(uint16_t& value) {
+        if (!need(2)) return false;
+        value = static_cast<uint16_t>((byte(0) << 8) | byte(1));
+        offset += 2;
+        return true;
+    }
+
+    bool u32(uint32_t& value) {
+        if (!need(4)) return false;
+        value = (static_cast<uint32_t>(byte(0)) << 24) | (static_cast<uint32_t>(byte(1)) << 16) |
+            (static_cast<uint32_t>(byte(2)) << 8) | byte(3);
+        offset += 4;
+        return true;
+    }
+
+    bool u64(uint64_t& value) {
+        uint32_t high = 0;
+        uint32_t low = 0;
+        if (!u32(high) || !u32(low)) return false;
+        value = (static_cast<uint64_t>(high) << 32) | low;
+        return true;
+    }
+
+    bool short_string(std::string& value) {
+        uint8_t length = 0;
+        if (!u8(length) || !need(length)) return false;
+        value.assign(data, offset, length);
+        offset += length;
+        return true;
+    }
+
+    // Данные прочитаны до конца и без ошибок
+    bool done() const { return ok && offset == data.size(); }
+
+private:
+    bool need(size_t count) {
+        ok = ok && data.size() - offset >= count;
+        return ok;
+    }
+
+    uint32_t byte(size_t index) const { return static_cast<uint8_t>(data[offset + index]); }
+
+    const std::string& data;
+    size_t offset = 0;
+    bool ok = true;
+};
+
+uint32_t read_u32(const char* p) {
+    const uint8_t* bytes = reinterpret_cast<const uint8_t*>(p);
+    return (static_cast<uint32_t>(bytes[0]) << 24) | (static_cast<uint32_t>(bytes[1]) << 16) |
+        (static_cast<uint32_t>(bytes[2]) << 8) | bytes[3];
+}
+
+} // namespace
+
+// Кадр: длина, тип, номер запроса, данные
+void append_frame(std::string& out, uint8_t type, uint32_t id, const std::string& payload) {
+    append_u32(out, static_cast<uint32_t>(HEADER_SIZE - LENGTH_SIZE + payload.size()));
+    out.push_back(static_cast<char>(type));
+    append_u32(out, id);
+    out += payload;
+}
+
+// Выделяет кадр из начала буфера
+size_t parse_frame(const char* data, size_t size, Frame& frame) {
+    if (size < LENGTH_SIZE) {
+        return 0;
+    }
+    uint32_t length = read_u32(data);
+    if (length < HEADER_SIZE - LENGTH_SIZE || length > MAX_FRAME_SIZE) {
+        throw std::invalid_argument("Invalid admin frame length: " + std::to_string(length));
+    }
+    if (size - LENGTH_SIZE < length) {
+        return 0;
+    }
+    frame.type = static_cast<uint8_t>(data[LENGTH_SIZE]);
+    frame.id = read_u32(data + LENGTH_SIZE + 1);
+    frame.payload.assign(data + HEADER_SIZE, length - (HEADER_SIZE - LENGTH_SIZE));
+    return LENGTH_SIZE + length;
+}
+
+std::string encode_check_request(const std::vector<std::string>& imsis, size_t begin, size_t end) {
+    std::string payload;
+    payload.reserve(2 + (end - begin) * 16);
+    append_u16(payload, static_cast<uint16_t>(end - begin));
+    for (size_t i = begin; i < end; ++i) {
+        append_short_string(payload, imsis[i]);
+    }
+    return payload;
+}
+
+bool decode_check_request(const std::string& payload, std::vector<std::string>& imsis) {
+    Reader reader(payload);
+    uint16_t count = 0;
+    if (!reader.u16(count) || count > MAX_CHECK_BATCH) {
+        return false;
+    }
+    imsis.resize(count);
+    for (auto& imsi : imsis) {
+        if (!reader.short_string(imsi)) {
+            return false;
+        }
+    }
+    return reader.done();
+}
+
+std::string encode_check_response(const std::vector<uint8_t>& active) {
+    std::string payload;
+    payload.reserve(2 + active.size());
+    append_u16(payload, static_cast<uint16_t>(active.size()));
+    payload.append(active.begin(), active.end());
+    return payload;
+}
+
+bool decode_check_response(const std::string& payload, std::vector<uint8_t>& active) {
+    Reader reader(payload);
+    uint16_t count = 0;
+    if (!reader.u16(count)) {
+        return false;
+    }
+    active.resize(count);
+    for (auto& state : active) {
+        reader.u8(state);
+    }
+    return reader.done();
+}
+
+std::string encode_export_request(uint32_t cursor, uint32_t limit) {
+    std::string payload;
+    append_u32(payload, cursor);
+    append_u32(payload, limit);
+    return payload;
+}
+
+bool decode_export_request(const std::string& payload, uint32_t& cursor, uint32_t& limit) {
+    Reader reader(payload);
+    return reader.u32(cursor) && reader.u32(limit) && reader.done();
+}
+
+std::string encode_export_response(const ExportPage& page) {
+    std::string payload;
+    payload.reserve(8 + page.sessions.size() * 32);
+    append_u32(payload, page.next_cursor);
+    append_u32(payload, static_cast<uint32_t>(page.sessions.size()));
+    for (const auto& session : page.sessions) {
+        append_short_string(payload, session.imsi);
+        append_u64(payload, static_cast<uint64_t>(session.creation_time_ms));
+        append_u64(payload, static_cast<uint64_t>(session.expires_at_ms));
+    }
+    return payload;
+}
+
+// Страница состоит из целых шардов и бывает больше запрошенного предела: число сессий
+// ограничено только размером кадра. Сессия занимает не меньше 17 байт
+bool decode_export_response(const std::string& payload, ExportPage& page) {
+    Reader reader(payload);
+    uint32_t count = 0;
+    if (!reader.u32(page.next_cursor) || !reader.u32(count) || count > payload.size() / 17) {
+        return false;
+    }
+    page.sessions.resize(count);
+    for (auto& session : page.sessions) {
+        uint64_t created = 0;
+        uint64_t expires = 0;
+        if (!reader.short_string(session.imsi) || !reader.u64(created) || !reader.u64(expires)) {
+            return false;
+        }
+        session.creation_time_ms = static_cast<int64_t>(created);
+        session.expires_at_ms = static_cast<int64_t>(expires);
+    }
+    return reader.done();
+}
+
+std::string encode_counters_response(const Counters& counters) {
+    std::string payload;
+    append_u16(payload, static_cast<uint16_t>(counters.size()));
+    for (const auto& counter : counters) {
+        append_short_string(payload, counter.first);
+        append_u64(payload, counter.second);
+    }
+    return payload;
+}
+
+bool decode_counters_response(const std::string& payload, Counters& counters) {
+    Reader reader(payload);
+    uint16_t count = 0;
+    if (!reader.u16(count)) {
+        return false;
+    }
+    counters.resize(count);
+    for (auto& counter : counters) {
+        if (!reader.short_string(counter.first) || !reader.u64(counter.second)) {
+            return false;
+        }
+    }
+    return reader.done();
+}
+
+} // namespace admin
@@ -0,0 +1,342 @@
+#include "admin_socket.hpp"
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+
+namespace {
+
+constexpr int MAX_EVENTS = 64;
+constexpr size_t READ_CHUNK = 64 * 1024;
+constexpr size_t READS_PER_WAKEUP = 4;      // Остальное дочитывается на следующем проходе: epoll по уровню
+
+} // namespace
+
+// Конструктор: сокет создаётся в run()
+AdminSocket::AdminSocket(const Config& config, std::shared_ptr<ISessionManager> sessions, std::shared_ptr<ILogger> logger)
+    : config(config), sessions(sessions), logger(logger), path(config.get_admin_socket_path()) {
+    if (!config.get_cluster_nodes().empty()) {
+        ring = std::make_unique<HashRing>(config.get_cluster_nodes());
+        node_id = static_cast<size_t>(config.get_cluster_node_id());
+    }
+}
+
+AdminSocket::~AdminSocket() {
+    stop();
+}
+
+void AdminSocket::set_session_export(std::shared_ptr<SessionManager> session_table) {
+    this->session_table = session_table;
+}
+
+void AdminSocket::set_admission_control(std::shared_ptr<AdmissionControl> admission_control) {
+    this->admission_control = admission_control;
+}
+
+// Создаёт сокет и запускает поток обслуживания
+void AdminSocket::run() {
+    struct sockaddr_un addr = {};
+    addr.sun_family = AF_UNIX;
+    if (path.empty() || path.size() >= sizeof(addr.sun_path)) {
+        throw std::runtime_error("Invalid admin socket path: " + path);
+    }
+    std::memcpy(addr.sun_path, path.c_str(), path.size());
+
+    listen_fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (listen_fd < 0) {
+        throw std::runtime_error("Failed to create admin socket: " + std::string(strerror(errno)));
+    }
+    // Файл от прежнего запуска мешает bind; живой сервер на том же пути здесь не отличить
+    unlink(path.c_str());
+    if (::bind(listen_fd, (struct sockaddr*)&addr, sizeof(addr)) < 0 || chmod(path.c_str(), 0660) < 0 ||
+        listen(listen_fd, 64) < 0) {
+        std::string error = strerror(errno);
+        close(listen_fd);
+        listen_fd = -1;
+        throw std::runtime_error("Failed to listen on admin socket " + path + ": " + error);
+    }
+
+    epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    wake_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    struct epoll_event event = {};
+    event.events = EPOLLIN;
+    event.data.fd = listen_fd;
+    epoll_ctl(epoll_fd, EPOLL_CTL_ADD, listen_fd, &event);
+    event.data.fd = wake_fd;
+    epoll_ctl(epoll_fd, EPOLL_CTL_ADD, wake_fd, &event);
+
+    running = true;
+    thread = std::thread(&AdminSocket::loop, this);
+    logger->info("Admin socket listening on {}", path);
+}
+
+// Останавливает поток и удаляет файл сокета
+void AdminSocket::stop() {
+    if (!running.exchange(false)) {
+        return;
+    }
+    uint64_t one = 1;
+    if (write(wake_fd, &one, sizeof(one)) < 0) {
+        logger->warn("Failed to wake admin socket thread");
+    }
+    if (thread.joinable()) {
+        thread.join();
+    }
+    while (!connections.empty()) {
+        close_connection(connections.begin()->first);
+    }
+    close(listen_fd);
+    close(epoll_fd);
+    close(wake_fd);
+    listen_fd = epoll_fd = wake_fd = -1;
+    unlink(path.c_str());
+    logger->info("Admin socket stopped");
+}
+
+// Цикл потока сокета
+void AdminSocket::loop() {
+    struct epoll_event events[MAX_EVENTS];
+    while (running) {
+        int count = epoll_wait(epoll_fd, events, MAX_EVENTS, -1);
+        if (count < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            logger->error("Admin socket epoll_wait failed: {}", strerror(errno));
+            return;
+        }
+        for (int i = 0; i < count && running; ++i) {
+            int fd = events[i].data.fd;
+            if (fd == wake_fd) {
+                continue;
+            }
+            if (fd == listen_fd) {
+                accept_connections();
+                continue;
+            }
+            auto it = connections.find(fd);
+            if (it == connections.end()) {
+                continue;
+            }
+            // Закрытие клиентом приходит как EPOLLIN с нулевым чтением; EPOLLERR — только ошибка сокета
+            bool alive = !(events[i].events & EPOLLERR) && serve(*it->second, events[i].events & (EPOLLIN | EPOLLHUP));
+            if (!alive) {
+                close_connection(fd);
+            }
+        }
+    }
+}
+
+// Принимает соединения до EAGAIN
+void AdminSocket::accept_connections() {
+    while (true) {
+        int fd = accept4(listen_fd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) {
+            if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+                logger->warn("Admin socket accept failed: {}", strerror(errno));
+            }
+            return;
+        }
+        if (connections.size() >= MAX_CONNECTIONS) {
+            close(fd);
+            logger->warn("Admin socket connection limit reached");
+            continue;
+        }
+        auto connection = std::make_unique<Connection>();
+        connection->fd = fd;
+        connection->events = EPOLLIN;
+        struct epoll_event event = {};
+        event.events = EPOLLIN;
+        event.data.fd = fd;
+        epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &event);
+        connections.emplace(fd, std::move(connection));
+        connections_accepted.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+// Читает запросы, отвечает и обновляет интерес в epoll
+bool AdminSocket::serve(Connection& connection, bool readable) {
+    if (readable) {
+        char buffer[READ_CHUNK];
+        for (size_t reads = 0; reads < READS_PER_WAKEUP; ++reads) {
+            ssize_t n = recv(connection.fd, buffer, sizeof(buffer), 0);
+            if (n > 0) {
+                connection.input.append(buffer, static_cast<size_t>(n));
+                if (static_cast<size_t>(n) < sizeof(buffer)) {
+                    break;
+                }
+                continue;
+            }
+            if (n == 0) {
+                return false;
+            }
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                break;
+            }
+            if (errno != EINTR) {
+                return false;
+            }
+        }
+    }
+    if (!process_input(connection) || !flush_output(connection)) {
+        return false;
+    }
+    // Ответы накопились, пока клиент не читает: сначала отправка, потом следующие запросы
+    size_t pending = connection.output.size() - connection.output_offset;
+    if (pending == 0 && !connection.input.empty() && !process_input(connection)) {
+        return false;
+    }
+    pending = connection.output.size() - connection.output_offset;
+    uint32_t events = (pending < MAX_PENDING_OUTPUT ? static_cast<uint32_t>(EPOLLIN) : 0u) |
+        (pending > 0 ? static_cast<uint32_t>(EPOLLOUT) : 0u);
+    if (events != connection.events) {
+        struct epoll_event event = {};
+        event.events = events;
+        event.data.fd = connection.fd;
+        epoll_ctl(epoll_fd, EPOLL_CTL_MOD, connection.fd, &event);
+        connection.events = events;
+    }
+    return true;
+}
+
+// Разбирает целые кадры и дописывает ответы
+bool AdminSocket::process_input(Connection& connection) {
+    size_t offset = 0;
+    admin::Frame request;
+    while (connection.output.size() - connection.output_offset < MAX_PENDING_OUTPUT) {
+        size_t consumed = 0;
+        try {
+            consumed = admin::parse_frame(connection.input.data() + offset, connection.input.size() - offset, request);
+        }
+        catch (const std::invalid_argument& e) {
+            errors.fetch_add(1, std::memory_order_relaxed);
+            logger->warn("Admin socket closing connection: {}", e.what());
+            return false;
+        }
+        if (consumed == 0) {
+            break;
+        }
+        offset += consumed;
+        handle(request, connection.output);
+    }
+    connection.input.erase(0, offset);
+    return true;
+}
+
+// Отправляет ответы без блокировки
+bool AdminSocket::flush_output(Connection& connection) {
+    while (connection.output_offset < connection.output.size()) {
+        ssize_t n = send(connection.fd, connection.output.data() + connection.output_offset,
+            connection.output.size() - connection.output_offset, MSG_NOSIGNAL);
+        if (n > 0) {
+            connection.output_offset += static_cast<size_t>(n);
+            continue;
+        }
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            break;
+        }
+        return false;
+    }
+    if (connection.output_offset == connection.output.size()) {
+        connection.output.clear();
+        connection.output_offset = 0;
+    }
+    return true;
+}
+
+// Выполняет запрос; ошибка запроса — ответ MSG_ERROR с кодом, соединение остаётся открытым
+void AdminSocket::handle(const admin::Frame& request, std::string& output) {
+    requests.fetch_add(1, std::memory_order_relaxed);
+    auto fail = [&](admin::ErrorCode code) {
+        errors.fetch_add(1, std::memory_order_relaxed);
+        admin::append_frame(output, admin::MSG_ERROR, request.id, std::string(1, static_cast<char>(code)));
+    };
+
+    switch (request.type) {
+    case admin::MSG_CHECK: {
+        std::vector<std::string> imsis;
+        if (!admin::decode_check_request(request.payload, imsis)) {
+            fail(admin::ERROR_MALFORMED);
+            return;
+        }
+        // Чужой IMSI не ищется в локальной таблице: «нет сессии» было бы ложным ответом
+        std::vector<uint8_t> status(imsis.size());
+        size_t foreign = 0;
+        for (size_t i = 0; i < imsis.size(); ++i) {
+            if (ring && ring->owner(imsis[i]) != node_id) {
+                status[i] = admin::CHECK_NOT_OWNED;
+                ++foreign;
+            }
+            else {
+                status[i] = sessions->has_session(imsis[i]) ? admin::CHECK_ACTIVE : admin::CHECK_INACTIVE;
+            }
+        }
+        lookups.fetch_add(imsis.size(), std::memory_order_relaxed);
+        if (foreign != 0) {
+            not_owned.fetch_add(foreign, std::memory_order_relaxed);
+        }
+        admin::append_frame(output, admin::MSG_CHECK, request.id, admin::encode_check_response(status));
+        return;
+    }
+    case admin::MSG_EXPORT: {
+        if (!session_table) {
+            fail(admin::ERROR_UNAVAILABLE);
+            return;
+        }
+        uint32_t cursor = 0;
+        uint32_t limit = 0;
+        if (!admin::decode_export_request(request.payload, cursor, limit) || cursor > SessionManager::SHARDS ||
+            limit < 1 || limit > admin::MAX_EXPORT_LIMIT) {
+            fail(admin::ERROR_MALFORMED);
+            return;
+        }
+        auto exported = session_table->export_sessions(cursor, limit);
+        admin::ExportPage page;
+        page.next_cursor = static_cast<uint32_t>(exported.next_cursor);
+        page.sessions.reserve(exported.sessions.size());
+        for (auto& session : exported.sessions) {
+            page.sessions.push_back({ std::move(session.imsi), session.creation_time_ms, session.expires_at_ms });
+        }
+        admin::append_frame(output, admin::MSG_EXPORT, request.id, admin::encode_export_response(page));
+        return;
+    }
+    case admin::MSG_COUNTERS:
+        admin::append_frame(output, admin::MSG_COUNTERS, request.id, admin::encode_counters_response(counters()));
+        return;
+    default:
+        fail(admin::ERROR_UNKNOWN_TYPE);
+    }
+}
+
+// Счётчики сокета и подключённых компонентов
+admin::Counters AdminSocket::counters() const {
+    admin::Counters result;
+    if (session_table) {
+        result.emplace_back("sessions", session_table->get_session_count());
+    }
+    if (admission_control) {
+        result.emplace_back("admitted", admission_control->get_admitted());
+        result.emplace_back("rate_limited", admission_control->get_rate_limited());
+        result.emplace_back("overloaded", admission_control->get_overloaded());
+    }
+    result.emplace_back("admin_connections", get_connections());
+    result.emplace_back("admin_requests", get_requests());
+    result.emplace_back("admin_lookups", get_lookups());
+    result.emplace_back("admin_errors", get_errors());
+    result.emplace_back("admin_not_owned", get_not_owned());
+    return result;
+}
+
+void AdminSocket::close_connection(int fd) {
+    epoll_ctl(epoll_fd, EPOLL_CTL_DEL, fd, nullptr);
+    close(fd);
+    connections.erase(fd);
+}
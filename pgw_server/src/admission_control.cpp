@@ -0,0 +1,92 @@
+#include "admission_control.hpp"
+#include <algorithm>
+#include <sstream>
+
+// Конструктор: размер таблицы округляется вверх до степени двойки
+AdmissionControl::AdmissionControl(double rate_per_sec, double burst, size_t max_queue_depth, size_t table_size)
+    : rate_per_sec(rate_per_sec), burst(burst), max_queue_depth(max_queue_depth) {
+    size_t capacity = MAX_PROBES;
+    while (capacity < table_size) {
+        capacity <<= 1;
+    }
+    buckets.reset(new Bucket[capacity]());
+    mask = capacity - 1;
+}
+
+// Ищет бакет адреса; новый адрес занимает свободный или самый давний слот
+AdmissionControl::Bucket& AdmissionControl::find_bucket(uint32_t addr, double capacity, int64_t now_ns) {
+    size_t start = (static_cast<size_t>(addr) * 0x9E3779B97F4A7C15ULL) >> 16;
+    Bucket* oldest = nullptr;
+    for (size_t probe = 0; probe < MAX_PROBES; ++probe) {
+        Bucket& bucket = buckets[(start + probe) & mask];
+        if (bucket.used && bucket.addr == addr) {
+            return bucket;
+        }
+        if (!bucket.used) {
+            oldest = &bucket;
+            break;
+        }
+        if (!oldest || bucket.last_ns < oldest->last_ns) {
+            oldest = &bucket;
+        }
+    }
+    if (oldest->used) {
+        ++evicted_peers;
+    }
+    *oldest = Bucket{ addr, true, capacity, now_ns };
+    return *oldest;
+}
+
+// Пополняет бакет пира по прошедшему времени и списывает один токен
+bool AdmissionControl::admit_peer(const struct sockaddr_in& peer, std::chrono::steady_clock::time_point now) {
+    double rate = rate_per_sec.load(std::memory_order_relaxed);
+    if (rate <= 0) {
+        ++admitted;
+        return true;
+    }
+    // burst = 0 допускается конфигурацией: без нижней границы пир не получил бы ни одного токена
+    double capacity = std::max(burst.load(std::memory_order_relaxed), 1.0);
+    int64_t now_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(now.time_since_epoch()).count();
+
+    Bucket& bucket = find_bucket(peer.sin_addr.s_addr, capacity, now_ns);
+    double elapsed = static_cast<double>(now_ns - bucket.last_ns) / 1e9;
+    bucket.tokens = std::min(capacity, bucket.tokens + elapsed * rate);
+    bucket.last_ns = now_ns;
+    if (bucket.tokens < 1.0) {
+        ++rate_limited;
+        return false;
+    }
+    bucket.tokens -= 1.0;
+    ++admitted;
+    return true;
+}
+
+// Отказывает в постановке в очередь при достижении предела глубины
+bool AdmissionControl::admit_queue(size_t queue_depth) {
+    size_t limit = max_queue_depth.load(std::memory_order_relaxed);
+    if (limit > 0 && queue_depth >= limit) {
+        ++overloaded;
+        return false;
+    }
+    return true;
+}
+
+// Устанавливает новые пределы; бакеты подстраиваются при следующем пополнении
+void AdmissionControl::set_limits(double rate_per_sec, double burst, size_t max_queue_depth) {
+    this->rate_per_sec.store(rate_per_sec);
+    this->burst.store(burst);
+    this->max_queue_depth.store(max_queue_depth);
+}
+
+// Формирует отчёт в формате key=value по строке на параметр
+std::string AdmissionControl::report() const {
+    std::stringstream ss;
+    ss << "rate_per_sec=" << get_rate_per_sec() << "\n"
+       << "burst=" << get_burst() << "\n"
+       << "max_queue_depth=" << get_max_queue_depth() << "\n"
+       << "admitted=" << get_admitted() << "\n"
+       << "rate_limited=" << get_rate_limited() << "\n"
+       << "overloaded=" << get_overloaded() << "\n"
+       << "evicted_peers=" << get_evicted_peers() << "\n";
+    return ss.str();
+}
\ No newline at end of file
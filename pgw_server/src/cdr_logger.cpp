@@ -1,54 +1,148 @@
-#include "cdr_logger.hpp"
-#include <chrono>
-#include <iomanip>
-#include <filesystem>
-#include <sstream>
-
-// :  CDRLogger    
-CDRLogger::CDRLogger(const Config& config, std::shared_ptr<ILogger> logger)
-    : config(config), logger(logger) {
-    //     CDR-
-    auto parent_path = std::filesystem::path(config.get_cdr_file()).parent_path();
-    if (!parent_path.empty() && !std::filesystem::exists(parent_path)) {
-        std::filesystem::create_directories(parent_path);
-    }
-
-    file.open(config.get_cdr_file(), std::ios::app);
-    if (!file.is_open()) {
-        logger->error("Failed to open CDR log file", config.get_cdr_file());
-        throw std::runtime_error("Failed to open CDR log file: " + config.get_cdr_file());
-    }
-    logger->info("CDRLogger initialized with file", config.get_cdr_file());
-}
-
-// :  
-CDRLogger::~CDRLogger() {
-    if (file.is_open()) {
-        file.flush();
-        file.close();
-    }
-}
-
-//    CDR-
-void CDRLogger::log(const std::string& imsi, const std::string& action) {
-    std::lock_guard<std::mutex> lock(mutex);
-    if (!file.is_open()) {
-        logger->error("CDR file is not open", config.get_cdr_file());
-        file.open(config.get_cdr_file(), std::ios::app);
-        if (!file.is_open()) {
-            logger->error("Failed to reopen CDR file", config.get_cdr_file());
-            return;
-        }
-    }
-
-    auto now = std::chrono::system_clock::now();
-    auto time_t = std::chrono::system_clock::to_time_t(now);
-    std::stringstream ss;
-    ss << std::put_time(std::localtime(&time_t), "%Y-%m-%d %H:%M:%S");
-    file << ss.str() << "," << imsi << "," << action << "\n";
-    file.flush(); //  
-    std::stringstream log_ss;
-    log_ss << "CDR logged: IMSI: " << imsi << ", action: " << action;
-    logger->info(log_ss.str());
-}
-
+#include "cdr_logger.hpp"
+#include <chrono>
+#include <iomanip>
+#include <filesystem>
+#include <sstream>
+
+namespace {
+
+// Метка времени CDR
+std::string format_time(std::chrono::system_clock::time_point time) {
+    auto time_t = std::chrono::system_clock::to_time_t(time);
+    std::stringstream ss;
+    ss << std::put_time(std::localtime(&time_t), "%Y-%m-%d %H:%M:%S");
+    return ss.str();
+}
+
+} // namespace
+
+// Конструктор: инициализирует CDRLogger с конфигурацией и логгером
+CDRLogger::CDRLogger(const Config& config, std::shared_ptr<ILogger> logger, std::shared_ptr<IClock> clock)
+    : config(config), logger(logger), clock(clock ? clock : std::make_shared<SystemClock>()),
+    coalesce_window(config.get_cdr_reject_coalesce_ms()),
+    coalesce_max_windows(static_cast<size_t>(config.get_cdr_reject_coalesce_max_imsis())) {
+    // Проверяем существование директории для CDR-файла
+    auto parent_path = std::filesystem::path(config.get_cdr_file()).parent_path();
+    if (!parent_path.empty() && !std::filesystem::exists(parent_path)) {
+        std::filesystem::create_directories(parent_path);
+    }
+
+    file.open(config.get_cdr_file(), std::ios::app);
+    if (!file.is_open()) {
+        logger->error("Failed to open CDR log file", config.get_cdr_file());
+        throw std::runtime_error("Failed to open CDR log file: " + config.get_cdr_file());
+    }
+    logger->info("CDRLogger initialized with file", config.get_cdr_file());
+}
+
+// Деструктор: закрывает открытые окна сведения и файл
+CDRLogger::~CDRLogger() {
+    if (file.is_open()) {
+        while (!windows.empty()) {
+            close_window(windows.begin());
+        }
+        file.flush();
+        file.close();
+    }
+}
+
+// Подключает поток событий сессий
+void CDRLogger::set_event_stream(std::shared_ptr<SessionEventStream> event_stream) {
+    std::lock_guard<ProfiledMutex> lock(mutex);
+    this->event_stream = event_stream;
+}
+
+// Подключает бортовой самописец
+void CDRLogger::set_flight_recorder(std::shared_ptr<FlightRecorder> flight_recorder) {
+    std::lock_guard<ProfiledMutex> lock(mutex);
+    this->flight_recorder = flight_recorder;
+}
+
+// Записывает событие в CDR-файл; интервал самописца включает ожидание мьютекса
+void CDRLogger::log(const std::string& imsi, const std::string& action) {
+    FlightSpan span(flight_recorder.get(), FlightEvent::CdrWrite);
+    std::lock_guard<ProfiledMutex> lock(mutex);
+    if (!file.is_open()) {
+        logger->error("CDR file is not open", config.get_cdr_file());
+        file.open(config.get_cdr_file(), std::ios::app);
+        if (!file.is_open()) {
+            logger->error("Failed to reopen CDR file", config.get_cdr_file());
+            return;
+        }
+    }
+
+    auto now = clock->wall_now();
+    if (coalesce_window.count() > 0) {
+        close_expired_windows(clock->monotonic_now());
+        if (action.compare(0, 8, "rejected") == 0) {
+            std::string key = imsi + "," + action;
+            auto it = coalesced.find(key);
+            if (it != coalesced.end()) {
+                // Повтор в открытом окне: только счётчик
+                CoalescedReject& window = *it->second;
+                if (window.repeats++ == 0) {
+                    window.first = now;
+                }
+                window.last = now;
+                coalesced_rejects.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+            if (coalesced.size() >= coalesce_max_windows) {
+                close_window(windows.begin());
+            }
+            CoalescedReject window;
+            window.key = key;
+            window.imsi = imsi;
+            window.action = action;
+            window.opened_at = clock->monotonic_now();
+            windows.push_back(std::move(window));
+            coalesced.emplace(std::move(key), std::prev(windows.end()));
+        }
+    }
+    write_line(now, imsi, action);
+}
+
+// Пишет закрывшиеся окна сведения
+void CDRLogger::flush_coalesced() {
+    if (coalesce_window.count() == 0) {
+        return;
+    }
+    std::lock_guard<ProfiledMutex> lock(mutex);
+    if (file.is_open()) {
+        close_expired_windows(clock->monotonic_now());
+    }
+}
+
+// Пишет строку CDR
+void CDRLogger::write_line(std::chrono::system_clock::time_point time, const std::string& imsi, const std::string& action) {
+    std::string timestamp = format_time(time);
+    file << timestamp << "," << imsi << "," << action << "\n";
+    file.flush(); // Гарантируем запись
+    if (event_stream) {
+        // Под мьютексом CDR, чтобы порядок событий совпадал с порядком строк в файле
+        event_stream->publish(timestamp, imsi, action);
+    }
+    std::stringstream log_ss;
+    log_ss << "CDR logged: IMSI: " << imsi << ", action: " << action;
+    logger->info(log_ss.str());
+}
+
+// Закрывает окно; сводная строка: "<action>; repeated=<N>; first=<время>; last=<время>"
+void CDRLogger::close_window(std::list<CoalescedReject>::iterator window) {
+    if (window->repeats > 0) {
+        std::stringstream action;
+        action << window->action << "; repeated=" << window->repeats
+               << "; first=" << format_time(window->first) << "; last=" << format_time(window->last);
+        write_line(clock->wall_now(), window->imsi, action.str());
+    }
+    coalesced.erase(window->key);
+    windows.erase(window);
+}
+
+// Окна открываются по времени, поэтому истёкшие лежат в начале списка
+void CDRLogger::close_expired_windows(std::chrono::steady_clock::time_point now) {
+    while (!windows.empty() && now - windows.front().opened_at >= coalesce_window) {
+        close_window(windows.begin());
+    }
+}
+
@@ -0,0 +1,59 @@
+#include "clock.hpp"
+
+// Конструктор: отсчёт ускоренного времени начинается сейчас
+ScaledClock::ScaledClock(double scale)
+    : scale(scale), start_monotonic(std::chrono::steady_clock::now()), start_wall(std::chrono::system_clock::now()) {
+}
+
+// Прошедшее время в масштабе
+std::chrono::nanoseconds ScaledClock::scaled_elapsed() const {
+    auto elapsed = std::chrono::steady_clock::now() - start_monotonic;
+    return std::chrono::nanoseconds(static_cast<int64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count() * scale));
+}
+
+// Монотонное время от момента создания в масштабе
+std::chrono::steady_clock::time_point ScaledClock::monotonic_now() const {
+    return start_monotonic + std::chrono::duration_cast<std::chrono::steady_clock::duration>(scaled_elapsed());
+}
+
+// Время реального мира идёт с той же скоростью, что и монотонное: метки CDR согласованы с истечением
+std::chrono::system_clock::time_point ScaledClock::wall_now() const {
+    return start_wall + std::chrono::duration_cast<std::chrono::system_clock::duration>(scaled_elapsed());
+}
+
+// Конструктор: часы стоят на моменте создания
+ManualClock::ManualClock()
+    : start_monotonic(std::chrono::steady_clock::now()), start_wall(std::chrono::system_clock::now()) {
+}
+
+// Монотонное время со сдвигом
+std::chrono::steady_clock::time_point ManualClock::monotonic_now() const {
+    return start_monotonic + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+        std::chrono::nanoseconds(monotonic_offset_ns.load()));
+}
+
+// Время реального мира со сдвигом
+std::chrono::system_clock::time_point ManualClock::wall_now() const {
+    return start_wall + std::chrono::duration_cast<std::chrono::system_clock::duration>(
+        std::chrono::nanoseconds(wall_offset_ns.load()));
+}
+
+// Сдвигает оба времени
+void ManualClock::advance(std::chrono::nanoseconds delta) {
+    monotonic_offset_ns += delta.count();
+    wall_offset_ns += delta.count();
+}
+
+// Переводит только время реального мира
+void ManualClock::jump_wall(std::chrono::nanoseconds delta) {
+    wall_offset_ns += delta.count();
+}
+
+// Выбирает часы по масштабу
+std::shared_ptr<IClock> make_clock(double scale) {
+    if (scale == 1.0) {
+        return std::make_shared<SystemClock>();
+    }
+    return std::make_shared<ScaledClock>(scale);
+}
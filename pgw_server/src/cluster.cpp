@@ -0,0 +1,434 @@
+#include "cluster.hpp"
+#include <arpa/inet.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+
+namespace {
+
+// Формат кадров внутреннего канала (целые — сетевой порядок байт):
+// запрос: 'Q', операция, id (4), длина IMSI (1), IMSI, TEID SGW (4; сохраняется при создании)
+// ответ:  'R', операция, id (4), результат (1), TEID (4), флаги (1: бит 0 — IPv4, бит 1 — IPv6),
+//         IPv4 (4), IPv6 (16), TEID SGW (4; сессии, созданной или удалённой запросом)
+constexpr uint8_t FRAME_REQUEST = 'Q';
+constexpr uint8_t FRAME_RESPONSE = 'R';
+constexpr size_t REQUEST_HEADER_SIZE = 7;
+constexpr size_t REQUEST_KEY_OFFSET = 1;    // Операция и id: ключ кэша ответов владельца
+constexpr size_t REQUEST_KEY_SIZE = 5;
+constexpr size_t RESPONSE_SIZE = 36;
+constexpr size_t MAX_FRAME_SIZE = 256;
+
+void write_u32(uint8_t* p, uint32_t v) {
+    v = htonl(v);
+    std::memcpy(p, &v, 4);
+}
+
+uint32_t read_u32(const uint8_t* p) {
+    uint32_t v;
+    std::memcpy(&v, p, 4);
+    return ntohl(v);
+}
+
+// Разбирает адрес узла "ip:port"
+struct sockaddr_in parse_node(const std::string& node) {
+    size_t colon = node.rfind(':');
+    struct sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    int port = 0;
+    try {
+        port = colon == std::string::npos ? 0 : std::stoi(node.substr(colon + 1));
+    }
+    catch (const std::exception&) {
+        port = 0;
+    }
+    if (port <= 0 || port > 65535 || inet_pton(AF_INET, node.substr(0, colon).c_str(), &addr.sin_addr) != 1) {
+        throw std::runtime_error("Invalid cluster node address (expected ip:port): " + node);
+    }
+    addr.sin_port = htons(static_cast<uint16_t>(port));
+    return addr;
+}
+
+} // namespace
+
+// Конструктор: строит кольцо по адресам узлов; канал открывается в run()
+ClusterSessionManager::ClusterSessionManager(const Config& config, std::shared_ptr<ISessionManager> local,
+    std::shared_ptr<ILogger> logger)
+    : config(config), local(local), logger(logger), ring(config.get_cluster_nodes()),
+    node_id(static_cast<size_t>(config.get_cluster_node_id())), next_id(std::random_device{}()),
+    // Повторы приходят в пределах таймаута отправителя; запас на случай большего таймаута у него
+    replies(std::chrono::milliseconds(2 * config.get_cluster_timeout_ms()), REPLY_CACHE_SIZE) {
+    for (const auto& node : config.get_cluster_nodes()) {
+        nodes.push_back(parse_node(node));
+    }
+    health.reset(new NodeHealth[nodes.size()]);
+    std::stringstream ss;
+    ss << "Cluster node " << node_id << " of " << nodes.size() << " on " << config.get_cluster_nodes()[node_id];
+    logger->info(ss.str());
+}
+
+// Деструктор: останавливает канал
+ClusterSessionManager::~ClusterSessionManager() {
+    stop();
+}
+
+// Открывает сокет канала на своём адресе и запускает потоки приёма
+void ClusterSessionManager::run() {
+    fd = socket(AF_INET, SOCK_DGRAM, 0);
+    if (fd < 0) {
+        throw std::runtime_error("Failed to create cluster socket: " + std::string(strerror(errno)));
+    }
+    int opt = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt));
+    // Таймаут приёма, чтобы потоки замечали остановку
+    struct timeval tv = { 0, 100000 };
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    if (::bind(fd, (struct sockaddr*)&nodes[node_id], sizeof(nodes[node_id])) < 0) {
+        close(fd);
+        fd = -1;
+        throw std::runtime_error("Failed to bind cluster socket: " + std::string(strerror(errno)));
+    }
+
+    running = true;
+    for (size_t i = 0; i < NUM_RECEIVERS; ++i) {
+        receivers.emplace_back(&ClusterSessionManager::receive_loop, this);
+    }
+    prober = std::thread(&ClusterSessionManager::probe_loop, this);
+    logger->info("Cluster channel started on {}", config.get_cluster_nodes()[node_id]);
+}
+
+// Останавливает канал, затем локальный менеджер
+void ClusterSessionManager::stop() {
+    if (running.exchange(false)) {
+        for (auto& receiver : receivers) {
+            if (receiver.joinable()) {
+                receiver.join();
+            }
+        }
+        receivers.clear();
+        if (prober.joinable()) {
+            prober.join();
+        }
+        close(fd);
+        fd = -1;
+        logger->info("Cluster channel stopped");
+    }
+    local->stop();
+}
+
+// Регистрирует ожидание и отправляет кадр запроса владельцу
+ClusterSessionManager::Call ClusterSessionManager::forward(size_t node, Operation operation, const std::string& imsi,
+    uint32_t peer_teid) {
+    Call call;
+    call.id = next_id.fetch_add(1);
+    call.node = node;
+    {
+        std::lock_guard<std::mutex> lock(pending_mutex);
+        call.reply = pending[call.id].get_future();
+    }
+
+    uint8_t frame[MAX_FRAME_SIZE];
+    size_t imsi_length = std::min(imsi.size(), MAX_FRAME_SIZE - REQUEST_HEADER_SIZE - 4);
+    frame[0] = FRAME_REQUEST;
+    frame[1] = operation;
+    write_u32(frame + 2, call.id);
+    frame[6] = static_cast<uint8_t>(imsi_length);
+    std::memcpy(frame + REQUEST_HEADER_SIZE, imsi.data(), imsi_length);
+    write_u32(frame + REQUEST_HEADER_SIZE + imsi_length, peer_teid);
+    call.frame.assign(reinterpret_cast<const char*>(frame), REQUEST_HEADER_SIZE + imsi_length + 4);
+    call.sent_at = std::chrono::steady_clock::now();
+    send_call(call);
+    ++forwarded;
+    return call;
+}
+
+void ClusterSessionManager::send_call(const Call& call) {
+    sendto(fd, call.frame.data(), call.frame.size(), 0, (const struct sockaddr*)&nodes[call.node], sizeof(nodes[call.node]));
+}
+
+// Потерянный запрос или ответ иначе превращается в отказ, хотя владелец мог уже создать сессию
+bool ClusterSessionManager::wait(Call& call, Reply& reply) {
+    auto timeout = std::chrono::milliseconds(config.get_cluster_timeout_ms());
+    auto interval = std::max(std::chrono::duration_cast<std::chrono::milliseconds>(timeout / ATTEMPTS),
+        std::chrono::milliseconds(1));
+    auto deadline = call.sent_at + timeout;
+    auto next_send = call.sent_at + interval;
+    while (true) {
+        if (call.reply.wait_until(std::min(next_send, deadline)) == std::future_status::ready) {
+            reply = call.reply.get();
+            health[call.node].timeouts = 0;
+            return true;
+        }
+        if (std::chrono::steady_clock::now() >= deadline || !running) {
+            break;
+        }
+        send_call(call);
+        ++retransmits;
+        next_send += interval;
+    }
+    {
+        std::lock_guard<std::mutex> lock(pending_mutex);
+        pending.erase(call.id);
+    }
+    ++timeouts;
+    logger->warn("Cluster request timed out, id {}", std::to_string(call.id));
+    record_timeout(call.node);
+    return false;
+}
+
+void ClusterSessionManager::record_timeout(size_t node) {
+    if (health[node].timeouts.fetch_add(1) + 1 >= DOWN_AFTER_TIMEOUTS && !health[node].down.exchange(true)) {
+        ++down_nodes;
+        logger->warn("Cluster node {} marked down, requests for its IMSIs are rejected until it answers a probe",
+            std::to_string(node));
+    }
+}
+
+void ClusterSessionManager::mark_alive(const struct sockaddr_in& from) {
+    for (size_t node = 0; node < nodes.size(); ++node) {
+        if (nodes[node].sin_addr.s_addr != from.sin_addr.s_addr || nodes[node].sin_port != from.sin_port) {
+            continue;
+        }
+        health[node].timeouts = 0;
+        if (health[node].down.exchange(false)) {
+            --down_nodes;
+            logger->info("Cluster node {} is reachable again", std::to_string(node));
+        }
+        return;
+    }
+}
+
+// Проба — проверка пустого IMSI: владелец отвечает сразу, ответ без ожидающего запроса отбрасывается
+void ClusterSessionManager::probe_loop() {
+    auto interval = std::chrono::milliseconds(std::max(config.get_cluster_timeout_ms(), 1));
+    auto next_probe = std::chrono::steady_clock::now() + interval;
+    while (running) {
+        std::this_thread::sleep_for(std::min(std::chrono::milliseconds(100), interval));
+        if (down_nodes == 0 || std::chrono::steady_clock::now() < next_probe) {
+            continue;
+        }
+        next_probe = std::chrono::steady_clock::now() + interval;
+        for (size_t node = 0; node < nodes.size(); ++node) {
+            if (!health[node].down) {
+                continue;
+            }
+            uint8_t frame[REQUEST_HEADER_SIZE + 4] = {};
+            frame[0] = FRAME_REQUEST;
+            frame[1] = OP_CHECK;
+            write_u32(frame + 2, next_id.fetch_add(1));
+            sendto(fd, frame, sizeof(frame), 0, (const struct sockaddr*)&nodes[node], sizeof(nodes[node]));
+            ++probes;
+        }
+    }
+}
+
+bool ClusterSessionManager::call_remote(size_t node, Operation operation, const std::string& imsi,
+    SessionResources* resources) {
+    // Канал уже остановлен: запросы, пришедшие во время остановки, отклоняются
+    if (!running) {
+        return false;
+    }
+    if (health[node].down) {
+        ++unreachable;
+        return false;
+    }
+    Call call = forward(node, operation, imsi, resources ? resources->peer_teid : 0);
+    Reply reply;
+    if (!wait(call, reply)) {
+        return false;
+    }
+    if (resources && reply.ok) {
+        *resources = reply.resources;
+    }
+    return reply.ok;
+}
+
+// Создание: у владельца; ресурсы сессии приходят в ответе
+bool ClusterSessionManager::create_session(const std::string& imsi, SessionResources* resources) {
+    size_t node = ring.owner(imsi);
+    if (node == node_id) {
+        return local->create_session(imsi, resources);
+    }
+    return call_remote(node, OP_CREATE, imsi, resources);
+}
+
+bool ClusterSessionManager::has_session(const std::string& imsi) {
+    size_t node = ring.owner(imsi);
+    if (node == node_id) {
+        return local->has_session(imsi);
+    }
+    return call_remote(node, OP_CHECK, imsi);
+}
+
+bool ClusterSessionManager::delete_session(const std::string& imsi, SessionResources* resources) {
+    size_t node = ring.owner(imsi);
+    if (node == node_id) {
+        return local->delete_session(imsi, resources);
+    }
+    return call_remote(node, OP_DELETE, imsi, resources);
+}
+
+// TEID выдаёт каждый узел из своего пула, поэтому один TEID может принадлежать сессиям разных
+// узлов: по нему нельзя ни найти владельца, ни доверять локальной находке. В кластере
+// Delete Session Request ищет сессию по IE IMSI
+bool ClusterSessionManager::find_session_by_teid(uint32_t, std::string&) {
+    return false;
+}
+
+bool ClusterSessionManager::is_reachable(const std::string& imsi) {
+    size_t node = ring.owner(imsi);
+    return node == node_id || !health[node].down;
+}
+
+// Свои IMSI удаляются одной пачкой, запросы к остальным узлам отправляются все сразу
+size_t ClusterSessionManager::delete_sessions(const std::vector<std::string>& imsis) {
+    std::vector<std::string> own;
+    std::vector<Call> calls;
+    for (const auto& imsi : imsis) {
+        size_t node = ring.owner(imsi);
+        if (node == node_id) {
+            own.push_back(imsi);
+        }
+        else if (!running) {
+            continue;
+        }
+        else if (health[node].down) {
+            ++unreachable;
+        }
+        else {
+            calls.push_back(forward(node, OP_DELETE, imsi));
+        }
+    }
+    size_t deleted = own.empty() ? 0 : local->delete_sessions(own);
+    for (auto& call : calls) {
+        Reply reply;
+        if (wait(call, reply) && reply.ok) {
+            ++deleted;
+        }
+    }
+    return deleted;
+}
+
+// Потоки приёма делят один сокет: каждая датаграмма достаётся ровно одному потоку
+void ClusterSessionManager::receive_loop() {
+    uint8_t buffer[MAX_FRAME_SIZE];
+    while (running) {
+        struct sockaddr_in from = {};
+        socklen_t from_length = sizeof(from);
+        ssize_t n = recvfrom(fd, buffer, sizeof(buffer), 0, (struct sockaddr*)&from, &from_length);
+        if (n <= 0) {
+            continue;
+        }
+        if (down_nodes != 0) {
+            mark_alive(from);
+        }
+        if (buffer[0] == FRAME_REQUEST) {
+            handle_request(buffer, static_cast<size_t>(n), from);
+        }
+        else if (buffer[0] == FRAME_RESPONSE) {
+            handle_response(buffer, static_cast<size_t>(n));
+        }
+    }
+}
+
+// Запрос другого узла выполняется локально без повторной пересылки,
+// чтобы расхождение конфигураций узлов не зациклило запрос
+void ClusterSessionManager::handle_request(const uint8_t* data, size_t length, const struct sockaddr_in& from) {
+    if (length < REQUEST_HEADER_SIZE || length < REQUEST_HEADER_SIZE + data[6] + 4) {
+        logger->warn("Dropped malformed cluster request");
+        return;
+    }
+    if (data[1] != OP_CREATE && data[1] != OP_DELETE && data[1] != OP_CHECK) {
+        logger->warn("Dropped cluster request with unknown operation {}", std::to_string(data[1]));
+        return;
+    }
+
+    // Повтор выполненного запроса получает прежний ответ: второе создание дало бы отказ
+    // "already exists", хотя сессия создана именно этим запросом
+    std::string request_key(reinterpret_cast<const char*>(data + REQUEST_KEY_OFFSET), REQUEST_KEY_SIZE);
+    std::string cached;
+    switch (replies.lookup(from, request_key, cached)) {
+    case ResponseCache::Lookup::Hit:
+        ++duplicates;
+        sendto(fd, cached.data(), cached.size(), 0, (const struct sockaddr*)&from, sizeof(from));
+        return;
+    case ResponseCache::Lookup::Pending:
+        // Первый экземпляр ещё выполняется в другом потоке приёма и ответит сам
+        ++duplicates;
+        return;
+    case ResponseCache::Lookup::Miss:
+        break;
+    }
+
+    std::string imsi(reinterpret_cast<const char*>(data + REQUEST_HEADER_SIZE), data[6]);
+    SessionResources resources;
+    resources.peer_teid = read_u32(data + REQUEST_HEADER_SIZE + data[6]);
+    bool ok = false;
+    switch (data[1]) {
+    case OP_CREATE: ok = local->create_session(imsi, &resources); break;
+    case OP_DELETE: ok = local->delete_session(imsi, &resources); break;
+    default: ok = local->has_session(imsi); break;
+    }
+    ++served;
+
+    uint8_t frame[RESPONSE_SIZE] = {};
+    frame[0] = FRAME_RESPONSE;
+    frame[1] = data[1];
+    std::memcpy(frame + 2, data + 2, 4);
+    frame[6] = ok ? 1 : 0;
+    write_u32(frame + 7, resources.teid);
+    frame[11] = static_cast<uint8_t>((resources.has_ipv4 ? 1 : 0) | (resources.has_ipv6 ? 2 : 0));
+    std::memcpy(frame + 12, &resources.ipv4, 4);
+    std::memcpy(frame + 16, resources.ipv6, 16);
+    write_u32(frame + 32, ok ? resources.peer_teid : 0);
+    replies.complete(from, request_key, std::string(reinterpret_cast<const char*>(frame), sizeof(frame)));
+    sendto(fd, frame, sizeof(frame), 0, (const struct sockaddr*)&from, sizeof(from));
+}
+
+void ClusterSessionManager::handle_response(const uint8_t* data, size_t length) {
+    if (length < RESPONSE_SIZE) {
+        logger->warn("Dropped malformed cluster response");
+        return;
+    }
+    Reply reply;
+    reply.ok = data[6] != 0;
+    reply.resources.teid = read_u32(data + 7);
+    reply.resources.has_ipv4 = (data[11] & 1) != 0;
+    reply.resources.has_ipv6 = (data[11] & 2) != 0;
+    std::memcpy(&reply.resources.ipv4, data + 12, 4);
+    std::memcpy(reply.resources.ipv6, data + 16, 16);
+    reply.resources.peer_teid = read_u32(data + 32);
+
+    std::promise<Reply> promise;
+    {
+        std::lock_guard<std::mutex> lock(pending_mutex);
+        auto it = pending.find(read_u32(data + 2));
+        if (it == pending.end()) {
+            // Ответ пришёл после таймаута
+            return;
+        }
+        promise = std::move(it->second);
+        pending.erase(it);
+    }
+    promise.set_value(reply);
+}
+
+// Формирует отчёт в формате key=value по строке на параметр
+std::string ClusterSessionManager::report() const {
+    std::stringstream ss;
+    ss << "node_id=" << node_id << "\n"
+       << "nodes=" << nodes.size() << "\n"
+       << "forwarded=" << forwarded.load() << "\n"
+       << "served=" << served.load() << "\n"
+       << "timeouts=" << timeouts.load() << "\n"
+       << "retransmits=" << retransmits.load() << "\n"
+       << "duplicates=" << duplicates.load() << "\n"
+       << "down_nodes=" << down_nodes.load() << "\n"
+       << "unreachable=" << unreachable.load() << "\n"
+       << "probes=" << probes.load() << "\n";
+    return ss.str();
+}
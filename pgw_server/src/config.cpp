@@ -1,82 +1,340 @@
-#include "config.hpp"
-#include <fstream>
-#include <stdexcept>
-#include <filesystem>
-
-// :    JSON-
-Config::Config(const std::string& config_file) {
-    //   
-    if (!std::filesystem::exists(config_file)) {
-        throw std::runtime_error("Config file does not exist: " + config_file);
-    }
-
-    std::ifstream file(config_file);
-    if (!file.is_open()) {
-        throw std::runtime_error("Failed to open config file: " + config_file);
-    }
-
-    nlohmann::json json;
-    try {
-        file >> json;
-    }
-    catch (const nlohmann::json::exception& e) {
-        throw std::runtime_error("Failed to parse config file: " + std::string(e.what()));
-    }
-
-    //     
-    if (json.contains("udp_ip") && json["udp_ip"].is_string()) {
-        udp_ip = json["udp_ip"];
-    }
-    else {
-        udp_ip = DEFAULT_UDP_IP;
-    }
-    if (json.contains("udp_port") && json["udp_port"].is_number_integer()) {
-        udp_port = json["udp_port"];
-    }
-    else {
-        udp_port = DEFAULT_UDP_PORT;
-    }
-    if (json.contains("session_timeout_sec") && json["session_timeout_sec"].is_number_integer()) {
-        session_timeout_sec = json["session_timeout_sec"];
-    }
-    else {
-        session_timeout_sec = DEFAULT_SESSION_TIMEOUT;
-    }
-    if (json.contains("cdr_file") && json["cdr_file"].is_string()) {
-        cdr_file = json["cdr_file"];
-    }
-    else {
-        cdr_file = DEFAULT_CDR_FILE;
-    }
-    if (json.contains("http_port") && json["http_port"].is_number_integer()) {
-        http_port = json["http_port"];
-    }
-    else {
-        http_port = DEFAULT_HTTP_PORT;
-    }
-    if (json.contains("graceful_shutdown_rate") && json["graceful_shutdown_rate"].is_number_integer()) {
-        graceful_shutdown_rate = json["graceful_shutdown_rate"];
-    }
-    else {
-        graceful_shutdown_rate = DEFAULT_SHUTDOWN_RATE;
-    }
-    if (json.contains("log_file") && json["log_file"].is_string()) {
-        log_file = json["log_file"];
-    }
-    else {
-        log_file = DEFAULT_LOG_FILE;
-    }
-    if (json.contains("log_level") && json["log_level"].is_string()) {
-        log_level = json["log_level"];
-    }
-    else {
-        log_level = DEFAULT_LOG_LEVEL;
-    }
-    if (json.contains("blacklist") && json["blacklist"].is_array()) {
-        for (const auto& item : json["blacklist"]) {
-            if (item.is_string()) {
-                blacklist.push_back(item);
-            }
-        }
-    }
+#include "config.hpp"
+#include <fstream>
+#include <stdexcept>
+#include <filesystem>
+
+// Конструктор: загружает и парсит JSON-конфигурацию
+Config::Config(const std::string& config_file) {
+    // Проверяем существование файла
+    if (!std::filesystem::exists(config_file)) {
+        throw std::runtime_error("Config file does not exist: " + config_file);
+    }
+
+    std::ifstream file(config_file);
+    if (!file.is_open()) {
+        throw std::runtime_error("Failed to open config file: " + config_file);
+    }
+
+    nlohmann::json json;
+    try {
+        file >> json;
+    }
+    catch (const nlohmann::json::exception& e) {
+        throw std::runtime_error("Failed to parse config file: " + std::string(e.what()));
+    }
+
+    // Проверяем типы и устанавливаем значения
+    if (json.contains("udp_ip") && json["udp_ip"].is_string()) {
+        udp_ip = json["udp_ip"];
+    }
+    else {
+        udp_ip = DEFAULT_UDP_IP;
+    }
+    if (json.contains("udp_port") && json["udp_port"].is_number_integer()) {
+        udp_port = json["udp_port"];
+    }
+    else {
+        udp_port = DEFAULT_UDP_PORT;
+    }
+    if (json.contains("session_timeout_sec") && json["session_timeout_sec"].is_number_integer()) {
+        session_timeout_sec = json["session_timeout_sec"];
+    }
+    else {
+        session_timeout_sec = DEFAULT_SESSION_TIMEOUT;
+    }
+    if (session_timeout_sec < 1) {
+        throw std::runtime_error("Invalid session_timeout_sec in config file");
+    }
+    if (json.contains("cdr_file") && json["cdr_file"].is_string()) {
+        cdr_file = json["cdr_file"];
+    }
+    else {
+        cdr_file = DEFAULT_CDR_FILE;
+    }
+    if (json.contains("http_port") && json["http_port"].is_number_integer()) {
+        http_port = json["http_port"];
+    }
+    else {
+        http_port = DEFAULT_HTTP_PORT;
+    }
+    if (json.contains("graceful_shutdown_rate") && json["graceful_shutdown_rate"].is_number_integer()) {
+        graceful_shutdown_rate = json["graceful_shutdown_rate"];
+    }
+    else {
+        graceful_shutdown_rate = DEFAULT_SHUTDOWN_RATE;
+    }
+    if (json.contains("log_file") && json["log_file"].is_string()) {
+        log_file = json["log_file"];
+    }
+    else {
+        log_file = DEFAULT_LOG_FILE;
+    }
+    if (json.contains("log_level") && json["log_level"].is_string()) {
+        log_level = json["log_level"];
+    }
+    else {
+        log_level = DEFAULT_LOG_LEVEL;
+    }
+    if (log_level != "DEBUG" && log_level != "INFO" && log_level != "WARN" && log_level != "ERROR" && log_level != "CRITICAL") {
+        throw std::runtime_error("Invalid log_level in config file: " + log_level);
+    }
+    if (json.contains("blacklist") && json["blacklist"].is_array()) {
+        for (const auto& item : json["blacklist"]) {
+            if (item.is_string()) {
+                blacklist.push_back(item);
+            }
+        }
+    }
+    if (json.contains("retransmit_ttl_ms") && json["retransmit_ttl_ms"].is_number_integer()) {
+        retransmit_ttl_ms = json["retransmit_ttl_ms"];
+    }
+    else {
+        retransmit_ttl_ms = DEFAULT_RETRANSMIT_TTL_MS;
+    }
+    if (json.contains("retransmit_cache_size") && json["retransmit_cache_size"].is_number_integer()) {
+        retransmit_cache_size = json["retransmit_cache_size"];
+    }
+    else {
+        retransmit_cache_size = DEFAULT_RETRANSMIT_CACHE_SIZE;
+    }
+    if (json.contains("rate_limit_per_sec") && json["rate_limit_per_sec"].is_number_integer()) {
+        rate_limit_per_sec = json["rate_limit_per_sec"];
+    }
+    else {
+        rate_limit_per_sec = DEFAULT_RATE_LIMIT_PER_SEC;
+    }
+    if (json.contains("rate_limit_burst") && json["rate_limit_burst"].is_number_integer()) {
+        rate_limit_burst = json["rate_limit_burst"];
+    }
+    else {
+        rate_limit_burst = DEFAULT_RATE_LIMIT_BURST;
+    }
+    if (json.contains("max_queue_depth") && json["max_queue_depth"].is_number_integer()) {
+        max_queue_depth = json["max_queue_depth"];
+    }
+    else {
+        max_queue_depth = DEFAULT_MAX_QUEUE_DEPTH;
+    }
+    if (json.contains("protocol") && json["protocol"].is_string()) {
+        protocol = json["protocol"];
+    }
+    else {
+        protocol = DEFAULT_PROTOCOL;
+    }
+    if (protocol != "bcd" && protocol != "gtpv2c") {
+        throw std::runtime_error("Invalid protocol in config file: " + protocol);
+    }
+    if (json.contains("teid_pool_size") && json["teid_pool_size"].is_number_integer()) {
+        teid_pool_size = json["teid_pool_size"];
+    }
+    else {
+        teid_pool_size = DEFAULT_TEID_POOL_SIZE;
+    }
+    if (teid_pool_size < 1) {
+        throw std::runtime_error("Invalid teid_pool_size in config file");
+    }
+    if (json.contains("ip_pools") && json["ip_pools"].is_array()) {
+        for (const auto& item : json["ip_pools"]) {
+            if (item.is_string()) {
+                ip_pools.push_back(item);
+            }
+        }
+    }
+    else {
+        ip_pools.push_back(DEFAULT_IP_POOL);
+    }
+    if (json.contains("cluster_nodes") && json["cluster_nodes"].is_array()) {
+        for (const auto& item : json["cluster_nodes"]) {
+            if (item.is_string()) {
+                cluster_nodes.push_back(item);
+            }
+        }
+    }
+    if (json.contains("cluster_node_id") && json["cluster_node_id"].is_number_integer()) {
+        cluster_node_id = json["cluster_node_id"];
+    }
+    else {
+        cluster_node_id = DEFAULT_CLUSTER_NODE_ID;
+    }
+    if (!cluster_nodes.empty() && (cluster_node_id < 0 || cluster_node_id >= static_cast<int>(cluster_nodes.size()))) {
+        throw std::runtime_error("cluster_node_id out of range: " + std::to_string(cluster_node_id));
+    }
+    if (json.contains("cluster_timeout_ms") && json["cluster_timeout_ms"].is_number_integer()) {
+        cluster_timeout_ms = json["cluster_timeout_ms"];
+    }
+    else {
+        cluster_timeout_ms = DEFAULT_CLUSTER_TIMEOUT_MS;
+    }
+    if (json.contains("replication_role") && json["replication_role"].is_string()) {
+        replication_role = json["replication_role"];
+    }
+    else {
+        replication_role = DEFAULT_REPLICATION_ROLE;
+    }
+    if (replication_role != "none" && replication_role != "active" && replication_role != "standby") {
+        throw std::runtime_error("Invalid replication_role in config file: " + replication_role);
+    }
+    if (json.contains("replication_address") && json["replication_address"].is_string()) {
+        replication_address = json["replication_address"];
+    }
+    else {
+        replication_address = DEFAULT_REPLICATION_ADDRESS;
+    }
+    if (json.contains("replication_batch_ms") && json["replication_batch_ms"].is_number_integer()) {
+        replication_batch_ms = json["replication_batch_ms"];
+    }
+    else {
+        replication_batch_ms = DEFAULT_REPLICATION_BATCH_MS;
+    }
+    if (json.contains("replication_checksum_sec") && json["replication_checksum_sec"].is_number_integer()) {
+        replication_checksum_sec = json["replication_checksum_sec"];
+    }
+    else {
+        replication_checksum_sec = DEFAULT_REPLICATION_CHECKSUM_SEC;
+    }
+    if (json.contains("replication_takeover_ms") && json["replication_takeover_ms"].is_number_integer()) {
+        replication_takeover_ms = json["replication_takeover_ms"];
+    }
+    else {
+        replication_takeover_ms = DEFAULT_REPLICATION_TAKEOVER_MS;
+    }
+    if (json.contains("worker_threads_min") && json["worker_threads_min"].is_number_integer()) {
+        worker_threads_min = json["worker_threads_min"];
+    }
+    else {
+        worker_threads_min = DEFAULT_WORKER_THREADS_MIN;
+    }
+    if (json.contains("worker_threads_max") && json["worker_threads_max"].is_number_integer()) {
+        worker_threads_max = json["worker_threads_max"];
+    }
+    else {
+        worker_threads_max = DEFAULT_WORKER_THREADS_MAX;
+    }
+    if (worker_threads_min < 1 || worker_threads_max < 0 || (worker_threads_max != 0 && worker_threads_max < worker_threads_min)) {
+        throw std::runtime_error("Invalid worker_threads_min/worker_threads_max in config file");
+    }
+    if (json.contains("worker_grow_wait_us") && json["worker_grow_wait_us"].is_number_integer()) {
+        worker_grow_wait_us = json["worker_grow_wait_us"];
+    }
+    else {
+        worker_grow_wait_us = DEFAULT_WORKER_GROW_WAIT_US;
+    }
+    if (json.contains("worker_shrink_idle_ms") && json["worker_shrink_idle_ms"].is_number_integer()) {
+        worker_shrink_idle_ms = json["worker_shrink_idle_ms"];
+    }
+    else {
+        worker_shrink_idle_ms = DEFAULT_WORKER_SHRINK_IDLE_MS;
+    }
+    if (json.contains("busy_poll") && json["busy_poll"].is_boolean()) {
+        busy_poll = json["busy_poll"];
+    }
+    else {
+        busy_poll = DEFAULT_BUSY_POLL;
+    }
+    if (json.contains("busy_poll_idle_ms") && json["busy_poll_idle_ms"].is_number_integer()) {
+        busy_poll_idle_ms = json["busy_poll_idle_ms"];
+    }
+    else {
+        busy_poll_idle_ms = DEFAULT_BUSY_POLL_IDLE_MS;
+    }
+    if (json.contains("busy_poll_cpu") && json["busy_poll_cpu"].is_number_integer()) {
+        busy_poll_cpu = json["busy_poll_cpu"];
+    }
+    else {
+        busy_poll_cpu = DEFAULT_BUSY_POLL_CPU;
+    }
+    if (json.contains("busy_poll_socket_us") && json["busy_poll_socket_us"].is_number_integer()) {
+        busy_poll_socket_us = json["busy_poll_socket_us"];
+    }
+    else {
+        busy_poll_socket_us = DEFAULT_BUSY_POLL_SOCKET_US;
+    }
+    if (json.contains("heavy_hitters_top_k") && json["heavy_hitters_top_k"].is_number_integer()) {
+        heavy_hitters_top_k = json["heavy_hitters_top_k"];
+    }
+    else {
+        heavy_hitters_top_k = DEFAULT_HEAVY_HITTERS_TOP_K;
+    }
+    if (json.contains("heavy_hitters_window_sec") && json["heavy_hitters_window_sec"].is_number_integer()) {
+        heavy_hitters_window_sec = json["heavy_hitters_window_sec"];
+    }
+    else {
+        heavy_hitters_window_sec = DEFAULT_HEAVY_HITTERS_WINDOW_SEC;
+    }
+    if (heavy_hitters_top_k < 1 || heavy_hitters_window_sec < 1) {
+        throw std::runtime_error("Invalid heavy_hitters_top_k/heavy_hitters_window_sec in config file");
+    }
+    if (json.contains("clock_scale") && json["clock_scale"].is_number()) {
+        clock_scale = json["clock_scale"];
+    }
+    else {
+        clock_scale = DEFAULT_CLOCK_SCALE;
+    }
+    if (clock_scale < 1.0) {
+        throw std::runtime_error("Invalid clock_scale in config file");
+    }
+    if (json.contains("event_stream_buffer") && json["event_stream_buffer"].is_number_integer()) {
+        event_stream_buffer = json["event_stream_buffer"];
+    }
+    else {
+        event_stream_buffer = DEFAULT_EVENT_STREAM_BUFFER;
+    }
+    if (json.contains("event_stream_max_subscribers") && json["event_stream_max_subscribers"].is_number_integer()) {
+        event_stream_max_subscribers = json["event_stream_max_subscribers"];
+    }
+    else {
+        event_stream_max_subscribers = DEFAULT_EVENT_STREAM_MAX_SUBSCRIBERS;
+    }
+    if (event_stream_buffer < 1 || event_stream_max_subscribers < 1) {
+        throw std::runtime_error("Invalid event_stream_buffer/event_stream_max_subscribers in config file");
+    }
+    if (json.contains("capture_ring_slots") && json["capture_ring_slots"].is_number_integer()) {
+        capture_ring_slots = json["capture_ring_slots"];
+    }
+    else {
+        capture_ring_slots = DEFAULT_CAPTURE_RING_SLOTS;
+    }
+    if (capture_ring_slots < 1) {
+        throw std::runtime_error("Invalid capture_ring_slots in config file");
+    }
+    if (json.contains("flight_recorder_events") && json["flight_recorder_events"].is_number_integer()) {
+        flight_recorder_events = json["flight_recorder_events"];
+    }
+    else {
+        flight_recorder_events = DEFAULT_FLIGHT_RECORDER_EVENTS;
+    }
+    if (flight_recorder_events < 0) {
+        throw std::runtime_error("Invalid flight_recorder_events in config file");
+    }
+    if (json.contains("flight_recorder_file") && json["flight_recorder_file"].is_string()) {
+        flight_recorder_file = json["flight_recorder_file"];
+    }
+    else {
+        flight_recorder_file = DEFAULT_FLIGHT_RECORDER_FILE;
+    }
+    if (json.contains("cdr_reject_coalesce_ms") && json["cdr_reject_coalesce_ms"].is_number_integer()) {
+        cdr_reject_coalesce_ms = json["cdr_reject_coalesce_ms"];
+    }
+    else {
+        cdr_reject_coalesce_ms = DEFAULT_CDR_REJECT_COALESCE_MS;
+    }
+    if (json.contains("cdr_reject_coalesce_max_imsis") && json["cdr_reject_coalesce_max_imsis"].is_number_integer()) {
+        cdr_reject_coalesce_max_imsis = json["cdr_reject_coalesce_max_imsis"];
+    }
+    else {
+        cdr_reject_coalesce_max_imsis = DEFAULT_CDR_REJECT_COALESCE_MAX_IMSIS;
+    }
+    if (cdr_reject_coalesce_ms < 0 || cdr_reject_coalesce_max_imsis < 1) {
+        throw std::runtime_error("Invalid cdr_reject_coalesce_ms/cdr_reject_coalesce_max_imsis in config file");
+    }
+    if (json.contains("admin_socket_path") && json["admin_socket_path"].is_string()) {
+        admin_socket_path = json["admin_socket_path"];
+    }
+    else {
+        admin_socket_path = DEFAULT_ADMIN_SOCKET_PATH;
+    }
+    // sun_path вмещает 107 символов и завершающий ноль
+    if (admin_socket_path.size() > 107) {
+        throw std::runtime_error("Invalid admin_socket_path in config file");
+    }
 }
\ No newline at end of file
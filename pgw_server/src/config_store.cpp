@@ -0,0 +1,273 @@
+#include "config_store.hpp"
+#include <sstream>
+#include <stdexcept>
+
+// Конструктор: стартовая конфигурация — версия 1
+ConfigStore::ConfigStore(const std::string& path, const Config& initial) : path(path) {
+    readers[0].store(0);
+    readers[1].store(0);
+    active.version = 1;
+    active.config = std::make_unique<const Config>(initial);
+    current_config.store(active.config.get(), std::memory_order_release);
+    current_version.store(1, std::memory_order_release);
+}
+
+// Текущий снимок. Читатель отмечается в счётчике эпохи до загрузки указателя: снимок,
+// вытесненный после этого, не освободится, пока отметка не снята
+ConfigStore::Ref ConfigStore::current() const {
+    uint32_t e = epoch.load() & 1;
+    readers[e].fetch_add(1);
+    return Ref(current_config.load(), &readers[e]);
+}
+
+// Подключает обработчик применения
+void ConfigStore::on_reload(ReloadHook hook) {
+    std::lock_guard<std::mutex> lock(writer_mutex);
+    hooks.push_back(std::move(hook));
+}
+
+// Перечитывает файл и публикует новый снимок
+ConfigReloadResult ConfigStore::reload() {
+    std::lock_guard<std::mutex> lock(writer_mutex);
+    ConfigReloadResult result;
+    std::unique_ptr<const Config> next;
+    try {
+        next = std::make_unique<const Config>(path);
+    }
+    catch (const std::exception& e) {
+        result.error = e.what();
+    }
+    if (next) {
+        auto changed = restart_required_changes(*active.config, *next);
+        if (!changed.empty()) {
+            result.error = "Restart required to change:";
+            for (const auto& key : changed) {
+                result.error += " " + key;
+            }
+        }
+    }
+    if (!result.error.empty()) {
+        ++reload_failures;
+        last_error = result.error;
+        result.version = get_version();
+        return result;
+    }
+    // Файл не изменился: новая версия вытеснила бы цель отката тем же содержимым
+    if (reloadable_changes(*active.config, *next).empty()) {
+        ++unchanged_reloads;
+        result.ok = true;
+        result.version = get_version();
+        return result;
+    }
+
+    Snapshot snapshot;
+    snapshot.version = ++last_version;
+    snapshot.config = std::move(next);
+    result = apply(active, snapshot);
+    if (result.ok) {
+        retire(rollback_target);
+        rollback_target = std::move(active);
+        active = std::move(snapshot);
+        ++reloads;
+    }
+    else {
+        // Снимок успел побыть опубликованным: читатели могут его держать
+        retire(snapshot);
+        ++reload_failures;
+    }
+    reclaim_retired();
+    return result;
+}
+
+// Возвращает предыдущий действовавший снимок
+ConfigReloadResult ConfigStore::rollback() {
+    std::lock_guard<std::mutex> lock(writer_mutex);
+    if (!rollback_target.config) {
+        ConfigReloadResult result;
+        result.version = get_version();
+        result.error = "No previous config version";
+        return result;
+    }
+    auto result = apply(active, rollback_target);
+    if (result.ok) {
+        retire(active);
+        active = std::move(rollback_target);
+        rollback_target = Snapshot();
+        ++rollbacks;
+    }
+    reclaim_retired();
+    return result;
+}
+
+// Освобождает вытесненные снимки без читателей
+void ConfigStore::reclaim() {
+    std::lock_guard<std::mutex> lock(writer_mutex);
+    reclaim_retired();
+}
+
+size_t ConfigStore::retired_snapshots() const {
+    std::lock_guard<std::mutex> lock(writer_mutex);
+    return retired.size();
+}
+
+// Откладывает снимок; освобождён он будет, когда обнулятся счётчики читателей обеих эпох
+void ConfigStore::retire(Snapshot& snapshot) {
+    if (snapshot.config) {
+        retired.push_back({ std::move(snapshot.config), { false, false } });
+    }
+}
+
+// Снимок освобождается, когда счётчики обеих эпох обнулялись после его вытеснения: читатель,
+// видевший его указатель, отметился раньше. Эпоха переключается, когда неактивный счётчик
+// уже обнулялся для всех ждущих снимков, чтобы новые читатели не держали в нуле прежний
+void ConfigStore::reclaim_retired() {
+    if (retired.empty()) {
+        return;
+    }
+    for (uint32_t e = 0; e < 2; ++e) {
+        if (readers[e].load() == 0) {
+            for (auto& entry : retired) {
+                entry.drained[e] = true;
+            }
+        }
+    }
+    uint32_t inactive = (epoch.load() & 1) ^ 1;
+    bool inactive_drained = true;
+    size_t kept = 0;
+    for (auto& entry : retired) {
+        if (entry.drained[0] && entry.drained[1]) {
+            continue;
+        }
+        inactive_drained = inactive_drained && entry.drained[inactive];
+        retired[kept++] = std::move(entry);
+    }
+    retired.resize(kept);
+    if (kept > 0 && inactive_drained) {
+        epoch.fetch_add(1);
+    }
+}
+
+// Публикует снимок и вызывает обработчики; если обработчик отверг снимок, действует прежний
+ConfigReloadResult ConfigStore::apply(const Snapshot& previous, const Snapshot& next) {
+    auto publish = [this](const Snapshot& snapshot) {
+        current_config.store(snapshot.config.get(), std::memory_order_release);
+        current_version.store(snapshot.version, std::memory_order_release);
+    };
+
+    ConfigReloadResult result;
+    publish(next);
+    try {
+        for (const auto& hook : hooks) {
+            hook(*previous.config, *next.config);
+        }
+    }
+    catch (const std::exception& e) {
+        publish(previous);
+        // Обработчики, успевшие применить новый снимок, возвращаются к прежнему
+        for (const auto& hook : hooks) {
+            try {
+                hook(*next.config, *previous.config);
+            }
+            catch (const std::exception&) {
+            }
+        }
+        result.error = std::string("Failed to apply config, rolled back: ") + e.what();
+        last_error = result.error;
+        result.version = previous.version;
+        return result;
+    }
+    result.ok = true;
+    result.version = next.version;
+    return result;
+}
+
+// Версия, счётчики и действующие значения
+std::string ConfigStore::report() const {
+    std::lock_guard<std::mutex> lock(writer_mutex);
+    const Config& config = *active.config;
+    std::stringstream ss;
+    ss << "version=" << get_version() << "\n"
+       << "path=" << path << "\n"
+       << "reloads=" << reloads << "\n"
+       << "unchanged_reloads=" << unchanged_reloads << "\n"
+       << "rollback_version=" << (rollback_target.config ? rollback_target.version : 0) << "\n"
+       << "retired_snapshots=" << retired.size() << "\n"
+       << "reload_failures=" << reload_failures << "\n"
+       << "rollbacks=" << rollbacks << "\n"
+       << "last_error=" << last_error << "\n"
+       << "session_timeout_sec=" << config.get_session_timeout_sec() << "\n"
+       << "log_level=" << config.get_log_level() << "\n"
+       << "blacklist_size=" << config.get_blacklist().size() << "\n"
+       << "rate_limit_per_sec=" << config.get_rate_limit_per_sec() << "\n"
+       << "rate_limit_burst=" << config.get_rate_limit_burst() << "\n"
+       << "max_queue_depth=" << config.get_max_queue_depth() << "\n";
+    return ss.str();
+}
+
+// Ключи, которые меняет перезагрузка
+std::vector<std::string> ConfigStore::reloadable_changes(const Config& previous, const Config& next) {
+    std::vector<std::string> changed;
+    auto check = [&changed](const char* key, bool same) {
+        if (!same) {
+            changed.push_back(key);
+        }
+    };
+    check("session_timeout_sec", previous.get_session_timeout_sec() == next.get_session_timeout_sec());
+    check("log_level", previous.get_log_level() == next.get_log_level());
+    check("blacklist", previous.get_blacklist() == next.get_blacklist());
+    check("rate_limit_per_sec", previous.get_rate_limit_per_sec() == next.get_rate_limit_per_sec());
+    check("rate_limit_burst", previous.get_rate_limit_burst() == next.get_rate_limit_burst());
+    check("max_queue_depth", previous.get_max_queue_depth() == next.get_max_queue_depth());
+    return changed;
+}
+
+// Ключи, которые читаются только при запуске компонентов
+std::vector<std::string> ConfigStore::restart_required_changes(const Config& previous, const Config& next) {
+    std::vector<std::string> changed;
+    auto check = [&changed](const char* key, bool same) {
+        if (!same) {
+            changed.push_back(key);
+        }
+    };
+    check("udp_ip", previous.get_udp_ip() == next.get_udp_ip());
+    check("udp_port", previous.get_udp_port() == next.get_udp_port());
+    check("cdr_file", previous.get_cdr_file() == next.get_cdr_file());
+    check("http_port", previous.get_http_port() == next.get_http_port());
+    check("graceful_shutdown_rate", previous.get_graceful_shutdown_rate() == next.get_graceful_shutdown_rate());
+    check("log_file", previous.get_log_file() == next.get_log_file());
+    check("retransmit_ttl_ms", previous.get_retransmit_ttl_ms() == next.get_retransmit_ttl_ms());
+    check("retransmit_cache_size", previous.get_retransmit_cache_size() == next.get_retransmit_cache_size());
+    check("protocol", previous.get_protocol() == next.get_protocol());
+    check("teid_pool_size", previous.get_teid_pool_size() == next.get_teid_pool_size());
+    check("ip_pools", previous.get_ip_pools() == next.get_ip_pools());
+    check("cluster_nodes", previous.get_cluster_nodes() == next.get_cluster_nodes());
+    check("cluster_node_id", previous.get_cluster_node_id() == next.get_cluster_node_id());
+    check("cluster_timeout_ms", previous.get_cluster_timeout_ms() == next.get_cluster_timeout_ms());
+    check("replication_role", previous.get_replication_role() == next.get_replication_role());
+    check("replication_address", previous.get_replication_address() == next.get_replication_address());
+    check("replication_batch_ms", previous.get_replication_batch_ms() == next.get_replication_batch_ms());
+    check("replication_checksum_sec", previous.get_replication_checksum_sec() == next.get_replication_checksum_sec());
+    check("replication_takeover_ms", previous.get_replication_takeover_ms() == next.get_replication_takeover_ms());
+    check("worker_threads_min", previous.get_worker_threads_min() == next.get_worker_threads_min());
+    check("worker_threads_max", previous.get_worker_threads_max() == next.get_worker_threads_max());
+    check("worker_grow_wait_us", previous.get_worker_grow_wait_us() == next.get_worker_grow_wait_us());
+    check("worker_shrink_idle_ms", previous.get_worker_shrink_idle_ms() == next.get_worker_shrink_idle_ms());
+    check("busy_poll", previous.get_busy_poll() == next.get_busy_poll());
+    check("busy_poll_idle_ms", previous.get_busy_poll_idle_ms() == next.get_busy_poll_idle_ms());
+    check("busy_poll_cpu", previous.get_busy_poll_cpu() == next.get_busy_poll_cpu());
+    check("busy_poll_socket_us", previous.get_busy_poll_socket_us() == next.get_busy_poll_socket_us());
+    check("heavy_hitters_top_k", previous.get_heavy_hitters_top_k() == next.get_heavy_hitters_top_k());
+    check("heavy_hitters_window_sec", previous.get_heavy_hitters_window_sec() == next.get_heavy_hitters_window_sec());
+    check("clock_scale", previous.get_clock_scale() == next.get_clock_scale());
+    check("event_stream_buffer", previous.get_event_stream_buffer() == next.get_event_stream_buffer());
+    check("event_stream_max_subscribers",
+        previous.get_event_stream_max_subscribers() == next.get_event_stream_max_subscribers());
+    check("capture_ring_slots", previous.get_capture_ring_slots() == next.get_capture_ring_slots());
+    check("flight_recorder_events", previous.get_flight_recorder_events() == next.get_flight_recorder_events());
+    check("flight_recorder_file", previous.get_flight_recorder_file() == next.get_flight_recorder_file());
+    check("cdr_reject_coalesce_ms", previous.get_cdr_reject_coalesce_ms() == next.get_cdr_reject_coalesce_ms());
+    check("cdr_reject_coalesce_max_imsis",
+        previous.get_cdr_reject_coalesce_max_imsis() == next.get_cdr_reject_coalesce_max_imsis());
+    check("admin_socket_path", previous.get_admin_socket_path() == next.get_admin_socket_path());
+    return changed;
+}
@@ -0,0 +1,204 @@
+#include "datagram_transport.hpp"
+#include "clock.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <sys/eventfd.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+// Конструктор Socket: создаёт UDP-сокет
+Socket::Socket() : fd(socket(AF_INET, SOCK_DGRAM, 0)) {
+    if (fd < 0) {
+        throw std::runtime_error("Failed to create socket: " + std::string(strerror(errno)));
+    }
+    // Устанавливаем SO_REUSEADDR
+    int opt = 1;
+    if (setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt)) < 0) {
+        throw std::runtime_error("Failed to set SO_REUSEADDR: " + std::string(strerror(errno)));
+    }
+}
+
+// Деструктор Socket: закрывает сокет
+Socket::~Socket() {
+    if (fd >= 0) {
+        close(fd);
+    }
+}
+
+// Устанавливает сокет в неблокирующий режим
+void Socket::set_non_blocking() {
+    if (fcntl(fd, F_SETFL, O_NONBLOCK) < 0) {
+        throw std::runtime_error("Failed to set socket to non-blocking: " + std::string(strerror(errno)));
+    }
+}
+
+// Привязывает сокет к IP и порту
+void Socket::bind(const std::string& ip, int port) {
+    struct sockaddr_in server_addr = {};
+    server_addr.sin_family = AF_INET;
+    server_addr.sin_addr.s_addr = inet_addr(ip.c_str());
+    server_addr.sin_port = htons(port);
+
+    if (::bind(fd, (struct sockaddr*)&server_addr, sizeof(server_addr)) < 0) {
+        throw std::runtime_error("Failed to bind socket: " + std::string(strerror(errno)));
+    }
+}
+
+// Переводит сокет в неблокирующий режим и привязывает его
+void UDPSocketTransport::open(const std::string& ip, int port) {
+    socket.set_non_blocking();
+    socket.bind(ip, port);
+}
+
+// Читает датаграмму вместе с управляющими сообщениями: меткой времени приёма (CLOCK_REALTIME)
+// и накопленным числом отброшенных ядром датаграмм
+ssize_t UDPSocketTransport::receive(char* buffer, size_t capacity, struct sockaddr_in& peer, socklen_t& addr_len,
+    DatagramInfo& info) {
+    struct iovec iov = { buffer, capacity };
+    alignas(struct cmsghdr) char control[CMSG_SPACE(sizeof(struct timespec)) + CMSG_SPACE(sizeof(uint32_t))];
+    struct msghdr message = {};
+    message.msg_name = &peer;
+    message.msg_namelen = sizeof(peer);
+    message.msg_iov = &iov;
+    message.msg_iovlen = 1;
+    message.msg_control = control;
+    message.msg_controllen = sizeof(control);
+    ssize_t n = recvmsg(socket.get_fd(), &message, 0);
+    if (n < 0) {
+        return n;
+    }
+    addr_len = message.msg_namelen;
+
+    for (struct cmsghdr* cmsg = CMSG_FIRSTHDR(&message); cmsg != nullptr; cmsg = CMSG_NXTHDR(&message, cmsg)) {
+        if (cmsg->cmsg_level != SOL_SOCKET) {
+            continue;
+        }
+        if (cmsg->cmsg_type == SCM_TIMESTAMPNS) {
+            struct timespec stamp;
+            memcpy(&stamp, CMSG_DATA(cmsg), sizeof(stamp));
+            info.rx_ns = static_cast<int64_t>(stamp.tv_sec) * 1000000000 + stamp.tv_nsec;
+        }
+        else if (cmsg->cmsg_type == SO_RXQ_OVFL) {
+            memcpy(&info.drops, CMSG_DATA(cmsg), sizeof(info.drops));
+            info.has_drops = true;
+        }
+    }
+    return n;
+}
+
+// Отправляет датаграмму через sendto
+void UDPSocketTransport::send(const void* data, size_t length, const struct sockaddr_in& peer, socklen_t addr_len) {
+    sendto(socket.get_fd(), data, length, 0, (const struct sockaddr*)&peer, addr_len);
+}
+
+// Включает метки времени приёма из ядра и счётчик отброшенных датаграмм.
+// Пробует обе опции, даже если первая не включилась
+void UDPSocketTransport::enable_receive_timestamps() {
+    int on = 1;
+    std::string errors;
+    if (setsockopt(socket.get_fd(), SOL_SOCKET, SO_TIMESTAMPNS, &on, sizeof(on)) < 0) {
+        errors = "Failed to enable SO_TIMESTAMPNS: " + std::string(strerror(errno));
+    }
+    if (setsockopt(socket.get_fd(), SOL_SOCKET, SO_RXQ_OVFL, &on, sizeof(on)) < 0) {
+        errors += (errors.empty() ? "" : "; ") + std::string("Failed to enable SO_RXQ_OVFL: ") + strerror(errno);
+    }
+    if (!errors.empty()) {
+        throw std::runtime_error(errors);
+    }
+}
+
+// Включает SO_BUSY_POLL: без CAP_NET_ADMIN ядро может не дать его поднять
+void UDPSocketTransport::enable_busy_poll(int socket_us) {
+    if (socket_us > 0 && setsockopt(socket.get_fd(), SOL_SOCKET, SO_BUSY_POLL, &socket_us, sizeof(socket_us)) < 0) {
+        throw std::runtime_error("Failed to set SO_BUSY_POLL: " + std::string(strerror(errno)));
+    }
+}
+
+// Конструктор: пустая очередь, eventfd не готов
+LoopbackTransport::LoopbackTransport(size_t capacity)
+    : capacity(capacity), ready_fd(eventfd(0, EFD_NONBLOCK)) {
+    if (ready_fd < 0) {
+        throw std::runtime_error("Failed to create eventfd: " + std::string(strerror(errno)));
+    }
+}
+
+// Деструктор: закрывает eventfd
+LoopbackTransport::~LoopbackTransport() {
+    close(ready_fd);
+}
+
+// Привязка не нужна: адрес только для журнала сервера
+void LoopbackTransport::open(const std::string& ip, int port) {
+    (void)ip;
+    (void)port;
+}
+
+// Ставит датаграмму в очередь; eventfd взводится только при переходе очереди из пустой в непустую,
+// поэтому поток с генератором не платит за системный вызов на каждую датаграмму
+bool LoopbackTransport::inject(const void* data, size_t length, const struct sockaddr_in& peer) {
+    Datagram datagram{ std::string(static_cast<const char*>(data), length), peer, realtime_ns() };
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (queue.size() >= capacity) {
+            dropped.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        queue.push_back(std::move(datagram));
+        if (queue.size() == 1) {
+            uint64_t one = 1;
+            ssize_t written = write(ready_fd, &one, sizeof(one));
+            (void)written;
+        }
+    }
+    injected.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+// Число датаграмм в очереди приёма
+size_t LoopbackTransport::get_queued() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return queue.size();
+}
+
+// Берёт датаграмму из очереди; опустевшая очередь сбрасывает eventfd под тем же мьютексом,
+// что и inject(), поэтому готовность не теряется
+ssize_t LoopbackTransport::receive(char* buffer, size_t capacity, struct sockaddr_in& peer, socklen_t& addr_len,
+    DatagramInfo& info) {
+    Datagram datagram;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (queue.empty()) {
+            errno = EAGAIN;
+            return -1;
+        }
+        datagram = std::move(queue.front());
+        queue.pop_front();
+        if (queue.empty()) {
+            uint64_t value;
+            ssize_t n = read(ready_fd, &value, sizeof(value));
+            (void)n;
+        }
+    }
+    // Как у UDP: не поместившийся хвост датаграммы теряется
+    size_t length = std::min(datagram.data.size(), capacity);
+    memcpy(buffer, datagram.data.data(), length);
+    peer = datagram.peer;
+    addr_len = sizeof(peer);
+    info.rx_ns = datagram.rx_ns;
+    info.has_drops = true;
+    info.drops = static_cast<uint32_t>(dropped.load(std::memory_order_relaxed));
+    return static_cast<ssize_t>(length);
+}
+
+// Передаёт ответ обработчику
+void LoopbackTransport::send(const void* data, size_t length, const struct sockaddr_in& peer, socklen_t addr_len) {
+    (void)addr_len;
+    replies.fetch_add(1, std::memory_order_relaxed);
+    if (reply_handler) {
+        reply_handler(static_cast<const char*>(data), length, peer);
+    }
+}
@@ -0,0 +1,159 @@
+#include "event_loop.hpp"
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <pthread.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/signalfd.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+
+// Конструктор: создаёт epoll и eventfd для пробуждения
+EventLoop::EventLoop() {
+    epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    if (epoll_fd < 0) {
+        throw std::runtime_error("Failed to create epoll: " + std::string(strerror(errno)));
+    }
+    wake_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (wake_fd < 0) {
+        close(epoll_fd);
+        throw std::runtime_error("Failed to create eventfd: " + std::string(strerror(errno)));
+    }
+    watch(wake_fd, [this]() {
+        uint64_t value;
+        while (read(wake_fd, &value, sizeof(value)) > 0) {
+        }
+        run_posted();
+    });
+}
+
+// Деструктор: закрывает дескрипторы и возвращает маску сигналов
+EventLoop::~EventLoop() {
+    for (const auto& source : sources) {
+        close(source->fd);
+    }
+    close(epoll_fd);
+    if (signals_blocked) {
+        pthread_sigmask(SIG_SETMASK, &previous_mask, nullptr);
+    }
+}
+
+// Регистрирует дескриптор в epoll
+void EventLoop::watch(int fd, std::function<void()> on_ready) {
+    sources.push_back(std::make_unique<Source>(Source{ fd, std::move(on_ready) }));
+    struct epoll_event event = {};
+    event.events = EPOLLIN;
+    event.data.ptr = sources.back().get();
+    if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &event) < 0) {
+        throw std::runtime_error("Failed to watch descriptor: " + std::string(strerror(errno)));
+    }
+}
+
+// Блокирует сигналы и доставляет их через signalfd
+void EventLoop::handle_signals(const std::vector<int>& signals, std::function<void(int)> handler) {
+    sigset_t mask;
+    sigemptyset(&mask);
+    for (int signo : signals) {
+        sigaddset(&mask, signo);
+    }
+    sigset_t previous;
+    if (pthread_sigmask(SIG_BLOCK, &mask, &previous) != 0) {
+        throw std::runtime_error("Failed to block signals");
+    }
+    if (!signals_blocked) {
+        previous_mask = previous;
+        signals_blocked = true;
+    }
+    int fd = signalfd(-1, &mask, SFD_NONBLOCK | SFD_CLOEXEC);
+    if (fd < 0) {
+        throw std::runtime_error("Failed to create signalfd: " + std::string(strerror(errno)));
+    }
+    watch(fd, [fd, handler]() {
+        struct signalfd_siginfo info;
+        while (read(fd, &info, sizeof(info)) == sizeof(info)) {
+            handler(static_cast<int>(info.ssi_signo));
+        }
+    });
+}
+
+// Периодическая задача на timerfd
+void EventLoop::add_timer(std::chrono::milliseconds period, std::function<void()> task) {
+    int fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    if (fd < 0) {
+        throw std::runtime_error("Failed to create timerfd: " + std::string(strerror(errno)));
+    }
+    struct itimerspec spec = {};
+    spec.it_interval.tv_sec = period.count() / 1000;
+    spec.it_interval.tv_nsec = (period.count() % 1000) * 1000000;
+    spec.it_value = spec.it_interval;
+    if (timerfd_settime(fd, 0, &spec, nullptr) < 0) {
+        close(fd);
+        throw std::runtime_error("Failed to arm timerfd: " + std::string(strerror(errno)));
+    }
+    // Пропущенные срабатывания (цикл был занят) сливаются в один запуск
+    watch(fd, [fd, task]() {
+        uint64_t expirations;
+        if (read(fd, &expirations, sizeof(expirations)) == sizeof(expirations)) {
+            task();
+        }
+    });
+}
+
+// Ставит задачу в очередь и будит цикл
+void EventLoop::post(std::function<void()> task) {
+    {
+        std::lock_guard<std::mutex> lock(posted_mutex);
+        posted.push_back(std::move(task));
+    }
+    uint64_t one = 1;
+    ssize_t written = write(wake_fd, &one, sizeof(one));
+    (void)written; // Счётчик eventfd переполниться не может: цикл вычитывает его целиком
+}
+
+// Выполняет накопленные задачи
+void EventLoop::run_posted() {
+    std::vector<std::function<void()>> tasks;
+    {
+        std::lock_guard<std::mutex> lock(posted_mutex);
+        tasks.swap(posted);
+    }
+    for (auto& task : tasks) {
+        task();
+    }
+}
+
+// Основной цикл
+void EventLoop::run() {
+    struct epoll_event events[16];
+    while (!stopping) {
+        int n = epoll_wait(epoll_fd, events, 16, -1);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            throw std::runtime_error("epoll_wait failed: " + std::string(strerror(errno)));
+        }
+        for (int i = 0; i < n && !stopping; ++i) {
+            static_cast<Source*>(events[i].data.ptr)->on_ready();
+        }
+    }
+}
+
+// Завершает цикл
+void EventLoop::stop() {
+    int64_t expected = 0;
+    int64_t now = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+    stop_requested_ns.compare_exchange_strong(expected, now);
+    stopping = true;
+    uint64_t one = 1;
+    ssize_t written = write(wake_fd, &one, sizeof(one));
+    (void)written;
+}
+
+// Момент запроса остановки
+std::chrono::steady_clock::time_point EventLoop::stop_requested_at() const {
+    return std::chrono::steady_clock::time_point(std::chrono::nanoseconds(stop_requested_ns.load()));
+}
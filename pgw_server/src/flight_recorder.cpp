@@ -0,0 +1,334 @@
+#include "flight_recorder.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <climits>
+#include <csignal>
+#include <cstring>
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace {
+
+// Имена событий в трассе и имена их значений (nullptr — без значения)
+const char* const EVENT_NAMES[] = { "receive", "enqueue", "session_create", "session_delete", "cdr_write", "send", "expiry_sweep" };
+const char* const VALUE_NAMES[] = { "bytes", "queue_depth", "ok", "ok", nullptr, "bytes", "expired" };
+constexpr uint32_t EVENT_COUNT = sizeof(EVENT_NAMES) / sizeof(EVENT_NAMES[0]);
+
+std::atomic<uint64_t> next_recorder_id{ 1 };
+
+// Кольцо потока в последнем самописце, в который поток писал
+struct ThreadRingCache {
+    uint64_t recorder_id = 0;
+    void* ring = nullptr;
+};
+thread_local ThreadRingCache thread_ring_cache;
+
+// Самописец для аварийного дампа: указатель читает обработчик сигнала, владение — здесь
+std::shared_ptr<FlightRecorder> crash_recorder_owner;
+std::atomic<FlightRecorder*> crash_recorder{ nullptr };
+char crash_path[PATH_MAX];
+std::atomic<bool> crash_dumped{ false };
+
+// Обработчик аварийных сигналов: дамп один раз, затем сигнал с действием по умолчанию
+void on_fatal_signal(int signal_number) {
+    FlightRecorder* recorder = crash_recorder.load();
+    if (recorder && !crash_dumped.exchange(true)) {
+        recorder->dump(crash_path);
+    }
+    // SA_RESETHAND уже вернул действие по умолчанию
+    raise(signal_number);
+}
+
+} // namespace
+
+// Буфер форматирования: сбрасывается в строку или в дескриптор. Числа форматируются вручную,
+// без snprintf, чтобы запись в дескриптор годилась для обработчика сигнала
+class FlightRecorder::TraceOutput {
+public:
+    explicit TraceOutput(std::string* out) : out(out), fd(-1) {}
+    explicit TraceOutput(int fd) : out(nullptr), fd(fd) {}
+
+    ~TraceOutput() { flush(); }
+
+    void put(const char* data, size_t length) {
+        while (length > 0) {
+            if (used == sizeof(buffer)) {
+                flush();
+            }
+            size_t chunk = std::min(length, sizeof(buffer) - used);
+            memcpy(buffer + used, data, chunk);
+            used += chunk;
+            data += chunk;
+            length -= chunk;
+        }
+    }
+
+    void put(const char* text) { put(text, strlen(text)); }
+
+    void put_uint(uint64_t value) {
+        char digits[20];
+        size_t n = 0;
+        do {
+            digits[n++] = static_cast<char>('0' + value % 10);
+            value /= 10;
+        } while (value != 0);
+        char reversed[20];
+        for (size_t i = 0; i < n; ++i) {
+            reversed[i] = digits[n - 1 - i];
+        }
+        put(reversed, n);
+    }
+
+    // Наносекунды как микросекунды с тремя знаками: единица времени трассы Chrome
+    void put_us(uint64_t ns) {
+        put_uint(ns / 1000);
+        char fraction[4] = { '.', static_cast<char>('0' + ns / 100 % 10), static_cast<char>('0' + ns / 10 % 10),
+            static_cast<char>('0' + ns % 10) };
+        put(fraction, sizeof(fraction));
+    }
+
+    // Строка JSON: кавычки, обратная косая и управляющие символы имени потока заменяются
+    void put_string(const char* text) {
+        put("\"");
+        for (const char* c = text; *c; ++c) {
+            char safe = (*c == '"' || *c == '\\' || static_cast<unsigned char>(*c) < 0x20) ? '_' : *c;
+            put(&safe, 1);
+        }
+        put("\"");
+    }
+
+    void flush() {
+        if (used == 0) {
+            return;
+        }
+        if (out) {
+            out->append(buffer, used);
+        }
+        else {
+            size_t written = 0;
+            while (written < used) {
+                ssize_t n = write(fd, buffer + written, used - written);
+                if (n < 0 && errno == EINTR) {
+                    continue;
+                }
+                if (n <= 0) {
+                    failed = true;
+                    break;
+                }
+                written += static_cast<size_t>(n);
+            }
+        }
+        used = 0;
+    }
+
+    bool failed = false;
+
+private:
+    std::string* out;
+    int fd;
+    char buffer[4096];
+    size_t used = 0;
+};
+
+// Конструктор: кольца выделяются при первом событии каждого потока
+FlightRecorder::FlightRecorder(size_t events_per_thread)
+    : capacity([events_per_thread]() {
+        size_t size = 1;
+        while (size < events_per_thread) {
+            size <<= 1;
+        }
+        return size;
+    }()),
+    id(next_recorder_id.fetch_add(1)), start_ticks(now()), start_time(std::chrono::steady_clock::now()) {
+}
+
+FlightRecorder::~FlightRecorder() = default;
+
+// Находит или регистрирует кольцо потока. Поток, писавший в другой самописец, ищет своё кольцо по tid
+FlightRecorder::Ring* FlightRecorder::ring_of_current_thread() {
+    if (thread_ring_cache.recorder_id == id) {
+        return static_cast<Ring*>(thread_ring_cache.ring);
+    }
+    int tid = static_cast<int>(syscall(SYS_gettid));
+    std::lock_guard<std::mutex> lock(registry_mutex);
+    Ring* ring = nullptr;
+    size_t count = ring_count.load(std::memory_order_relaxed);
+    for (size_t i = 0; i < count; ++i) {
+        if (rings[i]->tid == tid) {
+            ring = rings[i].get();
+            break;
+        }
+    }
+    if (!ring && count < MAX_THREADS) {
+        auto created = std::make_unique<Ring>();
+        created->tid = tid;
+        pthread_getname_np(pthread_self(), created->name, sizeof(created->name));
+        created->slots = std::make_unique<Slot[]>(capacity);
+        ring = created.get();
+        rings[count] = std::move(created);
+        ring_count.store(count + 1, std::memory_order_release);
+    }
+    else if (!ring) {
+        dropped_threads.fetch_add(1, std::memory_order_relaxed);
+    }
+    thread_ring_cache.recorder_id = id;
+    thread_ring_cache.ring = ring;
+    return ring;
+}
+
+// Запись слота между claimed и published; барьер release после claimed упорядочивает
+// его перед полями слота для читателя, который проверяет claimed после чтения полей
+void FlightRecorder::record(FlightEvent event, uint64_t start, uint64_t end, uint64_t value) {
+    Ring* ring = ring_of_current_thread();
+    if (!ring) {
+        return;
+    }
+    uint64_t index = ring->claimed.load(std::memory_order_relaxed);
+    ring->claimed.store(index + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    Slot& slot = ring->slots[index & (capacity - 1)];
+    slot.start.store(start, std::memory_order_relaxed);
+    slot.end.store(end, std::memory_order_relaxed);
+    slot.value.store(value, std::memory_order_relaxed);
+    slot.event.store(static_cast<uint32_t>(event), std::memory_order_relaxed);
+    ring->published.store(index + 1, std::memory_order_release);
+}
+
+// События всех колец. Такты переводятся в наносекунды по двум точкам: создание самописца и момент выгрузки
+void FlightRecorder::write_trace(TraceOutput& output, int64_t last_ms) const {
+    uint64_t now_ticks = now();
+    auto now_time = std::chrono::steady_clock::now();
+    // Сразу после запуска интервал слишком короткий для калибровки: ждём миллисекунду
+    while (now_time - start_time < std::chrono::milliseconds(1)) {
+        now_ticks = now();
+        now_time = std::chrono::steady_clock::now();
+    }
+    double elapsed_ns = static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(now_time - start_time).count());
+    double ns_per_tick = now_ticks > start_ticks ? elapsed_ns / static_cast<double>(now_ticks - start_ticks) : 1.0;
+    uint64_t cutoff = start_ticks;
+    if (last_ms > 0) {
+        uint64_t window_ticks = static_cast<uint64_t>(static_cast<double>(last_ms) * 1e6 / ns_per_tick);
+        cutoff = std::max(start_ticks, now_ticks > window_ticks ? now_ticks - window_ticks : 0);
+    }
+    auto to_ns = [this, ns_per_tick](uint64_t ticks) {
+        return static_cast<uint64_t>(static_cast<double>(ticks - start_ticks) * ns_per_tick);
+    };
+    uint64_t pid = static_cast<uint64_t>(getpid());
+
+    output.put("{\"displayTimeUnit\":\"ns\",\"otherData\":{\"events_per_thread\":");
+    output.put_uint(capacity);
+    output.put("},\"traceEvents\":[");
+    bool first = true;
+    size_t count = ring_count.load(std::memory_order_acquire);
+    for (size_t r = 0; r < count; ++r) {
+        const Ring& ring = *rings[r];
+        output.put(first ? "\n" : ",\n");
+        first = false;
+        output.put("{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":");
+        output.put_uint(pid);
+        output.put(",\"tid\":");
+        output.put_uint(static_cast<uint64_t>(ring.tid));
+        output.put(",\"args\":{\"name\":");
+        output.put_string(ring.name[0] ? ring.name : "thread");
+        output.put("}}");
+
+        uint64_t published = ring.published.load(std::memory_order_acquire);
+        uint64_t begin = published > capacity ? published - capacity : 0;
+        for (uint64_t index = begin; index < published; ++index) {
+            const Slot& slot = ring.slots[index & (capacity - 1)];
+            uint64_t start = slot.start.load(std::memory_order_relaxed);
+            uint64_t end = slot.end.load(std::memory_order_relaxed);
+            uint64_t value = slot.value.load(std::memory_order_relaxed);
+            uint32_t event = slot.event.load(std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_acquire);
+            // Писатель уже занял слот этого события под более новое: прочитанное могло смешаться
+            if (ring.claimed.load(std::memory_order_relaxed) > index + capacity) {
+                continue;
+            }
+            if (event >= EVENT_COUNT || start < cutoff) {
+                continue;
+            }
+            output.put(",\n{\"name\":\"");
+            output.put(EVENT_NAMES[event]);
+            output.put("\",\"cat\":\"pgw\",\"ph\":");
+            output.put(end != 0 ? "\"X\"" : "\"i\",\"s\":\"t\"");
+            output.put(",\"ts\":");
+            output.put_us(to_ns(start));
+            if (end != 0) {
+                output.put(",\"dur\":");
+                output.put_us(end > start ? to_ns(end) - to_ns(start) : 0);
+            }
+            output.put(",\"pid\":");
+            output.put_uint(pid);
+            output.put(",\"tid\":");
+            output.put_uint(static_cast<uint64_t>(ring.tid));
+            if (VALUE_NAMES[event]) {
+                output.put(",\"args\":{\"");
+                output.put(VALUE_NAMES[event]);
+                output.put("\":");
+                output.put_uint(value);
+                output.put("}");
+            }
+            output.put("}");
+        }
+    }
+    output.put("\n]}\n");
+}
+
+// Трасса в строку
+std::string FlightRecorder::chrome_trace(int64_t last_ms) const {
+    std::string trace;
+    {
+        TraceOutput output(&trace);
+        write_trace(output, last_ms);
+    }
+    return trace;
+}
+
+// Трасса в файл: только open/write/close и буфер на стеке
+bool FlightRecorder::dump(const char* path) const {
+    int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        return false;
+    }
+    bool ok;
+    {
+        TraceOutput output(fd);
+        write_trace(output, 0);
+        output.flush();
+        ok = !output.failed;
+    }
+    return close(fd) == 0 && ok;
+}
+
+// Сводка для /trace/status
+std::string FlightRecorder::report() const {
+    size_t count = ring_count.load(std::memory_order_acquire);
+    uint64_t recorded = 0;
+    for (size_t r = 0; r < count; ++r) {
+        recorded += rings[r]->published.load(std::memory_order_relaxed);
+    }
+    return "events_per_thread=" + std::to_string(capacity) + "\n" +
+        "threads=" + std::to_string(count) + "\n" +
+        "recorded=" + std::to_string(recorded) + "\n" +
+        "dropped_threads=" + std::to_string(dropped_threads.load(std::memory_order_relaxed)) + "\n";
+}
+
+// Ставит обработчики аварийных сигналов
+void FlightRecorder::install_crash_handler(std::shared_ptr<FlightRecorder> recorder, const std::string& path) {
+    if (path.size() >= sizeof(crash_path)) {
+        throw std::invalid_argument("Flight recorder dump path too long: " + path);
+    }
+    memcpy(crash_path, path.c_str(), path.size() + 1);
+    crash_recorder_owner = recorder;
+    crash_recorder.store(recorder.get());
+    struct sigaction action = {};
+    action.sa_handler = on_fatal_signal;
+    sigemptyset(&action.sa_mask);
+    action.sa_flags = SA_RESETHAND;
+    for (int signal_number : { SIGSEGV, SIGBUS, SIGFPE, SIGILL, SIGABRT }) {
+        sigaction(signal_number, &action, nullptr);
+    }
+}
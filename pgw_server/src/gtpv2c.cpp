@@ -0,0 +1,333 @@
+#include "gtpv2c.hpp"
+#include <cstring>
+
+namespace gtpv2c {
+
+namespace {
+
+uint16_t read_u16(const uint8_t* p) {
+    return static_cast<uint16_t>((p[0] << 8) | p[1]);
+}
+
+uint32_t read_u24(const uint8_t* p) {
+    return (static_cast<uint32_t>(p[0]) << 16) | (static_cast<uint32_t>(p[1]) << 8) | p[2];
+}
+
+uint32_t read_u32(const uint8_t* p) {
+    return (static_cast<uint32_t>(p[0]) << 24) | (static_cast<uint32_t>(p[1]) << 16) |
+           (static_cast<uint32_t>(p[2]) << 8) | p[3];
+}
+
+void write_u16(uint8_t* p, uint16_t v) {
+    p[0] = static_cast<uint8_t>(v >> 8);
+    p[1] = static_cast<uint8_t>(v);
+}
+
+void write_u24(uint8_t* p, uint32_t v) {
+    p[0] = static_cast<uint8_t>(v >> 16);
+    p[1] = static_cast<uint8_t>(v >> 8);
+    p[2] = static_cast<uint8_t>(v);
+}
+
+void write_u32(uint8_t* p, uint32_t v) {
+    p[0] = static_cast<uint8_t>(v >> 24);
+    p[1] = static_cast<uint8_t>(v >> 16);
+    p[2] = static_cast<uint8_t>(v >> 8);
+    p[3] = static_cast<uint8_t>(v);
+}
+
+} // namespace
+
+// Разбирает заголовок (§5.5) и перебирает IE, запоминая первые экземпляры нужных типов
+ParseResult parse(const uint8_t* data, size_t length, MessageView& message) {
+    message = MessageView();
+    if (length < HEADER_SIZE_NO_TEID) {
+        return ParseResult::TOO_SHORT;
+    }
+    if ((data[0] >> 5) != VERSION) {
+        return ParseResult::BAD_VERSION;
+    }
+    bool has_teid = (data[0] & 0x08) != 0;
+    size_t header_size = has_teid ? HEADER_SIZE : HEADER_SIZE_NO_TEID;
+    if (length < header_size) {
+        return ParseResult::TOO_SHORT;
+    }
+    // Поле длины не включает первые 4 октета; хвост сверх длины (piggyback) игнорируется
+    size_t total = static_cast<size_t>(read_u16(data + 2)) + 4;
+    if (total < header_size || total > length) {
+        return ParseResult::BAD_LENGTH;
+    }
+
+    message.type = data[1];
+    message.has_teid = has_teid;
+    message.teid = has_teid ? read_u32(data + 4) : 0;
+    message.sequence = read_u24(data + (has_teid ? 8 : 4));
+    message.data = data;
+    message.length = total;
+
+    size_t pos = header_size;
+    while (pos < total) {
+        if (total - pos < IE_HEADER_SIZE) {
+            return ParseResult::BAD_IE;
+        }
+        uint8_t type = data[pos];
+        uint16_t ie_length = read_u16(data + pos + 1);
+        uint8_t instance = data[pos + 3] & 0x0F;
+        if (total - pos - IE_HEADER_SIZE < ie_length) {
+            return ParseResult::BAD_IE;
+        }
+        IEView ie;
+        ie.value = data + pos + IE_HEADER_SIZE;
+        ie.length = ie_length;
+        if (instance == 0) {
+            if (type == IE_IMSI && !message.imsi.present()) message.imsi = ie;
+            else if (type == IE_CAUSE && !message.cause.present()) message.cause = ie;
+            else if (type == IE_FTEID && !message.fteid.present()) message.fteid = ie;
+            else if (type == IE_PAA && !message.paa.present()) message.paa = ie;
+        }
+        pos += IE_HEADER_SIZE + ie_length;
+    }
+    return ParseResult::OK;
+}
+
+// TBCD (§8.3): младшая тетрада — первая цифра, 0xF в старшей — заполнитель
+size_t decode_imsi(const IEView& ie, char* out, size_t capacity) {
+    if (!ie.present() || ie.length == 0) {
+        return 0;
+    }
+    size_t count = 0;
+    for (uint16_t i = 0; i < ie.length; ++i) {
+        uint8_t digits[2] = { static_cast<uint8_t>(ie.value[i] & 0x0F), static_cast<uint8_t>(ie.value[i] >> 4) };
+        for (int half = 0; half < 2; ++half) {
+            if (digits[half] == 0x0F) {
+                // Заполнитель допустим только в старшей тетраде последнего октета
+                return (half == 1 && i + 1 == ie.length) ? count : 0;
+            }
+            if (digits[half] > 9 || count >= capacity || count >= MAX_IMSI_DIGITS) {
+                return 0;
+            }
+            out[count++] = static_cast<char>('0' + digits[half]);
+        }
+    }
+    return count;
+}
+
+// Cause (§8.4): первый октет — значение, второй — флаги
+bool decode_cause(const IEView& ie, uint8_t& cause) {
+    if (!ie.present() || ie.length < 2) {
+        return false;
+    }
+    cause = ie.value[0];
+    return true;
+}
+
+// F-TEID (§8.22): флаги V4/V6 и тип интерфейса, TEID, затем адреса
+bool decode_fteid(const IEView& ie, FTEID& fteid) {
+    if (!ie.present() || ie.length < 5) {
+        return false;
+    }
+    fteid = FTEID();
+    bool v4 = (ie.value[0] & 0x80) != 0;
+    bool v6 = (ie.value[0] & 0x40) != 0;
+    fteid.interface_type = ie.value[0] & 0x3F;
+    fteid.teid = read_u32(ie.value + 1);
+    size_t pos = 5;
+    if (v4) {
+        if (ie.length < pos + 4) {
+            return false;
+        }
+        std::memcpy(&fteid.ipv4, ie.value + pos, 4);
+        fteid.has_ipv4 = true;
+        pos += 4;
+    }
+    if (v6) {
+        if (ie.length < pos + 16) {
+            return false;
+        }
+        fteid.ipv6 = ie.value + pos;
+    }
+    return true;
+}
+
+// PAA (§8.14): тип PDN, затем длина префикса и IPv6 и/или IPv4
+bool decode_paa(const IEView& ie, PAA& paa) {
+    if (!ie.present() || ie.length < 1) {
+        return false;
+    }
+    paa = PAA();
+    uint8_t pdn_type = ie.value[0] & 0x07;
+    size_t pos = 1;
+    if (pdn_type == PDN_IPV6 || pdn_type == PDN_IPV4V6) {
+        if (ie.length < pos + 17) {
+            return false;
+        }
+        paa.ipv6_prefix_length = ie.value[pos];
+        paa.ipv6 = ie.value + pos + 1;
+        pos += 17;
+    }
+    if (pdn_type == PDN_IPV4 || pdn_type == PDN_IPV4V6) {
+        if (ie.length < pos + 4) {
+            return false;
+        }
+        std::memcpy(&paa.ipv4, ie.value + pos, 4);
+        paa.has_ipv4 = true;
+    }
+    return paa.has_ipv4 || paa.ipv6;
+}
+
+// Конструктор: буфер принадлежит вызывающей стороне
+Writer::Writer(uint8_t* buffer, size_t capacity) : buffer(buffer), capacity(capacity) {
+}
+
+// Пишет заголовок с флагом T; длина проставляется в finish()
+void Writer::begin(uint8_t type, uint32_t teid, uint32_t sequence) {
+    size = 0;
+    overflow = capacity < HEADER_SIZE;
+    if (overflow) {
+        return;
+    }
+    buffer[0] = static_cast<uint8_t>((VERSION << 5) | 0x08);
+    buffer[1] = type;
+    write_u16(buffer + 2, 0);
+    write_u32(buffer + 4, teid);
+    write_u24(buffer + 8, sequence);
+    buffer[11] = 0;
+    size = HEADER_SIZE;
+}
+
+// Резервирует место под IE и пишет его заголовок; nullptr при нехватке места
+uint8_t* Writer::reserve_ie(uint8_t type, uint16_t length, uint8_t instance) {
+    if (overflow || capacity - size < IE_HEADER_SIZE + static_cast<size_t>(length)) {
+        overflow = true;
+        return nullptr;
+    }
+    uint8_t* p = buffer + size;
+    p[0] = type;
+    write_u16(p + 1, length);
+    p[3] = instance & 0x0F;
+    size += IE_HEADER_SIZE + length;
+    return p + IE_HEADER_SIZE;
+}
+
+void Writer::add_imsi(const char* digits, size_t count) {
+    if (count == 0 || count > MAX_IMSI_DIGITS) {
+        overflow = true;
+        return;
+    }
+    uint8_t* value = reserve_ie(IE_IMSI, static_cast<uint16_t>((count + 1) / 2), 0);
+    if (!value) {
+        return;
+    }
+    for (size_t i = 0; i < count; i += 2) {
+        uint8_t low = static_cast<uint8_t>(digits[i] - '0');
+        uint8_t high = (i + 1 < count) ? static_cast<uint8_t>(digits[i + 1] - '0') : 0x0F;
+        if (low > 9 || high > 0x0F || (high > 9 && high != 0x0F)) {
+            overflow = true;
+            return;
+        }
+        value[i / 2] = static_cast<uint8_t>((high << 4) | low);
+    }
+}
+
+void Writer::add_cause(uint8_t cause) {
+    uint8_t* value = reserve_ie(IE_CAUSE, 2, 0);
+    if (!value) {
+        return;
+    }
+    value[0] = cause;
+    value[1] = 0;
+}
+
+void Writer::add_fteid(const FTEID& fteid, uint8_t instance) {
+    uint16_t length = static_cast<uint16_t>(5 + (fteid.has_ipv4 ? 4 : 0) + (fteid.ipv6 ? 16 : 0));
+    uint8_t* value = reserve_ie(IE_FTEID, length, instance);
+    if (!value) {
+        return;
+    }
+    value[0] = static_cast<uint8_t>((fteid.has_ipv4 ? 0x80 : 0) | (fteid.ipv6 ? 0x40 : 0) | (fteid.interface_type & 0x3F));
+    write_u32(value + 1, fteid.teid);
+    size_t pos = 5;
+    if (fteid.has_ipv4) {
+        std::memcpy(value + pos, &fteid.ipv4, 4);
+        pos += 4;
+    }
+    if (fteid.ipv6) {
+        std::memcpy(value + pos, fteid.ipv6, 16);
+    }
+}
+
+void Writer::add_paa(const PAA& paa) {
+    if (!paa.has_ipv4 && !paa.ipv6) {
+        overflow = true;
+        return;
+    }
+    uint16_t length = static_cast<uint16_t>(1 + (paa.ipv6 ? 17 : 0) + (paa.has_ipv4 ? 4 : 0));
+    uint8_t* value = reserve_ie(IE_PAA, length, 0);
+    if (!value) {
+        return;
+    }
+    value[0] = paa.has_ipv4 && paa.ipv6 ? PDN_IPV4V6 : paa.ipv6 ? PDN_IPV6 : PDN_IPV4;
+    size_t pos = 1;
+    if (paa.ipv6) {
+        value[pos] = paa.ipv6_prefix_length;
+        std::memcpy(value + pos + 1, paa.ipv6, 16);
+        pos += 17;
+    }
+    if (paa.has_ipv4) {
+        std::memcpy(value + pos, &paa.ipv4, 4);
+    }
+}
+
+size_t Writer::finish() {
+    if (overflow || size < HEADER_SIZE) {
+        return 0;
+    }
+    write_u16(buffer + 2, static_cast<uint16_t>(size - 4));
+    return size;
+}
+
+// Create Session Request: TEID заголовка 0, F-TEID отправителя для ответа
+size_t encode_create_session_request(uint8_t* buffer, size_t capacity, uint32_t sequence,
+                                     const char* imsi, size_t imsi_length, const FTEID& sender) {
+    Writer writer(buffer, capacity);
+    writer.begin(CREATE_SESSION_REQUEST, 0, sequence);
+    writer.add_imsi(imsi, imsi_length);
+    writer.add_fteid(sender);
+    return writer.finish();
+}
+
+// Create Session Response: TEID заголовка — TEID отправителя запроса
+size_t encode_create_session_response(uint8_t* buffer, size_t capacity, uint32_t peer_teid, uint32_t sequence,
+                                      uint8_t cause, const FTEID* pgw_fteid, const PAA* paa) {
+    Writer writer(buffer, capacity);
+    writer.begin(CREATE_SESSION_RESPONSE, peer_teid, sequence);
+    writer.add_cause(cause);
+    if (pgw_fteid) {
+        writer.add_fteid(*pgw_fteid, 1);
+    }
+    if (paa) {
+        writer.add_paa(*paa);
+    }
+    return writer.finish();
+}
+
+// Delete Session Request: сессия определяется по IMSI
+size_t encode_delete_session_request(uint8_t* buffer, size_t capacity, uint32_t teid, uint32_t sequence,
+                                     const char* imsi, size_t imsi_length) {
+    Writer writer(buffer, capacity);
+    writer.begin(DELETE_SESSION_REQUEST, teid, sequence);
+    if (imsi_length > 0) {
+        writer.add_imsi(imsi, imsi_length);
+    }
+    return writer.finish();
+}
+
+size_t encode_delete_session_response(uint8_t* buffer, size_t capacity, uint32_t peer_teid, uint32_t sequence,
+                                      uint8_t cause) {
+    Writer writer(buffer, capacity);
+    writer.begin(DELETE_SESSION_RESPONSE, peer_teid, sequence);
+    writer.add_cause(cause);
+    return writer.finish();
+}
+
+} // namespace gtpv2c
\ No newline at end of file
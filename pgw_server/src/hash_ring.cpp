@@ -0,0 +1,46 @@
+#include "hash_ring.hpp"
+#include <algorithm>
+#include <stdexcept>
+
+// Конструктор: раскладывает виртуальные точки всех узлов и сортирует кольцо
+HashRing::HashRing(const std::vector<std::string>& nodes) : node_count(nodes.size()) {
+    if (nodes.empty()) {
+        throw std::runtime_error("Hash ring requires at least one node");
+    }
+    points.reserve(nodes.size() * VIRTUAL_NODES);
+    for (size_t node = 0; node < nodes.size(); ++node) {
+        for (size_t i = 0; i < VIRTUAL_NODES; ++i) {
+            points.push_back(Point{ hash(nodes[node] + "#" + std::to_string(i)), node });
+        }
+    }
+    std::sort(points.begin(), points.end(), [](const Point& a, const Point& b) {
+        return a.position < b.position || (a.position == b.position && a.node < b.node);
+    });
+}
+
+// FNV-1a даёт слабые младшие биты на коротких ключах, поэтому добавлен финализатор splitmix64
+uint64_t HashRing::hash(const std::string& key) {
+    uint64_t value = 0xcbf29ce484222325ULL;
+    for (unsigned char c : key) {
+        value ^= c;
+        value *= 0x100000001b3ULL;
+    }
+    value ^= value >> 30;
+    value *= 0xbf58476d1ce4e5b9ULL;
+    value ^= value >> 27;
+    value *= 0x94d049bb133111ebULL;
+    value ^= value >> 31;
+    return value;
+}
+
+// Владелец — первая точка кольца по часовой стрелке от хеша IMSI
+size_t HashRing::owner(const std::string& imsi) const {
+    uint64_t position = hash(imsi);
+    auto it = std::lower_bound(points.begin(), points.end(), position, [](const Point& point, uint64_t value) {
+        return point.position < value;
+    });
+    if (it == points.end()) {
+        it = points.begin();
+    }
+    return it->node;
+}
@@ -0,0 +1,199 @@
+#include "heavy_hitters.hpp"
+#include <algorithm>
+#include <cstring>
+#include <sstream>
+#include <arpa/inet.h>
+
+// Учитывает ключ: растут только счётчики, равные текущему минимуму
+uint32_t CountMinSketch::add(uint64_t hash) {
+    uint32_t current = estimate(hash);
+    uint32_t updated = current == UINT32_MAX ? current : current + 1;
+    for (size_t row = 0; row < DEPTH; ++row) {
+        uint32_t& counter = rows[row][slot(hash, row)];
+        counter = std::max(counter, updated);
+    }
+    return updated;
+}
+
+// Минимум по строкам: коллизии только завышают счётчики
+uint32_t CountMinSketch::estimate(uint64_t hash) const {
+    uint32_t result = UINT32_MAX;
+    for (size_t row = 0; row < DEPTH; ++row) {
+        result = std::min(result, rows[row][slot(hash, row)]);
+    }
+    return result;
+}
+
+// Затухание всех счётчиков
+void CountMinSketch::decay(unsigned shift) {
+    for (auto& row : rows) {
+        for (auto& counter : row) {
+            counter = shift >= 32 ? 0 : counter >> shift;
+        }
+    }
+}
+
+// Счётчик строки row: h1 + row * h2 по половинам хеша
+size_t CountMinSketch::slot(uint64_t hash, size_t row) {
+    uint32_t h1 = static_cast<uint32_t>(hash);
+    uint32_t h2 = static_cast<uint32_t>(hash >> 32) | 1;
+    return (h1 + row * h2) & (WIDTH - 1);
+}
+
+// Конструктор: пустая таблица кандидатов
+TopKTracker::TopKTracker(size_t top_k, std::chrono::seconds window)
+    : top_k(std::max<size_t>(top_k, 1)), capacity(this->top_k * CANDIDATES_PER_TOP), window(window),
+    last_decay(std::chrono::steady_clock::now()), last_publish(last_decay), snapshot_decayed_at(last_decay) {
+    candidates.reserve(capacity);
+    index.reserve(capacity * 2);
+}
+
+// Учитывает ключ в sketch и таблице кандидатов
+void TopKTracker::record(const std::string& key, std::chrono::steady_clock::time_point now) {
+    if (now - last_decay >= window) {
+        apply_decay(now);
+    }
+    uint64_t estimate = sketch.add(std::hash<std::string>{}(key));
+    ++records;
+    ++unpublished;
+
+    auto found = index.find(key);
+    if (found != index.end()) {
+        candidates[found->second].count = estimate;
+    }
+    else if (candidates.size() < capacity) {
+        index.emplace(key, candidates.size());
+        candidates.push_back({ key, estimate });
+    }
+    else {
+        // Вытесняем самого редкого кандидата, если новый ключ уже встречался чаще него
+        auto rarest = std::min_element(candidates.begin(), candidates.end(),
+            [](const Candidate& a, const Candidate& b) { return a.count < b.count; });
+        if (estimate > rarest->count) {
+            index.erase(rarest->key);
+            index.emplace(key, static_cast<size_t>(rarest - candidates.begin()));
+            rarest->key = key;
+            rarest->count = estimate;
+        }
+    }
+
+    if (unpublished >= PUBLISH_EVERY || now - last_publish >= PUBLISH_PERIOD) {
+        publish(now);
+    }
+}
+
+// Делит sketch, кандидатов и общее число записей пополам за каждое прошедшее окно
+void TopKTracker::apply_decay(std::chrono::steady_clock::time_point now) {
+    auto windows = (now - last_decay) / window;
+    if (windows <= 0) {
+        return;
+    }
+    unsigned shift = static_cast<unsigned>(std::min<int64_t>(windows, 63));
+    sketch.decay(shift);
+    for (auto& candidate : candidates) {
+        candidate.count >>= shift;
+    }
+    records >>= shift;
+    last_decay += window * windows;
+    ++unpublished;
+}
+
+// Снимок: top_k кандидатов с ненулевой частотой по убыванию
+void TopKTracker::publish(std::chrono::steady_clock::time_point now) {
+    apply_decay(now);
+    if (unpublished == 0) {
+        return;
+    }
+    std::vector<std::pair<std::string, uint64_t>> leaders;
+    leaders.reserve(candidates.size());
+    for (const auto& candidate : candidates) {
+        if (candidate.count > 0) {
+            leaders.emplace_back(candidate.key, candidate.count);
+        }
+    }
+    size_t count = std::min(top_k, leaders.size());
+    std::partial_sort(leaders.begin(), leaders.begin() + count, leaders.end(),
+        [](const auto& a, const auto& b) { return a.second > b.second || (a.second == b.second && a.first < b.first); });
+    leaders.resize(count);
+    {
+        std::lock_guard<std::mutex> lock(snapshot_mutex);
+        snapshot.swap(leaders);
+        snapshot_records = records;
+        snapshot_decayed_at = last_decay;
+    }
+    unpublished = 0;
+    last_publish = now;
+}
+
+// Сколько окон прошло с последнего затухания в снимке; вызывается под snapshot_mutex
+unsigned TopKTracker::pending_shift(std::chrono::steady_clock::time_point now) const {
+    auto windows = (now - snapshot_decayed_at) / window;
+    return windows <= 0 ? 0 : static_cast<unsigned>(std::min<int64_t>(windows, 63));
+}
+
+// Топ из снимка: если поток приёма простаивает, частоты всё равно затухают
+std::vector<std::pair<std::string, uint64_t>> TopKTracker::top(std::chrono::steady_clock::time_point now) const {
+    std::lock_guard<std::mutex> lock(snapshot_mutex);
+    unsigned shift = pending_shift(now);
+    std::vector<std::pair<std::string, uint64_t>> result;
+    for (const auto& [key, count] : snapshot) {
+        if ((count >> shift) > 0) {
+            result.emplace_back(key, count >> shift);
+        }
+    }
+    return result;
+}
+
+// Число записей из снимка с затуханием
+uint64_t TopKTracker::total(std::chrono::steady_clock::time_point now) const {
+    std::lock_guard<std::mutex> lock(snapshot_mutex);
+    return snapshot_records >> pending_shift(now);
+}
+
+// Конструктор: одинаковые размер топа и окно для пиров и IMSI
+HeavyHitters::HeavyHitters(size_t top_k, std::chrono::seconds window)
+    : window(window), peers(top_k, window), imsis(top_k, window) {
+}
+
+// Ключ пира — адрес без порта: флуд с разных портов одного узла считается вместе
+void HeavyHitters::record_peer(const struct sockaddr_in& peer, std::chrono::steady_clock::time_point now) {
+    peers.record(std::string(reinterpret_cast<const char*>(&peer.sin_addr.s_addr), sizeof(peer.sin_addr.s_addr)), now);
+}
+
+// Учитывает IMSI запроса
+void HeavyHitters::record_imsi(const std::string& imsi, std::chrono::steady_clock::time_point now) {
+    imsis.record(imsi, now);
+}
+
+// Обновляет снимки обоих списков
+void HeavyHitters::publish(std::chrono::steady_clock::time_point now) {
+    peers.publish(now);
+    imsis.publish(now);
+}
+
+// Отчёт: окно, число учтённых датаграмм и запросов, затем пары peer_N/peer_N_count и imsi_N/imsi_N_count
+std::string HeavyHitters::report() const {
+    auto now = std::chrono::steady_clock::now();
+    std::ostringstream out;
+    out << "window_sec=" << window.count() << "\n"
+        << "top_k=" << peers.get_top_k() << "\n"
+        << "peer_total=" << peers.total(now) << "\n"
+        << "imsi_total=" << imsis.total(now) << "\n";
+    size_t rank = 0;
+    for (const auto& [key, count] : peers.top(now)) {
+        struct in_addr address;
+        memcpy(&address.s_addr, key.data(), sizeof(address.s_addr));
+        char text[INET_ADDRSTRLEN];
+        inet_ntop(AF_INET, &address, text, sizeof(text));
+        ++rank;
+        out << "peer_" << rank << "=" << text << "\n"
+            << "peer_" << rank << "_count=" << count << "\n";
+    }
+    rank = 0;
+    for (const auto& [key, count] : imsis.top(now)) {
+        ++rank;
+        out << "imsi_" << rank << "=" << key << "\n"
+            << "imsi_" << rank << "_count=" << count << "\n";
+    }
+    return out.str();
+}
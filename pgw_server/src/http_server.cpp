@@ -1,85 +1,621 @@
-#include "http_server.hpp"
-#include <thread>
-#include <chrono>
-#include <sstream>
-
-// :  HTTP-  
-HTTPServer::HTTPServer(const Config& config, std::shared_ptr<ILogger> logger,
-    std::shared_ptr<ISessionManager> session_manager, std::function<void()> stop_callback,
-    std::atomic<bool>& running)
-    : config(config), logger(logger), session_manager(session_manager), stop_callback(stop_callback),
-    running(running), running_local(false) {
-    server = std::make_unique<httplib::Server>();
-
-    //   HTTP-
-    server->Get("/check_subscriber", [this](const httplib::Request& req, httplib::Response& res) {
-        handle_check_subscriber(req, res);
-        });
-    server->Get("/stop", [this](const httplib::Request& req, httplib::Response& res) {
-        handle_stop(req, res);
-        });
-
-    logger->info("HTTP Server initialized on port: {}", std::to_string(config.get_http_port()));
-}
-
-// :  
-HTTPServer::~HTTPServer() {
-    stop();
-}
-
-//  HTTP-   
-void HTTPServer::run() {
-    running_local = true;
-    logger->info("Starting HTTP Server on port: {}", std::to_string(config.get_http_port()));
-
-    server_thread = std::thread([this]() {
-        if (!server->listen("0.0.0.0", config.get_http_port())) {
-            logger->error("Failed to start HTTP server on port: {}", std::to_string(config.get_http_port()));
-        }
-        });
-}
-
-//  HTTP-   
-void HTTPServer::stop() {
-    if (running_local) {
-        running_local = false;
-        server->stop();
-        session_manager->stop();
-        stop_callback(); //     (,  UDP-)
-
-        if (server_thread.joinable()) {
-            server_thread.join();
-        }
-
-        logger->info("HTTP Server stopped");
-        logger->flush(); //  
-    }
-}
-
-//   /check_subscriber
-void HTTPServer::handle_check_subscriber(const httplib::Request& req, httplib::Response& res) {
-    auto imsi = req.get_param_value("imsi");
-    if (imsi.empty()) {
-        res.status = 400;
-        res.set_content("Missing IMSI parameter", "text/plain");
-        logger->warn("Check subscriber request failed: missing IMSI");
-        return;
-    }
-
-    bool has_session = session_manager->has_session(imsi);
-    std::string result = has_session ? "active" : "not active";
-    res.set_content(result, "text/plain");
-    logger->info("Check subscriber request", "IMSI: " + imsi + ", result: " + result); // 
-}
-
-//   /stop
-void HTTPServer::handle_stop(const httplib::Request& req, httplib::Response& res) {
-    res.set_content("Stopping server...", "text/plain");
-    logger->info("Received stop request");
-
-    running = false;
-    std::thread([this]() {
-        std::this_thread::sleep_for(std::chrono::milliseconds(50));
-        stop();
-        }).detach();
+#include "http_server.hpp"
+#include "lock_profiler.hpp"
+#include <thread>
+#include <chrono>
+#include <sstream>
+#include <stdexcept>
+
+// Конструктор: инициализирует HTTP-сервер с зависимостями
+HTTPServer::HTTPServer(const Config& config, std::shared_ptr<ILogger> logger,
+    std::shared_ptr<ISessionManager> session_manager, std::function<void()> stop_callback,
+    std::atomic<bool>& running)
+    : config(config), logger(logger), session_manager(session_manager), stop_callback(stop_callback),
+    running(running), running_local(false) {
+    server = std::make_unique<httplib::Server>();
+
+    // Регистрируем обработчики HTTP-запросов
+    server->Get("/check_subscriber", [this](const httplib::Request& req, httplib::Response& res) {
+        handle_check_subscriber(req, res);
+        });
+    server->Get("/delete_session", [this](const httplib::Request& req, httplib::Response& res) {
+        handle_delete_session(req, res);
+        });
+    server->Get("/delete_sessions", [this](const httplib::Request& req, httplib::Response& res) {
+        handle_delete_sessions(req, res);
+        });
+    server->Post("/delete_sessions", [this](const httplib::Request& req, httplib::Response& res) {
+        handle_delete_sessions(req, res);
+        });
+    server->Get("/stop", [this](const httplib::Request& req, httplib::Response& res) {
+        handle_stop(req, res);
+        });
+    server->Get("/admission", [this](const httplib::Request& req, httplib::Response& res) {
+        handle_admission(req, res);
+        });
+    server->Get("/admission/set", [this](const httplib::Request& req, httplib::Response& res) {
+        handle_admission_set(req, res);
+        });
+    server->Get("/cluster", [this](const httplib::Request& req, httplib::Response& res) {
+        handle_cluster(req, res);
+        });
+    server->Get("/replication", [this](const httplib::Request& req, httplib::Response& res) {
+        handle_replication(req, res);
+        });
+    server->Get("/replication/takeover", [this](const httplib::Request& req, httplib::Response& res) {
+        handle_replication_takeover(req, res);
+        });
+    server->Get("/workers", [this](const httplib::Request& req, httplib::Response& res) {
+        handle_workers(req, res);
+        });
+    server->Get("/latency", [this](const httplib::Request& req, httplib::Response& res) {
+        handle_latency(req, res);
+        });
+    server->Get("/heavy_hitters", [this](const httplib::Request& req, httplib::Response& res) {
+        handle_heavy_hitters(req, res);
+        });
+    server->Get("/session_events", [this](const httplib::Request& req, httplib::Response& res) {
+        handle_session_events(req, res);
+        });
+    server->Get("/session_events/stats", [this](const httplib::Request& req, httplib::Response& res) {
+        handle_session_events_stats(req, res);
+        });
+    server->Get("/sessions/export", [this](const httplib::Request& req, httplib::Response& res) {
+        handle_sessions_export(req, res);
+        });
+    server->Get("/config", [this](const httplib::Request& req, httplib::Response& res) {
+        handle_config(req, res);
+        });
+    server->Post("/config/reload", [this](const httplib::Request& req, httplib::Response& res) {
+        handle_config_change(req, res, false);
+        });
+    server->Post("/config/rollback", [this](const httplib::Request& req, httplib::Response& res) {
+        handle_config_change(req, res, true);
+        });
+    server->Get("/capture", [this](const httplib::Request& req, httplib::Response& res) {
+        handle_capture(req, res);
+        });
+    server->Get("/capture/start", [this](const httplib::Request& req, httplib::Response& res) {
+        handle_capture_start(req, res);
+        });
+    server->Get("/capture/stop", [this](const httplib::Request& req, httplib::Response& res) {
+        handle_capture_stop(req, res);
+        });
+    server->Get("/capture/pcap", [this](const httplib::Request& req, httplib::Response& res) {
+        handle_capture_pcap(req, res);
+        });
+    server->Get("/trace", [this](const httplib::Request& req, httplib::Response& res) {
+        handle_trace(req, res);
+        });
+    server->Get("/trace/status", [this](const httplib::Request& req, httplib::Response& res) {
+        handle_trace_status(req, res);
+        });
+    server->Get("/locks", [this](const httplib::Request& req, httplib::Response& res) {
+        handle_locks(req, res);
+        });
+
+    logger->info("HTTP Server initialized on port: {}", std::to_string(config.get_http_port()));
+}
+
+// Деструктор: останавливает сервер
+HTTPServer::~HTTPServer() {
+    stop();
+}
+
+// Занимает порт и запускает HTTP-сервер в отдельном потоке
+void HTTPServer::run() {
+    logger->info("Starting HTTP Server on port: {}", std::to_string(config.get_http_port()));
+    // Порт занимается до возврата: после run() сервер уже принимает соединения
+    if (!server->bind_to_port("0.0.0.0", config.get_http_port())) {
+        logger->error("Failed to start HTTP server on port: {}", std::to_string(config.get_http_port()));
+        throw std::runtime_error("Failed to bind HTTP port " + std::to_string(config.get_http_port()));
+    }
+    running_local = true;
+
+    server_thread = std::thread([this]() {
+        server->listen_after_bind();
+        });
+}
+
+// Останавливает HTTP-сервер и все зависимости
+void HTTPServer::stop() {
+    // Остановку могут вызвать одновременно /stop и main: второй вызов ждёт завершения первого,
+    // чтобы main не разрушил сервер, пока /stop ещё останавливает компоненты
+    std::lock_guard<std::mutex> lock(stop_mutex);
+    if (running_local) {
+        running_local = false;
+        // Закрываем поток событий, чтобы открытые подписки завершились, не дожидаясь keepalive
+        if (session_events) {
+            session_events->close();
+        }
+        server->stop();
+        session_manager->stop();
+        stop_callback(); // Вызываем внешнюю функцию остановки (например, для UDP-сервера)
+
+        if (server_thread.joinable()) {
+            server_thread.join();
+        }
+
+        logger->info("HTTP Server stopped");
+        logger->flush(); // Гарантируем запись
+    }
+}
+
+// Обрабатывает запрос /check_subscriber
+void HTTPServer::handle_check_subscriber(const httplib::Request& req, httplib::Response& res) {
+    auto imsi = req.get_param_value("imsi");
+    if (imsi.empty()) {
+        res.status = 400;
+        res.set_content("Missing IMSI parameter", "text/plain");
+        logger->warn("Check subscriber request failed: missing IMSI");
+        return;
+    }
+
+    bool has_session = session_manager->has_session(imsi);
+    std::string result = has_session ? "active" : "not active";
+    res.set_content(result, "text/plain");
+    logger->info("Check subscriber request", "IMSI: " + imsi + ", result: " + result); // Конкатенация
+}
+
+// Обрабатывает запрос /delete_session?imsi=<IMSI>
+void HTTPServer::handle_delete_session(const httplib::Request& req, httplib::Response& res) {
+    auto imsi = req.get_param_value("imsi");
+    if (imsi.empty()) {
+        res.status = 400;
+        res.set_content("Missing IMSI parameter", "text/plain");
+        logger->warn("Delete session request failed: missing IMSI");
+        return;
+    }
+
+    bool deleted = session_manager->delete_session(imsi);
+    std::string result = deleted ? "deleted" : "not found";
+    if (!deleted) {
+        res.status = 404;
+    }
+    res.set_content(result, "text/plain");
+    logger->info("Delete session request", "IMSI: " + imsi + ", result: " + result);
+}
+
+// Обрабатывает запрос /delete_sessions: GET ?imsi=<IMSI>,<IMSI>,... или POST со списком в теле.
+// IMSI разделяются запятыми или пробельными символами
+void HTTPServer::handle_delete_sessions(const httplib::Request& req, httplib::Response& res) {
+    std::string list = req.has_param("imsi") ? req.get_param_value("imsi") : req.body;
+    for (auto& c : list) {
+        if (c == ',') c = ' ';
+    }
+    std::vector<std::string> imsis;
+    std::stringstream ss(list);
+    std::string imsi;
+    while (ss >> imsi) {
+        imsis.push_back(imsi);
+    }
+    if (imsis.empty()) {
+        res.status = 400;
+        res.set_content("Missing IMSI list", "text/plain");
+        logger->warn("Batch delete request failed: empty IMSI list");
+        return;
+    }
+
+    size_t deleted = session_manager->delete_sessions(imsis);
+    std::stringstream result;
+    result << "requested=" << imsis.size() << "\n"
+           << "deleted=" << deleted << "\n";
+    res.set_content(result.str(), "text/plain");
+    logger->info("Batch delete request", "requested: " + std::to_string(imsis.size()) +
+        ", deleted: " + std::to_string(deleted));
+}
+
+// Обрабатывает запрос /stop
+void HTTPServer::handle_stop(const httplib::Request& req, httplib::Response& res) {
+    res.set_content("Stopping server...", "text/plain");
+    logger->info("Received stop request");
+
+    running = false;
+    if (shutdown_handler) {
+        shutdown_handler();
+        return;
+    }
+    std::thread([this]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        stop();
+        }).detach();
+}
+
+// Подключает обработчик /stop
+void HTTPServer::set_shutdown_handler(std::function<void()> shutdown_handler) {
+    this->shutdown_handler = shutdown_handler;
+}
+
+// Подключает контроль допуска UDP-сервера
+void HTTPServer::set_admission_control(std::shared_ptr<AdmissionControl> admission_control) {
+    this->admission_control = admission_control;
+}
+
+// Обрабатывает запрос /admission
+void HTTPServer::handle_admission(const httplib::Request& req, httplib::Response& res) {
+    if (!admission_control) {
+        res.status = 503;
+        res.set_content("Admission control not available", "text/plain");
+        return;
+    }
+    res.set_content(admission_control->report(), "text/plain");
+}
+
+// Обрабатывает запрос /admission/set?rate=<N>&burst=<N>&max_queue=<N>; не указанные параметры не меняются
+void HTTPServer::handle_admission_set(const httplib::Request& req, httplib::Response& res) {
+    if (!admission_control) {
+        res.status = 503;
+        res.set_content("Admission control not available", "text/plain");
+        return;
+    }
+
+    double rate = admission_control->get_rate_per_sec();
+    double burst = admission_control->get_burst();
+    long long max_queue = static_cast<long long>(admission_control->get_max_queue_depth());
+    try {
+        if (req.has_param("rate")) rate = std::stod(req.get_param_value("rate"));
+        if (req.has_param("burst")) burst = std::stod(req.get_param_value("burst"));
+        if (req.has_param("max_queue")) max_queue = std::stoll(req.get_param_value("max_queue"));
+    }
+    catch (const std::exception&) {
+        res.status = 400;
+        res.set_content("Invalid admission parameter", "text/plain");
+        logger->warn("Admission update failed: invalid parameter");
+        return;
+    }
+    if (rate < 0 || burst < 0 || max_queue < 0) {
+        res.status = 400;
+        res.set_content("Admission parameters must be non-negative", "text/plain");
+        logger->warn("Admission update failed: negative parameter");
+        return;
+    }
+
+    admission_control->set_limits(rate, burst, static_cast<size_t>(max_queue));
+    res.set_content(admission_control->report(), "text/plain");
+    logger->info("Admission limits updated", "rate: " + std::to_string(rate) + ", burst: " + std::to_string(burst) +
+        ", max_queue: " + std::to_string(max_queue));
+}
+
+// Подключает узел кластера
+void HTTPServer::set_cluster(std::shared_ptr<ClusterSessionManager> cluster) {
+    this->cluster = cluster;
+}
+
+// Обрабатывает запрос /cluster
+void HTTPServer::handle_cluster(const httplib::Request& req, httplib::Response& res) {
+    if (!cluster) {
+        res.status = 503;
+        res.set_content("Cluster mode not enabled", "text/plain");
+        return;
+    }
+    res.set_content(cluster->report(), "text/plain");
+}
+
+// Подключает сторону репликации
+void HTTPServer::set_replication(std::shared_ptr<ReplicationEndpoint> replication) {
+    this->replication = replication;
+}
+
+// Обрабатывает запрос /replication
+void HTTPServer::handle_replication(const httplib::Request& req, httplib::Response& res) {
+    if (!replication) {
+        res.status = 503;
+        res.set_content("Replication not enabled", "text/plain");
+        return;
+    }
+    res.set_content(replication->report(), "text/plain");
+}
+
+// Обрабатывает запрос /replication/takeover; переключение выполняет main
+void HTTPServer::handle_replication_takeover(const httplib::Request& req, httplib::Response& res) {
+    if (!replication || !replication->request_takeover()) {
+        res.status = 409;
+        res.set_content("Not a standby", "text/plain");
+        return;
+    }
+    res.set_content("Takeover requested", "text/plain");
+    logger->info("Manual takeover requested");
+}
+
+// Подключает регулятор пула рабочих потоков UDP-сервера
+void HTTPServer::set_worker_pool_sizer(std::shared_ptr<WorkerPoolSizer> pool_sizer) {
+    this->pool_sizer = pool_sizer;
+}
+
+// Обрабатывает запрос /workers
+void HTTPServer::handle_workers(const httplib::Request& req, httplib::Response& res) {
+    if (!pool_sizer) {
+        res.status = 503;
+        res.set_content("Worker pool not available", "text/plain");
+        return;
+    }
+    res.set_content(pool_sizer->report(), "text/plain");
+}
+
+// Подключает задержки UDP-пути
+void HTTPServer::set_latency_stats(std::shared_ptr<LatencyStats> latency_stats) {
+    this->latency_stats = latency_stats;
+}
+
+// Обрабатывает запрос /latency
+void HTTPServer::handle_latency(const httplib::Request& req, httplib::Response& res) {
+    if (!latency_stats) {
+        res.status = 503;
+        res.set_content("Latency statistics not available", "text/plain");
+        return;
+    }
+    res.set_content(latency_stats->report(), "text/plain");
+}
+
+// Подключает самых активных пиров и IMSI
+void HTTPServer::set_heavy_hitters(std::shared_ptr<HeavyHitters> heavy_hitters) {
+    this->heavy_hitters = heavy_hitters;
+}
+
+// Обрабатывает запрос /heavy_hitters
+void HTTPServer::handle_heavy_hitters(const httplib::Request& req, httplib::Response& res) {
+    if (!heavy_hitters) {
+        res.status = 503;
+        res.set_content("Heavy hitters not available", "text/plain");
+        return;
+    }
+    res.set_content(heavy_hitters->report(), "text/plain");
+}
+
+// Подключает поток событий сессий
+void HTTPServer::set_session_events(std::shared_ptr<SessionEventStream> session_events) {
+    this->session_events = session_events;
+}
+
+// Обрабатывает запрос /session_events[?last_event_id=<N>]. Номер последнего полученного события берётся
+// из параметра или заголовка Last-Event-ID (его шлёт EventSource при переподключении); без номера — только новые события.
+// Ответ отдаётся по частям из кольца подписки: запись в сокет идёт в потоке соединения и не держит блокировок потока
+void HTTPServer::handle_session_events(const httplib::Request& req, httplib::Response& res) {
+    if (!session_events) {
+        res.status = 503;
+        res.set_content("Session events not available", "text/plain");
+        return;
+    }
+
+    std::optional<uint64_t> last_event_id;
+    std::string resume = req.has_param("last_event_id") ? req.get_param_value("last_event_id") : req.get_header_value("Last-Event-ID");
+    if (!resume.empty()) {
+        try {
+            size_t pos = 0;
+            last_event_id = std::stoull(resume, &pos);
+            if (pos != resume.size()) {
+                throw std::invalid_argument("trailing characters");
+            }
+        }
+        catch (const std::exception&) {
+            res.status = 400;
+            res.set_content("Invalid last_event_id", "text/plain");
+            logger->warn("Session events request failed: invalid last_event_id");
+            return;
+        }
+    }
+
+    auto subscription = session_events->subscribe(last_event_id);
+    if (!subscription) {
+        res.status = 503;
+        res.set_content("Too many session event subscribers", "text/plain");
+        logger->warn("Session events subscription rejected");
+        return;
+    }
+    logger->info("Session events subscriber connected, last_event_id: {}", last_event_id ? std::to_string(*last_event_id) : "none");
+
+    auto stream = session_events;
+    res.set_header("Cache-Control", "no-cache");
+    res.set_chunked_content_provider("text/event-stream",
+        [subscription](size_t, httplib::DataSink& sink) {
+            // Пустая порция раз в секунду уходит комментарием keepalive: так замечается отключившийся клиент
+            auto batch = subscription->wait(std::chrono::seconds(1));
+            std::string chunk = SessionEventStream::format_sse(batch);
+            if (!chunk.empty() && !sink.write(chunk.data(), chunk.size())) {
+                return false;
+            }
+            if (batch.closed) {
+                sink.done();
+            }
+            return true;
+        },
+        [this, stream, subscription](bool) {
+            stream->unsubscribe(subscription);
+            logger->info("Session events subscriber disconnected");
+        });
+}
+
+// Обрабатывает запрос /session_events/stats
+void HTTPServer::handle_session_events_stats(const httplib::Request& req, httplib::Response& res) {
+    if (!session_events) {
+        res.status = 503;
+        res.set_content("Session events not available", "text/plain");
+        return;
+    }
+    res.set_content(session_events->report(), "text/plain");
+}
+
+// Подключает таблицу сессий этого узла
+void HTTPServer::set_session_export(std::shared_ptr<SessionManager> session_table) {
+    this->session_table = session_table;
+}
+
+// Обрабатывает запрос /sessions/export?cursor=<N>&limit=<N>. Ответ: next_cursor (end — выгрузка закончена),
+// count и строки session=IMSI,время создания,время истечения (мс от эпохи). Клиент повторяет запрос
+// с next_cursor; прерванную выгрузку можно продолжить с последнего полученного курсора
+void HTTPServer::handle_sessions_export(const httplib::Request& req, httplib::Response& res) {
+    if (!session_table) {
+        res.status = 503;
+        res.set_content("Session export not available", "text/plain");
+        return;
+    }
+
+    long long cursor = 0;
+    long long limit = DEFAULT_EXPORT_LIMIT;
+    try {
+        if (req.has_param("cursor")) cursor = std::stoll(req.get_param_value("cursor"));
+        if (req.has_param("limit")) limit = std::stoll(req.get_param_value("limit"));
+    }
+    catch (const std::exception&) {
+        res.status = 400;
+        res.set_content("Invalid export parameter", "text/plain");
+        logger->warn("Session export failed: invalid parameter");
+        return;
+    }
+    if (cursor < 0 || cursor > static_cast<long long>(SessionManager::SHARDS) || limit < 1 || limit > MAX_EXPORT_LIMIT) {
+        res.status = 400;
+        res.set_content("Export cursor or limit out of range", "text/plain");
+        logger->warn("Session export failed: cursor or limit out of range");
+        return;
+    }
+
+    auto page = session_table->export_sessions(static_cast<size_t>(cursor), static_cast<size_t>(limit));
+    std::string body = "next_cursor=" +
+        (page.next_cursor >= SessionManager::SHARDS ? std::string("end") : std::to_string(page.next_cursor)) + "\n" +
+        "count=" + std::to_string(page.sessions.size()) + "\n";
+    for (const auto& session : page.sessions) {
+        body += "session=" + session.imsi + "," + std::to_string(session.creation_time_ms) + "," +
+            std::to_string(session.expires_at_ms) + "\n";
+    }
+    res.set_content(body, "text/plain");
+}
+
+// Подключает перезагружаемую конфигурацию
+void HTTPServer::set_config_store(std::shared_ptr<ConfigStore> config_store) {
+    this->config_store = config_store;
+}
+
+// Обрабатывает запрос /config
+void HTTPServer::handle_config(const httplib::Request& req, httplib::Response& res) {
+    if (!config_store) {
+        res.status = 503;
+        res.set_content("Config reload not available", "text/plain");
+        return;
+    }
+    res.set_content(config_store->report(), "text/plain");
+}
+
+// Обрабатывает запросы /config/reload и /config/rollback. При отказе действующий снимок не меняется,
+// ответ 409 с причиной; при успехе — отчёт с новой версией
+void HTTPServer::handle_config_change(const httplib::Request& req, httplib::Response& res, bool rollback) {
+    if (!config_store) {
+        res.status = 503;
+        res.set_content("Config reload not available", "text/plain");
+        return;
+    }
+    auto result = rollback ? config_store->rollback() : config_store->reload();
+    if (!result.ok) {
+        res.status = 409;
+        res.set_content("error=" + result.error + "\nversion=" + std::to_string(result.version) + "\n", "text/plain");
+        logger->warn("Config change rejected: {}", result.error);
+        return;
+    }
+    res.set_content(config_store->report(), "text/plain");
+    logger->info("Config version {} applied", std::to_string(result.version));
+}
+
+// Подключает кольцо захвата датаграмм
+void HTTPServer::set_packet_capture(std::shared_ptr<PacketCapture> packet_capture) {
+    this->packet_capture = packet_capture;
+}
+
+// Обрабатывает запрос /capture
+void HTTPServer::handle_capture(const httplib::Request& req, httplib::Response& res) {
+    if (!packet_capture) {
+        res.status = 503;
+        res.set_content("Packet capture not available", "text/plain");
+        return;
+    }
+    res.set_content(packet_capture->report(), "text/plain");
+}
+
+// Обрабатывает запрос /capture/start. Без параметров сохраняются все датаграммы
+void HTTPServer::handle_capture_start(const httplib::Request& req, httplib::Response& res) {
+    if (!packet_capture) {
+        res.status = 503;
+        res.set_content("Packet capture not available", "text/plain");
+        return;
+    }
+    std::string peer = req.has_param("peer") ? req.get_param_value("peer") : "";
+    std::string imsi_prefix = req.has_param("imsi_prefix") ? req.get_param_value("imsi_prefix") : "";
+    try {
+        packet_capture->start(peer, imsi_prefix);
+    }
+    catch (const std::invalid_argument& e) {
+        res.status = 400;
+        res.set_content(e.what(), "text/plain");
+        logger->warn("Capture start failed: {}", e.what());
+        return;
+    }
+    res.set_content(packet_capture->report(), "text/plain");
+    logger->info("Packet capture started: {}", "peer=" + peer + " imsi_prefix=" + imsi_prefix);
+}
+
+// Обрабатывает запрос /capture/stop
+void HTTPServer::handle_capture_stop(const httplib::Request& req, httplib::Response& res) {
+    if (!packet_capture) {
+        res.status = 503;
+        res.set_content("Packet capture not available", "text/plain");
+        return;
+    }
+    packet_capture->stop();
+    res.set_content(packet_capture->report(), "text/plain");
+    logger->info("Packet capture stopped");
+}
+
+// Обрабатывает запрос /capture/pcap: выгрузка не останавливает захват
+void HTTPServer::handle_capture_pcap(const httplib::Request& req, httplib::Response& res) {
+    if (!packet_capture) {
+        res.status = 503;
+        res.set_content("Packet capture not available", "text/plain");
+        return;
+    }
+    res.set_content(packet_capture->pcap(), "application/vnd.tcpdump.pcap");
+}
+
+// Подключает бортовой самописец
+void HTTPServer::set_flight_recorder(std::shared_ptr<FlightRecorder> flight_recorder) {
+    this->flight_recorder = flight_recorder;
+}
+
+// Обрабатывает запрос /trace: выгрузка не останавливает запись
+void HTTPServer::handle_trace(const httplib::Request& req, httplib::Response& res) {
+    if (!flight_recorder) {
+        res.status = 503;
+        res.set_content("Flight recorder not available", "text/plain");
+        return;
+    }
+    long long last_ms = 0;
+    try {
+        if (req.has_param("ms")) last_ms = std::stoll(req.get_param_value("ms"));
+    }
+    catch (const std::exception&) {
+        last_ms = -1;
+    }
+    if (last_ms < 0) {
+        res.status = 400;
+        res.set_content("Invalid trace window", "text/plain");
+        logger->warn("Trace export failed: invalid window");
+        return;
+    }
+    res.set_content(flight_recorder->chrome_trace(last_ms), "application/json");
+}
+
+// Обрабатывает запрос /trace/status
+void HTTPServer::handle_trace_status(const httplib::Request& req, httplib::Response& res) {
+    if (!flight_recorder) {
+        res.status = 503;
+        res.set_content("Flight recorder not available", "text/plain");
+        return;
+    }
+    res.set_content(flight_recorder->report(), "text/plain");
+}
+
+// Счётчики именованных блокировок; без PGW_LOCK_PROFILING (сборка Release) профилирование вырезано
+void HTTPServer::handle_locks(const httplib::Request& req, httplib::Response& res) {
+    if (!LockRegistry::enabled()) {
+        res.status = 503;
+        res.set_content("Lock profiling not compiled in", "text/plain");
+        return;
+    }
+    res.set_content(LockRegistry::instance().report(), "text/plain");
 }
\ No newline at end of file
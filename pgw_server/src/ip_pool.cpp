@@ -0,0 +1,289 @@
+#include "ip_pool.hpp"
+#include <arpa/inet.h>
+#include <stdexcept>
+
+namespace {
+
+constexpr uint64_t FULL = ~0ULL;
+
+// Старшие 64 бита адреса (для IPv4 — 32 бита) как число
+uint64_t read_prefix(const std::array<uint8_t, 16>& bytes, size_t length) {
+    uint64_t value = 0;
+    for (size_t i = 0; i < length; ++i) {
+        value = (value << 8) | bytes[i];
+    }
+    return value;
+}
+
+void write_prefix(std::array<uint8_t, 16>& bytes, size_t length, uint64_t value) {
+    for (size_t i = length; i > 0; --i) {
+        bytes[i - 1] = static_cast<uint8_t>(value);
+        value >>= 8;
+    }
+}
+
+} // namespace
+
+// Текстовое представление: IPv6-префикс выводится с длиной /64
+std::string IPAddress::to_string() const {
+    char text[INET6_ADDRSTRLEN];
+    if (!inet_ntop(ipv6 ? AF_INET6 : AF_INET, bytes.data(), text, sizeof(text))) {
+        return std::string();
+    }
+    return ipv6 ? std::string(text) + "/64" : std::string(text);
+}
+
+// Конструктор: разбирает CIDR, обнуляет биты хоста и резервирует лишние биты карты
+IPPool::IPPool(const std::string& cidr, size_t cache_slots) : cidr(cidr), cache(cache_slots) {
+    size_t slash = cidr.find('/');
+    if (slash == std::string::npos) {
+        throw std::runtime_error("Invalid IP pool (expected address/prefix): " + cidr);
+    }
+    std::string address = cidr.substr(0, slash);
+    try {
+        prefix_length = std::stoi(cidr.substr(slash + 1));
+    }
+    catch (const std::exception&) {
+        throw std::runtime_error("Invalid IP pool prefix length: " + cidr);
+    }
+    ipv6 = address.find(':') != std::string::npos;
+    if (inet_pton(ipv6 ? AF_INET6 : AF_INET, address.c_str(), base.data()) != 1) {
+        throw std::runtime_error("Invalid IP pool address: " + cidr);
+    }
+
+    size_t width = ipv6 ? 8 : 4;                        // Байты, в которых лежит номер адреса
+    int host_bits = (ipv6 ? 64 : 32) - prefix_length;
+    if (ipv6 ? (prefix_length < 40 || prefix_length > 64) : (prefix_length < 8 || prefix_length > 30)) {
+        throw std::runtime_error("IP pool prefix length out of range: " + cidr);
+    }
+    uint64_t network = read_prefix(base, width) & ~((1ULL << host_bits) - 1);
+    write_prefix(base, width, network);
+    for (size_t i = width; i < base.size(); ++i) {
+        base[i] = 0;
+    }
+
+    bits = static_cast<size_t>(1) << host_bits;
+    word_count = (bits + 63) / 64;
+    summary_count = (word_count + 63) / 64;
+    words.reset(new std::atomic<uint64_t>[word_count]);
+    summary.reset(new std::atomic<uint64_t>[summary_count]);
+    for (size_t i = 0; i < word_count; ++i) {
+        words[i].store(0, std::memory_order_relaxed);
+    }
+    for (size_t i = 0; i < summary_count; ++i) {
+        summary[i].store(0, std::memory_order_relaxed);
+    }
+    // Биты за концом пула и слова за концом сводки считаются занятыми
+    if (bits % 64) {
+        words[word_count - 1].store(FULL << (bits % 64), std::memory_order_relaxed);
+    }
+    if (word_count % 64) {
+        summary[summary_count - 1].store(FULL << (word_count % 64), std::memory_order_relaxed);
+    }
+    size = bits;
+    if (!ipv6) {
+        // Адрес сети и широковещательный адрес не выдаются
+        words[0].fetch_or(1);
+        words[(bits - 1) / 64].fetch_or(1ULL << ((bits - 1) % 64));
+        size -= 2;
+    }
+}
+
+IPAddress IPPool::to_address(uint32_t index) const {
+    IPAddress address;
+    address.ipv6 = ipv6;
+    address.bytes = base;
+    size_t width = ipv6 ? 8 : 4;
+    write_prefix(address.bytes, width, read_prefix(base, width) + index);
+    return address;
+}
+
+// Для IPv6 учитываются только старшие 64 бита: UE может назвать любой адрес своего префикса
+bool IPPool::to_index(const IPAddress& address, uint32_t& index) const {
+    if (address.ipv6 != ipv6) {
+        return false;
+    }
+    size_t width = ipv6 ? 8 : 4;
+    uint64_t offset = read_prefix(address.bytes, width) - read_prefix(base, width);
+    if (offset >= bits || (!ipv6 && (offset == 0 || offset == bits - 1))) {
+        return false;
+    }
+    index = static_cast<uint32_t>(offset);
+    return true;
+}
+
+// Занимает бит адреса напрямую в карте, минуя магазины
+bool IPPool::reserve(const IPAddress& address) {
+    uint32_t index;
+    if (!to_index(address, index)) {
+        return false;
+    }
+    size_t word = index / 64;
+    uint64_t bit = 1ULL << (index % 64);
+    uint64_t previous = words[word].fetch_or(bit, std::memory_order_acq_rel);
+    if (previous & bit) {
+        return false;
+    }
+    if ((previous | bit) == FULL) {
+        mark_full(word);
+    }
+    used.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+bool IPPool::contains(const IPAddress& address) const {
+    uint32_t index;
+    return to_index(address, index);
+}
+
+void IPPool::mark_full(size_t word) {
+    uint64_t mask = 1ULL << (word % 64);
+    summary[word / 64].fetch_or(mask, std::memory_order_acq_rel);
+    // Освобождение могло произойти между заполнением слова и установкой бита сводки
+    if (words[word].load(std::memory_order_acquire) != FULL) {
+        summary[word / 64].fetch_and(~mask, std::memory_order_acq_rel);
+    }
+}
+
+// Просматривает сводку от курсора; в слове сводки берётся первое незаполненное слово карты
+bool IPPool::take_bit(uint32_t& index) {
+    size_t start = cursor.load(std::memory_order_relaxed);
+    for (size_t n = 0; n < summary_count; ++n) {
+        size_t s = (start + n) % summary_count;
+        uint64_t free_words = ~summary[s].load(std::memory_order_acquire);
+        while (free_words) {
+            size_t word = s * 64 + static_cast<size_t>(__builtin_ctzll(free_words));
+            uint64_t value = words[word].load(std::memory_order_relaxed);
+            while (value != FULL) {
+                uint64_t bit = 1ULL << __builtin_ctzll(~value);
+                if (words[word].compare_exchange_weak(value, value | bit, std::memory_order_acq_rel, std::memory_order_relaxed)) {
+                    if ((value | bit) == FULL) {
+                        mark_full(word);
+                    }
+                    cursor.store(s, std::memory_order_relaxed);
+                    index = static_cast<uint32_t>(word * 64 + static_cast<size_t>(__builtin_ctzll(bit)));
+                    return true;
+                }
+            }
+            mark_full(word);
+            free_words = ~summary[s].load(std::memory_order_acquire);
+        }
+    }
+    return false;
+}
+
+void IPPool::clear_bit(uint32_t index) {
+    size_t word = index / 64;
+    uint64_t previous = words[word].fetch_and(~(1ULL << (index % 64)), std::memory_order_acq_rel);
+    if (previous == FULL) {
+        summary[word / 64].fetch_and(~(1ULL << (word % 64)), std::memory_order_acq_rel);
+    }
+}
+
+bool IPPool::steal(uint32_t& index) {
+    for (size_t slot = 0; slot < cache.get_slots(); ++slot) {
+        PerCoreCache::Magazine* magazine = cache.acquire_slot(slot);
+        if (!magazine) {
+            continue;
+        }
+        bool found = magazine->count > 0;
+        if (found) {
+            index = magazine->items[--magazine->count];
+        }
+        cache.release(magazine);
+        if (found) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Выделяет адрес: магазин ядра (пополняется пачкой из карты), затем карта напрямую
+bool IPPool::allocate(IPAddress& address) {
+    uint32_t index = 0;
+    bool found = false;
+    PerCoreCache::Magazine* magazine = cache.acquire();
+    if (magazine) {
+        uint32_t taken;
+        if (magazine->count == 0) {
+            while (magazine->count < PerCoreCache::MAGAZINE_SIZE / 2 && take_bit(taken)) {
+                magazine->items[magazine->count++] = taken;
+            }
+        }
+        if (magazine->count > 0) {
+            index = magazine->items[--magazine->count];
+            found = true;
+        }
+        cache.release(magazine);
+    }
+    if (!found && !take_bit(index) && !steal(index)) {
+        return false;
+    }
+    used.fetch_add(1, std::memory_order_relaxed);
+    address = to_address(index);
+    return true;
+}
+
+// Возвращает адрес в магазин ядра; полный магазин сбрасывает половину в карту
+bool IPPool::release(const IPAddress& address) {
+    uint32_t index;
+    if (!to_index(address, index)) {
+        return false;
+    }
+    used.fetch_sub(1, std::memory_order_relaxed);
+    PerCoreCache::Magazine* magazine = cache.acquire();
+    if (!magazine) {
+        clear_bit(index);
+        return true;
+    }
+    if (magazine->count == PerCoreCache::MAGAZINE_SIZE) {
+        while (magazine->count > PerCoreCache::MAGAZINE_SIZE / 2) {
+            clear_bit(magazine->items[--magazine->count]);
+        }
+    }
+    magazine->items[magazine->count++] = index;
+    cache.release(magazine);
+    return true;
+}
+
+// Конструктор: пулы IPv4 идут перед пулами IPv6, порядок внутри семейства сохраняется
+IPPoolSet::IPPoolSet(const std::vector<std::string>& cidrs, size_t cache_slots) {
+    std::vector<std::unique_ptr<IPPool>> ipv6_pools;
+    for (const auto& cidr : cidrs) {
+        auto pool = std::make_unique<IPPool>(cidr, cache_slots);
+        (pool->is_ipv6() ? ipv6_pools : pools).push_back(std::move(pool));
+    }
+    ipv4_pools = pools.size();
+    for (auto& pool : ipv6_pools) {
+        pools.push_back(std::move(pool));
+    }
+}
+
+bool IPPoolSet::allocate(bool ipv6, IPAddress& address) {
+    size_t first = ipv6 ? ipv4_pools : 0;
+    size_t last = ipv6 ? pools.size() : ipv4_pools;
+    for (size_t i = first; i < last; ++i) {
+        if (pools[i]->allocate(address)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool IPPoolSet::release(const IPAddress& address) {
+    for (auto& pool : pools) {
+        if (pool->release(address)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool IPPoolSet::reserve(const IPAddress& address) {
+    for (auto& pool : pools) {
+        if (pool->contains(address)) {
+            return pool->reserve(address);
+        }
+    }
+    return false;
+}
@@ -0,0 +1,68 @@
+#include "latency_stats.hpp"
+#include <algorithm>
+#include <sstream>
+
+// Учитывает задержку; отрицательная (сдвиг часов реального времени) считается нулевой
+void LatencyHistogram::record(std::chrono::nanoseconds latency) {
+    uint64_t ns = latency.count() > 0 ? static_cast<uint64_t>(latency.count()) : 0;
+    size_t bucket = 0;
+    while (bucket < BOUNDS_US.size() && ns > BOUNDS_US[bucket] * 1000) {
+        ++bucket;
+    }
+    buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+    count.fetch_add(1, std::memory_order_relaxed);
+    sum_ns.fetch_add(ns, std::memory_order_relaxed);
+    uint64_t current = max_ns.load(std::memory_order_relaxed);
+    while (ns > current && !max_ns.compare_exchange_weak(current, ns, std::memory_order_relaxed)) {
+    }
+}
+
+// Оценивает перцентиль по корзинам сверху
+double LatencyHistogram::percentile_us(double p) const {
+    uint64_t total = count.load(std::memory_order_relaxed);
+    if (total == 0) {
+        return 0;
+    }
+    uint64_t rank = std::max<uint64_t>(1, static_cast<uint64_t>(p * total + 0.5));
+    uint64_t seen = 0;
+    for (size_t bucket = 0; bucket < BOUNDS_US.size(); ++bucket) {
+        seen += buckets[bucket].load(std::memory_order_relaxed);
+        if (seen >= rank) {
+            // Граница корзины не может быть больше наблюдавшегося максимума
+            return std::min(static_cast<double>(BOUNDS_US[bucket]), max_ns.load(std::memory_order_relaxed) / 1000.0);
+        }
+    }
+    // Корзина переполнения: лучшая оценка сверху — максимум
+    return max_ns.load(std::memory_order_relaxed) / 1000.0;
+}
+
+// Строки отчёта одной гистограммы
+std::string LatencyHistogram::report(const std::string& name) const {
+    uint64_t total = count.load(std::memory_order_relaxed);
+    std::ostringstream out;
+    out << name << "_count=" << total << "\n"
+        << name << "_avg_us=" << (total ? sum_ns.load(std::memory_order_relaxed) / 1000.0 / total : 0) << "\n"
+        << name << "_max_us=" << max_ns.load(std::memory_order_relaxed) / 1000.0 << "\n"
+        << name << "_p50_us=" << percentile_us(0.50) << "\n"
+        << name << "_p90_us=" << percentile_us(0.90) << "\n"
+        << name << "_p99_us=" << percentile_us(0.99) << "\n"
+        << name << "_p999_us=" << percentile_us(0.999) << "\n";
+    // Накопленные корзины: сколько задержек не дольше границы
+    uint64_t seen = 0;
+    for (size_t bucket = 0; bucket < BOUNDS_US.size(); ++bucket) {
+        seen += buckets[bucket].load(std::memory_order_relaxed);
+        out << name << "_le_" << BOUNDS_US[bucket] << "us=" << seen << "\n";
+    }
+    return out.str();
+}
+
+// Отчёт по всем этапам
+std::string LatencyStats::report() const {
+    std::ostringstream out;
+    out << "socket_drops=" << get_socket_drops() << "\n"
+        << "untimestamped=" << untimestamped.load(std::memory_order_relaxed) << "\n"
+        << socket_wait.report("socket_wait")
+        << queue_wait.report("queue_wait")
+        << socket_to_reply.report("socket_to_reply");
+    return out.str();
+}
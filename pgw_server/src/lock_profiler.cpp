@@ -0,0 +1,54 @@
+#include "lock_profiler.hpp"
+#include <sstream>
+
+// Учитывает захват
+void LockStats::record_acquire(bool was_contended, std::chrono::nanoseconds wait) {
+    acquisitions.fetch_add(1, std::memory_order_relaxed);
+    if (was_contended) {
+        contended.fetch_add(1, std::memory_order_relaxed);
+        wait_time.record(wait);
+    }
+}
+
+// Отчёт блокировки: доля захватов с ожиданием и обе гистограммы
+std::string LockStats::report() const {
+    uint64_t total = get_acquisitions();
+    uint64_t waited = get_contended();
+    std::ostringstream out;
+    out << name << "_acquisitions=" << total << "\n"
+        << name << "_contended=" << waited << "\n"
+        << name << "_contended_ratio=" << (total ? static_cast<double>(waited) / total : 0) << "\n"
+        << wait_time.report(name + "_wait")
+        << hold_time.report(name + "_hold");
+    return out.str();
+}
+
+// Реестр создаётся при первом обращении и не разрушается: мьютексы статических объектов
+// могут освобождаться после деструкторов других статических объектов
+LockRegistry& LockRegistry::instance() {
+    static LockRegistry* registry = new LockRegistry();
+    return *registry;
+}
+
+// Находит или создаёт счётчики блокировки
+LockStats& LockRegistry::get(const std::string& name) {
+    std::lock_guard<std::mutex> lock(mutex);
+    for (const auto& stats : locks) {
+        if (stats->get_name() == name) {
+            return *stats;
+        }
+    }
+    locks.push_back(std::make_unique<LockStats>(name));
+    return *locks.back();
+}
+
+// Отчёт по всем блокировкам
+std::string LockRegistry::report() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    std::ostringstream out;
+    out << "locks=" << locks.size() << "\n";
+    for (const auto& stats : locks) {
+        out << stats->report();
+    }
+    return out.str();
+}
@@ -1,114 +1,297 @@
-#include "config.hpp"
-#include "logger.hpp"
-#include "udp_server.hpp"
-#include "session_manager.hpp"
-#include "cdr_logger.hpp"
-#include "http_server.hpp"
-#include <iostream>
-#include <thread>
-#include <csignal>
-#include <atomic>
-#include <cstdlib>
-#include <unistd.h>
-#include <sys/socket.h>
-#include <netinet/in.h>
-
-//     
-std::atomic<bool> running(true);
-
-//   SIGINT/SIGTERM
-void signal_handler(int) {
-    running = false;
-}
-
-//   
-int main(int argc, char* argv[]) {
-    try {
-        //   
-        std::signal(SIGINT, signal_handler);
-        std::signal(SIGTERM, signal_handler);
-
-        //  
-        std::string config_path = (argc > 1) ? argv[1] : "config.json";
-        Config config(config_path);
-
-        // ,   
-        int sock = socket(AF_INET, SOCK_STREAM, 0);
-        if (sock < 0) {
-            std::cerr << "Error: Failed to create socket for port check" << std::endl;
-            return 1;
-        }
-        int opt = 1;
-        setsockopt(sock, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt));
-        sockaddr_in addr{};
-        addr.sin_family = AF_INET;
-        addr.sin_addr.s_addr = INADDR_ANY;
-        addr.sin_port = htons(config.get_http_port());
-        if (bind(sock, (struct sockaddr*)&addr, sizeof(addr)) < 0) {
-            std::cerr << "Error: HTTP port " << config.get_http_port() << " already in use" << std::endl;
-            close(sock);
-            return 1;
-        }
-        close(sock);
-
-        sock = socket(AF_INET, SOCK_DGRAM, 0);
-        if (sock < 0) {
-            std::cerr << "Error: Failed to create socket for UDP port check" << std::endl;
-            return 1;
-        }
-        setsockopt(sock, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt));
-        addr.sin_port = htons(config.get_udp_port());
-        if (bind(sock, (struct sockaddr*)&addr, sizeof(addr)) < 0) {
-            std::cerr << "Error: UDP port " << config.get_udp_port() << " already in use" << std::endl;
-            close(sock);
-            return 1;
-        }
-        close(sock);
-
-        //  
-        Logger::init(config.get_log_file(), config.get_log_level());
-        auto logger = Logger::get();
-        logger->info("Starting PGW Server...", "");
-
-        //  
-        auto cdr_logger = std::make_shared<CDRLogger>(config, logger);
-        auto session_manager = std::make_shared<SessionManager>(config, cdr_logger);
-        auto udp_server = std::make_shared<UDPServer>(config, session_manager, cdr_logger);
-        HTTPServer http_server(config, logger, session_manager, [udp_server]() { udp_server->stop(); }, running);
-
-        //     
-        std::thread session_thread([&session_manager]() { session_manager->run(); });
-        std::thread udp_thread([&udp_server]() { udp_server->run(); });
-        std::thread http_thread([&http_server]() { http_server.run(); });
-
-        //   
-        while (running) {
-            std::this_thread::sleep_for(std::chrono::milliseconds(100));
-        }
-
-        //  
-        http_server.stop();
-        if (udp_thread.joinable()) {
-            udp_thread.join();
-        }
-        if (session_thread.joinable()) {
-            session_thread.join();
-        }
-        if (http_thread.joinable()) {
-            http_thread.join();
-        }
-
-        logger->info("PGW Server stopped", "");
-        logger->flush();
-    }
-    catch (const std::exception& e) {
-        std::cerr << "Error: " << e.what() << std::endl;
-        if (Logger::get()) {
-            Logger::get()->error("Server failed: {}", e.what());
-            Logger::get()->flush();
-        }
-        return 1;
-    }
-
-    return 0;
+#include "config.hpp"
+#include "config_store.hpp"
+#include "logger.hpp"
+#include "udp_server.hpp"
+#include "session_manager.hpp"
+#include "cdr_logger.hpp"
+#include "http_server.hpp"
+#include "cluster.hpp"
+#include "replication.hpp"
+#include "event_loop.hpp"
+#include "flight_recorder.hpp"
+#include "admin_socket.hpp"
+#include <iostream>
+#include <thread>
+#include <csignal>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <algorithm>
+#include <sstream>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+
+// Глобальный флаг завершения; HTTP-сервер сбрасывает его по /stop
+std::atomic<bool> running(true);
+
+// Период проверки резервного узла на переключение
+constexpr std::chrono::milliseconds TAKEOVER_CHECK_PERIOD(20);
+
+// Период регулятора пула рабочих потоков UDP-сервера
+constexpr std::chrono::milliseconds WORKER_ADJUST_PERIOD(100);
+
+// Миллисекунды с момента since, для журнала времени запуска и остановки
+static std::string elapsed_ms(std::chrono::steady_clock::time_point since) {
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - since;
+    std::ostringstream out;
+    out << std::fixed << std::setprecision(2) << elapsed.count();
+    return out.str();
+}
+
+// Точка входа приложения
+int main(int argc, char* argv[]) {
+    auto started_at = std::chrono::steady_clock::now();
+    try {
+        // Цикл событий создаётся первым: потоки компонентов наследуют маску с заблокированными
+        // SIGINT/SIGTERM, и сигналы приходят только в цикл через signalfd
+        EventLoop loop;
+        loop.handle_signals({ SIGINT, SIGTERM }, [&loop](int) {
+            running = false;
+            loop.stop();
+        });
+        // SIGHUP перечитывает конфигурацию; хранилище снимков появляется после запуска компонентов
+        std::shared_ptr<ConfigStore> config_store;
+        loop.handle_signals({ SIGHUP }, [&config_store](int) {
+            if (!config_store) {
+                return;
+            }
+            auto result = config_store->reload();
+            if (result.ok) {
+                Logger::get()->info("Config reloaded on SIGHUP, version {}", std::to_string(result.version));
+            }
+            else {
+                Logger::get()->warn("Config reload on SIGHUP rejected: {}", result.error);
+            }
+        });
+
+        // SIGUSR1 сбрасывает трассу бортового самописца в flight_recorder_file, не останавливая запись
+        std::shared_ptr<FlightRecorder> flight_recorder;
+        std::string flight_recorder_file;
+        loop.handle_signals({ SIGUSR1 }, [&flight_recorder, &flight_recorder_file](int) {
+            if (!flight_recorder) {
+                return;
+            }
+            if (flight_recorder->dump(flight_recorder_file.c_str())) {
+                Logger::get()->info("Flight recorder trace written to {}", flight_recorder_file);
+            }
+            else {
+                Logger::get()->error("Failed to write flight recorder trace to {}", flight_recorder_file);
+            }
+        });
+
+        // Загружаем конфигурацию
+        std::string config_path = (argc > 1) ? argv[1] : "config.json";
+        Config config(config_path);
+
+        // Проверяем, заняты ли порты
+        int sock = socket(AF_INET, SOCK_STREAM, 0);
+        if (sock < 0) {
+            std::cerr << "Error: Failed to create socket for port check" << std::endl;
+            return 1;
+        }
+        int opt = 1;
+        setsockopt(sock, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt));
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = INADDR_ANY;
+        addr.sin_port = htons(config.get_http_port());
+        if (bind(sock, (struct sockaddr*)&addr, sizeof(addr)) < 0) {
+            std::cerr << "Error: HTTP port " << config.get_http_port() << " already in use" << std::endl;
+            close(sock);
+            return 1;
+        }
+        close(sock);
+
+        // Резервный узел занимает UDP-порт только при переключении, пока он у основного
+        bool standby = config.get_replication_role() == "standby";
+        if (!standby) {
+            sock = socket(AF_INET, SOCK_DGRAM, 0);
+            if (sock < 0) {
+                std::cerr << "Error: Failed to create socket for UDP port check" << std::endl;
+                return 1;
+            }
+            setsockopt(sock, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt));
+            addr.sin_port = htons(config.get_udp_port());
+            if (bind(sock, (struct sockaddr*)&addr, sizeof(addr)) < 0) {
+                std::cerr << "Error: UDP port " << config.get_udp_port() << " already in use" << std::endl;
+                close(sock);
+                return 1;
+            }
+            close(sock);
+        }
+
+        // Инициализируем логгер
+        Logger::init(config.get_log_file(), config.get_log_level());
+        auto logger = Logger::get();
+        logger->info("Starting PGW Server...", "");
+
+        // Создаём компоненты; при clock_scale > 1 сессии истекают и CDR датируются по ускоренным часам
+        auto clock = make_clock(config.get_clock_scale());
+        if (config.get_clock_scale() != 1.0) {
+            logger->warn("Session clock accelerated, scale: {}", std::to_string(config.get_clock_scale()));
+        }
+        auto cdr_logger = std::make_shared<CDRLogger>(config, logger, clock);
+        // События сессий для /session_events: те же записи, что в CDR, без чтения файла
+        auto session_events = std::make_shared<SessionEventStream>(
+            static_cast<size_t>(config.get_event_stream_buffer()), static_cast<size_t>(config.get_event_stream_max_subscribers()));
+        cdr_logger->set_event_stream(session_events);
+        auto session_manager = std::make_shared<SessionManager>(config, cdr_logger);
+
+        // Бортовой самописец пишет всегда; трасса выгружается по /trace, SIGUSR1 и при аварийном сигнале
+        if (config.get_flight_recorder_events() > 0) {
+            flight_recorder = std::make_shared<FlightRecorder>(static_cast<size_t>(config.get_flight_recorder_events()));
+            flight_recorder_file = config.get_flight_recorder_file();
+            FlightRecorder::install_crash_handler(flight_recorder, flight_recorder_file);
+            cdr_logger->set_flight_recorder(flight_recorder);
+            session_manager->set_flight_recorder(flight_recorder);
+        }
+
+        // Репликация: основной узел шлёт дельты сессий, резервный ведёт их копию
+        std::shared_ptr<ReplicationSender> replication_sender;
+        std::shared_ptr<ReplicationReceiver> replication_receiver;
+        if (config.get_replication_role() == "active") {
+            replication_sender = std::make_shared<ReplicationSender>(config, *session_manager, logger);
+            session_manager->set_listener(replication_sender);
+            replication_sender->run();
+        }
+        else if (standby) {
+            replication_receiver = std::make_shared<ReplicationReceiver>(config, logger);
+            replication_receiver->run();
+        }
+
+        // В режиме кластера серверы работают через узел, пересылающий чужие IMSI владельцам
+        std::shared_ptr<ISessionManager> sessions = session_manager;
+        std::shared_ptr<ClusterSessionManager> cluster;
+        if (!config.get_cluster_nodes().empty()) {
+            cluster = std::make_shared<ClusterSessionManager>(config, session_manager, logger);
+            cluster->run();
+            sessions = cluster;
+        }
+
+        auto udp_server = std::make_shared<UDPServer>(config, sessions, cdr_logger);
+        udp_server->set_flight_recorder(flight_recorder);
+        HTTPServer http_server(config, logger, sessions, [udp_server]() { udp_server->stop(); }, running);
+        http_server.set_shutdown_handler([&loop]() { loop.stop(); });
+        http_server.set_admission_control(udp_server->get_admission_control());
+        http_server.set_worker_pool_sizer(udp_server->get_worker_pool_sizer());
+        http_server.set_latency_stats(udp_server->get_latency_stats());
+        http_server.set_heavy_hitters(udp_server->get_heavy_hitters());
+        http_server.set_packet_capture(udp_server->get_packet_capture());
+        http_server.set_flight_recorder(flight_recorder);
+        http_server.set_session_events(session_events);
+        http_server.set_session_export(session_manager);
+
+        // Административный сокет для агентов на том же хосте; отвечает по локальной таблице
+        std::shared_ptr<AdminSocket> admin_socket;
+        if (!config.get_admin_socket_path().empty()) {
+            admin_socket = std::make_shared<AdminSocket>(config, session_manager, logger);
+            admin_socket->set_session_export(session_manager);
+            admin_socket->set_admission_control(udp_server->get_admission_control());
+        }
+
+        // Перезагрузка конфигурации: новые снимки подхватываются менеджером сессий при чтении,
+        // уровень логирования и пределы допуска применяются обработчиками
+        config_store = std::make_shared<ConfigStore>(config_path, config);
+        config_store->on_reload([logger](const Config& previous, const Config& next) {
+            if (previous.get_log_level() != next.get_log_level()) {
+                logger->set_level(next.get_log_level());
+            }
+        });
+        // Пределы, заданные через /admission/set, сохраняются, пока их ключи в файле не изменятся
+        config_store->on_reload([admission_control = udp_server->get_admission_control()](const Config& previous, const Config& next) {
+            if (previous.get_rate_limit_per_sec() != next.get_rate_limit_per_sec() ||
+                previous.get_rate_limit_burst() != next.get_rate_limit_burst() ||
+                previous.get_max_queue_depth() != next.get_max_queue_depth()) {
+                admission_control->set_limits(next.get_rate_limit_per_sec(), next.get_rate_limit_burst(),
+                    static_cast<size_t>(std::max(next.get_max_queue_depth(), 0)));
+            }
+        });
+        session_manager->set_config_store(config_store);
+        http_server.set_config_store(config_store);
+        if (cluster) {
+            http_server.set_cluster(cluster);
+        }
+        if (replication_sender) {
+            http_server.set_replication(replication_sender);
+        }
+        else if (replication_receiver) {
+            http_server.set_replication(replication_receiver);
+        }
+
+        // UDP-сервер — единственный компонент со своим блокирующим циклом приёма.
+        // Его сбой и готовность передаются в цикл событий
+        std::thread udp_thread;
+        auto start_udp = [&](const std::string& message, std::chrono::steady_clock::time_point since) {
+            udp_thread = std::thread([&, message, since]() {
+                try {
+                    udp_server->run([&, message, since]() {
+                        loop.post([&, message, since]() { logger->info(message, elapsed_ms(since)); });
+                    });
+                }
+                catch (const std::exception& e) {
+                    logger->error("UDP Server failed: {}", e.what());
+                    running = false;
+                    loop.stop();
+                }
+            });
+        };
+
+        session_manager->run();
+        http_server.run();
+        if (admin_socket) {
+            admin_socket->run();
+        }
+        // UDP-сервер резервного узла запускается при переключении; порт может быть ещё занят
+        if (standby) {
+            logger->info("PGW Server started in {} ms (standby)", elapsed_ms(started_at));
+            loop.add_timer(TAKEOVER_CHECK_PERIOD, [&]() {
+                if (!udp_thread.joinable() && replication_receiver->takeover_ready()) {
+                    auto promoted_at = std::chrono::steady_clock::now();
+                    session_manager->restore_sessions(replication_receiver->take_over());
+                    logger->warn("Standby promoted to active");
+                    start_udp("Promoted node serving UDP in {} ms", promoted_at);
+                }
+            });
+        }
+        else {
+            start_udp("PGW Server started in {} ms", started_at);
+        }
+
+        loop.add_timer(WORKER_ADJUST_PERIOD, [&udp_server]() { udp_server->adjust_workers(); });
+
+        // Ожидаем сигнала, /stop или сбоя UDP-сервера
+        loop.run();
+        auto stop_requested_at = loop.stop_requested_at();
+        logger->info("Shutdown requested, stopping components", "");
+
+        // Останавливаем компоненты: HTTP-сервер останавливает менеджер сессий и UDP-сервер
+        if (admin_socket) {
+            admin_socket->stop();
+        }
+        http_server.stop();
+        if (replication_sender) {
+            replication_sender->stop();
+        }
+        if (replication_receiver) {
+            replication_receiver->stop();
+        }
+        if (udp_thread.joinable()) {
+            udp_thread.join();
+        }
+
+        logger->info("PGW Server stopped in {} ms", elapsed_ms(stop_requested_at));
+        logger->flush();
+    }
+    catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        if (Logger::get()) {
+            Logger::get()->error("Server failed: {}", e.what());
+            Logger::get()->flush();
+        }
+        return 1;
+    }
+
+    return 0;
 }
\ No newline at end of file
@@ -0,0 +1,265 @@
+#include "packet_capture.hpp"
+#include "clock.hpp"
+#include <algorithm>
+#include <cstring>
+#include <sstream>
+#include <stdexcept>
+#include <arpa/inet.h>
+
+namespace {
+
+constexpr uint64_t PEER_FILTER_SET = 1ULL << 48;
+constexpr uint32_t PCAP_MAGIC_NS = 0xa1b23c4d;     // pcap с наносекундными метками
+constexpr uint32_t LINKTYPE_IPV4 = 228;
+constexpr size_t IPV4_HEADER = 20;
+constexpr size_t UDP_HEADER = 8;
+
+// Дописывает значение в порядке байт хоста: читатель pcap определяет его по магическому числу
+template <typename T>
+void append(std::string& out, T value) {
+    out.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+// Контрольная сумма заголовка IPv4 (RFC 791)
+uint16_t ipv4_checksum(const uint8_t* header, size_t length) {
+    uint32_t sum = 0;
+    for (size_t i = 0; i + 1 < length; i += 2) {
+        sum += (static_cast<uint32_t>(header[i]) << 8) | header[i + 1];
+    }
+    while (sum >> 16) {
+        sum = (sum & 0xFFFF) + (sum >> 16);
+    }
+    return static_cast<uint16_t>(~sum);
+}
+
+} // namespace
+
+// Конструктор: кольцо выделяется сразу, запись в него не выделяет память
+PacketCapture::PacketCapture(size_t slots, uint32_t local_addr, uint16_t local_port)
+    : slot_count(std::max<size_t>(slots, 1)), local_addr(local_addr), local_port(local_port),
+    slots(new Slot[std::max<size_t>(slots, 1)]) {
+}
+
+// Публикует фильтр и включает захват; билеты до start_ticket в выгрузку не попадают
+void PacketCapture::start(const std::string& peer, const std::string& imsi_prefix) {
+    uint64_t next_peer_filter = 0;
+    if (!peer.empty()) {
+        std::string host = peer;
+        unsigned long port = 0;
+        auto colon = peer.find(':');
+        if (colon != std::string::npos) {
+            host = peer.substr(0, colon);
+            std::string port_text = peer.substr(colon + 1);
+            if (port_text.empty() || port_text.find_first_not_of("0123456789") != std::string::npos ||
+                port_text.size() > 5 || (port = std::stoul(port_text)) > 65535) {
+                throw std::invalid_argument("Invalid capture peer port: " + peer);
+            }
+        }
+        struct in_addr addr;
+        if (inet_pton(AF_INET, host.c_str(), &addr) != 1) {
+            throw std::invalid_argument("Invalid capture peer address: " + peer);
+        }
+        next_peer_filter = PEER_FILTER_SET | (static_cast<uint64_t>(addr.s_addr) << 16) |
+            htons(static_cast<uint16_t>(port));
+    }
+    uint64_t next_imsi_filter = 0;
+    if (!imsi_prefix.empty()) {
+        if (imsi_prefix.size() > MAX_IMSI_PREFIX || imsi_prefix.find_first_not_of("0123456789") != std::string::npos) {
+            throw std::invalid_argument("Invalid capture IMSI prefix: " + imsi_prefix);
+        }
+        next_imsi_filter = (static_cast<uint64_t>(imsi_prefix.size()) << 56) | std::stoull(imsi_prefix);
+    }
+
+    // Пока фильтр меняется, захват выключен: датаграмма не пройдёт по половине нового фильтра
+    enabled.store(false, std::memory_order_relaxed);
+    peer_filter.store(next_peer_filter, std::memory_order_relaxed);
+    imsi_filter.store(next_imsi_filter, std::memory_order_relaxed);
+    start_ticket.store(head.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    enabled.store(true, std::memory_order_release);
+}
+
+// Выключает захват
+void PacketCapture::stop() {
+    enabled.store(false, std::memory_order_release);
+}
+
+// Сохраняет запрос, прошедший фильтр
+bool PacketCapture::record_request(const void* data, size_t length, const sockaddr_in& peer, int64_t timestamp_ns,
+    const std::string* imsi) {
+    if (!matches_peer(peer)) {
+        return false;
+    }
+    uint64_t filter = imsi_filter.load(std::memory_order_relaxed);
+    if (filter != 0 && (imsi == nullptr || !matches_imsi(*imsi, filter))) {
+        return false;
+    }
+    write(CaptureDirection::Request, data, length, peer, timestamp_ns != 0 ? timestamp_ns : realtime_ns());
+    return true;
+}
+
+// Сохраняет ответ: запрос уже прошёл фильтр, поэтому он не проверяется
+void PacketCapture::record_reply(const void* data, size_t length, const sockaddr_in& peer) {
+    if (!is_enabled()) {
+        return;
+    }
+    write(CaptureDirection::Reply, data, length, peer, realtime_ns());
+}
+
+// Адрес и порт пира совпадают с фильтром
+bool PacketCapture::matches_peer(const sockaddr_in& peer) const {
+    uint64_t filter = peer_filter.load(std::memory_order_relaxed);
+    if (filter == 0) {
+        return true;
+    }
+    uint32_t addr = static_cast<uint32_t>(filter >> 16);
+    uint16_t port = static_cast<uint16_t>(filter);
+    return peer.sin_addr.s_addr == addr && (port == 0 || peer.sin_port == port);
+}
+
+// Первые цифры IMSI равны префиксу: префикс хранится числом, сравнение без выделения памяти
+bool PacketCapture::matches_imsi(const std::string& imsi, uint64_t filter) {
+    size_t length = static_cast<size_t>(filter >> 56);
+    uint64_t prefix = filter & ((1ULL << 56) - 1);
+    if (imsi.size() < length) {
+        return false;
+    }
+    uint64_t value = 0;
+    for (size_t i = 0; i < length; ++i) {
+        if (imsi[i] < '0' || imsi[i] > '9') {
+            return false;
+        }
+        value = value * 10 + static_cast<uint64_t>(imsi[i] - '0');
+    }
+    return value == prefix;
+}
+
+// Seqlock: нечётный номер на время записи, чётный — после; читатель сверяет номер до и после копирования
+void PacketCapture::write(CaptureDirection direction, const void* data, size_t length, const sockaddr_in& peer,
+    int64_t timestamp_ns) {
+    uint64_t ticket = head.fetch_add(1, std::memory_order_relaxed);
+    Slot& slot = slots[ticket % slot_count];
+    slot.sequence.store(2 * ticket + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    size_t captured = std::min(length, SNAPLEN);
+    slot.timestamp_ns = timestamp_ns;
+    slot.peer_addr = peer.sin_addr.s_addr;
+    slot.peer_port = peer.sin_port;
+    slot.direction = direction;
+    slot.length = static_cast<uint32_t>(length);
+    slot.captured = static_cast<uint16_t>(captured);
+    std::memcpy(slot.data, data, captured);
+    slot.sequence.store(2 * ticket + 2, std::memory_order_release);
+}
+
+// Копирует слоты текущего захвата, пропуская недописанные и перезаписанные
+std::vector<CapturedPacket> PacketCapture::snapshot() const {
+    uint64_t end = head.load(std::memory_order_acquire);
+    uint64_t begin = std::max(start_ticket.load(std::memory_order_relaxed), end > slot_count ? end - slot_count : 0);
+    std::vector<CapturedPacket> packets;
+    packets.reserve(static_cast<size_t>(end - begin));
+    for (uint64_t ticket = begin; ticket < end; ++ticket) {
+        const Slot& slot = slots[ticket % slot_count];
+        uint64_t sequence = slot.sequence.load(std::memory_order_acquire);
+        if (sequence != 2 * ticket + 2) {
+            continue;
+        }
+        CapturedPacket packet;
+        packet.timestamp_ns = slot.timestamp_ns;
+        packet.direction = slot.direction;
+        packet.peer_addr = slot.peer_addr;
+        packet.peer_port = slot.peer_port;
+        packet.length = slot.length;
+        packet.data.assign(reinterpret_cast<const char*>(slot.data), std::min<size_t>(slot.captured, SNAPLEN));
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot.sequence.load(std::memory_order_relaxed) != sequence) {
+            continue;
+        }
+        packets.push_back(std::move(packet));
+    }
+    return packets;
+}
+
+// Текущий захват в формате pcap
+std::string PacketCapture::pcap() const {
+    return format_pcap(snapshot(), local_addr, local_port);
+}
+
+// Состояние и фильтр захвата
+std::string PacketCapture::report() const {
+    uint64_t peer = peer_filter.load(std::memory_order_relaxed);
+    uint64_t imsi = imsi_filter.load(std::memory_order_relaxed);
+    uint64_t end = head.load(std::memory_order_acquire);
+    uint64_t captured = end - std::min(end, start_ticket.load(std::memory_order_relaxed));
+
+    std::stringstream ss;
+    ss << "enabled=" << (is_enabled() ? "true" : "false") << "\n";
+    ss << "peer=";
+    if (peer != 0) {
+        struct in_addr addr;
+        addr.s_addr = static_cast<uint32_t>(peer >> 16);
+        char text[INET_ADDRSTRLEN];
+        inet_ntop(AF_INET, &addr, text, sizeof(text));
+        ss << text;
+        if (static_cast<uint16_t>(peer) != 0) {
+            ss << ":" << ntohs(static_cast<uint16_t>(peer));
+        }
+    }
+    ss << "\n";
+    ss << "imsi_prefix=";
+    if (imsi != 0) {
+        std::string digits = std::to_string(imsi & ((1ULL << 56) - 1));
+        ss << std::string(static_cast<size_t>(imsi >> 56) - digits.size(), '0') << digits;
+    }
+    ss << "\n";
+    ss << "captured=" << captured << "\n"
+       << "in_ring=" << std::min<uint64_t>(captured, slot_count) << "\n"
+       << "slots=" << slot_count << "\n"
+       << "snaplen=" << SNAPLEN << "\n";
+    return ss.str();
+}
+
+// Глобальный заголовок pcap и записи с заголовками IPv4/UDP; контрольная сумма UDP не считается (0 в IPv4)
+std::string PacketCapture::format_pcap(const std::vector<CapturedPacket>& packets, uint32_t local_addr, uint16_t local_port) {
+    std::string out;
+    out.reserve(24 + packets.size() * (16 + IPV4_HEADER + UDP_HEADER + SNAPLEN));
+    append<uint32_t>(out, PCAP_MAGIC_NS);
+    append<uint16_t>(out, 2);
+    append<uint16_t>(out, 4);
+    append<int32_t>(out, 0);
+    append<uint32_t>(out, 0);
+    append<uint32_t>(out, static_cast<uint32_t>(IPV4_HEADER + UDP_HEADER + SNAPLEN));
+    append<uint32_t>(out, LINKTYPE_IPV4);
+
+    for (const auto& packet : packets) {
+        size_t udp_length = std::min<size_t>(UDP_HEADER + packet.length, 0xFFFF - IPV4_HEADER);
+        append<uint32_t>(out, static_cast<uint32_t>(packet.timestamp_ns / 1000000000));
+        append<uint32_t>(out, static_cast<uint32_t>(packet.timestamp_ns % 1000000000));
+        append<uint32_t>(out, static_cast<uint32_t>(IPV4_HEADER + UDP_HEADER + packet.data.size()));
+        append<uint32_t>(out, static_cast<uint32_t>(IPV4_HEADER + udp_length));
+
+        bool request = packet.direction == CaptureDirection::Request;
+        uint32_t source = request ? packet.peer_addr : local_addr;
+        uint32_t destination = request ? local_addr : packet.peer_addr;
+        uint16_t source_port = request ? packet.peer_port : local_port;
+        uint16_t destination_port = request ? local_port : packet.peer_port;
+
+        uint8_t header[IPV4_HEADER + UDP_HEADER] = {};
+        header[0] = 0x45;   // IPv4, заголовок 5 слов
+        uint16_t total = htons(static_cast<uint16_t>(IPV4_HEADER + udp_length));
+        std::memcpy(header + 2, &total, 2);
+        header[6] = 0x40;   // DF
+        header[8] = 64;     // TTL
+        header[9] = IPPROTO_UDP;
+        std::memcpy(header + 12, &source, 4);
+        std::memcpy(header + 16, &destination, 4);
+        uint16_t checksum = htons(ipv4_checksum(header, IPV4_HEADER));
+        std::memcpy(header + 10, &checksum, 2);
+        std::memcpy(header + IPV4_HEADER, &source_port, 2);
+        std::memcpy(header + IPV4_HEADER + 2, &destination_port, 2);
+        uint16_t length = htons(static_cast<uint16_t>(udp_length));
+        std::memcpy(header + IPV4_HEADER + 4, &length, 2);
+        out.append(reinterpret_cast<const char*>(header), sizeof(header));
+        out.append(packet.data);
+    }
+    return out;
+}
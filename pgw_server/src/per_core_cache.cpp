@@ -0,0 +1,27 @@
+#include "per_core_cache.hpp"
+#include <algorithm>
+#include <sched.h>
+#include <thread>
+
+// Конструктор: каждый слот изначально держит свой пустой магазин
+PerCoreCache::PerCoreCache(size_t slots)
+    : slots(slots ? slots : std::max(1u, std::thread::hardware_concurrency())), table(new Slot[this->slots]) {
+    for (size_t i = 0; i < this->slots; ++i) {
+        table[i].storage.slot = i;
+        table[i].magazine.store(&table[i].storage);
+    }
+}
+
+// Магазин ядра, на котором выполняется поток
+PerCoreCache::Magazine* PerCoreCache::acquire() {
+    int cpu = sched_getcpu();
+    return acquire_slot(cpu < 0 ? 0 : static_cast<size_t>(cpu) % slots);
+}
+
+PerCoreCache::Magazine* PerCoreCache::acquire_slot(size_t slot) {
+    return table[slot].magazine.exchange(nullptr, std::memory_order_acquire);
+}
+
+void PerCoreCache::release(Magazine* magazine) {
+    table[magazine->slot].magazine.store(magazine, std::memory_order_release);
+}
@@ -0,0 +1,721 @@
+#include "replication.hpp"
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <sstream>
+#include <stdexcept>
+
+using namespace replication;
+
+namespace {
+
+void append_u32(std::vector<uint8_t>& out, uint32_t value) {
+    for (int shift = 24; shift >= 0; shift -= 8) {
+        out.push_back(static_cast<uint8_t>(value >> shift));
+    }
+}
+
+void append_u64(std::vector<uint8_t>& out, uint64_t value) {
+    for (int shift = 56; shift >= 0; shift -= 8) {
+        out.push_back(static_cast<uint8_t>(value >> shift));
+    }
+}
+
+uint32_t read_u32(const uint8_t* p) {
+    return (static_cast<uint32_t>(p[0]) << 24) | (static_cast<uint32_t>(p[1]) << 16) |
+        (static_cast<uint32_t>(p[2]) << 8) | p[3];
+}
+
+uint64_t read_u64(const uint8_t* p) {
+    return (static_cast<uint64_t>(read_u32(p)) << 32) | read_u32(p + 4);
+}
+
+// Кодирует запись пачки; у удаления и истечения только IMSI
+void append_record(std::vector<uint8_t>& out, RecordType type, const SessionRecord& record) {
+    out.push_back(type);
+    size_t length = std::min<size_t>(record.imsi.size(), 255);
+    out.push_back(static_cast<uint8_t>(length));
+    out.insert(out.end(), record.imsi.begin(), record.imsi.begin() + length);
+    if (type != RECORD_CREATE) {
+        return;
+    }
+    append_u64(out, static_cast<uint64_t>(record.creation_time_ms));
+    append_u32(out, record.resources.teid);
+    out.push_back(static_cast<uint8_t>((record.resources.has_ipv4 ? 1 : 0) | (record.resources.has_ipv6 ? 2 : 0)));
+    const uint8_t* ipv4 = reinterpret_cast<const uint8_t*>(&record.resources.ipv4);
+    out.insert(out.end(), ipv4, ipv4 + 4);
+    out.insert(out.end(), record.resources.ipv6, record.resources.ipv6 + 16);
+    append_u32(out, record.resources.peer_teid);
+}
+
+// Заголовок кадра перед данными
+std::vector<uint8_t> frame_header(FrameType type, uint64_t sequence, size_t length) {
+    std::vector<uint8_t> header;
+    header.reserve(FRAME_HEADER_SIZE);
+    header.push_back(type);
+    append_u64(header, sequence);
+    append_u32(header, static_cast<uint32_t>(length));
+    return header;
+}
+
+bool write_all(int fd, const uint8_t* data, size_t length) {
+    while (length > 0) {
+        ssize_t n = send(fd, data, length, MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            return false;
+        }
+        data += n;
+        length -= static_cast<size_t>(n);
+    }
+    return true;
+}
+
+// Читает ровно length байт; таймаут приёма лишь даёт проверить флаг остановки
+bool read_all(int fd, uint8_t* data, size_t length, const std::atomic<bool>& running) {
+    while (length > 0) {
+        ssize_t n = recv(fd, data, length, 0);
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)) {
+            if (!running) {
+                return false;
+            }
+            continue;
+        }
+        if (n <= 0) {
+            return false;
+        }
+        data += n;
+        length -= static_cast<size_t>(n);
+    }
+    return true;
+}
+
+// Читает кадр целиком
+bool read_frame(int fd, uint8_t& type, uint64_t& sequence, std::vector<uint8_t>& payload, const std::atomic<bool>& running) {
+    uint8_t header[FRAME_HEADER_SIZE];
+    if (!read_all(fd, header, sizeof(header), running)) {
+        return false;
+    }
+    type = header[0];
+    sequence = read_u64(header + 1);
+    uint32_t length = read_u32(header + 9);
+    if (length > MAX_FRAME_PAYLOAD) {
+        return false;
+    }
+    payload.resize(length);
+    return length == 0 || read_all(fd, payload.data(), length, running);
+}
+
+struct sockaddr_in parse_address(const std::string& address) {
+    size_t colon = address.rfind(':');
+    struct sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    int port = 0;
+    try {
+        port = colon == std::string::npos ? 0 : std::stoi(address.substr(colon + 1));
+    }
+    catch (const std::exception&) {
+        port = 0;
+    }
+    if (port <= 0 || port > 65535 || inet_pton(AF_INET, address.substr(0, colon).c_str(), &addr.sin_addr) != 1) {
+        throw std::runtime_error("Invalid replication_address (expected ip:port): " + address);
+    }
+    addr.sin_port = htons(static_cast<uint16_t>(port));
+    return addr;
+}
+
+// Таймауты сокета: приём — для проверки остановки, отправка — чтобы зависший standby не держал поток
+void set_timeouts(int fd, int receive_ms, int send_ms) {
+    struct timeval receive = { receive_ms / 1000, (receive_ms % 1000) * 1000 };
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &receive, sizeof(receive));
+    struct timeval send = { send_ms / 1000, (send_ms % 1000) * 1000 };
+    setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &send, sizeof(send));
+    int opt = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &opt, sizeof(opt));
+}
+
+} // namespace
+
+// FNV-1a по IMSI и ресурсам с финализатором splitmix64
+uint64_t replication::record_hash(const SessionRecord& record) {
+    uint64_t value = 0xcbf29ce484222325ULL;
+    auto mix = [&value](const void* data, size_t length) {
+        const uint8_t* bytes = static_cast<const uint8_t*>(data);
+        for (size_t i = 0; i < length; ++i) {
+            value ^= bytes[i];
+            value *= 0x100000001b3ULL;
+        }
+    };
+    mix(record.imsi.data(), record.imsi.size());
+    mix(&record.creation_time_ms, sizeof(record.creation_time_ms));
+    mix(&record.resources.teid, sizeof(record.resources.teid));
+    mix(&record.resources.peer_teid, sizeof(record.resources.peer_teid));
+    if (record.resources.has_ipv4) {
+        mix(&record.resources.ipv4, sizeof(record.resources.ipv4));
+    }
+    if (record.resources.has_ipv6) {
+        mix(record.resources.ipv6, sizeof(record.resources.ipv6));
+    }
+    value ^= value >> 30;
+    value *= 0xbf58476d1ce4e5b9ULL;
+    value ^= value >> 27;
+    value *= 0x94d049bb133111ebULL;
+    value ^= value >> 31;
+    return value;
+}
+
+// Конструктор: адрес проверяется сразу, чтобы ошибка конфигурации была видна при запуске
+ReplicationSender::ReplicationSender(const Config& config, SessionManager& sessions, std::shared_ptr<ILogger> logger)
+    : config(config), sessions(sessions), logger(logger) {
+    parse_address(config.get_replication_address());
+}
+
+ReplicationSender::~ReplicationSender() {
+    stop();
+}
+
+// Открывает слушающий сокет и запускает потоки приёма standby и отправки
+void ReplicationSender::run() {
+    struct sockaddr_in addr = parse_address(config.get_replication_address());
+    listen_fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (listen_fd < 0) {
+        throw std::runtime_error("Failed to create replication socket: " + std::string(strerror(errno)));
+    }
+    int opt = 1;
+    setsockopt(listen_fd, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt));
+    set_timeouts(listen_fd, 100, 1000);
+    if (::bind(listen_fd, (struct sockaddr*)&addr, sizeof(addr)) < 0 || listen(listen_fd, 1) < 0) {
+        close(listen_fd);
+        listen_fd = -1;
+        throw std::runtime_error("Failed to listen on replication address: " + std::string(strerror(errno)));
+    }
+    running = true;
+    accept_thread = std::thread(&ReplicationSender::accept_loop, this);
+    send_thread = std::thread(&ReplicationSender::send_loop, this);
+    logger->info("Replication source listening on {}", config.get_replication_address());
+}
+
+void ReplicationSender::stop() {
+    if (running.exchange(false)) {
+        queue_cond.notify_all();
+        if (send_thread.joinable()) {
+            send_thread.join();
+        }
+        if (accept_thread.joinable()) {
+            accept_thread.join();
+        }
+        close(listen_fd);
+        listen_fd = -1;
+        logger->info("Replication source stopped");
+    }
+}
+
+void ReplicationSender::on_session_created(const SessionRecord& record) {
+    enqueue(RECORD_CREATE, record);
+}
+
+void ReplicationSender::on_session_removed(const SessionRecord& record, bool expired) {
+    enqueue(expired ? RECORD_EXPIRE : RECORD_DELETE, record);
+}
+
+// Контрольная сумма ведётся всегда; дельты копятся только для подключённого standby,
+// неподключённый получит полную копию
+void ReplicationSender::enqueue(RecordType type, const SessionRecord& record) {
+    std::lock_guard<std::mutex> lock(queue_mutex);
+    checksum ^= record_hash(record);
+    if (type == RECORD_CREATE) {
+        ++session_count;
+    }
+    else {
+        --session_count;
+    }
+    if (!connected || resync_needed) {
+        return;
+    }
+    if (queue.size() >= MAX_QUEUE) {
+        // standby не успевает: дельты заменяет полная копия
+        deltas_dropped += queue.size() + 1;
+        queue.clear();
+        resync_needed = true;
+        queue_cond.notify_one();
+        return;
+    }
+    queue.push_back(Delta{ type, record });
+    if (queue.size() == BATCH_RECORDS) {
+        queue_cond.notify_one();
+    }
+}
+
+// Принимает по одному standby; читает его подтверждения и запросы копии до разрыва
+void ReplicationSender::accept_loop() {
+    while (running) {
+        struct sockaddr_in from = {};
+        socklen_t from_length = sizeof(from);
+        int fd = accept(listen_fd, (struct sockaddr*)&from, &from_length);
+        if (fd < 0) {
+            continue;
+        }
+        set_timeouts(fd, 100, 1000);
+        {
+            std::lock_guard<std::mutex> lock(send_mutex);
+            client_fd = fd;
+            acked = sequence;
+            unacked.clear();
+        }
+        {
+            std::lock_guard<std::mutex> lock(queue_mutex);
+            connected = true;
+            resync_needed = true;
+            queue.clear();
+        }
+        queue_cond.notify_one();
+        logger->info("Standby connected from {}", inet_ntoa(from.sin_addr));
+
+        uint8_t type;
+        uint64_t frame_sequence;
+        std::vector<uint8_t> payload;
+        while (running && read_frame(fd, type, frame_sequence, payload, running)) {
+            if (type == FRAME_ACK) {
+                std::lock_guard<std::mutex> lock(send_mutex);
+                acked = std::max(acked, frame_sequence);
+                while (!unacked.empty() && unacked.front().first <= acked) {
+                    unacked.pop_front();
+                }
+            }
+            else if (type == FRAME_RESYNC) {
+                std::lock_guard<std::mutex> lock(queue_mutex);
+                resync_needed = true;
+                queue_cond.notify_one();
+                logger->warn("Standby requested full resync");
+            }
+        }
+        disconnect(fd, "standby disconnected");
+        close(fd);
+    }
+}
+
+// Снимает соединение; закрывает дескриптор поток приёма, поэтому здесь только shutdown
+void ReplicationSender::disconnect(int fd, const char* reason) {
+    {
+        std::lock_guard<std::mutex> lock(send_mutex);
+        if (client_fd != fd) {
+            return;
+        }
+        shutdown(fd, SHUT_RDWR);
+        client_fd = -1;
+        unacked.clear();
+    }
+    {
+        std::lock_guard<std::mutex> lock(queue_mutex);
+        connected = false;
+        queue.clear();
+    }
+    if (running) {
+        logger->warn("Replication stream closed: {}", reason);
+    }
+}
+
+bool ReplicationSender::send_frame(FrameType type, const std::vector<uint8_t>& payload) {
+    int fd;
+    {
+        std::lock_guard<std::mutex> lock(send_mutex);
+        fd = client_fd;
+        if (fd >= 0) {
+            std::vector<uint8_t> header = frame_header(type, sequence + 1, payload.size());
+            if (write_all(fd, header.data(), header.size()) && write_all(fd, payload.data(), payload.size())) {
+                ++sequence;
+                unacked.emplace_back(sequence, std::chrono::steady_clock::now());
+                return true;
+            }
+        }
+    }
+    if (fd >= 0) {
+        disconnect(fd, "write failed");
+    }
+    return false;
+}
+
+bool ReplicationSender::send_deltas(const std::vector<Delta>& deltas) {
+    std::vector<uint8_t> payload;
+    for (size_t first = 0; first < deltas.size(); first += BATCH_RECORDS) {
+        payload.clear();
+        size_t last = std::min(deltas.size(), first + BATCH_RECORDS);
+        for (size_t i = first; i < last; ++i) {
+            append_record(payload, deltas[i].type, deltas[i].record);
+        }
+        if (!send_frame(FRAME_BATCH, payload)) {
+            return false;
+        }
+    }
+    deltas_sent += deltas.size();
+    return true;
+}
+
+// Копия снимается под мьютексом менеджера сессий вместе с очисткой очереди: дельты,
+// уже попавшие в копию, не отправляются повторно, а более поздние идут следом за ней
+bool ReplicationSender::send_snapshot() {
+    std::vector<SessionRecord> records;
+    uint64_t count = 0;
+    uint64_t sum = 0;
+    sessions.snapshot([&](std::vector<SessionRecord>& all) {
+        std::lock_guard<std::mutex> lock(queue_mutex);
+        queue.clear();
+        resync_needed = false;
+        count = session_count;
+        sum = checksum;
+        records.swap(all);
+    });
+
+    if (!send_frame(FRAME_SNAPSHOT_BEGIN, {})) {
+        return false;
+    }
+    std::vector<uint8_t> payload;
+    for (size_t first = 0; first < records.size(); first += BATCH_RECORDS) {
+        payload.clear();
+        size_t last = std::min(records.size(), first + BATCH_RECORDS);
+        for (size_t i = first; i < last; ++i) {
+            append_record(payload, RECORD_CREATE, records[i]);
+        }
+        if (!send_frame(FRAME_BATCH, payload)) {
+            return false;
+        }
+    }
+    std::vector<uint8_t> totals;
+    append_u64(totals, count);
+    append_u64(totals, sum);
+    if (!send_frame(FRAME_SNAPSHOT_END, {}) || !send_frame(FRAME_CHECKSUM, totals)) {
+        return false;
+    }
+    ++snapshots_sent;
+    logger->info("Replication snapshot sent, sessions: {}", std::to_string(records.size()));
+    return true;
+}
+
+// Пачка уходит, когда набралось BATCH_RECORDS дельт или прошло replication_batch_ms
+void ReplicationSender::send_loop() {
+    auto now = std::chrono::steady_clock::now();
+    auto last_send = now;
+    auto last_checksum = now;
+    while (running) {
+        std::vector<Delta> deltas;
+        bool snapshot = false;
+        uint64_t count = 0;
+        uint64_t sum = 0;
+        {
+            std::unique_lock<std::mutex> lock(queue_mutex);
+            queue_cond.wait_for(lock, std::chrono::milliseconds(config.get_replication_batch_ms()), [this] {
+                return !running || (connected && resync_needed) || queue.size() >= BATCH_RECORDS;
+            });
+            if (!running) {
+                break;
+            }
+            if (!connected) {
+                continue;
+            }
+            snapshot = resync_needed;
+            if (!snapshot) {
+                deltas.swap(queue);
+                count = session_count;
+                sum = checksum;
+            }
+        }
+
+        now = std::chrono::steady_clock::now();
+        if (snapshot) {
+            if (send_snapshot()) {
+                last_send = last_checksum = now;
+            }
+            continue;
+        }
+        bool ok = true;
+        if (!deltas.empty()) {
+            ok = send_deltas(deltas);
+            last_send = now;
+        }
+        else if (now - last_send >= std::chrono::milliseconds(HEARTBEAT_MS)) {
+            ok = send_frame(FRAME_BATCH, {});
+            last_send = now;
+        }
+        if (ok && config.get_replication_checksum_sec() > 0 &&
+            now - last_checksum >= std::chrono::seconds(config.get_replication_checksum_sec())) {
+            std::vector<uint8_t> totals;
+            append_u64(totals, count);
+            append_u64(totals, sum);
+            send_frame(FRAME_CHECKSUM, totals);
+            last_checksum = now;
+        }
+    }
+}
+
+// Отставание standby: кадры без подтверждения и возраст самого старого из них
+std::string ReplicationSender::report() const {
+    std::stringstream ss;
+    ss << "role=active\n";
+    {
+        std::lock_guard<std::mutex> lock(send_mutex);
+        long long lag_ms = unacked.empty() ? 0 : std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now() - unacked.front().second).count();
+        ss << "connected=" << (client_fd >= 0 ? 1 : 0) << "\n"
+           << "sequence=" << sequence << "\n"
+           << "acked=" << acked << "\n"
+           << "lag_frames=" << (sequence - acked) << "\n"
+           << "lag_ms=" << lag_ms << "\n";
+    }
+    {
+        std::lock_guard<std::mutex> lock(queue_mutex);
+        ss << "pending_deltas=" << queue.size() << "\n"
+           << "sessions=" << session_count << "\n";
+    }
+    ss << "deltas_sent=" << deltas_sent.load() << "\n"
+       << "snapshots_sent=" << snapshots_sent.load() << "\n"
+       << "deltas_dropped=" << deltas_dropped.load() << "\n";
+    return ss.str();
+}
+
+void ReplicationReceiver::Table::put(SessionRecord record) {
+    auto it = sessions.find(record.imsi);
+    if (it != sessions.end()) {
+        checksum ^= record_hash(it->second);
+        sessions.erase(it);
+    }
+    checksum ^= record_hash(record);
+    std::string imsi = record.imsi;
+    sessions.emplace(std::move(imsi), std::move(record));
+}
+
+void ReplicationReceiver::Table::erase(const std::string& imsi) {
+    auto it = sessions.find(imsi);
+    if (it != sessions.end()) {
+        checksum ^= record_hash(it->second);
+        sessions.erase(it);
+    }
+}
+
+ReplicationReceiver::ReplicationReceiver(const Config& config, std::shared_ptr<ILogger> logger)
+    : config(config), logger(logger) {
+    parse_address(config.get_replication_address());
+}
+
+ReplicationReceiver::~ReplicationReceiver() {
+    stop();
+}
+
+void ReplicationReceiver::run() {
+    running = true;
+    receive_thread = std::thread(&ReplicationReceiver::receive_loop, this);
+    logger->info("Standby replicating from {}", config.get_replication_address());
+}
+
+void ReplicationReceiver::stop() {
+    if (running.exchange(false)) {
+        if (receive_thread.joinable()) {
+            receive_thread.join();
+        }
+        logger->info("Replication receiver stopped");
+    }
+}
+
+// Переподключается к active каждые 100 мс; в соединении первой приходит полная копия
+void ReplicationReceiver::receive_loop() {
+    struct sockaddr_in addr = parse_address(config.get_replication_address());
+    while (running) {
+        int fd = socket(AF_INET, SOCK_STREAM, 0);
+        if (fd < 0 || connect(fd, (struct sockaddr*)&addr, sizeof(addr)) < 0) {
+            if (fd >= 0) {
+                close(fd);
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+            continue;
+        }
+        set_timeouts(fd, 100, 1000);
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            connected = true;
+            ever_connected = true;
+            synchronized = false;
+            in_snapshot = false;
+            last_contact = std::chrono::steady_clock::now();
+        }
+        logger->info("Connected to active at {}", config.get_replication_address());
+
+        uint8_t type;
+        uint64_t frame_sequence;
+        std::vector<uint8_t> payload;
+        while (running && read_frame(fd, type, frame_sequence, payload, running)) {
+            if (!apply_frame(type, frame_sequence, payload, fd)) {
+                send_control(fd, FRAME_RESYNC, 0);
+            }
+        }
+        close(fd);
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            connected = false;
+            in_snapshot = false;
+        }
+        if (running) {
+            logger->warn("Replication stream from active lost");
+        }
+    }
+}
+
+bool ReplicationReceiver::apply_frame(uint8_t type, uint64_t frame_sequence, const std::vector<uint8_t>& payload, int fd) {
+    std::lock_guard<std::mutex> lock(mutex);
+    last_contact = std::chrono::steady_clock::now();
+    if (type == FRAME_SNAPSHOT_BEGIN) {
+        // Полная копия начинает последовательность заново
+        staging = Table();
+        in_snapshot = true;
+        synchronized = true;
+        last_sequence = frame_sequence;
+        send_control(fd, FRAME_ACK, frame_sequence);
+        return true;
+    }
+    if (!synchronized) {
+        // Ждём полную копию, запрошенную ранее
+        return true;
+    }
+    if (frame_sequence != last_sequence + 1) {
+        logger->warn("Replication sequence gap, expected {}", std::to_string(last_sequence + 1));
+        synchronized = false;
+        return false;
+    }
+    last_sequence = frame_sequence;
+
+    switch (type) {
+    case FRAME_BATCH:
+        if (!apply_batch(payload)) {
+            logger->warn("Malformed replication batch");
+            synchronized = false;
+            return false;
+        }
+        break;
+    case FRAME_SNAPSHOT_END:
+        table = std::move(staging);
+        staging = Table();
+        in_snapshot = false;
+        ++snapshots;
+        logger->info("Replication snapshot applied, sessions: {}", std::to_string(table.sessions.size()));
+        break;
+    case FRAME_CHECKSUM: {
+        if (payload.size() < 16 || in_snapshot) {
+            break;
+        }
+        ++checksum_checks;
+        uint64_t count = read_u64(payload.data());
+        uint64_t sum = read_u64(payload.data() + 8);
+        if (count != table.sessions.size() || sum != table.checksum) {
+            ++checksum_mismatches;
+            logger->warn("Replication checksum mismatch, requesting full resync");
+            synchronized = false;
+            return false;
+        }
+        break;
+    }
+    default:
+        break;
+    }
+    send_control(fd, FRAME_ACK, frame_sequence);
+    return true;
+}
+
+bool ReplicationReceiver::apply_batch(const std::vector<uint8_t>& payload) {
+    Table& target = in_snapshot ? staging : table;
+    size_t offset = 0;
+    while (offset < payload.size()) {
+        if (payload.size() - offset < 2) {
+            return false;
+        }
+        uint8_t type = payload[offset];
+        size_t length = payload[offset + 1];
+        offset += 2;
+        if (payload.size() - offset < length) {
+            return false;
+        }
+        SessionRecord record;
+        record.imsi.assign(reinterpret_cast<const char*>(payload.data() + offset), length);
+        offset += length;
+        if (type != RECORD_CREATE) {
+            target.erase(record.imsi);
+            continue;
+        }
+        if (payload.size() - offset < 37) {
+            return false;
+        }
+        const uint8_t* p = payload.data() + offset;
+        record.creation_time_ms = static_cast<int64_t>(read_u64(p));
+        record.resources.teid = read_u32(p + 8);
+        record.resources.has_ipv4 = (p[12] & 1) != 0;
+        record.resources.has_ipv6 = (p[12] & 2) != 0;
+        std::memcpy(&record.resources.ipv4, p + 13, 4);
+        std::memcpy(record.resources.ipv6, p + 17, 16);
+        record.resources.peer_teid = read_u32(p + 33);
+        offset += 37;
+        target.put(std::move(record));
+    }
+    return true;
+}
+
+void ReplicationReceiver::send_control(int fd, FrameType type, uint64_t frame_sequence) {
+    std::vector<uint8_t> header = frame_header(type, frame_sequence, 0);
+    write_all(fd, header.data(), header.size());
+}
+
+// Автоматическое переключение — только если active был и замолчал: иначе резерв,
+// запущенный раньше active, сразу занял бы его порт
+bool ReplicationReceiver::takeover_ready() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (takeover_requested) {
+        return true;
+    }
+    int timeout = config.get_replication_takeover_ms();
+    return timeout > 0 && ever_connected &&
+        std::chrono::steady_clock::now() - last_contact >= std::chrono::milliseconds(timeout);
+}
+
+bool ReplicationReceiver::request_takeover() {
+    std::lock_guard<std::mutex> lock(mutex);
+    takeover_requested = true;
+    return true;
+}
+
+// Копия, принимаемая не до конца, не используется: остаётся последняя целая таблица
+std::vector<SessionRecord> ReplicationReceiver::take_over() {
+    stop();
+    std::lock_guard<std::mutex> lock(mutex);
+    if (in_snapshot) {
+        logger->warn("Taking over during snapshot transfer, using previous table");
+    }
+    std::vector<SessionRecord> records;
+    records.reserve(table.sessions.size());
+    for (auto& entry : table.sessions) {
+        records.push_back(std::move(entry.second));
+    }
+    table = Table();
+    promoted = true;
+    logger->info("Standby taking over with sessions: {}", std::to_string(records.size()));
+    return records;
+}
+
+std::string ReplicationReceiver::report() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    long long silence_ms = ever_connected ? std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - last_contact).count() : -1;
+    std::stringstream ss;
+    ss << "role=" << (promoted ? "promoted" : "standby") << "\n"
+       << "connected=" << (connected ? 1 : 0) << "\n"
+       << "synchronized=" << (synchronized ? 1 : 0) << "\n"
+       << "sessions=" << table.sessions.size() << "\n"
+       << "sequence=" << last_sequence << "\n"
+       << "last_contact_ms=" << silence_ms << "\n"
+       << "snapshots=" << snapshots << "\n"
+       << "checksum_checks=" << checksum_checks << "\n"
+       << "checksum_mismatches=" << checksum_mismatches << "\n";
+    return ss.str();
+}
@@ -0,0 +1,102 @@
+#include "response_cache.hpp"
+#include <algorithm>
+#include <iterator>
+
+// Конструктор: задаёт время жизни записей и предельный размер кэша
+ResponseCache::ResponseCache(std::chrono::milliseconds ttl, size_t max_entries)
+    : ttl(ttl), max_entries(max_entries) {
+}
+
+// Формирует ключ: 4 байта адреса, 2 байта порта и идентификатор запроса
+std::string ResponseCache::make_key(const struct sockaddr_in& peer, const std::string& request_id) {
+    std::string key;
+    key.reserve(sizeof(peer.sin_addr.s_addr) + sizeof(peer.sin_port) + request_id.size());
+    key.append(reinterpret_cast<const char*>(&peer.sin_addr.s_addr), sizeof(peer.sin_addr.s_addr));
+    key.append(reinterpret_cast<const char*>(&peer.sin_port), sizeof(peer.sin_port));
+    key.append(request_id);
+    return key;
+}
+
+// Ищет запрос в кэше, регистрируя новый запрос как ожидающий ответа
+ResponseCache::Lookup ResponseCache::lookup(const struct sockaddr_in& peer, const std::string& request_id,
+    std::string& response) {
+    if (ttl.count() <= 0 || max_entries == 0) {
+        return Lookup::Miss;
+    }
+
+    auto now = std::chrono::steady_clock::now();
+    std::string key = make_key(peer, request_id);
+    std::lock_guard<std::mutex> lock(mutex);
+    evict(now);
+
+    auto it = entries.find(key);
+    if (it != entries.end()) {
+        if (!it->second.ready) {
+            ++suppressed;
+            return Lookup::Pending;
+        }
+        response = it->second.response;
+        ++replayed;
+        return Lookup::Hit;
+    }
+
+    entries.emplace(key, Entry{ now, std::string(), false });
+    order.emplace_back(now, std::move(key));
+    return Lookup::Miss;
+}
+
+// Сохраняет ответ; если запись уже вытеснена, ответ не кэшируется
+void ResponseCache::complete(const struct sockaddr_in& peer, const std::string& request_id,
+    const std::string& response) {
+    if (ttl.count() <= 0 || max_entries == 0) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = entries.find(make_key(peer, request_id));
+    if (it != entries.end()) {
+        it->second.response = response;
+        it->second.ready = true;
+    }
+}
+
+// Удаляет запись запроса вместе с её позицией в очереди вставки. Забывают только что
+// зарегистрированные запросы, поэтому позиция ищется с конца очереди
+void ResponseCache::forget(const struct sockaddr_in& peer, const std::string& request_id) {
+    if (ttl.count() <= 0 || max_entries == 0) {
+        return;
+    }
+
+    std::string key = make_key(peer, request_id);
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = entries.find(key);
+    if (it == entries.end()) {
+        return;
+    }
+    for (auto position = order.rbegin(); position != order.rend(); ++position) {
+        if (position->first == it->second.created && position->second == key) {
+            order.erase(std::next(position).base());
+            break;
+        }
+    }
+    entries.erase(it);
+}
+
+// Возвращает число записей в кэше с учётом позиций очереди вставки
+size_t ResponseCache::size() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return std::max(entries.size(), order.size());
+}
+
+// Удаляет устаревшие записи с начала очереди вставки
+void ResponseCache::evict(std::chrono::steady_clock::time_point now) {
+    // Предел считается и по очереди: её размер ограничен, даже если записи удалены мимо неё
+    while (!order.empty() && (now - order.front().first >= ttl || order.size() >= max_entries)) {
+        auto it = entries.find(order.front().second);
+        // Запись могла быть вставлена заново после вытеснения, сверяем время создания
+        if (it != entries.end() && it->second.created == order.front().first) {
+            entries.erase(it);
+        }
+        order.pop_front();
+    }
+}
\ No newline at end of file
@@ -0,0 +1,172 @@
+#include "session_events.hpp"
+#include <algorithm>
+#include <sstream>
+
+// Тип события: действие до двоеточия ("rejected: no resources" -> "rejected")
+std::string SessionEvent::type() const {
+    return action.substr(0, action.find(':'));
+}
+
+// Конструктор: пустое кольцо заданной ёмкости
+SessionEventSubscription::SessionEventSubscription(size_t capacity) : capacity(capacity) {
+}
+
+// Ждёт событий не дольше timeout и забирает все накопленные
+SessionEventBatch SessionEventSubscription::wait(std::chrono::milliseconds timeout) {
+    std::unique_lock<std::mutex> lock(mutex);
+    cv.wait_for(lock, timeout, [this]() { return !ring.empty() || pending_lost > 0 || closed; });
+    SessionEventBatch batch;
+    batch.events.assign(ring.begin(), ring.end());
+    ring.clear();
+    batch.lost = pending_lost;
+    pending_lost = 0;
+    batch.closed = closed;
+    return batch;
+}
+
+// Всего пропущено событий
+uint64_t SessionEventSubscription::get_lost() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return total_lost;
+}
+
+// Кладёт событие; медленный читатель теряет самые старые события, а не задерживает публикацию
+void SessionEventSubscription::push(std::shared_ptr<const SessionEvent> event) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (ring.size() >= capacity) {
+            ring.pop_front();
+            ++pending_lost;
+            ++total_lost;
+        }
+        ring.push_back(std::move(event));
+    }
+    cv.notify_one();
+}
+
+// Отмечает пропуск событий до начала подписки
+void SessionEventSubscription::add_lost(uint64_t count) {
+    std::lock_guard<std::mutex> lock(mutex);
+    pending_lost += count;
+    total_lost += count;
+}
+
+// Будит ожидающего читателя
+void SessionEventSubscription::close() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        closed = true;
+    }
+    cv.notify_one();
+}
+
+// Конструктор: история и кольца подписчиков по capacity событий
+SessionEventStream::SessionEventStream(size_t capacity, size_t max_subscribers)
+    : capacity(capacity), max_subscribers(max_subscribers) {
+}
+
+// Публикует событие; под блокировкой только перенос указателя в историю и кольца
+void SessionEventStream::publish(const std::string& timestamp, const std::string& imsi, const std::string& action) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (closed) {
+        return;
+    }
+    auto event = std::make_shared<const SessionEvent>(SessionEvent{ ++last_seq, timestamp, imsi, action });
+    if (history.size() >= capacity) {
+        history.pop_front();
+    }
+    history.push_back(event);
+    for (const auto& subscriber : subscribers) {
+        subscriber->push(event);
+    }
+}
+
+// Подписывает на события после after_seq или только на новые
+std::shared_ptr<SessionEventSubscription> SessionEventStream::subscribe(std::optional<uint64_t> after_seq) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (closed || subscribers.size() >= max_subscribers) {
+        ++rejected_subscriptions;
+        return nullptr;
+    }
+    auto subscription = std::make_shared<SessionEventSubscription>(capacity);
+    // Номер больше последнего означает, что клиент пришёл от прошлого запуска: отдаём только новые события
+    if (after_seq && *after_seq < last_seq) {
+        uint64_t oldest = history.empty() ? last_seq + 1 : history.front()->seq;
+        if (*after_seq + 1 < oldest) {
+            subscription->add_lost(oldest - *after_seq - 1);
+        }
+        for (const auto& event : history) {
+            if (event->seq > *after_seq) {
+                subscription->push(event);
+            }
+        }
+    }
+    subscribers.push_back(subscription);
+    return subscription;
+}
+
+// Отписывает клиента
+void SessionEventStream::unsubscribe(const std::shared_ptr<SessionEventSubscription>& subscription) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = std::find(subscribers.begin(), subscribers.end(), subscription);
+    if (it != subscribers.end()) {
+        lost_by_unsubscribed += (*it)->get_lost();
+        subscribers.erase(it);
+    }
+}
+
+// Закрывает поток
+void SessionEventStream::close() {
+    std::lock_guard<std::mutex> lock(mutex);
+    closed = true;
+    for (const auto& subscriber : subscribers) {
+        subscriber->close();
+    }
+}
+
+// Номер последнего события
+uint64_t SessionEventStream::get_last_seq() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return last_seq;
+}
+
+// Число подписчиков
+size_t SessionEventStream::get_subscriber_count() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return subscribers.size();
+}
+
+// Счётчики потока
+std::string SessionEventStream::report() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    uint64_t lost = lost_by_unsubscribed;
+    for (const auto& subscriber : subscribers) {
+        lost += subscriber->get_lost();
+    }
+    std::stringstream ss;
+    ss << "last_seq=" << last_seq << "\n"
+       << "first_seq=" << (history.empty() ? last_seq + 1 : history.front()->seq) << "\n"
+       << "buffer=" << capacity << "\n"
+       << "subscribers=" << subscribers.size() << "\n"
+       << "max_subscribers=" << max_subscribers << "\n"
+       << "rejected_subscriptions=" << rejected_subscriptions << "\n"
+       << "lost=" << lost << "\n";
+    return ss.str();
+}
+
+// Порция в формате text/event-stream
+std::string SessionEventStream::format_sse(const SessionEventBatch& batch) {
+    std::string out;
+    if (batch.lost > 0) {
+        out += "event: lost\ndata: " + std::to_string(batch.lost) + "\n\n";
+    }
+    for (const auto& event : batch.events) {
+        out += "id: " + std::to_string(event->seq) + "\n";
+        out += "event: " + event->type() + "\n";
+        out += "data: " + event->timestamp + "," + event->imsi + "," + event->action + "\n\n";
+    }
+    if (out.empty() && !batch.closed) {
+        out = ": keepalive\n\n";
+    }
+    return out;
+}
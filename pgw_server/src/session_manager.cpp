@@ -1,94 +1,405 @@
-#include "session_manager.hpp"
-#include <thread>
-#include <chrono>
-#include <algorithm>
-#include <sstream>
-
-// :   
-SessionManager::SessionManager(const Config& config, std::shared_ptr<CDRLogger> cdr_logger)
-    : config(config), cdr_logger(cdr_logger), running(false) {
-    std::stringstream ss;
-    ss << "SessionManager initialized with timeout: " << config.get_session_timeout_sec();
-    cdr_logger->get_logger()->info(ss.str());
-}
-
-// :  
-SessionManager::~SessionManager() {
-    stop();
-}
-
-//    
-void SessionManager::run() {
-    running = true;
-    cleanup_thread = std::thread([this]() {
-        while (running) {
-            cleanup_expired_sessions();
-            std::this_thread::sleep_for(std::chrono::milliseconds(config.get_graceful_shutdown_rate()));
-        }
-        });
-}
-
-//      
-void SessionManager::stop() {
-    if (running) {
-        running = false;
-        if (cleanup_thread.joinable()) {
-            cleanup_thread.join();
-        }
-        std::lock_guard<std::mutex> lock(mutex);
-        for (const auto& session : sessions) {
-            cdr_logger->log(session.first, "deleted");
-            std::stringstream ss;
-            ss << "Deleted session for IMSI: " << session.first;
-            cdr_logger->get_logger()->info(ss.str());
-            std::this_thread::sleep_for(std::chrono::milliseconds(config.get_graceful_shutdown_rate()));
-        }
-        sessions.clear();
-        cdr_logger->get_logger()->info("SessionManager stopped");
-        cdr_logger->get_logger()->flush();
-    }
-}
-
-//    IMSI,        
-bool SessionManager::create_session(const std::string& imsi) {
-    if (std::find(config.get_blacklist().begin(), config.get_blacklist().end(), imsi) != config.get_blacklist().end()) {
-        cdr_logger->get_logger()->info("Session creation rejected for IMSI (in blacklist)", imsi);
-        return false;
-    }
-
-    std::lock_guard<std::mutex> lock(mutex);
-    if (sessions.find(imsi) != sessions.end()) {
-        cdr_logger->log(imsi, "rejected: session already exists");
-        cdr_logger->get_logger()->info("Session creation rejected for IMSI (already exists)", imsi);
-        return false;
-    }
-
-    sessions[imsi] = Session{ std::chrono::system_clock::now() };
-    cdr_logger->log(imsi, "created");
-    cdr_logger->get_logger()->info("Session created for IMSI", imsi);
-    return true;
-}
-
-//    
-bool SessionManager::has_session(const std::string& imsi) {
-    std::lock_guard<std::mutex> lock(mutex);
-    return sessions.find(imsi) != sessions.end();
-}
-
-//   
-void SessionManager::cleanup_expired_sessions() {
-    std::lock_guard<std::mutex> lock(mutex);
-    auto now = std::chrono::system_clock::now();
-    for (auto it = sessions.begin(); it != sessions.end();) {
-        if (now - it->second.creation_time > std::chrono::seconds(config.get_session_timeout_sec())) {
-            cdr_logger->log(it->first, "deleted");
-            std::stringstream ss;
-            ss << "Expired session deleted for IMSI: " << it->first;
-            cdr_logger->get_logger()->info(ss.str());
-            it = sessions.erase(it);
-        }
-        else {
-            ++it;
-        }
-    }
+#include "session_manager.hpp"
+#include <thread>
+#include <chrono>
+#include <algorithm>
+#include <cstring>
+#include <sstream>
+
+// Конструктор: инициализирует менеджер сессий
+SessionManager::SessionManager(const Config& config, std::shared_ptr<CDRLogger> cdr_logger, std::shared_ptr<IClock> clock)
+    : config(config), cdr_logger(cdr_logger), clock(clock ? clock : cdr_logger->get_clock()),
+    sessions(SHARDS), teids(static_cast<uint32_t>(config.get_teid_pool_size())), ip_pools(config.get_ip_pools()),
+    running(false) {
+    std::stringstream ss;
+    ss << "SessionManager initialized with timeout: " << config.get_session_timeout_sec();
+    cdr_logger->get_logger()->info(ss.str());
+}
+
+// Деструктор: останавливает менеджер
+SessionManager::~SessionManager() {
+    stop();
+}
+
+// Запускает фоновую очистку сессий
+void SessionManager::run() {
+    running = true;
+    cleanup_thread = std::thread([this]() {
+        while (running) {
+            cleanup_expired_sessions();
+            // Сводные строки отказов пишутся тем же потоком, вне мьютекса сессий
+            cdr_logger->flush_coalesced();
+            std::this_thread::sleep_for(std::chrono::milliseconds(config.get_graceful_shutdown_rate()));
+        }
+        });
+}
+
+// Останавливает менеджер и очищает все сессии
+void SessionManager::stop() {
+    if (running) {
+        running = false;
+        if (cleanup_thread.joinable()) {
+            cleanup_thread.join();
+        }
+        std::lock_guard<ProfiledMutex> lock(mutex);
+        for (const std::string* imsi : expiry_queue) {
+            release_resources(shard_of(*imsi).find(*imsi)->second.resources);
+            cdr_logger->log(*imsi, "deleted");
+            std::stringstream ss;
+            ss << "Deleted session for IMSI: " << *imsi;
+            cdr_logger->get_logger()->info(ss.str());
+            std::this_thread::sleep_for(std::chrono::milliseconds(config.get_graceful_shutdown_rate()));
+        }
+        expiry_queue.clear();
+        for (auto& shard : sessions) {
+            shard.clear();
+        }
+        teid_sessions.clear();
+        index.clear();
+        cdr_logger->get_logger()->info("SessionManager stopped");
+        cdr_logger->get_logger()->flush();
+    }
+}
+
+// Выделяет TEID, IPv4-адрес и IPv6-префикс (для настроенных семейств)
+bool SessionManager::allocate_resources(SessionResources& resources) {
+    resources = SessionResources();
+    resources.teid = teids.allocate();
+    if (resources.teid == 0) {
+        return false;
+    }
+    IPAddress address;
+    if (ip_pools.has_ipv4()) {
+        if (!ip_pools.allocate(false, address)) {
+            release_resources(resources);
+            return false;
+        }
+        resources.has_ipv4 = true;
+        std::memcpy(&resources.ipv4, address.bytes.data(), sizeof(resources.ipv4));
+    }
+    if (ip_pools.has_ipv6()) {
+        if (!ip_pools.allocate(true, address)) {
+            release_resources(resources);
+            return false;
+        }
+        resources.has_ipv6 = true;
+        std::memcpy(resources.ipv6, address.bytes.data(), sizeof(resources.ipv6));
+    }
+    return true;
+}
+
+// Возвращает выделенное в пулы; незаполненные поля пропускаются
+void SessionManager::release_resources(const SessionResources& resources) {
+    teids.release(resources.teid);
+    IPAddress address;
+    if (resources.has_ipv4) {
+        std::memcpy(address.bytes.data(), &resources.ipv4, sizeof(resources.ipv4));
+        ip_pools.release(address);
+    }
+    if (resources.has_ipv6) {
+        address.ipv6 = true;
+        std::memcpy(address.bytes.data(), resources.ipv6, sizeof(resources.ipv6));
+        ip_pools.release(address);
+    }
+}
+
+// Создаёт сессию для IMSI, если не в чёрном списке и не существует
+bool SessionManager::create_session(const std::string& imsi, SessionResources* resources) {
+    bool blacklisted;
+    {
+        auto live = live_config();
+        const auto& blacklist = live->get_blacklist();
+        blacklisted = std::find(blacklist.begin(), blacklist.end(), imsi) != blacklist.end();
+    }
+    if (blacklisted) {
+        cdr_logger->get_logger()->info("Session creation rejected for IMSI (in blacklist)", imsi);
+        return false;
+    }
+
+    // Повтор attach отсеивается по индексу без блокировок до выделения ресурсов: иначе при
+    // исчерпанном пуле он получил бы "no resources", а каждый повтор гонял бы TEID и адрес через пулы
+    if (has_session(imsi)) {
+        cdr_logger->log(imsi, "rejected: session already exists");
+        cdr_logger->get_logger()->info("Session creation rejected for IMSI (already exists)", imsi);
+        return false;
+    }
+
+    // Пулы не требуют блокировок, выделяем до захвата мьютекса и возвращаем при отказе
+    // (сессию мог создать параллельный запрос того же IMSI)
+    SessionResources allocated;
+    if (!allocate_resources(allocated)) {
+        cdr_logger->log(imsi, "rejected: no resources");
+        cdr_logger->get_logger()->warn("Session creation rejected for IMSI (TEID or address pool exhausted)", imsi);
+        return false;
+    }
+
+    std::lock_guard<ProfiledMutex> lock(mutex);
+    SessionTable& shard = shard_of(imsi);
+    if (shard.find(imsi) != shard.end()) {
+        release_resources(allocated);
+        cdr_logger->log(imsi, "rejected: session already exists");
+        cdr_logger->get_logger()->info("Session creation rejected for IMSI (already exists)", imsi);
+        return false;
+    }
+
+    allocated.peer_teid = resources ? resources->peer_teid : 0;
+    auto it = shard.emplace(imsi, Session{ clock->wall_now(), clock->monotonic_now(), {}, allocated }).first;
+    // Узлы unordered_map не перемещаются при рехешировании, указатель на ключ стабилен
+    it->second.expiry = expiry_queue.insert(expiry_queue.end(), &it->first);
+    teid_sessions[allocated.teid] = &it->first;
+    index.insert(SubscriberIndex::pack(imsi));
+    if (listener) {
+        listener->on_session_created(make_record(imsi, it->second));
+    }
+    cdr_logger->log(imsi, "created");
+    cdr_logger->get_logger()->info("Session created for IMSI", imsi);
+    if (resources) {
+        *resources = allocated;
+    }
+    return true;
+}
+
+// Шард таблицы по хешу IMSI
+SessionManager::SessionTable& SessionManager::shard_of(const std::string& imsi) {
+    return sessions[std::hash<std::string>{}(imsi) % SHARDS];
+}
+
+// Проверяет наличие активной сессии
+bool SessionManager::has_session(const std::string& imsi) {
+    uint64_t key = SubscriberIndex::pack(imsi);
+    if (key != 0) {
+        return index.contains(key);
+    }
+    // IMSI нестандартной длины в индекс не попадают, ищем под мьютексом
+    std::lock_guard<ProfiledMutex> lock(mutex);
+    SessionTable& shard = shard_of(imsi);
+    return shard.find(imsi) != shard.end();
+}
+
+// Удаляет сессию из всех структур; узел очереди истечения известен, поиск не нужен
+void SessionManager::erase_session(SessionTable& shard, SessionTable::iterator it) {
+    index.erase(SubscriberIndex::pack(it->first));
+    if (it->second.resources.teid != 0) {
+        teid_sessions.erase(it->second.resources.teid);
+    }
+    release_resources(it->second.resources);
+    expiry_queue.erase(it->second.expiry);
+    shard.erase(it);
+}
+
+// Удаляет сессию по запросу абонента
+bool SessionManager::delete_session(const std::string& imsi, SessionResources* resources) {
+    std::lock_guard<ProfiledMutex> lock(mutex);
+    SessionTable& shard = shard_of(imsi);
+    auto it = shard.find(imsi);
+    if (it == shard.end()) {
+        cdr_logger->get_logger()->info("Session deletion failed for IMSI (not found)", imsi);
+        return false;
+    }
+    if (listener) {
+        listener->on_session_removed(make_record(imsi, it->second), false);
+    }
+    if (resources) {
+        *resources = it->second.resources;
+    }
+    erase_session(shard, it);
+    cdr_logger->log(imsi, "deleted");
+    cdr_logger->get_logger()->info("Session deleted for IMSI", imsi);
+    return true;
+}
+
+// Поиск по TEID под мьютексом: таблица TEID меняется вместе с таблицей сессий
+bool SessionManager::find_session_by_teid(uint32_t teid, std::string& imsi) {
+    std::lock_guard<ProfiledMutex> lock(mutex);
+    auto it = teid_sessions.find(teid);
+    if (it == teid_sessions.end()) {
+        return false;
+    }
+    imsi = *it->second;
+    return true;
+}
+
+// Удаляет сессии по списку IMSI; отсутствующие IMSI пропускаются
+size_t SessionManager::delete_sessions(const std::vector<std::string>& imsis) {
+    size_t deleted = 0;
+    std::lock_guard<ProfiledMutex> lock(mutex);
+    for (const auto& imsi : imsis) {
+        SessionTable& shard = shard_of(imsi);
+        auto it = shard.find(imsi);
+        if (it == shard.end()) {
+            continue;
+        }
+        if (listener) {
+            listener->on_session_removed(make_record(imsi, it->second), false);
+        }
+        erase_session(shard, it);
+        cdr_logger->log(imsi, "deleted");
+        ++deleted;
+    }
+    std::stringstream ss;
+    ss << "Batch deletion: " << deleted << " of " << imsis.size() << " sessions deleted";
+    cdr_logger->get_logger()->info(ss.str());
+    return deleted;
+}
+
+// Удаляет истёкшие сессии: они лежат в голове очереди истечения, остальные не просматриваются.
+// Возраст считается по монотонным часам: перевод системных часов не вызывает массового истечения
+size_t SessionManager::cleanup_expired_sessions() {
+    FlightSpan span(flight_recorder.get(), FlightEvent::ExpirySweep);
+    std::lock_guard<ProfiledMutex> lock(mutex);
+    auto now = clock->monotonic_now();
+    auto timeout = std::chrono::seconds(live_config()->get_session_timeout_sec());
+    size_t expired = 0;
+    while (!expiry_queue.empty()) {
+        SessionTable& shard = shard_of(*expiry_queue.front());
+        auto it = shard.find(*expiry_queue.front());
+        if (now - it->second.created_at <= timeout) {
+            break;
+        }
+        std::string imsi = it->first;
+        if (listener) {
+            listener->on_session_removed(make_record(imsi, it->second), true);
+        }
+        erase_session(shard, it);
+        cdr_logger->log(imsi, "deleted");
+        std::stringstream ss;
+        ss << "Expired session deleted for IMSI: " << imsi;
+        cdr_logger->get_logger()->info(ss.str());
+        ++expired;
+    }
+    // Таблицы индекса, заменённые при росте, и вытесненные снимки конфигурации
+    // освобождаются и без новых записей
+    index.reclaim();
+    if (config_store) {
+        config_store->reclaim();
+    }
+    span.set_value(expired);
+    return expired;
+}
+
+// Число активных сессий
+size_t SessionManager::get_session_count() {
+    std::lock_guard<ProfiledMutex> lock(mutex);
+    return expiry_queue.size();
+}
+
+SessionRecord SessionManager::make_record(const std::string& imsi, const Session& session) {
+    SessionRecord record;
+    record.imsi = imsi;
+    record.creation_time_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+        session.creation_time.time_since_epoch()).count();
+    record.resources = session.resources;
+    return record;
+}
+
+// Подключает наблюдателя изменений
+void SessionManager::set_listener(std::shared_ptr<ISessionListener> listener) {
+    std::lock_guard<ProfiledMutex> lock(mutex);
+    this->listener = listener;
+}
+
+// Подключает перезагружаемую конфигурацию
+void SessionManager::set_config_store(std::shared_ptr<ConfigStore> config_store) {
+    std::lock_guard<ProfiledMutex> lock(mutex);
+    this->config_store = config_store;
+}
+
+// Подключает бортовой самописец
+void SessionManager::set_flight_recorder(std::shared_ptr<FlightRecorder> flight_recorder) {
+    std::lock_guard<ProfiledMutex> lock(mutex);
+    this->flight_recorder = flight_recorder;
+}
+
+// Собирает все сессии в порядке создания и передаёт их consumer, не отпуская мьютекс
+void SessionManager::snapshot(const std::function<void(std::vector<SessionRecord>&)>& consumer) {
+    std::lock_guard<ProfiledMutex> lock(mutex);
+    std::vector<SessionRecord> records;
+    records.reserve(expiry_queue.size());
+    for (const std::string* imsi : expiry_queue) {
+        records.push_back(make_record(*imsi, shard_of(*imsi).find(*imsi)->second));
+    }
+    consumer(records);
+}
+
+// Восстанавливает сессии в порядке создания, чтобы очередь истечения осталась упорядоченной
+size_t SessionManager::restore_sessions(std::vector<SessionRecord> records) {
+    std::sort(records.begin(), records.end(), [](const SessionRecord& a, const SessionRecord& b) {
+        return a.creation_time_ms < b.creation_time_ms;
+    });
+    std::vector<uint32_t> restored_teids;
+    size_t restored = 0;
+    // Монотонное время создания восстанавливается по возрасту сессии в часах реального мира;
+    // сессия «из будущего» (расхождение часов узлов) считается только что созданной
+    auto wall_now = clock->wall_now();
+    auto monotonic_now = clock->monotonic_now();
+    std::lock_guard<ProfiledMutex> lock(mutex);
+    for (const auto& record : records) {
+        SessionTable& shard = shard_of(record.imsi);
+        if (shard.find(record.imsi) != shard.end()) {
+            continue;
+        }
+        // Адрес, который не удалось занять (другие пулы на резерве), не будет возвращён в пул при удалении
+        SessionResources resources = record.resources;
+        IPAddress address;
+        if (resources.has_ipv4) {
+            std::memcpy(address.bytes.data(), &resources.ipv4, sizeof(resources.ipv4));
+            if (!ip_pools.reserve(address)) {
+                resources.has_ipv4 = false;
+                cdr_logger->get_logger()->warn("Restored session address is outside pools or in use, IMSI {}", record.imsi);
+            }
+        }
+        if (resources.has_ipv6) {
+            address.ipv6 = true;
+            std::memcpy(address.bytes.data(), resources.ipv6, sizeof(resources.ipv6));
+            if (!ip_pools.reserve(address)) {
+                resources.has_ipv6 = false;
+                cdr_logger->get_logger()->warn("Restored session prefix is outside pools or in use, IMSI {}", record.imsi);
+            }
+        }
+        if (resources.teid > teids.get_capacity()) {
+            resources.teid = 0;
+        }
+        restored_teids.push_back(resources.teid);
+
+        auto creation_time = std::chrono::system_clock::time_point(std::chrono::milliseconds(record.creation_time_ms));
+        auto age = std::max(std::chrono::duration_cast<std::chrono::steady_clock::duration>(wall_now - creation_time),
+            std::chrono::steady_clock::duration::zero());
+        auto it = shard.emplace(record.imsi, Session{ creation_time, monotonic_now - age, {}, resources }).first;
+        it->second.expiry = expiry_queue.insert(expiry_queue.end(), &it->first);
+        if (resources.teid != 0) {
+            teid_sessions[resources.teid] = &it->first;
+        }
+        index.insert(SubscriberIndex::pack(record.imsi));
+        ++restored;
+    }
+    teids.reserve(std::move(restored_teids));
+
+    std::stringstream ss;
+    ss << "Restored " << restored << " sessions";
+    cdr_logger->get_logger()->info(ss.str());
+    return restored;
+}
+
+// Выгружает страницу таблицы по шардам. Мьютекс держится на копирование одного шарда,
+// между шардами создание и удаление сессий идут как обычно
+SessionExportPage SessionManager::export_sessions(size_t cursor, size_t limit) {
+    SessionExportPage page;
+    auto timeout = std::chrono::seconds(live_config()->get_session_timeout_sec());
+    size_t shard_index = std::min(cursor, SHARDS);
+    limit = std::max<size_t>(limit, 1);
+    while (shard_index < SHARDS && page.sessions.size() < limit) {
+        std::lock_guard<ProfiledMutex> lock(mutex);
+        // Срок истечения переводится из монотонных часов в часы реального мира
+        auto wall_now = clock->wall_now();
+        auto monotonic_now = clock->monotonic_now();
+        for (const auto& [imsi, session] : sessions[shard_index]) {
+            auto expires_at = wall_now + std::chrono::duration_cast<std::chrono::system_clock::duration>(
+                session.created_at + timeout - monotonic_now);
+            page.sessions.push_back({ imsi,
+                std::chrono::duration_cast<std::chrono::milliseconds>(session.creation_time.time_since_epoch()).count(),
+                std::chrono::duration_cast<std::chrono::milliseconds>(expires_at.time_since_epoch()).count() });
+        }
+        ++shard_index;
+    }
+    page.next_cursor = shard_index;
+    return page;
 }
\ No newline at end of file
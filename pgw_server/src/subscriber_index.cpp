@@ -0,0 +1,208 @@
+#include "subscriber_index.hpp"
+
+// Таблица: ёмкость всегда степень двойки, все слоты пусты
+SubscriberIndex::Table::Table(size_t capacity)
+    : mask(capacity - 1), slots(new std::atomic<uint64_t>[capacity]) {
+    for (size_t i = 0; i < capacity; ++i) {
+        slots[i].store(EMPTY, std::memory_order_relaxed);
+    }
+}
+
+// Конструктор: создаёт пустую таблицу начальной ёмкости
+SubscriberIndex::SubscriberIndex(size_t initial_capacity) : initial_capacity(1) {
+    while (this->initial_capacity < initial_capacity) {
+        this->initial_capacity <<= 1;
+    }
+    readers[0].store(0);
+    readers[1].store(0);
+    current.store(new Table(this->initial_capacity));
+}
+
+// Деструктор: читателей к этому моменту быть не должно
+SubscriberIndex::~SubscriberIndex() {
+    for (const auto& entry : retired) {
+        delete entry.table;
+    }
+    delete current.load();
+}
+
+// Упаковывает IMSI: старший байт — длина (ведущие нули различимы), младшие — число
+uint64_t SubscriberIndex::pack(const std::string& imsi) {
+    if (imsi.empty() || imsi.size() > 15) {
+        return EMPTY;
+    }
+    uint64_t value = 0;
+    for (char c : imsi) {
+        if (c < '0' || c > '9') {
+            return EMPTY;
+        }
+        value = value * 10 + static_cast<uint64_t>(c - '0');
+    }
+    return (static_cast<uint64_t>(imsi.size()) << 56) | value;
+}
+
+// Перемешивание ключа (финализатор splitmix64)
+size_t SubscriberIndex::hash(uint64_t key) {
+    key ^= key >> 30;
+    key *= 0xbf58476d1ce4e5b9ULL;
+    key ^= key >> 27;
+    key *= 0x94d049bb133111ebULL;
+    key ^= key >> 31;
+    return static_cast<size_t>(key);
+}
+
+// Поиск без блокировок: читатель отмечается в счётчике своей эпохи и проходит
+// не более чем всю таблицу, поэтому завершается за ограниченное число шагов
+bool SubscriberIndex::contains(uint64_t key) const {
+    if (key == EMPTY) {
+        return false;
+    }
+    uint32_t e = epoch.load() & 1;
+    readers[e].fetch_add(1);
+    const Table* table = current.load();
+    size_t i = hash(key) & table->mask;
+    bool found = false;
+    for (size_t probes = 0; probes <= table->mask; ++probes) {
+        uint64_t slot = table->slots[i].load(std::memory_order_acquire);
+        if (slot == key) {
+            found = true;
+            break;
+        }
+        if (slot == EMPTY) {
+            break;
+        }
+        i = (i + 1) & table->mask;
+    }
+    readers[e].fetch_sub(1);
+    return found;
+}
+
+// Добавляет ключ, переиспользуя надгробия; заполненность держится не выше половины
+void SubscriberIndex::insert(uint64_t key) {
+    if (key == EMPTY) {
+        return;
+    }
+    if (!retired.empty()) {
+        reclaim();
+    }
+    Table* table = current.load(std::memory_order_relaxed);
+    if ((used + 1) * 2 > table->mask + 1) {
+        size_t capacity = initial_capacity;
+        while (capacity < (live + 1) * 4) {
+            capacity <<= 1;
+        }
+        rebuild(capacity, true);
+        table = current.load(std::memory_order_relaxed);
+    }
+
+    size_t i = hash(key) & table->mask;
+    size_t tombstone = table->mask + 1;
+    for (;;) {
+        uint64_t slot = table->slots[i].load(std::memory_order_relaxed);
+        if (slot == key) {
+            return;
+        }
+        if (slot == TOMBSTONE && tombstone > table->mask) {
+            tombstone = i;
+        }
+        if (slot == EMPTY) {
+            break;
+        }
+        i = (i + 1) & table->mask;
+    }
+    if (tombstone <= table->mask) {
+        i = tombstone;
+    }
+    else {
+        ++used;
+    }
+    table->slots[i].store(key, std::memory_order_release);
+    ++live;
+}
+
+// Удаляет ключ, оставляя надгробие, чтобы не разрывать цепочки проб читателей
+void SubscriberIndex::erase(uint64_t key) {
+    if (key == EMPTY) {
+        return;
+    }
+    if (!retired.empty()) {
+        reclaim();
+    }
+    Table* table = current.load(std::memory_order_relaxed);
+    size_t i = hash(key) & table->mask;
+    for (size_t probes = 0; probes <= table->mask; ++probes) {
+        uint64_t slot = table->slots[i].load(std::memory_order_relaxed);
+        if (slot == key) {
+            table->slots[i].store(TOMBSTONE, std::memory_order_release);
+            --live;
+            return;
+        }
+        if (slot == EMPTY) {
+            return;
+        }
+        i = (i + 1) & table->mask;
+    }
+}
+
+// Очищает индекс публикацией новой пустой таблицы
+void SubscriberIndex::clear() {
+    rebuild(initial_capacity, false);
+    live = 0;
+    used = 0;
+}
+
+// Строит новую таблицу, подменяет указатель и откладывает старую до ухода её читателей
+void SubscriberIndex::rebuild(size_t capacity, bool copy_keys) {
+    Table* old_table = current.load(std::memory_order_relaxed);
+    Table* new_table = new Table(capacity);
+    if (copy_keys) {
+        for (size_t j = 0; j <= old_table->mask; ++j) {
+            uint64_t key = old_table->slots[j].load(std::memory_order_relaxed);
+            if (key == EMPTY || key == TOMBSTONE) {
+                continue;
+            }
+            size_t i = hash(key) & new_table->mask;
+            while (new_table->slots[i].load(std::memory_order_relaxed) != EMPTY) {
+                i = (i + 1) & new_table->mask;
+            }
+            new_table->slots[i].store(key, std::memory_order_relaxed);
+        }
+        used = live;
+    }
+    current.store(new_table);
+    retired.push_back({ old_table, { false, false } });
+    reclaim();
+}
+
+// Старую таблицу мог взять только читатель, отметившийся в счётчике до замены указателя.
+// Когда после замены обнулились счётчики обеих эпох, таких читателей не осталось.
+// Новые читатели отмечаются в счётчике текущей эпохи, поэтому счётчик другой эпохи
+// только убывает; когда он обнулился для всех отложенных таблиц, эпоха переключается,
+// и обнуляться начинает второй счётчик. Писатель проверяет счётчики и не ждёт
+void SubscriberIndex::reclaim() {
+    if (retired.empty()) {
+        return;
+    }
+    for (uint32_t e = 0; e < 2; ++e) {
+        if (readers[e].load() == 0) {
+            for (auto& entry : retired) {
+                entry.drained[e] = true;
+            }
+        }
+    }
+    uint32_t inactive = (epoch.load() & 1) ^ 1;
+    bool inactive_drained = true;
+    size_t kept = 0;
+    for (auto& entry : retired) {
+        if (entry.drained[0] && entry.drained[1]) {
+            delete entry.table;
+            continue;
+        }
+        inactive_drained = inactive_drained && entry.drained[inactive];
+        retired[kept++] = entry;
+    }
+    retired.resize(kept);
+    if (kept > 0 && inactive_drained) {
+        epoch.fetch_add(1);
+    }
+}
\ No newline at end of file
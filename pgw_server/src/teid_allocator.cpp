@@ -0,0 +1,141 @@
+#include "teid_allocator.hpp"
+#include <algorithm>
+#include <stdexcept>
+
+// Конструктор: массив связей не инициализируется, элемент записывается при освобождении TEID
+TEIDAllocator::TEIDAllocator(uint32_t capacity, size_t cache_slots)
+    : capacity(capacity), next(new std::atomic<uint32_t>[static_cast<size_t>(capacity) + 1]), cache(cache_slots) {
+    if (capacity == 0) {
+        throw std::runtime_error("TEID pool capacity must be positive");
+    }
+}
+
+// Стек Трайбера: тег в старших 32 битах головы меняется при каждом снятии,
+// поэтому CAS не пройдёт, если вершину успели снять и вернуть (ABA)
+bool TEIDAllocator::pop_free(uint32_t& teid) {
+    uint64_t current = head.load(std::memory_order_acquire);
+    while (static_cast<uint32_t>(current) != 0) {
+        uint32_t top = static_cast<uint32_t>(current);
+        uint32_t below = next[top].load(std::memory_order_relaxed);
+        uint64_t updated = (((current >> 32) + 1) << 32) | below;
+        if (head.compare_exchange_weak(current, updated, std::memory_order_acq_rel, std::memory_order_acquire)) {
+            teid = top;
+            return true;
+        }
+    }
+    return false;
+}
+
+void TEIDAllocator::push_free(uint32_t teid) {
+    uint64_t current = head.load(std::memory_order_relaxed);
+    do {
+        next[teid].store(static_cast<uint32_t>(current), std::memory_order_relaxed);
+    } while (!head.compare_exchange_weak(current, (current & 0xFFFFFFFF00000000ULL) | teid,
+        std::memory_order_release, std::memory_order_relaxed));
+}
+
+// Заполняет половину магазина, оставляя место под освобождения
+void TEIDAllocator::refill(PerCoreCache::Magazine* magazine) {
+    const size_t batch = PerCoreCache::MAGAZINE_SIZE / 2;
+    if (fresh.load(std::memory_order_relaxed) <= capacity) {
+        uint64_t first = fresh.fetch_add(batch, std::memory_order_relaxed);
+        uint64_t last = std::min<uint64_t>(first + batch, static_cast<uint64_t>(capacity) + 1);
+        // Раздаём в обратном порядке, чтобы из магазина TEID выходили по возрастанию
+        for (uint64_t teid = last; teid > first; --teid) {
+            magazine->items[magazine->count++] = static_cast<uint32_t>(teid - 1);
+        }
+    }
+    uint32_t teid;
+    while (magazine->count < batch && pop_free(teid)) {
+        magazine->items[magazine->count++] = teid;
+    }
+}
+
+// Обходит магазины других ядер; занятые пропускает
+bool TEIDAllocator::steal(uint32_t& teid) {
+    for (size_t slot = 0; slot < cache.get_slots(); ++slot) {
+        PerCoreCache::Magazine* magazine = cache.acquire_slot(slot);
+        if (!magazine) {
+            continue;
+        }
+        bool found = magazine->count > 0;
+        if (found) {
+            teid = magazine->items[--magazine->count];
+        }
+        cache.release(magazine);
+        if (found) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Выделяет TEID: сначала из магазина своего ядра, затем из общего пула
+uint32_t TEIDAllocator::allocate() {
+    uint32_t teid = 0;
+    PerCoreCache::Magazine* magazine = cache.acquire();
+    if (magazine) {
+        if (magazine->count == 0) {
+            refill(magazine);
+        }
+        if (magazine->count > 0) {
+            teid = magazine->items[--magazine->count];
+        }
+        cache.release(magazine);
+    }
+    if (teid == 0 && fresh.load(std::memory_order_relaxed) <= capacity) {
+        uint64_t candidate = fresh.fetch_add(1, std::memory_order_relaxed);
+        if (candidate <= capacity) {
+            teid = static_cast<uint32_t>(candidate);
+        }
+    }
+    if (teid == 0 && !pop_free(teid) && !steal(teid)) {
+        return 0;
+    }
+    used.fetch_add(1, std::memory_order_relaxed);
+    return teid;
+}
+
+// Возвращает TEID в магазин своего ядра; полный магазин сбрасывает половину в общий стек
+void TEIDAllocator::release(uint32_t teid) {
+    if (teid == 0 || teid > capacity) {
+        return;
+    }
+    used.fetch_sub(1, std::memory_order_relaxed);
+    PerCoreCache::Magazine* magazine = cache.acquire();
+    if (!magazine) {
+        push_free(teid);
+        return;
+    }
+    if (magazine->count == PerCoreCache::MAGAZINE_SIZE) {
+        while (magazine->count > PerCoreCache::MAGAZINE_SIZE / 2) {
+            push_free(magazine->items[--magazine->count]);
+        }
+    }
+    magazine->items[magazine->count++] = teid;
+    cache.release(magazine);
+}
+
+// Все TEID до наибольшего занятого считаются выданными, незанятые из них кладутся на стек свободных
+void TEIDAllocator::reserve(std::vector<uint32_t> teids) {
+    std::sort(teids.begin(), teids.end());
+    teids.erase(std::unique(teids.begin(), teids.end()), teids.end());
+    teids.erase(std::remove_if(teids.begin(), teids.end(), [this](uint32_t teid) {
+        return teid == 0 || teid > capacity;
+    }), teids.end());
+    if (teids.empty()) {
+        return;
+    }
+    uint32_t last = teids.back();
+    size_t position = teids.size();
+    // Обход сверху вниз: на вершине стека окажутся меньшие TEID
+    for (uint32_t teid = last; teid > 0; --teid) {
+        if (position > 0 && teids[position - 1] == teid) {
+            --position;
+            continue;
+        }
+        push_free(teid);
+    }
+    fresh.store(static_cast<uint64_t>(last) + 1, std::memory_order_relaxed);
+    used.fetch_add(static_cast<int64_t>(teids.size()), std::memory_order_relaxed);
+}
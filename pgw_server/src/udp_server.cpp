@@ -1,164 +1,572 @@
-#include "udp_server.hpp"
-#include <cstring>
-#include <sys/socket.h>
-#include <netinet/in.h>
-#include <arpa/inet.h>
-#include <unistd.h>
-#include <fcntl.h>
-#include <regex>
-#include <sstream>
-
-//  Socket:  UDP-
-Socket::Socket() : fd(socket(AF_INET, SOCK_DGRAM, 0)) {
-    if (fd < 0) {
-        throw std::runtime_error("Failed to create socket: " + std::string(strerror(errno)));
-    }
-    //  SO_REUSEADDR
-    int opt = 1;
-    if (setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt)) < 0) {
-        throw std::runtime_error("Failed to set SO_REUSEADDR: " + std::string(strerror(errno)));
-    }
-}
-
-//  Socket:  
-Socket::~Socket() {
-    if (fd >= 0) {
-        close(fd);
-    }
-}
-
-//     
-void Socket::set_non_blocking() {
-    if (fcntl(fd, F_SETFL, O_NONBLOCK) < 0) {
-        throw std::runtime_error("Failed to set socket to non-blocking: " + std::string(strerror(errno)));
-    }
-}
-
-//    IP  
-void Socket::bind(const std::string& ip, int port) {
-    struct sockaddr_in server_addr = {};
-    server_addr.sin_family = AF_INET;
-    server_addr.sin_addr.s_addr = inet_addr(ip.c_str());
-    server_addr.sin_port = htons(port);
-
-    if (::bind(fd, (struct sockaddr*)&server_addr, sizeof(server_addr)) < 0) {
-        throw std::runtime_error("Failed to bind socket: " + std::string(strerror(errno)));
-    }
-}
-
-// :  UDP-
-UDPServer::UDPServer(const Config& config, std::shared_ptr<ISessionManager> session_manager, std::shared_ptr<CDRLogger> cdr_logger)
-    : config(config), session_manager(session_manager), cdr_logger(cdr_logger), running(false) {
-    std::stringstream ss;
-    ss << "Initializing UDP Server on " << config.get_udp_ip() << ":" << config.get_udp_port();
-    cdr_logger->get_logger()->info(ss.str());
-}
-
-// :  
-UDPServer::~UDPServer() {
-    stop();
-}
-
-//  BCD- IMSI
-std::string UDPServer::decode_bcd(const char* buffer, ssize_t length) {
-    std::string imsi;
-    for (ssize_t i = 0; i < length; ++i) {
-        char high = (buffer[i] >> 4) & 0xF;
-        char low = buffer[i] & 0xF;
-        if (high != 0xF) imsi.push_back(high + '0');
-        if (low != 0xF) imsi.push_back(low + '0');
-    }
-    cdr_logger->get_logger()->info("Decoded IMSI", imsi);
-    return imsi;
-}
-
-//     
-void UDPServer::run() {
-    socket.set_non_blocking();
-    socket.bind(config.get_udp_ip(), config.get_udp_port());
-    std::stringstream ss;
-    ss << "UDP Server started on " << config.get_udp_ip() << ":" << config.get_udp_port();
-    cdr_logger->get_logger()->info(ss.str());
-    running = true;
-
-    //    
-    for (size_t i = 0; i < NUM_THREADS; ++i) {
-        workers.emplace_back(&UDPServer::worker_thread, this);
-    }
-
-    char buffer[BUFFER_SIZE];
-    struct sockaddr_in client_addr;
-    socklen_t addr_len = sizeof(client_addr);
-
-    //    UDP-
-    while (running) {
-        ssize_t n = recvfrom(socket.get_fd(), buffer, BUFFER_SIZE - 1, 0, (struct sockaddr*)&client_addr, &addr_len);
-        if (n < 0) {
-            if (errno == EAGAIN || errno == EWOULDBLOCK) {
-                std::this_thread::sleep_for(std::chrono::milliseconds(10));
-                continue;
-            }
-            if (running) {
-                cdr_logger->get_logger()->error("Failed to receive data", strerror(errno));
-            }
-            continue;
-        }
-
-        buffer[n] = '\0'; //  
-        std::string imsi = decode_bcd(buffer, n);
-        {
-            std::lock_guard<std::mutex> lock(queue_mutex);
-            request_queue.emplace(imsi, client_addr, addr_len);
-            cdr_logger->get_logger()->info("Enqueued IMSI", imsi);
-        }
-        queue_cond.notify_one();
-    }
-}
-
-//    
-void UDPServer::worker_thread() {
-    while (running) {
-        std::tuple<std::string, struct sockaddr_in, socklen_t> request;
-        {
-            std::unique_lock<std::mutex> lock(queue_mutex);
-            queue_cond.wait(lock, [this] { return !request_queue.empty() || !running; });
-            if (!running && request_queue.empty()) return;
-            request = request_queue.front();
-            request_queue.pop();
-        }
-        process_request(std::get<0>(request), std::get<1>(request), std::get<2>(request));
-    }
-}
-
-//   IMSI
-void UDPServer::process_request(const std::string& imsi, const struct sockaddr_in& client_addr, socklen_t addr_len) {
-    std::regex imsi_regex("^[0-9]{15}$");
-    if (!std::regex_match(imsi, imsi_regex)) {
-        cdr_logger->get_logger()->info("Invalid IMSI format", imsi);
-        sendto(socket.get_fd(), "rejected", strlen("rejected"), 0, (struct sockaddr*)&client_addr, addr_len);
-        return;
-    }
-
-    bool created = session_manager->create_session(imsi);
-    std::string response = created ? "created" : "rejected";
-    std::stringstream ss;
-    ss << "Processed IMSI: " << imsi << ", response: " << response;
-    cdr_logger->get_logger()->info(ss.str());
-    sendto(socket.get_fd(), response.c_str(), response.size(), 0, (struct sockaddr*)&client_addr, addr_len);
-}
-
-//    
-void UDPServer::stop() {
-    if (running) {
-        running = false;
-        queue_cond.notify_all();
-        for (auto& worker : workers) {
-            if (worker.joinable()) {
-                worker.join();
-            }
-        }
-        workers.clear();
-        cdr_logger->get_logger()->info("UDP Server stopped");
-        cdr_logger->get_logger()->flush();
-    }
+#include "udp_server.hpp"
+#include "clock.hpp"
+#include <cstring>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+#include <poll.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/eventfd.h>
+#include <regex>
+#include <algorithm>
+#include <sstream>
+
+namespace {
+
+// Подсказка процессору внутри цикла опроса: не занимать конвейер соседнего гиперпотока
+inline void cpu_relax() {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__)
+    asm volatile("yield");
+#endif
+}
+
+} // namespace
+
+// Конструктор: инициализирует UDP-сервер
+UDPServer::UDPServer(const Config& config, std::shared_ptr<ISessionManager> session_manager, std::shared_ptr<CDRLogger> cdr_logger,
+    std::shared_ptr<IDatagramTransport> transport)
+    : config(config), session_manager(session_manager), cdr_logger(cdr_logger),
+    transport(transport ? transport : std::make_shared<UDPSocketTransport>()), wake_fd(eventfd(0, EFD_NONBLOCK)), running(false),
+    gtp_mode(config.get_protocol() == "gtpv2c"), gtp_address(inet_addr(config.get_udp_ip().c_str())),
+    response_cache(std::chrono::milliseconds(config.get_retransmit_ttl_ms()),
+        static_cast<size_t>(std::max(config.get_retransmit_cache_size(), 0))),
+    admission_control(std::make_shared<AdmissionControl>(config.get_rate_limit_per_sec(), config.get_rate_limit_burst(),
+        static_cast<size_t>(std::max(config.get_max_queue_depth(), 0)))),
+    latency_stats(std::make_shared<LatencyStats>()),
+    heavy_hitters(std::make_shared<HeavyHitters>(static_cast<size_t>(config.get_heavy_hitters_top_k()),
+        std::chrono::seconds(config.get_heavy_hitters_window_sec()))),
+    packet_capture(std::make_shared<PacketCapture>(static_cast<size_t>(config.get_capture_ring_slots()),
+        inet_addr(config.get_udp_ip().c_str()), htons(static_cast<uint16_t>(config.get_udp_port())))),
+    busy_poll(config.get_busy_poll()), busy_poll_idle(std::max(config.get_busy_poll_idle_ms(), 0)),
+    pool_sizer(std::make_shared<WorkerPoolSizer>(config.get_worker_threads_min(), config.get_worker_threads_max(),
+        std::chrono::microseconds(config.get_worker_grow_wait_us()), std::chrono::milliseconds(config.get_worker_shrink_idle_ms()))) {
+    if (wake_fd < 0) {
+        throw std::runtime_error("Failed to create eventfd: " + std::string(strerror(errno)));
+    }
+    std::stringstream ss;
+    ss << "Initializing UDP Server on " << config.get_udp_ip() << ":" << config.get_udp_port()
+       << " (protocol: " << config.get_protocol() << ")";
+    cdr_logger->get_logger()->info(ss.str());
+}
+
+// Деструктор: останавливает сервер
+UDPServer::~UDPServer() {
+    stop();
+    close(wake_fd);
+}
+
+// Декодирует BCD-кодировку IMSI
+std::string UDPServer::decode_bcd(const char* buffer, ssize_t length) {
+    std::string imsi;
+    for (ssize_t i = 0; i < length; ++i) {
+        char high = (buffer[i] >> 4) & 0xF;
+        char low = buffer[i] & 0xF;
+        if (high != 0xF) imsi.push_back(high + '0');
+        if (low != 0xF) imsi.push_back(low + '0');
+    }
+    cdr_logger->get_logger()->info("Decoded IMSI", imsi);
+    return imsi;
+}
+
+// Запускает сервер и пул потоков
+void UDPServer::run(std::function<void()> on_started) {
+    transport->open(config.get_udp_ip(), config.get_udp_port());
+    // Без меток сервер работает, но /latency не отличит ожидание в сокете от ожидания в очереди
+    try {
+        transport->enable_receive_timestamps();
+    }
+    catch (const std::exception& e) {
+        cdr_logger->get_logger()->warn("{}", e.what());
+    }
+    std::stringstream ss;
+    ss << "UDP Server started on " << config.get_udp_ip() << ":" << config.get_udp_port();
+    cdr_logger->get_logger()->info(ss.str());
+    running = true;
+    if (busy_poll) {
+        enable_busy_poll();
+    }
+
+    // Запускаем пул рабочих потоков минимального размера; дальше его меняет adjust_workers()
+    {
+        std::lock_guard<ProfiledMutex> lock(queue_mutex);
+        active_workers = pool_sizer->get_target();
+        spawn_workers(active_workers);
+    }
+    if (on_started) {
+        on_started();
+    }
+
+    char buffer[BUFFER_SIZE];
+    struct sockaddr_in client_addr;
+    socklen_t addr_len = sizeof(client_addr);
+
+    // В режиме опроса — момент последней датаграммы (или пробуждения): по нему опрос сменяется ожиданием
+    auto last_activity = std::chrono::steady_clock::now();
+    uint64_t spins = 0;
+
+    // Основной цикл приёма UDP-запросов
+    while (running) {
+        int64_t kernel_rx_ns = 0;
+        ssize_t n = receive_datagram(buffer, BUFFER_SIZE - 1, client_addr, addr_len, kernel_rx_ns);
+        if (n < 0) {
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                if (busy_poll && std::chrono::steady_clock::now() - last_activity < busy_poll_idle) {
+                    // Изредка уступаем ядро: если рабочий поток делит его с потоком приёма,
+                    // ответ не ждёт конца кванта планировщика
+                    if ((++spins & (BUSY_POLL_YIELD_EVERY - 1)) == 0) {
+                        std::this_thread::yield();
+                    }
+                    else {
+                        cpu_relax();
+                    }
+                    continue;
+                }
+                // Перед сном снимок топа догоняет последние датаграммы
+                heavy_hitters->publish(std::chrono::steady_clock::now());
+                // Ждём датаграмму или пробуждение от stop() без опроса по таймеру
+                struct pollfd fds[2] = { { transport->get_poll_fd(), POLLIN, 0 }, { wake_fd, POLLIN, 0 } };
+                poll(fds, 2, -1);
+                if (busy_poll) {
+                    ++busy_poll_fallbacks;
+                    last_activity = std::chrono::steady_clock::now();
+                }
+                continue;
+            }
+            if (running) {
+                cdr_logger->get_logger()->error("Failed to receive data", strerror(errno));
+            }
+            continue;
+        }
+
+        buffer[n] = '\0'; // Завершаем строку
+        if (flight_recorder) {
+            flight_recorder->instant(FlightEvent::Receive, static_cast<uint64_t>(n));
+        }
+        if (busy_poll) {
+            last_activity = std::chrono::steady_clock::now();
+        }
+
+        // Пир учитывается до ограничения скорости: флудер попадает в топ, даже если его отбрасывают
+        auto received_at = std::chrono::steady_clock::now();
+        heavy_hitters->record_peer(client_addr, received_at);
+
+        // Выключенный захват — одна загрузка флага. Без фильтра по IMSI датаграмма сохраняется до разбора,
+        // поэтому в захват попадают и отброшенные ограничением скорости, и нераспознанные
+        bool capturing = packet_capture->is_enabled();
+        bool captured = capturing && packet_capture->record_request(buffer, n, client_addr, kernel_rx_ns, nullptr);
+
+        // Пир превысил свою скорость: отбрасываем без ответа, чтобы не усиливать поток
+        if (!admission_control->admit_peer(client_addr, received_at)) {
+            cdr_logger->get_logger()->debug("Dropped request from rate-limited peer", inet_ntoa(client_addr.sin_addr));
+            continue;
+        }
+
+        UDPRequest request;
+        request.client_addr = client_addr;
+        request.addr_len = addr_len;
+        request.kernel_rx_ns = kernel_rx_ns;
+        if (!decode_request(buffer, n, request)) {
+            continue;
+        }
+        heavy_hitters->record_imsi(request.imsi, received_at);
+        if (capturing && !captured) {
+            captured = packet_capture->record_request(buffer, n, client_addr, kernel_rx_ns, &request.imsi);
+        }
+        request.captured = captured;
+
+        // Повтор уже принятого запроса: отвечаем из кэша, не трогая сессии и CDR
+        std::string cached_response;
+        auto cached = response_cache.lookup(client_addr, request.request_id, cached_response);
+        if (cached == ResponseCache::Lookup::Hit) {
+            transport->send(cached_response.data(), cached_response.size(), client_addr, addr_len);
+            if (flight_recorder) {
+                flight_recorder->instant(FlightEvent::Send, cached_response.size());
+            }
+            if (captured) {
+                packet_capture->record_reply(cached_response.data(), cached_response.size(), client_addr);
+            }
+            cdr_logger->get_logger()->debug("Replayed cached response");
+            continue;
+        }
+        if (cached == ResponseCache::Lookup::Pending) {
+            cdr_logger->get_logger()->debug("Dropped retransmission of request in progress");
+            continue;
+        }
+
+        bool overloaded = false;
+        {
+            std::lock_guard<ProfiledMutex> lock(queue_mutex);
+            if (admission_control->admit_queue(request_queue.size())) {
+                cdr_logger->get_logger()->info("Enqueued IMSI", request.imsi);
+                request.enqueued_at = std::chrono::steady_clock::now();
+                request_queue.push(request);
+                if (flight_recorder) {
+                    flight_recorder->instant(FlightEvent::Enqueue, request_queue.size());
+                }
+            }
+            else {
+                overloaded = true;
+            }
+        }
+        if (overloaded) {
+            // Очередь переполнена: сразу отказываем, повтор запроса позже будет обработан заново
+            response_cache.forget(client_addr, request.request_id);
+            uint8_t reply[BUFFER_SIZE];
+            size_t reply_length = encode_response(request, Outcome::Overload, nullptr, reply, sizeof(reply));
+            transport->send(reply, reply_length, client_addr, addr_len);
+            if (flight_recorder) {
+                flight_recorder->instant(FlightEvent::Send, reply_length);
+            }
+            if (captured) {
+                packet_capture->record_reply(reply, reply_length, client_addr);
+            }
+            cdr_logger->get_logger()->warn("Rejected IMSI due to overload", request.imsi);
+            continue;
+        }
+        queue_cond.notify_one();
+    }
+}
+
+// Обрабатывает запросы из очереди
+void UDPServer::worker_thread(size_t index) {
+    ProfiledLock lock(queue_mutex);
+    while (running) {
+        if (index >= active_workers) {
+            // Поток лишний: паркуется, не занимая процессор, и не перехватывает пробуждения очереди
+            if (!request_queue.empty()) {
+                queue_cond.notify_one();
+            }
+            park_cond.wait(lock, [this, index] { return index < active_workers || !running; });
+            continue;
+        }
+        queue_cond.wait(lock, [this, index] { return !request_queue.empty() || !running || index >= active_workers; });
+        if (request_queue.empty() || index >= active_workers) {
+            continue;
+        }
+        UDPRequest request = std::move(request_queue.front());
+        request_queue.pop();
+        lock.unlock();
+
+        auto dequeued_at = std::chrono::steady_clock::now();
+        pool_sizer->record_dequeue(dequeued_at - request.enqueued_at);
+        latency_stats->record_queue_wait(dequeued_at - request.enqueued_at);
+        process_request(request);
+        pool_sizer->record_busy(std::chrono::steady_clock::now() - dequeued_at);
+
+        lock.lock();
+    }
+    // Остановка: разбираем остаток очереди, как раньше
+    while (!request_queue.empty()) {
+        UDPRequest request = std::move(request_queue.front());
+        request_queue.pop();
+        lock.unlock();
+        process_request(request);
+        lock.lock();
+    }
+}
+
+// Включает режим опроса: SO_BUSY_POLL в транспорте и привязка потока приёма к ядру.
+// Ошибки не фатальны: без CAP_NET_ADMIN ядро может не дать поднять SO_BUSY_POLL,
+// и тогда поток приёма всё равно опрашивает сокет сам
+void UDPServer::enable_busy_poll() {
+    auto server_logger = cdr_logger->get_logger();
+    try {
+        transport->enable_busy_poll(config.get_busy_poll_socket_us());
+    }
+    catch (const std::exception& e) {
+        server_logger->warn("{}", e.what());
+    }
+    int cpu = config.get_busy_poll_cpu();
+    if (cpu >= 0) {
+        cpu_set_t cpus;
+        CPU_ZERO(&cpus);
+        CPU_SET(cpu, &cpus);
+        int error = pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus);
+        if (error != 0) {
+            server_logger->warn("Failed to pin UDP receive thread: {}", strerror(error));
+        }
+    }
+    server_logger->info("Busy-poll receive enabled, blocking after idle ms: {}", std::to_string(busy_poll_idle.count()));
+}
+
+// Читает датаграмму из транспорта: обновляет счётчик отброшенных и учитывает ожидание
+// от прихода (метка CLOCK_REALTIME) до чтения потоком приёма
+ssize_t UDPServer::receive_datagram(char* buffer, size_t capacity, struct sockaddr_in& client_addr, socklen_t& addr_len,
+    int64_t& kernel_rx_ns) {
+    DatagramInfo info;
+    ssize_t n = transport->receive(buffer, capacity, client_addr, addr_len, info);
+    if (n < 0) {
+        return n;
+    }
+    if (info.has_drops) {
+        latency_stats->update_socket_drops(info.drops);
+    }
+    kernel_rx_ns = info.rx_ns;
+    if (kernel_rx_ns != 0) {
+        latency_stats->record_socket_wait(std::chrono::nanoseconds(realtime_ns() - kernel_rx_ns));
+    }
+    else {
+        latency_stats->record_untimestamped();
+    }
+    return n;
+}
+
+// Запускает недостающие рабочие потоки
+void UDPServer::spawn_workers(size_t count) {
+    while (workers.size() < count) {
+        workers.emplace_back(&UDPServer::worker_thread, this, workers.size());
+    }
+}
+
+// Подключает бортовой самописец
+void UDPServer::set_flight_recorder(std::shared_ptr<FlightRecorder> flight_recorder) {
+    this->flight_recorder = flight_recorder;
+}
+
+// Тик регулятора размера пула
+void UDPServer::adjust_workers() {
+    std::lock_guard<ProfiledMutex> lock(queue_mutex);
+    if (!running) {
+        return;
+    }
+    size_t target = pool_sizer->adjust(request_queue.size(), std::chrono::steady_clock::now());
+    if (target == active_workers) {
+        return;
+    }
+    // Потоки не завершаются при сокращении, а паркуются: следующий рост не платит за их создание
+    spawn_workers(target);
+    active_workers = target;
+    queue_cond.notify_all();
+    park_cond.notify_all();
+}
+
+// Декодирует датаграмму: в режиме BCD ключ кэша — сама датаграмма,
+// в режиме GTPv2-C — тип сообщения и номер последовательности
+bool UDPServer::decode_request(const char* buffer, ssize_t length, UDPRequest& request) {
+    if (!gtp_mode) {
+        request.request_id.assign(buffer, length);
+        if (length > 0 && static_cast<uint8_t>(buffer[0]) == BCD_DELETE_MARKER) {
+            request.message_type = gtpv2c::DELETE_SESSION_REQUEST;
+            request.imsi = decode_bcd(buffer + 1, length - 1);
+        }
+        else {
+            request.imsi = decode_bcd(buffer, length);
+        }
+        return true;
+    }
+
+    gtpv2c::MessageView message;
+    if (gtpv2c::parse(reinterpret_cast<const uint8_t*>(buffer), static_cast<size_t>(length), message) != gtpv2c::ParseResult::OK) {
+        cdr_logger->get_logger()->warn("Dropped malformed GTPv2-C message");
+        return false;
+    }
+    if (message.type != gtpv2c::CREATE_SESSION_REQUEST && message.type != gtpv2c::DELETE_SESSION_REQUEST) {
+        cdr_logger->get_logger()->warn("Dropped unexpected GTPv2-C message type", std::to_string(message.type));
+        return false;
+    }
+
+    request.message_type = message.type;
+    request.sequence = message.sequence;
+    char id[4] = { static_cast<char>(message.type), static_cast<char>(message.sequence >> 16),
+        static_cast<char>(message.sequence >> 8), static_cast<char>(message.sequence) };
+    request.request_id.assign(id, sizeof(id));
+
+    gtpv2c::FTEID sender;
+    if (message.type == gtpv2c::CREATE_SESSION_REQUEST && gtpv2c::decode_fteid(message.fteid, sender)) {
+        request.peer_teid = sender.teid;
+    }
+    if (message.has_teid) {
+        request.teid = message.teid;
+    }
+    request.imsi_missing = !message.imsi.present();
+    char digits[gtpv2c::MAX_IMSI_DIGITS];
+    size_t count = gtpv2c::decode_imsi(message.imsi, digits, sizeof(digits));
+    request.imsi.assign(digits, count);
+    cdr_logger->get_logger()->info("Decoded IMSI", request.imsi);
+    return true;
+}
+
+// Кодирует ответ: строки в режиме BCD, Create/Delete Session Response в режиме GTPv2-C.
+// Ответ на успешное создание несёт F-TEID PGW (instance 1) и PAA с адресами UE; ответ на удаление
+// адресован TEID SGW, сохранённому с сессией (resources удалённой сессии)
+size_t UDPServer::encode_response(const UDPRequest& request, Outcome outcome, const SessionResources* resources,
+    uint8_t* out, size_t capacity) {
+    if (!gtp_mode) {
+        const char* text = outcome == Outcome::Created ? "created"
+            : outcome == Outcome::Deleted ? "deleted"
+            : outcome == Outcome::NotFound ? "not found"
+            : outcome == Outcome::Overload ? "rejected: overload"
+            : "rejected";
+        size_t length = std::min(strlen(text), capacity);
+        memcpy(out, text, length);
+        return length;
+    }
+
+    uint8_t cause = gtpv2c::CAUSE_REQUEST_REJECTED;
+    switch (outcome) {
+    case Outcome::Created: cause = gtpv2c::CAUSE_REQUEST_ACCEPTED; break;
+    case Outcome::Rejected: cause = gtpv2c::CAUSE_REQUEST_REJECTED; break;
+    case Outcome::Deleted: cause = gtpv2c::CAUSE_REQUEST_ACCEPTED; break;
+    case Outcome::NotFound: cause = gtpv2c::CAUSE_CONTEXT_NOT_FOUND; break;
+    case Outcome::InvalidImsi: cause = gtpv2c::CAUSE_MANDATORY_IE_INCORRECT; break;
+    case Outcome::MissingImsi: cause = gtpv2c::CAUSE_MANDATORY_IE_MISSING; break;
+    case Outcome::Overload: cause = gtpv2c::CAUSE_NO_RESOURCES_AVAILABLE; break;
+    }
+    if (request.message_type == gtpv2c::DELETE_SESSION_REQUEST) {
+        return gtpv2c::encode_delete_session_response(out, capacity, resources ? resources->peer_teid : 0,
+            request.sequence, cause);
+    }
+    if (!resources) {
+        return gtpv2c::encode_create_session_response(out, capacity, request.peer_teid, request.sequence, cause, nullptr);
+    }
+    gtpv2c::FTEID pgw;
+    pgw.interface_type = gtpv2c::S5S8_PGW_GTPC;
+    pgw.teid = resources->teid;
+    pgw.has_ipv4 = true;
+    pgw.ipv4 = gtp_address;
+    gtpv2c::PAA paa;
+    paa.has_ipv4 = resources->has_ipv4;
+    paa.ipv4 = resources->ipv4;
+    paa.ipv6 = resources->has_ipv6 ? resources->ipv6 : nullptr;
+    return gtpv2c::encode_create_session_response(out, capacity, request.peer_teid, request.sequence, cause, &pgw,
+        (paa.has_ipv4 || paa.ipv6) ? &paa : nullptr);
+}
+
+// Кодирует ответ в буфер на стеке, кэширует и отправляет его
+void UDPServer::send_response(const UDPRequest& request, Outcome outcome, const SessionResources* resources) {
+    uint8_t reply[BUFFER_SIZE];
+    size_t length = encode_response(request, outcome, resources, reply, sizeof(reply));
+    response_cache.complete(request.client_addr, request.request_id, std::string(reinterpret_cast<const char*>(reply), length));
+    transport->send(reply, length, request.client_addr, request.addr_len);
+    if (flight_recorder) {
+        flight_recorder->instant(FlightEvent::Send, length);
+    }
+    if (request.captured) {
+        packet_capture->record_reply(reply, length, request.client_addr);
+    }
+    if (request.kernel_rx_ns != 0) {
+        latency_stats->record_socket_to_reply(std::chrono::nanoseconds(realtime_ns() - request.kernel_rx_ns));
+    }
+}
+
+// В режиме BCD датаграммы создания и удаления одного IMSI неизменны, поэтому ключ кэша
+// совпадает у всех повторов цикла attach/detach. Смена состояния сессии делает кэшированный
+// ответ на противоположный запрос устаревшим: без этого повторное подключение в пределах
+// TTL получило бы "created" из кэша, не создав сессию
+void UDPServer::forget_opposite(const UDPRequest& request) {
+    if (gtp_mode) {
+        return;
+    }
+    if (request.message_type == gtpv2c::DELETE_SESSION_REQUEST) {
+        response_cache.forget(request.client_addr, request.request_id.substr(1));
+    }
+    else {
+        response_cache.forget(request.client_addr, std::string(1, static_cast<char>(BCD_DELETE_MARKER)) + request.request_id);
+    }
+}
+
+// Проверяет IMSI: отсутствует (только GTPv2-C) или не из 15 цифр
+bool UDPServer::validate_imsi(const UDPRequest& request) {
+    std::regex imsi_regex("^[0-9]{15}$");
+    if (request.imsi_missing) {
+        cdr_logger->get_logger()->info("Missing IMSI in request");
+        send_response(request, Outcome::MissingImsi);
+        return false;
+    }
+    if (!std::regex_match(request.imsi, imsi_regex)) {
+        cdr_logger->get_logger()->info("Invalid IMSI format", request.imsi);
+        send_response(request, Outcome::InvalidImsi);
+        return false;
+    }
+    return true;
+}
+
+// Обрабатывает запрос IMSI
+void UDPServer::process_request(const UDPRequest& request) {
+    std::string imsi = request.imsi;
+    // SGW адресует Delete Session Request выданным TEID управления PGW и обычно не передаёт IMSI:
+    // сессия ищется по TEID заголовка, IE IMSI — запасной путь
+    bool by_teid = gtp_mode && request.message_type == gtpv2c::DELETE_SESSION_REQUEST && request.teid != 0 &&
+        session_manager->find_session_by_teid(request.teid, imsi);
+    if (!by_teid && gtp_mode && request.message_type == gtpv2c::DELETE_SESSION_REQUEST && request.teid != 0 &&
+        request.imsi_missing) {
+        cdr_logger->get_logger()->info("Delete for unknown TEID", std::to_string(request.teid));
+        send_response(request, Outcome::NotFound);
+        return;
+    }
+    if (!by_teid && !validate_imsi(request)) {
+        return;
+    }
+    // Владелец IMSI в кластере недоступен: отказ сразу, а не после таймаута пересылки.
+    // Ответ не остаётся в кэше, чтобы повтор после восстановления узла был обработан
+    if (!session_manager->is_reachable(imsi)) {
+        cdr_logger->get_logger()->warn("Rejected IMSI, owner node unreachable", imsi);
+        send_response(request, Outcome::Overload);
+        response_cache.forget(request.client_addr, request.request_id);
+        return;
+    }
+
+    if (request.message_type == gtpv2c::DELETE_SESSION_REQUEST) {
+        SessionResources removed;
+        bool deleted;
+        {
+            FlightSpan span(flight_recorder.get(), FlightEvent::SessionDelete);
+            deleted = session_manager->delete_session(imsi, &removed);
+            span.set_value(deleted ? 1 : 0);
+        }
+        if (deleted) {
+            forget_opposite(request);
+        }
+        std::stringstream ss;
+        ss << "Processed delete for IMSI: " << imsi << ", response: " << (deleted ? "deleted" : "not found");
+        cdr_logger->get_logger()->info(ss.str());
+        send_response(request, deleted ? Outcome::Deleted : Outcome::NotFound, deleted ? &removed : nullptr);
+        return;
+    }
+
+    SessionResources resources;
+    resources.peer_teid = request.peer_teid;
+    bool created;
+    {
+        FlightSpan span(flight_recorder.get(), FlightEvent::SessionCreate);
+        created = session_manager->create_session(imsi, &resources);
+        span.set_value(created ? 1 : 0);
+    }
+    if (created) {
+        forget_opposite(request);
+    }
+    std::stringstream ss;
+    ss << "Processed IMSI: " << imsi << ", response: " << (created ? "created" : "rejected");
+    if (created) {
+        ss << ", TEID: " << resources.teid;
+    }
+    cdr_logger->get_logger()->info(ss.str());
+    send_response(request, created ? Outcome::Created : Outcome::Rejected, created ? &resources : nullptr);
+}
+
+// Останавливает сервер и потоки
+void UDPServer::stop() {
+    if (running.exchange(false)) {
+        uint64_t one = 1;
+        ssize_t written = write(wake_fd, &one, sizeof(one));
+        (void)written;
+        std::vector<std::thread> stopped;
+        {
+            std::lock_guard<ProfiledMutex> lock(queue_mutex);
+            stopped.swap(workers);
+        }
+        queue_cond.notify_all();
+        park_cond.notify_all();
+        for (auto& worker : stopped) {
+            if (worker.joinable()) {
+                worker.join();
+            }
+        }
+        cdr_logger->get_logger()->info("UDP Server stopped");
+        cdr_logger->get_logger()->flush();
+    }
 }
\ No newline at end of file
@@ -0,0 +1,85 @@
+#include "worker_pool_sizer.hpp"
+#include <algorithm>
+#include <sstream>
+#include <thread>
+
+// Конструктор: пул начинает с минимального размера
+WorkerPoolSizer::WorkerPoolSizer(size_t min_workers, size_t max_workers, std::chrono::microseconds grow_wait,
+    std::chrono::milliseconds shrink_idle)
+    : min_workers(std::max<size_t>(min_workers, 1)),
+    max_workers(std::max(max_workers != 0 ? max_workers : static_cast<size_t>(std::thread::hardware_concurrency()),
+        std::max<size_t>(min_workers, 1))),
+    grow_wait(grow_wait), shrink_idle(shrink_idle), target(this->min_workers),
+    last_tick(std::chrono::steady_clock::now()), idle_since(last_tick) {
+}
+
+// Учитывает ожидание запроса в очереди
+void WorkerPoolSizer::record_dequeue(std::chrono::nanoseconds wait) {
+    wait_ns.fetch_add(static_cast<uint64_t>(wait.count()), std::memory_order_relaxed);
+    dequeued.fetch_add(1, std::memory_order_relaxed);
+}
+
+// Учитывает время обработки запроса
+void WorkerPoolSizer::record_busy(std::chrono::nanoseconds busy) {
+    busy_ns.fetch_add(static_cast<uint64_t>(busy.count()), std::memory_order_relaxed);
+}
+
+// Пересчитывает загрузку и решает, менять ли размер пула
+size_t WorkerPoolSizer::adjust(size_t depth, std::chrono::steady_clock::time_point now) {
+    std::lock_guard<std::mutex> lock(mutex);
+    uint64_t interval_wait = wait_ns.exchange(0, std::memory_order_relaxed);
+    uint64_t interval_dequeued = dequeued.exchange(0, std::memory_order_relaxed);
+    uint64_t interval_busy = busy_ns.exchange(0, std::memory_order_relaxed);
+    auto interval = std::chrono::duration_cast<std::chrono::nanoseconds>(now - last_tick).count();
+    last_tick = now;
+
+    size_t current = target.load();
+    queue_depth = depth;
+    processed += interval_dequeued;
+    avg_wait_us = interval_dequeued ? interval_wait / 1000.0 / interval_dequeued : 0;
+    utilization = interval > 0 ? std::min(1.0, static_cast<double>(interval_busy) / interval / current) : 0;
+
+    // Запросы ждут дольше порога или очередь растёт быстрее, чем её разбирают
+    bool pressure = avg_wait_us > grow_wait.count() || depth > current * GROW_DEPTH_PER_WORKER;
+    pressure_ticks = pressure ? pressure_ticks + 1 : 0;
+    if (pressure_ticks >= GROW_AFTER_TICKS && current < max_workers) {
+        target = current + 1;
+        pressure_ticks = 0;
+        idle = false;
+        ++grows;
+        return target;
+    }
+
+    // Простой отсчитывается заново после каждого сокращения, поэтому пул уменьшается не чаще раза в shrink_idle
+    bool underused = !pressure && depth == 0 && utilization < SHRINK_UTILIZATION;
+    if (!underused) {
+        idle = false;
+        return target;
+    }
+    if (!idle) {
+        idle = true;
+        idle_since = now;
+    }
+    if (now - idle_since >= shrink_idle && current > min_workers) {
+        target = current - 1;
+        idle_since = now;
+        ++shrinks;
+    }
+    return target;
+}
+
+// Отчёт в формате key=value по строке на параметр
+std::string WorkerPoolSizer::report() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    std::ostringstream out;
+    out << "workers=" << target.load() << "\n"
+        << "min=" << min_workers << "\n"
+        << "max=" << max_workers << "\n"
+        << "utilization=" << utilization << "\n"
+        << "avg_wait_us=" << avg_wait_us << "\n"
+        << "queue_depth=" << queue_depth << "\n"
+        << "processed=" << processed << "\n"
+        << "grows=" << grows << "\n"
+        << "shrinks=" << shrinks << "\n";
+    return out.str();
+}
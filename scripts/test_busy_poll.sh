@@ -0,0 +1,63 @@
+#!/bin/bash
+
+# Сравнивает задержку ответа pgw_server в обычном режиме и в режиме опроса (busy_poll) на петлевом интерфейсе.
+# Для каждого режима: задержка одиночных запросов без фона, затем та же задержка под фоновой нагрузкой
+# от bench_cluster_load. Поток приёма в режиме опроса привязан к ядру BUSY_POLL_CPU.
+
+BUILD_DIR=~/pgw_project/build
+WORK_DIR=$(mktemp -d)
+REQUESTS=5000
+INTERVAL_US=50
+LOAD_SECONDS=5
+LOAD_THREADS=1
+LOAD_WINDOW=8
+BUSY_POLL_CPU=0
+
+trap 'pkill -f "pgw_server $WORK_DIR" 2>/dev/null; rm -rf $WORK_DIR' EXIT
+
+# Запускает сервер в режиме $1 (true/false) и измеряет задержку
+run_mode() {
+    local busy_poll=$1
+    cat > $WORK_DIR/server.json <<JSON
+{
+    "udp_ip": "127.0.0.1",
+    "udp_port": 9400,
+    "session_timeout_sec": 600,
+    "cdr_file": "$WORK_DIR/cdr.log",
+    "http_port": 8400,
+    "graceful_shutdown_rate": 0,
+    "log_file": "$WORK_DIR/pgw.log",
+    "log_level": "WARN",
+    "rate_limit_per_sec": 0,
+    "max_queue_depth": 0,
+    "teid_pool_size": 16777215,
+    "ip_pools": ["10.0.0.0/8"],
+    "busy_poll": $busy_poll,
+    "busy_poll_cpu": $BUSY_POLL_CPU,
+    "blacklist": []
+}
+JSON
+    $BUILD_DIR/pgw_server/pgw_server $WORK_DIR/server.json > /dev/null 2>&1 &
+    local pid=$!
+    sleep 1
+    if ! ps -p $pid > /dev/null; then
+        echo "FAIL: server failed to start (busy_poll=$busy_poll)"
+        exit 1
+    fi
+
+    echo "busy_poll=$busy_poll:"
+    echo "  idle:       $($BUILD_DIR/benchmarks/bench_udp_latency 127.0.0.1:9400 $REQUESTS $INTERVAL_US | tail -1)"
+    $BUILD_DIR/benchmarks/bench_cluster_load 127.0.0.1:9400 $LOAD_SECONDS $LOAD_THREADS $LOAD_WINDOW > $WORK_DIR/load.txt &
+    local load_pid=$!
+    echo "  under load: $($BUILD_DIR/benchmarks/bench_udp_latency 127.0.0.1:9400 $REQUESTS $INTERVAL_US | tail -1)"
+    wait $load_pid
+    echo "  load:       $(tail -1 $WORK_DIR/load.txt)"
+
+    curl -s "http://127.0.0.1:8400/stop" > /dev/null
+    wait $pid 2>/dev/null
+}
+
+echo "Starting busy-poll latency comparison at $(date)..."
+run_mode false
+run_mode true
+echo "Busy-poll latency comparison completed at $(date)"
@@ -0,0 +1,80 @@
+#!/bin/bash
+
+# Измеряет суммарную пропускную способность кластера из 1, 2 и 4 узлов pgw_server на петлевом интерфейсе.
+# Узлы получают свои конфигурации с портами 9100+i (UDP), 8100+i (HTTP) и 9200+i (внутренний канал);
+# генератор нагрузки шлёт Create по уникальным IMSI на все узлы сразу, часть запросов узлы пересылают владельцам.
+
+BUILD_DIR=~/pgw_project/build
+WORK_DIR=$(mktemp -d)
+DURATION=5
+THREADS_PER_NODE=2
+WINDOW=64
+
+trap 'pkill -f "pgw_server $WORK_DIR" 2>/dev/null; rm -rf $WORK_DIR' EXIT
+
+# Запускает кластер из $1 узлов и прогоняет нагрузку
+run_cluster() {
+    local size=$1
+    local nodes=""
+    local endpoints=""
+    for ((i=0; i<size; i++)); do
+        nodes="$nodes\"127.0.0.1:$((9200 + i))\""
+        endpoints="${endpoints}127.0.0.1:$((9100 + i))"
+        if [ $i -lt $((size - 1)) ]; then
+            nodes="$nodes, "
+            endpoints="$endpoints,"
+        fi
+    done
+
+    local pids=()
+    for ((i=0; i<size; i++)); do
+        cat > $WORK_DIR/node$i.json <<JSON
+{
+    "udp_ip": "127.0.0.1",
+    "udp_port": $((9100 + i)),
+    "session_timeout_sec": 600,
+    "cdr_file": "$WORK_DIR/cdr$i.log",
+    "http_port": $((8100 + i)),
+    "graceful_shutdown_rate": 0,
+    "log_file": "$WORK_DIR/pgw$i.log",
+    "log_level": "WARN",
+    "rate_limit_per_sec": 0,
+    "max_queue_depth": 0,
+    "teid_pool_size": 16777215,
+    "ip_pools": ["10.0.0.0/8"],
+    "cluster_nodes": [$nodes],
+    "cluster_node_id": $i,
+    "blacklist": []
+}
+JSON
+        $BUILD_DIR/pgw_server/pgw_server $WORK_DIR/node$i.json > /dev/null 2>&1 &
+        pids+=($!)
+    done
+    sleep 2
+
+    for pid in "${pids[@]}"; do
+        if ! ps -p $pid > /dev/null; then
+            echo "FAIL: node failed to start (cluster of $size)"
+            exit 1
+        fi
+    done
+
+    echo "Cluster of $size node(s):"
+    $BUILD_DIR/benchmarks/bench_cluster_load $endpoints $DURATION $THREADS_PER_NODE $WINDOW | sed 's/^/  /'
+    for ((i=0; i<size; i++)); do
+        echo "  node $i: $(curl -s "http://127.0.0.1:$((8100 + i))/cluster" | tr '\n' ' ')"
+    done
+
+    for ((i=0; i<size; i++)); do
+        curl -s "http://127.0.0.1:$((8100 + i))/stop" > /dev/null
+    done
+    for pid in "${pids[@]}"; do
+        wait $pid 2>/dev/null
+    done
+}
+
+echo "Starting cluster scaling test at $(date)..."
+for size in 1 2 4; do
+    run_cluster $size
+done
+echo "Cluster scaling test completed at $(date)"
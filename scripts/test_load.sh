@@ -1,6 +1,7 @@
 #!/bin/bash
 
-# Проверяет нагрузку на pgw_server с 1000 клиентами
+# Проверяет нагрузку на pgw_server с 1000 клиентами.
+# Сервер работает на ускоренных часах (clock_scale): таймаут сессий 30 с истекает за 30/CLOCK_SCALE с
 
 BUILD_DIR=~/pgw_project/build
 CONFIG_FILE=~/pgw_project/config.json
@@ -8,6 +9,10 @@ CLIENT_CONFIG_FILE=~/pgw_project/client_config.json
 CDR_LOG=~/pgw_project/scripts/cdr.log
 START_IMSI=123456789100000
 NUM_CLIENTS=1000
+CLOCK_SCALE=10
+SESSION_TIMEOUT_SEC=30
+SERVER_CONFIG=$(mktemp)
+trap 'rm -f $SERVER_CONFIG' EXIT
 
 echo "Starting load test at $(date)..."
 
@@ -19,9 +24,12 @@ sleep 3 # Увеличена задержка для полного заверш
 rm -f $BUILD_DIR/pgw.log $BUILD_DIR/client.log $CDR_LOG
 echo "Logs cleared: pgw.log, client.log, cdr.log"
 
+# Конфигурация сервера с ускоренными часами
+sed "0,/{/s//{\n  \"clock_scale\": $CLOCK_SCALE,/" $CONFIG_FILE > $SERVER_CONFIG
+
 # Запускаем сервер
-echo "Starting pgw_server..."
-$BUILD_DIR/pgw_server/pgw_server $CONFIG_FILE &
+echo "Starting pgw_server (clock_scale $CLOCK_SCALE)..."
+$BUILD_DIR/pgw_server/pgw_server $SERVER_CONFIG &
 SERVER_PID=$!
 sleep 3 # Увеличена задержка для инициализации сервера
 
@@ -47,9 +55,9 @@ for pid in "${CLIENT_PIDS[@]}"; do
 done
 echo "All clients completed"
 
-# Даём дополнительное время на запись в CDR
-echo "Waiting 15 seconds for CDR logging..."
-sleep 15
+# Даём дополнительное время на запись в CDR (меньше таймаута сессий в реальном времени)
+echo "Waiting 2 seconds for CDR logging..."
+sleep 2
 
 # Проверяем CDR-лог на записи created
 echo "Checking cdr.log for $NUM_CLIENTS created entries..."
@@ -70,9 +78,10 @@ else
     exit 1
 fi
 
-# Ждём истечения сессий (30 секунд + запас)
-echo "Waiting 35 seconds for session expiration..."
-sleep 35
+# Ждём истечения сессий: таймаут в ускоренном времени + запас
+EXPIRY_WAIT=$(( SESSION_TIMEOUT_SEC / CLOCK_SCALE + 2 ))
+echo "Waiting $EXPIRY_WAIT seconds for session expiration..."
+sleep $EXPIRY_WAIT
 
 # Проверяем CDR-лог на записи deleted
 echo "Contents of cdr.log before checking deleted:"
@@ -0,0 +1,325 @@
+#include <gtest/gtest.h>
+#include <logger.hpp>
+#include "admin_socket.hpp"
+#include "admin_client.hpp"
+#include "cdr_logger.hpp"
+#include "config.hpp"
+#include "session_manager.hpp"
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace {
+
+const char* SOCKET_PATH = "test_admin.sock";
+
+std::string imsi_of(int i) {
+    std::string digits = std::to_string(i);
+    return "00101" + std::string(10 - digits.size(), '0') + digits;
+}
+
+// Соединение без клиента: для кадров, которые AdminClient не отправит
+int connect_raw() {
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    struct sockaddr_un addr = {};
+    addr.sun_family = AF_UNIX;
+    std::strncpy(addr.sun_path, SOCKET_PATH, sizeof(addr.sun_path) - 1);
+    struct timeval tv = { 2, 0 };
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    EXPECT_EQ(connect(fd, (struct sockaddr*)&addr, sizeof(addr)), 0);
+    return fd;
+}
+
+// Читает один кадр ответа; input хранит байты следующих кадров. false — соединение закрыто
+bool read_frame(int fd, std::string& input, admin::Frame& frame) {
+    char buffer[4096];
+    size_t consumed;
+    while ((consumed = admin::parse_frame(input.data(), input.size(), frame)) == 0) {
+        ssize_t n = recv(fd, buffer, sizeof(buffer), 0);
+        if (n <= 0) {
+            return false;
+        }
+        input.append(buffer, static_cast<size_t>(n));
+    }
+    input.erase(0, consumed);
+    return true;
+}
+
+} // namespace
+
+class AdminSocketTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        std::ofstream config_file("test_config.json");
+        config_file << R"({
+            "session_timeout_sec": 30,
+            "cdr_file": "test_cdr.log",
+            "log_file": "test.log",
+            "log_level": "INFO",
+            "admin_socket_path": "test_admin.sock",
+            "blacklist": []
+        })";
+        config_file.close();
+
+        Logger::init("test.log", "INFO");
+        config_ = std::make_shared<Config>("test_config.json");
+        logger_ = Logger::get();
+        cdr_logger_ = std::make_shared<CDRLogger>(*config_, logger_);
+        session_manager_ = std::make_shared<SessionManager>(*config_, cdr_logger_);
+        admin_socket_ = std::make_shared<AdminSocket>(*config_, session_manager_, logger_);
+    }
+
+    void TearDown() override {
+        admin_socket_.reset();
+        session_manager_.reset();
+        cdr_logger_.reset();
+        std::remove("test_config.json");
+        std::remove("test.log");
+        std::remove("test_cdr.log");
+    }
+
+    std::shared_ptr<Config> config_;
+    std::shared_ptr<Logger> logger_;
+    std::shared_ptr<CDRLogger> cdr_logger_;
+    std::shared_ptr<SessionManager> session_manager_;
+    std::shared_ptr<AdminSocket> admin_socket_;
+};
+
+TEST_F(AdminSocketTest, EncodesAndParsesFrames) {
+    std::string stream;
+    std::vector<std::string> imsis = { imsi_of(1), imsi_of(2), imsi_of(3) };
+    admin::append_frame(stream, admin::MSG_CHECK, 7, admin::encode_check_request(imsis, 1, 3));
+    admin::append_frame(stream, admin::MSG_COUNTERS, 8, "");
+
+    // Неполный кадр ждёт остальных байт
+    admin::Frame frame;
+    EXPECT_EQ(admin::parse_frame(stream.data(), 3, frame), 0u);
+    size_t first = admin::parse_frame(stream.data(), stream.size(), frame);
+    ASSERT_EQ(first, admin::HEADER_SIZE + 2 + 2 * 16);
+    EXPECT_EQ(frame.type, admin::MSG_CHECK);
+    EXPECT_EQ(frame.id, 7u);
+    std::vector<std::string> decoded;
+    ASSERT_TRUE(admin::decode_check_request(frame.payload, decoded));
+    EXPECT_EQ(decoded, std::vector<std::string>({ imsi_of(2), imsi_of(3) }));
+    EXPECT_FALSE(admin::decode_check_request(frame.payload.substr(0, frame.payload.size() - 1), decoded));
+    EXPECT_EQ(admin::parse_frame(stream.data() + first, stream.size() - first - 1, frame), 0u);
+    EXPECT_EQ(admin::parse_frame(stream.data() + first, stream.size() - first, frame), admin::HEADER_SIZE);
+    EXPECT_EQ(frame.id, 8u);
+    EXPECT_TRUE(frame.payload.empty());
+
+    admin::ExportPage page;
+    page.next_cursor = 12;
+    page.sessions.push_back({ imsi_of(5), 1700000000123LL, 1700000030123LL });
+    admin::ExportPage decoded_page;
+    ASSERT_TRUE(admin::decode_export_response(admin::encode_export_response(page), decoded_page));
+    EXPECT_EQ(decoded_page.next_cursor, 12u);
+    ASSERT_EQ(decoded_page.sessions.size(), 1u);
+    EXPECT_EQ(decoded_page.sessions[0].imsi, imsi_of(5));
+    EXPECT_EQ(decoded_page.sessions[0].expires_at_ms, 1700000030123LL);
+
+    // Страница из целых шардов может превышать MAX_EXPORT_LIMIT
+    page.sessions.assign(admin::MAX_EXPORT_LIMIT + 1, { imsi_of(6), 1700000000123LL, 1700000030123LL });
+    std::string payload = admin::encode_export_response(page);
+    ASSERT_TRUE(admin::decode_export_response(payload, decoded_page));
+    EXPECT_EQ(decoded_page.sessions.size(), admin::MAX_EXPORT_LIMIT + 1);
+    payload[4] = static_cast<char>(0xff);
+    EXPECT_FALSE(admin::decode_export_response(payload, decoded_page));
+
+    std::string oversized = std::string("\xff\xff\xff\xff", 4) + "xxxxx";
+    EXPECT_THROW(admin::parse_frame(oversized.data(), oversized.size(), frame), std::invalid_argument);
+}
+
+TEST_F(AdminSocketTest, ChecksPipelinedBatches) {
+    for (int i = 0; i < 1000; i += 3) {
+        ASSERT_TRUE(session_manager_->create_session(imsi_of(i)));
+    }
+    admin_socket_->run();
+    struct stat st;
+    ASSERT_EQ(stat(SOCKET_PATH, &st), 0);
+    EXPECT_TRUE(S_ISSOCK(st.st_mode));
+    EXPECT_EQ(st.st_mode & 0777, 0660u);
+
+    AdminClient client(SOCKET_PATH);
+    std::vector<std::string> imsis;
+    for (int i = 0; i < 1000; ++i) {
+        imsis.push_back(imsi_of(i));
+    }
+    // 16 пачек по 64 IMSI, до 4 запросов без ответа
+    auto status = client.check(imsis, 64, 4);
+    ASSERT_EQ(status.size(), imsis.size());
+    for (int i = 0; i < 1000; ++i) {
+        EXPECT_EQ(status[i], i % 3 == 0 ? admin::CHECK_ACTIVE : admin::CHECK_INACTIVE) << imsis[i];
+    }
+    EXPECT_TRUE(client.check({}).empty());
+    EXPECT_EQ(admin_socket_->get_requests(), 16u);
+    EXPECT_EQ(admin_socket_->get_lookups(), 1000u);
+
+    // Несколько клиентов одновременно
+    AdminClient second(SOCKET_PATH);
+    EXPECT_EQ(second.check({ imsi_of(3), imsi_of(4) }), std::vector<uint8_t>({ admin::CHECK_ACTIVE, admin::CHECK_INACTIVE }));
+    EXPECT_EQ(client.check({ imsi_of(999) }), std::vector<uint8_t>({ admin::CHECK_ACTIVE }));
+    EXPECT_EQ(admin_socket_->get_connections(), 2u);
+
+    admin_socket_->stop();
+    EXPECT_NE(stat(SOCKET_PATH, &st), 0);
+}
+
+TEST_F(AdminSocketTest, ExportsSessionsAndCounters) {
+    admin_socket_->run();
+    AdminClient client(SOCKET_PATH);
+    // Без таблицы сессий выгрузка недоступна, а соединение остаётся открытым
+    EXPECT_THROW(client.export_sessions(0, 100), std::runtime_error);
+    admin_socket_->stop();
+
+    for (int i = 0; i < 250; ++i) {
+        ASSERT_TRUE(session_manager_->create_session(imsi_of(i)));
+    }
+    admin_socket_ = std::make_shared<AdminSocket>(*config_, session_manager_, logger_);
+    admin_socket_->set_session_export(session_manager_);
+    admin_socket_->set_admission_control(std::make_shared<AdmissionControl>(0, 0, 100));
+    admin_socket_->run();
+    AdminClient exporter(SOCKET_PATH);
+
+    std::map<std::string, admin::ExportedSession> exported;
+    uint32_t cursor = 0;
+    size_t pages = 0;
+    while (true) {
+        auto page = exporter.export_sessions(cursor, 100);
+        if (page.sessions.empty()) {
+            EXPECT_EQ(page.next_cursor, SessionManager::SHARDS);
+            break;
+        }
+        ++pages;
+        for (const auto& session : page.sessions) {
+            exported[session.imsi] = session;
+        }
+        ASSERT_GT(page.next_cursor, cursor);
+        cursor = page.next_cursor;
+    }
+    EXPECT_EQ(exported.size(), 250u);
+    EXPECT_GE(pages, 3u);
+    const auto& session = exported[imsi_of(7)];
+    EXPECT_NEAR(session.expires_at_ms - session.creation_time_ms, 30000, 1000);
+    EXPECT_THROW(exporter.export_sessions(SessionManager::SHARDS + 1, 10), std::runtime_error);
+    EXPECT_THROW(exporter.export_sessions(0, admin::MAX_EXPORT_LIMIT + 1), std::runtime_error);
+
+    std::map<std::string, uint64_t> counters;
+    for (const auto& counter : exporter.counters()) {
+        counters[counter.first] = counter.second;
+    }
+    EXPECT_EQ(counters["sessions"], 250u);
+    EXPECT_EQ(counters.count("admitted"), 1u);
+    EXPECT_EQ(counters["admin_connections"], 1u);
+    EXPECT_EQ(counters["admin_errors"], 2u);
+}
+
+TEST_F(AdminSocketTest, ExportsPagesLargerThanLimit) {
+    // 20000 сессий на 4096 шардов: в части шардов больше одной сессии, страница с пределом 1 — весь шард
+    std::vector<SessionRecord> records(20000);
+    int64_t now_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    for (size_t i = 0; i < records.size(); ++i) {
+        records[i].imsi = imsi_of(static_cast<int>(i));
+        records[i].creation_time_ms = now_ms;
+    }
+    ASSERT_EQ(session_manager_->restore_sessions(std::move(records)), 20000u);
+    admin_socket_->set_session_export(session_manager_);
+    admin_socket_->run();
+    AdminClient exporter(SOCKET_PATH);
+
+    size_t exported = 0;
+    size_t largest = 0;
+    uint32_t cursor = 0;
+    while (cursor < SessionManager::SHARDS) {
+        auto page = exporter.export_sessions(cursor, 1);
+        exported += page.sessions.size();
+        largest = std::max(largest, page.sessions.size());
+        ASSERT_GT(page.next_cursor, cursor);
+        cursor = page.next_cursor;
+    }
+    EXPECT_EQ(exported, 20000u);
+    EXPECT_GT(largest, 1u);
+}
+
+TEST_F(AdminSocketTest, AnswersBadRequestsAndDropsBrokenStreams) {
+    admin_socket_->run();
+    int fd = connect_raw();
+    std::string frames;
+    admin::append_frame(frames, 42, 1, "");
+    admin::append_frame(frames, admin::MSG_CHECK, 2, "\x00");
+    admin::append_frame(frames, admin::MSG_CHECK, 3, admin::encode_check_request({ imsi_of(1) }, 0, 1));
+    ASSERT_EQ(send(fd, frames.data(), frames.size(), 0), static_cast<ssize_t>(frames.size()));
+
+    std::string input;
+    admin::Frame response;
+    ASSERT_TRUE(read_frame(fd, input, response));
+    EXPECT_EQ(response.type, admin::MSG_ERROR);
+    EXPECT_EQ(response.id, 1u);
+    EXPECT_EQ(response.payload, std::string(1, static_cast<char>(admin::ERROR_UNKNOWN_TYPE)));
+    ASSERT_TRUE(read_frame(fd, input, response));
+    EXPECT_EQ(response.id, 2u);
+    EXPECT_EQ(response.payload, std::string(1, static_cast<char>(admin::ERROR_MALFORMED)));
+    ASSERT_TRUE(read_frame(fd, input, response));
+    EXPECT_EQ(response.type, admin::MSG_CHECK);
+    EXPECT_EQ(response.id, 3u);
+
+    // Длина кадра вне пределов: поток не разобрать, сервер закрывает соединение
+    std::string broken("\xff\xff\xff\xff\x01", 5);
+    ASSERT_EQ(send(fd, broken.data(), broken.size(), 0), 5);
+    EXPECT_FALSE(read_frame(fd, input, response));
+    close(fd);
+    EXPECT_EQ(admin_socket_->get_errors(), 3u);
+
+    // Прочие соединения не задеты
+    AdminClient client(SOCKET_PATH);
+    EXPECT_EQ(client.check({ imsi_of(1) }), std::vector<uint8_t>({ admin::CHECK_INACTIVE }));
+}
+
+TEST_F(AdminSocketTest, ReportsImsisOwnedByOtherNodes) {
+    std::ofstream config_file("test_config.json");
+    config_file << R"({
+        "session_timeout_sec": 30,
+        "cdr_file": "test_cdr.log",
+        "log_file": "test.log",
+        "log_level": "INFO",
+        "admin_socket_path": "test_admin.sock",
+        "cluster_nodes": ["127.0.0.1:39001", "127.0.0.1:39002"],
+        "cluster_node_id": 0,
+        "blacklist": []
+    })";
+    config_file.close();
+    Config cluster_config("test_config.json");
+    admin_socket_.reset();
+    admin_socket_ = std::make_shared<AdminSocket>(cluster_config, session_manager_, logger_);
+
+    // Первые IMSI этого узла и соседнего; сессия есть у обоих, но соседний узел её не знает
+    HashRing ring(cluster_config.get_cluster_nodes());
+    std::string local;
+    std::string remote;
+    for (int i = 0; local.empty() || remote.empty(); ++i) {
+        (ring.owner(imsi_of(i)) == 0 ? local : remote) = imsi_of(i);
+    }
+    ASSERT_TRUE(session_manager_->create_session(local));
+    ASSERT_TRUE(session_manager_->create_session(remote));
+    std::string inactive;
+    for (int i = 1000; inactive.empty(); ++i) {
+        if (ring.owner(imsi_of(i)) == 0) {
+            inactive = imsi_of(i);
+        }
+    }
+
+    admin_socket_->run();
+    AdminClient client(SOCKET_PATH);
+    EXPECT_EQ(client.check({ local, remote, inactive }),
+        std::vector<uint8_t>({ admin::CHECK_ACTIVE, admin::CHECK_NOT_OWNED, admin::CHECK_INACTIVE }));
+    EXPECT_EQ(admin_socket_->get_not_owned(), 1u);
+    admin_socket_.reset();
+}
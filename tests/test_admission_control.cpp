@@ -0,0 +1,82 @@
+#include <gtest/gtest.h>
+#include "admission_control.hpp"
+#include <arpa/inet.h>
+
+// Формирует адрес пира для тестов
+static struct sockaddr_in make_peer(const char* ip) {
+    struct sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = inet_addr(ip);
+    addr.sin_port = htons(40000);
+    return addr;
+}
+
+TEST(AdmissionControlTest, TokenBucketPerPeer) {
+    AdmissionControl admission(10, 5, 0);
+    auto now = std::chrono::steady_clock::now();
+    auto flooder = make_peer("10.0.0.1");
+    auto quiet = make_peer("10.0.0.2");
+
+    int admitted = 0;
+    for (int i = 0; i < 20; ++i) {
+        admitted += admission.admit_peer(flooder, now) ? 1 : 0;
+    }
+    EXPECT_EQ(admitted, 5);
+    EXPECT_EQ(admission.get_rate_limited(), 15u);
+
+    // Другой пир не страдает от соседа
+    EXPECT_TRUE(admission.admit_peer(quiet, now));
+
+    // Через 200 мс при 10 токенах/с пополнилось 2 токена
+    now += std::chrono::milliseconds(200);
+    EXPECT_TRUE(admission.admit_peer(flooder, now));
+    EXPECT_TRUE(admission.admit_peer(flooder, now));
+    EXPECT_FALSE(admission.admit_peer(flooder, now));
+}
+
+TEST(AdmissionControlTest, QueueDepthLimit) {
+    AdmissionControl admission(0, 0, 3);
+    EXPECT_TRUE(admission.admit_queue(0));
+    EXPECT_TRUE(admission.admit_queue(2));
+    EXPECT_FALSE(admission.admit_queue(3));
+    EXPECT_EQ(admission.get_overloaded(), 1u);
+}
+
+TEST(AdmissionControlTest, LimitsChangeAtRuntime) {
+    AdmissionControl admission(0, 0, 0);
+    auto now = std::chrono::steady_clock::now();
+    auto peer = make_peer("10.0.0.1");
+    for (int i = 0; i < 100; ++i) {
+        EXPECT_TRUE(admission.admit_peer(peer, now));
+    }
+    EXPECT_TRUE(admission.admit_queue(1000000));
+
+    admission.set_limits(1, 1, 10);
+    auto other = make_peer("10.0.0.3");
+    EXPECT_TRUE(admission.admit_peer(other, now));
+    EXPECT_FALSE(admission.admit_peer(other, now));
+    EXPECT_FALSE(admission.admit_queue(10));
+}
+
+TEST(AdmissionControlTest, TableEvictsIdlePeers) {
+    AdmissionControl admission(10, 1, 0, 8);
+    auto now = std::chrono::steady_clock::now();
+    for (int i = 0; i < 100; ++i) {
+        std::string ip = "10.0.1." + std::to_string(i);
+        EXPECT_TRUE(admission.admit_peer(make_peer(ip.c_str()), now));
+    }
+    EXPECT_GT(admission.get_evicted_peers(), 0u);
+}
+
+TEST(AdmissionControlTest, ZeroBurstAdmitsFirstDatagram) {
+    AdmissionControl admission(10, 0, 0, 8);
+    auto now = std::chrono::steady_clock::now();
+    // Новый пир и пир после вытеснения из таблицы начинают с одного токена, как после пополнения
+    for (int i = 0; i < 100; ++i) {
+        std::string ip = "10.0.2." + std::to_string(i);
+        EXPECT_TRUE(admission.admit_peer(make_peer(ip.c_str()), now)) << ip;
+        EXPECT_FALSE(admission.admit_peer(make_peer(ip.c_str()), now)) << ip;
+    }
+    EXPECT_GT(admission.get_evicted_peers(), 0u);
+    EXPECT_EQ(admission.get_admitted(), 100u);
+}
\ No newline at end of file
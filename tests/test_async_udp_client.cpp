@@ -0,0 +1,210 @@
+#include <gtest/gtest.h>
+#include <logger.hpp>
+#include "async_udp_client.hpp"
+#include "client_config.hpp"
+#include "config.hpp"
+#include "session_manager.hpp"
+#include "cdr_logger.hpp"
+#include "udp_server.hpp"
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <thread>
+#include <arpa/inet.h>
+#include <unistd.h>
+
+class AsyncUDPClientTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        Logger::init("test_async.log", "ERROR");
+        logger_ = Logger::get();
+    }
+
+    void TearDown() override {
+        if (udp_server_) {
+            udp_server_->stop();
+            server_thread_.join();
+        }
+        udp_server_.reset();
+        session_manager_.reset();
+        cdr_logger_.reset();
+        server_config_.reset();
+        std::remove("test_async_server_config.json");
+        std::remove("test_async_client_config.json");
+        std::remove("test_async.log");
+        std::remove("test_async_cdr.log");
+    }
+
+    void start_server(const std::string& protocol) {
+        std::ofstream server_config_file("test_async_server_config.json");
+        server_config_file << R"({
+            "udp_ip": "127.0.0.1",
+            "udp_port": 19600,
+            "protocol": ")" << protocol << R"(",
+            "session_timeout_sec": 30,
+            "cdr_file": "test_async_cdr.log",
+            "http_port": 8080,
+            "graceful_shutdown_rate": 10,
+            "log_file": "test_async.log",
+            "log_level": "ERROR",
+            "blacklist": ["001019999999999"]
+        })";
+        server_config_file.close();
+        server_config_ = std::make_shared<Config>("test_async_server_config.json");
+        cdr_logger_ = std::make_shared<CDRLogger>(*server_config_, logger_);
+        session_manager_ = std::make_shared<SessionManager>(*server_config_, cdr_logger_);
+        udp_server_ = std::make_shared<UDPServer>(*server_config_, session_manager_, cdr_logger_);
+        server_thread_ = std::thread([this]() { udp_server_->run(); });
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    }
+
+    std::shared_ptr<ClientConfig> make_client_config(const std::string& protocol, int port, int timeout_ms, int retries) {
+        std::ofstream client_config_file("test_async_client_config.json");
+        client_config_file << R"({
+            "server_ip": "127.0.0.1",
+            "server_port": )" << port << R"(,
+            "protocol": ")" << protocol << R"(",
+            "request_timeout_ms": )" << timeout_ms << R"(,
+            "request_retries": )" << retries << R"(,
+            "max_in_flight": 256,
+            "log_file": "test_async.log",
+            "log_level": "ERROR"
+        })";
+        client_config_file.close();
+        return std::make_shared<ClientConfig>("test_async_client_config.json");
+    }
+
+    static std::string imsi_of(int i) {
+        std::string digits = std::to_string(i);
+        return "00101" + std::string(10 - digits.size(), '0') + digits;
+    }
+
+    std::shared_ptr<ILogger> logger_;
+    std::shared_ptr<Config> server_config_;
+    std::shared_ptr<CDRLogger> cdr_logger_;
+    std::shared_ptr<SessionManager> session_manager_;
+    std::shared_ptr<UDPServer> udp_server_;
+    std::thread server_thread_;
+};
+
+TEST_F(AsyncUDPClientTest, TimerWheelFiresEachTimerOnceAtItsTick) {
+    auto origin = std::chrono::steady_clock::now();
+    TimerWheel wheel(std::chrono::milliseconds(10), 8, origin);
+    wheel.schedule(1, origin + std::chrono::milliseconds(25));
+    wheel.schedule(2, origin + std::chrono::milliseconds(5));
+    // Срок дальше оборота колеса (80 мс): ячейка та же, что у 30 мс
+    wheel.schedule(3, origin + std::chrono::milliseconds(110));
+    EXPECT_EQ(wheel.size(), 3u);
+
+    std::vector<uint64_t> fired;
+    auto collect = [&fired](uint64_t id) { fired.push_back(id); };
+    wheel.advance(origin + std::chrono::milliseconds(9), collect);
+    EXPECT_TRUE(fired.empty());
+    wheel.advance(origin + std::chrono::milliseconds(10), collect);
+    EXPECT_EQ(fired, std::vector<uint64_t>{ 2 });
+    wheel.advance(origin + std::chrono::milliseconds(35), collect);
+    EXPECT_EQ(fired, (std::vector<uint64_t>{ 2, 1 }));
+    wheel.advance(origin + std::chrono::milliseconds(105), collect);
+    EXPECT_EQ(fired.size(), 2u);
+    EXPECT_EQ(wheel.size(), 1u);
+    // Долгий простой: колесо догоняет время одним оборотом и не теряет таймер
+    wheel.advance(origin + std::chrono::seconds(5), collect);
+    EXPECT_EQ(fired, (std::vector<uint64_t>{ 2, 1, 3 }));
+    EXPECT_EQ(wheel.size(), 0u);
+}
+
+TEST_F(AsyncUDPClientTest, PipelinesRequestsAndCorrelatesBySequence) {
+    start_server("gtpv2c");
+    auto config = make_client_config("gtpv2c", 19600, 1000, 3);
+    AsyncUDPClient client(*config, logger_);
+
+    const int count = 2000;
+    std::vector<std::string> imsis;
+    for (int i = 0; i < count; ++i) {
+        imsis.push_back(imsi_of(i));
+    }
+    imsis.push_back("001019999999999");
+    auto results = client.send_imsis(imsis);
+    ASSERT_EQ(results.size(), imsis.size());
+    for (int i = 0; i < count; ++i) {
+        // Ответ сопоставлен своему запросу, порядок итогов — порядок входа
+        EXPECT_EQ(results[i].imsi, imsis[i]);
+        EXPECT_TRUE(results[i].ok) << results[i].error;
+        EXPECT_EQ(results[i].response, "created");
+        EXPECT_EQ(results[i].cause, gtpv2c::CAUSE_REQUEST_ACCEPTED);
+    }
+    EXPECT_EQ(results.back().response, "rejected");
+    EXPECT_EQ(session_manager_->get_session_count(), static_cast<size_t>(count));
+    EXPECT_EQ(client.get_in_flight(), 0u);
+    EXPECT_EQ(client.get_queued(), 0u);
+
+    // Повторный attach той же сессии — тоже created
+    auto again = client.send_imsi(imsi_of(0)).get();
+    EXPECT_TRUE(again.ok);
+    EXPECT_EQ(again.attempts, 1);
+}
+
+TEST_F(AsyncUDPClientTest, RetriesThenTimesOutAgainstSilentServer) {
+    // Сокет, который принимает запросы и не отвечает
+    int silent_fd = socket(AF_INET, SOCK_DGRAM, 0);
+    ASSERT_GE(silent_fd, 0);
+    struct sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = inet_addr("127.0.0.1");
+    addr.sin_port = htons(19601);
+    ASSERT_EQ(bind(silent_fd, (struct sockaddr*)&addr, sizeof(addr)), 0);
+
+    auto config = make_client_config("gtpv2c", 19601, 50, 3);
+    AsyncUDPClient client(*config, logger_);
+    auto start = std::chrono::steady_clock::now();
+    auto result = client.send_imsi(imsi_of(1)).get();
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    EXPECT_FALSE(result.ok);
+    EXPECT_EQ(result.error, "timeout");
+    EXPECT_EQ(result.attempts, 3);
+    EXPECT_GE(elapsed, std::chrono::milliseconds(150));
+
+    // Три попытки с одним и тем же номером последовательности
+    char buffer[256];
+    std::vector<uint32_t> sequences;
+    ssize_t n;
+    while ((n = recv(silent_fd, buffer, sizeof(buffer), MSG_DONTWAIT)) > 0) {
+        gtpv2c::MessageView message;
+        ASSERT_EQ(gtpv2c::parse(reinterpret_cast<const uint8_t*>(buffer), n, message), gtpv2c::ParseResult::OK);
+        sequences.push_back(message.sequence);
+    }
+    ASSERT_EQ(sequences.size(), 3u);
+    EXPECT_EQ(sequences[0], sequences[1]);
+    EXPECT_EQ(sequences[1], sequences[2]);
+    close(silent_fd);
+}
+
+TEST_F(AsyncUDPClientTest, CallbacksAndStopInBcdMode) {
+    // Режим BCD: в ответе нет номера запроса, окно в один запрос
+    start_server("bcd");
+
+    auto config = make_client_config("bcd", 19600, 1000, 3);
+    AsyncUDPClient client(*config, logger_);
+    std::atomic<int> created{ 0 };
+    std::atomic<int> done{ 0 };
+    for (int i = 0; i < 20; ++i) {
+        client.send_imsi(imsi_of(i), [&](const ClientResult& result) {
+            if (result.ok && result.response == "created") {
+                ++created;
+            }
+            ++done;
+        });
+    }
+    EXPECT_LE(client.get_in_flight(), 1u);
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (done < 20 && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    EXPECT_EQ(created.load(), 20);
+    EXPECT_THROW(client.send_imsi("12345", [](const ClientResult&) {}), std::invalid_argument);
+
+    client.stop();
+    auto stopped = client.send_imsi(imsi_of(21)).get();
+    EXPECT_FALSE(stopped.ok);
+    EXPECT_EQ(stopped.error, "stopped");
+}
@@ -1,62 +1,207 @@
-#include <gtest/gtest.h>
-#include <logger.hpp>
-#include "cdr_logger.hpp"
-#include "config.hpp"
-#include <fstream>
-
-class CDRLoggerTest : public ::testing::Test {
-protected:
-    void SetUp() override {
-        std::ofstream config_file("test_config.json");
-        config_file << R"({
-            "udp_ip": "127.0.0.1",
-            "udp_port": 9000,
-            "session_timeout_sec": 30,
-            "cdr_file": "test_cdr.log",
-            "http_port": 8080,
-            "graceful_shutdown_rate": 10,
-            "log_file": "test.log",
-            "log_level": "INFO",
-            "blacklist": []
-        })";
-        config_file.close();
-
-        Logger::init("test.log", "INFO");
-        config_ = std::make_shared<Config>("test_config.json");
-        logger_ = Logger::get();
-        cdr_logger_ = std::make_shared<CDRLogger>(*config_, logger_);
-    }
-
-    void TearDown() override {
-        cdr_logger_.reset();
-        config_.reset();
-        logger_.reset();
-        std::remove("test_config.json");
-        std::remove("test.log");
-        std::remove("test_cdr.log");
-    }
-
-    std::shared_ptr<Config> config_;
-    std::shared_ptr<Logger> logger_;
-    std::shared_ptr<CDRLogger> cdr_logger_;
-};
-
-TEST_F(CDRLoggerTest, LogCreated) {
-    std::string imsi = "123456789012345";
-    cdr_logger_->log(imsi, "created");
-
-    std::ifstream file("test_cdr.log");
-    std::string line;
-    std::getline(file, line);
-    EXPECT_TRUE(line.find(imsi + ",created") != std::string::npos);
-}
-
-TEST_F(CDRLoggerTest, LogDeleted) {
-    std::string imsi = "123456789012345";
-    cdr_logger_->log(imsi, "deleted");
-
-    std::ifstream file("test_cdr.log");
-    std::string line;
-    std::getline(file, line);
-    EXPECT_TRUE(line.find(imsi + ",deleted") != std::string::npos);
-}
\ No newline at end of file
+#include <gtest/gtest.h>
+#include <logger.hpp>
+#include "cdr_logger.hpp"
+#include "config.hpp"
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+// Строки CDR-файла
+std::vector<std::string> read_lines(const std::string& path) {
+    std::ifstream file(path);
+    std::vector<std::string> lines;
+    std::string line;
+    while (std::getline(file, line)) {
+        lines.push_back(line);
+    }
+    return lines;
+}
+
+// Метка времени CDR
+std::string cdr_time(std::chrono::system_clock::time_point time) {
+    auto time_t = std::chrono::system_clock::to_time_t(time);
+    std::stringstream ss;
+    ss << std::put_time(std::localtime(&time_t), "%Y-%m-%d %H:%M:%S");
+    return ss.str();
+}
+
+// Конфигурация с заданным окном сведения отказов
+std::shared_ptr<Config> coalesce_config(int window_ms, int max_imsis) {
+    std::ofstream config_file("test_config_coalesce.json");
+    config_file << R"({
+        "cdr_file": "test_cdr.log",
+        "log_file": "test.log",
+        "cdr_reject_coalesce_ms": )" << window_ms << R"(,
+        "cdr_reject_coalesce_max_imsis": )" << max_imsis << R"(
+    })";
+    config_file.close();
+    auto config = std::make_shared<Config>("test_config_coalesce.json");
+    std::remove("test_config_coalesce.json");
+    return config;
+}
+
+} // namespace
+
+class CDRLoggerTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        std::ofstream config_file("test_config.json");
+        config_file << R"({
+            "udp_ip": "127.0.0.1",
+            "udp_port": 9000,
+            "session_timeout_sec": 30,
+            "cdr_file": "test_cdr.log",
+            "http_port": 8080,
+            "graceful_shutdown_rate": 10,
+            "log_file": "test.log",
+            "log_level": "INFO",
+            "blacklist": []
+        })";
+        config_file.close();
+
+        Logger::init("test.log", "INFO");
+        config_ = std::make_shared<Config>("test_config.json");
+        logger_ = Logger::get();
+        cdr_logger_ = std::make_shared<CDRLogger>(*config_, logger_);
+    }
+
+    void TearDown() override {
+        cdr_logger_.reset();
+        config_.reset();
+        logger_.reset();
+        std::remove("test_config.json");
+        std::remove("test.log");
+        std::remove("test_cdr.log");
+    }
+
+    std::shared_ptr<Config> config_;
+    std::shared_ptr<Logger> logger_;
+    std::shared_ptr<CDRLogger> cdr_logger_;
+};
+
+TEST_F(CDRLoggerTest, LogCreated) {
+    std::string imsi = "123456789012345";
+    cdr_logger_->log(imsi, "created");
+
+    std::ifstream file("test_cdr.log");
+    std::string line;
+    std::getline(file, line);
+    EXPECT_TRUE(line.find(imsi + ",created") != std::string::npos);
+}
+
+TEST_F(CDRLoggerTest, LogDeleted) {
+    std::string imsi = "123456789012345";
+    cdr_logger_->log(imsi, "deleted");
+
+    std::ifstream file("test_cdr.log");
+    std::string line;
+    std::getline(file, line);
+    EXPECT_TRUE(line.find(imsi + ",deleted") != std::string::npos);
+}
+
+TEST_F(CDRLoggerTest, TimestampsComeFromInjectedClock) {
+    std::remove("test_cdr.log");
+    auto clock = std::make_shared<ManualClock>();
+    clock->jump_wall(std::chrono::hours(24 * 365));
+    CDRLogger logger(*config_, logger_, clock);
+    logger.log("123456789012345", "created");
+
+    auto time_t = std::chrono::system_clock::to_time_t(clock->wall_now());
+    std::stringstream expected;
+    expected << std::put_time(std::localtime(&time_t), "%Y-%m-%d %H:%M:%S") << ",123456789012345,created";
+    std::ifstream file("test_cdr.log");
+    std::string line;
+    std::getline(file, line);
+    EXPECT_EQ(line, expected.str());
+}
+
+TEST_F(CDRLoggerTest, CoalescesRepeatedRejectsWithinWindow) {
+    std::remove("test_cdr.log");
+    EXPECT_EQ(config_->get_cdr_reject_coalesce_ms(), 1000);
+    auto clock = std::make_shared<ManualClock>();
+    auto logger = std::make_unique<CDRLogger>(*config_, logger_, clock);
+    const std::string reject = "rejected: session already exists";
+    logger->log("001010000000001", reject);
+    auto first = clock->wall_now();
+    for (int i = 0; i < 4; ++i) {
+        clock->advance(std::chrono::milliseconds(200));
+        logger->log("001010000000001", reject);
+    }
+    auto last = clock->wall_now();
+    logger->log("001010000000002", reject);
+    logger->log("001010000000001", "created");
+    EXPECT_EQ(logger->get_coalesced_rejects(), 4u);
+
+    // Окно первого IMSI ещё открыто: повторы не записаны
+    auto lines = read_lines("test_cdr.log");
+    ASSERT_EQ(lines.size(), 3u);
+    EXPECT_EQ(lines[0], cdr_time(first) + ",001010000000001," + reject);
+    EXPECT_NE(lines[1].find(",001010000000002," + reject), std::string::npos);
+    EXPECT_NE(lines[2].find(",001010000000001,created"), std::string::npos);
+
+    // Повтор, пришедший уже после закрытия окна, открывает новое окно
+    clock->advance(std::chrono::milliseconds(300));
+    logger->log("001010000000001", reject);
+    EXPECT_EQ(logger->get_coalesced_rejects(), 4u);
+    lines = read_lines("test_cdr.log");
+    ASSERT_EQ(lines.size(), 5u);
+    EXPECT_EQ(lines[3], cdr_time(clock->wall_now()) + ",001010000000001," + reject + "; repeated=4; first=" +
+        cdr_time(first + std::chrono::milliseconds(200)) + "; last=" + cdr_time(last));
+    EXPECT_NE(lines[4].find(",001010000000001," + reject), std::string::npos);
+    EXPECT_EQ(lines[4].find("repeated"), std::string::npos);
+
+    // Сводка без новых записей: периодический вызов; окно без повторов строки не даёт
+    logger->log("001010000000001", reject);
+    clock->advance(std::chrono::milliseconds(1000));
+    logger->flush_coalesced();
+    lines = read_lines("test_cdr.log");
+    ASSERT_EQ(lines.size(), 6u);
+    EXPECT_NE(lines[5].find("; repeated=1; "), std::string::npos);
+
+    // Открытые окна закрываются при уничтожении
+    logger->log("001010000000003", reject);
+    logger->log("001010000000003", reject);
+    logger.reset();
+    lines = read_lines("test_cdr.log");
+    ASSERT_EQ(lines.size(), 8u);
+    EXPECT_NE(lines[7].find(",001010000000003," + reject + "; repeated=1; "), std::string::npos);
+}
+
+TEST_F(CDRLoggerTest, BoundsOpenCoalescingWindows) {
+    std::remove("test_cdr.log");
+    auto config = coalesce_config(60000, 2);
+    auto clock = std::make_shared<ManualClock>();
+    CDRLogger logger(*config, logger_, clock);
+    const std::string reject = "rejected: no resources";
+    logger.log("001010000000001", reject);
+    logger.log("001010000000001", reject);
+    logger.log("001010000000002", reject);
+    // Третье окно вытесняет самое старое раньше срока
+    logger.log("001010000000003", reject);
+    auto lines = read_lines("test_cdr.log");
+    ASSERT_EQ(lines.size(), 4u);
+    EXPECT_NE(lines[2].find(",001010000000001," + reject + "; repeated=1; "), std::string::npos);
+    EXPECT_NE(lines[3].find(",001010000000003," + reject), std::string::npos);
+
+    logger.log("001010000000001", reject);
+    EXPECT_EQ(read_lines("test_cdr.log").size(), 5u);
+}
+
+TEST_F(CDRLoggerTest, ZeroWindowWritesEveryReject) {
+    std::remove("test_cdr.log");
+    auto config = coalesce_config(0, 1);
+    CDRLogger logger(*config, logger_);
+    for (int i = 0; i < 3; ++i) {
+        logger.log("001010000000001", "rejected: session already exists");
+    }
+    logger.flush_coalesced();
+    EXPECT_EQ(read_lines("test_cdr.log").size(), 3u);
+    EXPECT_EQ(logger.get_coalesced_rejects(), 0u);
+    EXPECT_THROW(coalesce_config(-1, 1), std::runtime_error);
+    EXPECT_THROW(coalesce_config(1000, 0), std::runtime_error);
+}
+
@@ -0,0 +1,48 @@
+#include <gtest/gtest.h>
+#include "clock.hpp"
+#include <thread>
+
+using namespace std::chrono_literals;
+
+TEST(ClockTest, ManualClockMovesOnlyWhenAdvanced) {
+    ManualClock clock;
+    auto monotonic = clock.monotonic_now();
+    auto wall = clock.wall_now();
+    std::this_thread::sleep_for(5ms);
+    EXPECT_EQ(clock.monotonic_now(), monotonic);
+    EXPECT_EQ(clock.wall_now(), wall);
+
+    clock.advance(90s);
+    EXPECT_EQ(clock.monotonic_now() - monotonic, 90s);
+    EXPECT_EQ(clock.wall_now() - wall, 90s);
+}
+
+TEST(ClockTest, ManualWallJumpLeavesMonotonicTime) {
+    ManualClock clock;
+    auto monotonic = clock.monotonic_now();
+    auto wall = clock.wall_now();
+    clock.jump_wall(-1h);
+    EXPECT_EQ(clock.monotonic_now(), monotonic);
+    EXPECT_EQ(wall - clock.wall_now(), 1h);
+}
+
+TEST(ClockTest, ScaledClockRunsFaster) {
+    ScaledClock clock(100.0);
+    auto real_start = std::chrono::steady_clock::now();
+    auto monotonic = clock.monotonic_now();
+    auto wall = clock.wall_now();
+    std::this_thread::sleep_for(20ms);
+    auto real_elapsed = std::chrono::steady_clock::now() - real_start;
+    auto scaled_elapsed = clock.monotonic_now() - monotonic;
+    // Не меньше 100 x 20 мс и не больше 100 x реально прошедшего
+    EXPECT_GE(scaled_elapsed, 2s);
+    EXPECT_LE(scaled_elapsed, real_elapsed * 100 + 1ms);
+    EXPECT_GE(clock.wall_now() - wall, 2s);
+}
+
+TEST(ClockTest, MakeClockPicksByScale) {
+    EXPECT_NE(std::dynamic_pointer_cast<SystemClock>(make_clock(1.0)), nullptr);
+    auto scaled = std::dynamic_pointer_cast<ScaledClock>(make_clock(30.0));
+    ASSERT_NE(scaled, nullptr);
+    EXPECT_EQ(scaled->get_scale(), 30.0);
+}
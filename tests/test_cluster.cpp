@@ -0,0 +1,277 @@
+#include <gtest/gtest.h>
+#include <logger.hpp>
+#include "cluster.hpp"
+#include "hash_ring.hpp"
+#include "session_manager.hpp"
+#include "cdr_logger.hpp"
+#include "config.hpp"
+#include <arpa/inet.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <future>
+#include <string>
+#include <thread>
+#include <vector>
+
+TEST(HashRingTest, SpreadsImsisEvenly) {
+    HashRing ring({ "10.0.0.1:9100", "10.0.0.2:9100", "10.0.0.3:9100", "10.0.0.4:9100" });
+    std::vector<int> counts(4, 0);
+    const int total = 40000;
+    for (int i = 0; i < total; ++i) {
+        ++counts[ring.owner(std::to_string(250010000000000LL + i))];
+    }
+    // Отклонение доли каждого узла от 1/4 не больше 20%
+    for (int count : counts) {
+        EXPECT_GT(count, total / 4 * 8 / 10);
+        EXPECT_LT(count, total / 4 * 12 / 10);
+    }
+}
+
+TEST(HashRingTest, AddingNodeMovesOnlyItsShare) {
+    HashRing before({ "10.0.0.1:9100", "10.0.0.2:9100", "10.0.0.3:9100" });
+    HashRing after({ "10.0.0.1:9100", "10.0.0.2:9100", "10.0.0.3:9100", "10.0.0.4:9100" });
+    const int total = 40000;
+    int moved = 0;
+    for (int i = 0; i < total; ++i) {
+        std::string imsi = std::to_string(250010000000000LL + i);
+        size_t owner = after.owner(imsi);
+        if (owner != before.owner(imsi)) {
+            // IMSI переезжают только на новый узел
+            EXPECT_EQ(owner, 3u);
+            ++moved;
+        }
+    }
+    EXPECT_GT(moved, total / 4 * 7 / 10);
+    EXPECT_LT(moved, total / 4 * 13 / 10);
+}
+
+// Два узла кластера в одном процессе на петлевом интерфейсе
+class ClusterTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        Logger::init("test.log", "INFO");
+        logger_ = Logger::get();
+        for (int node = 0; node < 2; ++node) {
+            std::string path = "test_cluster_" + std::to_string(node) + ".json";
+            std::ofstream config_file(path);
+            config_file << R"({
+                "udp_ip": "127.0.0.1",
+                "udp_port": 19000,
+                "session_timeout_sec": 30,
+                "cdr_file": "test_cluster_cdr_)" << node << R"(.log",
+                "http_port": 18080,
+                "graceful_shutdown_rate": 10,
+                "log_file": "test.log",
+                "log_level": "INFO",
+                "blacklist": ["001010123456789"],
+                "cluster_nodes": ["127.0.0.1:19301", "127.0.0.1:19302"],
+                "cluster_node_id": )" << node << R"(,
+                "cluster_timeout_ms": 500
+            })";
+            config_file.close();
+
+            configs_.push_back(std::make_shared<Config>(path));
+            auto cdr_logger = std::make_shared<CDRLogger>(*configs_.back(), logger_);
+            locals_.push_back(std::make_shared<SessionManager>(*configs_.back(), cdr_logger));
+            nodes_.push_back(std::make_shared<ClusterSessionManager>(*configs_.back(), locals_.back(), logger_));
+            nodes_.back()->run();
+        }
+    }
+
+    void TearDown() override {
+        for (auto& node : nodes_) {
+            node->stop();
+        }
+        nodes_.clear();
+        locals_.clear();
+        configs_.clear();
+        for (int node = 0; node < 2; ++node) {
+            std::remove(("test_cluster_" + std::to_string(node) + ".json").c_str());
+            std::remove(("test_cluster_cdr_" + std::to_string(node) + ".log").c_str());
+        }
+        std::remove("test.log");
+    }
+
+    // IMSI, принадлежащий узлу owner
+    std::string imsi_owned_by(size_t owner) {
+        for (long long i = 0;; ++i) {
+            std::string imsi = std::to_string(250010000000000LL + i);
+            if (nodes_[0]->owner(imsi) == owner) {
+                return imsi;
+            }
+        }
+    }
+
+    std::shared_ptr<Logger> logger_;
+    std::vector<std::shared_ptr<Config>> configs_;
+    std::vector<std::shared_ptr<SessionManager>> locals_;
+    std::vector<std::shared_ptr<ClusterSessionManager>> nodes_;
+};
+
+TEST_F(ClusterTest, ForwardsToOwner) {
+    std::string imsi = imsi_owned_by(1);
+    EXPECT_EQ(nodes_[1]->owner(imsi), 1u);
+
+    // Создание через узел 0 выполняется на узле 1 вместе с выделением ресурсов
+    SessionResources resources;
+    EXPECT_TRUE(nodes_[0]->create_session(imsi, &resources));
+    EXPECT_NE(resources.teid, 0u);
+    EXPECT_TRUE(resources.has_ipv4);
+    EXPECT_TRUE(locals_[1]->has_session(imsi));
+    EXPECT_FALSE(locals_[0]->has_session(imsi));
+
+    // Проверка видна с обоих узлов
+    EXPECT_TRUE(nodes_[0]->has_session(imsi));
+    EXPECT_TRUE(nodes_[1]->has_session(imsi));
+
+    EXPECT_TRUE(nodes_[0]->delete_session(imsi));
+    EXPECT_FALSE(nodes_[1]->has_session(imsi));
+    EXPECT_FALSE(nodes_[0]->delete_session(imsi));
+
+    EXPECT_NE(nodes_[0]->report().find("forwarded=4"), std::string::npos);
+    EXPECT_NE(nodes_[1]->report().find("served=4"), std::string::npos);
+}
+
+TEST_F(ClusterTest, BatchDeleteSpansNodes) {
+    std::vector<std::string> imsis = { imsi_owned_by(0), imsi_owned_by(1) };
+    for (const auto& imsi : imsis) {
+        ASSERT_TRUE(nodes_[1]->create_session(imsi));
+    }
+    imsis.push_back("999999999999999");
+    EXPECT_EQ(nodes_[0]->delete_sessions(imsis), 2u);
+    EXPECT_FALSE(locals_[0]->has_session(imsis[0]));
+    EXPECT_FALSE(locals_[1]->has_session(imsis[1]));
+}
+
+TEST_F(ClusterTest, UnreachableOwnerTimesOut) {
+    std::string imsi = imsi_owned_by(1);
+    nodes_[1]->stop();
+    EXPECT_FALSE(nodes_[0]->create_session(imsi));
+    EXPECT_NE(nodes_[0]->report().find("timeouts=1"), std::string::npos);
+}
+
+// После DOWN_AFTER_TIMEOUTS таймаутов подряд запросы к узлу отклоняются сразу, не занимая
+// вызывающий поток; узел возвращается в строй, ответив на пробный запрос
+TEST_F(ClusterTest, FailsFastWhileOwnerIsDown) {
+    std::string imsi = imsi_owned_by(1);
+    nodes_[1]->stop();
+    for (int i = 0; i < 3; ++i) {
+        EXPECT_FALSE(nodes_[0]->create_session(imsi));
+    }
+    EXPECT_FALSE(nodes_[0]->is_reachable(imsi));
+    EXPECT_TRUE(nodes_[0]->is_reachable(imsi_owned_by(0)));
+    auto start = std::chrono::steady_clock::now();
+    EXPECT_FALSE(nodes_[0]->create_session(imsi));
+    EXPECT_FALSE(nodes_[0]->has_session(imsi));
+    EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(100));
+    // Свои IMSI обслуживаются как прежде
+    EXPECT_TRUE(nodes_[0]->create_session(imsi_owned_by(0)));
+    std::string report = nodes_[0]->report();
+    EXPECT_NE(report.find("timeouts=3"), std::string::npos);
+    EXPECT_NE(report.find("down_nodes=1"), std::string::npos);
+    EXPECT_NE(report.find("unreachable=2"), std::string::npos);
+
+    // Узел 1 снова запущен: после пробы запросы к нему пересылаются
+    nodes_[1] = std::make_shared<ClusterSessionManager>(*configs_[1], locals_[1], logger_);
+    nodes_[1]->run();
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(3);
+    while (!nodes_[0]->is_reachable(imsi) && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    }
+    ASSERT_TRUE(nodes_[0]->is_reachable(imsi));
+    EXPECT_TRUE(nodes_[0]->create_session(imsi));
+    EXPECT_TRUE(locals_[1]->has_session(imsi));
+    report = nodes_[0]->report();
+    EXPECT_NE(report.find("down_nodes=0"), std::string::npos);
+    EXPECT_EQ(report.find("probes=0"), std::string::npos);
+}
+
+// Кадр запроса внутреннего канала: 'Q', операция, id (4), длина IMSI (1), IMSI, TEID SGW (4)
+static std::string cluster_request(uint8_t operation, uint32_t id, const std::string& imsi) {
+    std::string frame = { 'Q', static_cast<char>(operation), static_cast<char>(id >> 24), static_cast<char>(id >> 16),
+        static_cast<char>(id >> 8), static_cast<char>(id), static_cast<char>(imsi.size()) };
+    return frame + imsi + std::string("\0\0\0\x05", 4);
+}
+
+// UDP-сокет теста на адресе addr с таймаутом приёма 1 с
+static int bind_socket(const char* ip, int port) {
+    int fd = socket(AF_INET, SOCK_DGRAM, 0);
+    struct sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = inet_addr(ip);
+    addr.sin_port = htons(port);
+    int opt = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt));
+    EXPECT_EQ(bind(fd, (struct sockaddr*)&addr, sizeof(addr)), 0);
+    struct timeval tv = { 1, 0 };
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    return fd;
+}
+
+TEST_F(ClusterTest, RetransmitsWhenReplyIsLost) {
+    std::string imsi = imsi_owned_by(1);
+    nodes_[1]->stop();
+    // Тест занимает адрес узла 1: первый запрос остаётся без ответа, отвечаем на повтор
+    int owner = bind_socket("127.0.0.1", 19302);
+    auto created = std::async(std::launch::async, [&]() {
+        SessionResources resources;
+        bool ok = nodes_[0]->create_session(imsi, &resources);
+        return ok ? resources.teid : 0u;
+    });
+
+    uint8_t first[256];
+    uint8_t repeat[256];
+    struct sockaddr_in from = {};
+    socklen_t from_length = sizeof(from);
+    ssize_t n = recv(owner, first, sizeof(first), 0);
+    ASSERT_GT(n, 7);
+    ASSERT_EQ(recvfrom(owner, repeat, sizeof(repeat), 0, (struct sockaddr*)&from, &from_length), n);
+    EXPECT_EQ(std::memcmp(first, repeat, static_cast<size_t>(n)), 0);
+
+    uint8_t reply[36] = { 'R', 1 };
+    std::memcpy(reply + 2, repeat + 2, 4);
+    reply[6] = 1;
+    reply[10] = 77;     // TEID
+    sendto(owner, reply, sizeof(reply), 0, (struct sockaddr*)&from, from_length);
+    EXPECT_EQ(created.get(), 77u);
+    close(owner);
+
+    std::string report = nodes_[0]->report();
+    EXPECT_NE(report.find("timeouts=0"), std::string::npos);
+    EXPECT_EQ(report.find("retransmits=0"), std::string::npos);
+}
+
+TEST_F(ClusterTest, OwnerAnswersRepeatedRequestOnce) {
+    std::string imsi = imsi_owned_by(1);
+    int peer = bind_socket("127.0.0.1", 19303);
+    struct sockaddr_in owner = {};
+    owner.sin_family = AF_INET;
+    owner.sin_addr.s_addr = inet_addr("127.0.0.1");
+    owner.sin_port = htons(19302);
+
+    // Один и тот же запрос создания дважды: ответ на повтор совпадает с первым, а не "already exists"
+    std::string request = cluster_request(1, 42, imsi);
+    uint8_t replies[2][64];
+    for (auto& reply : replies) {
+        sendto(peer, request.data(), request.size(), 0, (struct sockaddr*)&owner, sizeof(owner));
+        ASSERT_EQ(recv(peer, reply, sizeof(reply), 0), 36);
+    }
+    EXPECT_EQ(replies[0][6], 1);
+    EXPECT_EQ(replies[0][35], 5);   // TEID SGW сохранён с сессией
+    EXPECT_EQ(std::memcmp(replies[0], replies[1], 36), 0);
+
+    // Новый номер — новый запрос: сессия уже есть
+    request = cluster_request(1, 43, imsi);
+    sendto(peer, request.data(), request.size(), 0, (struct sockaddr*)&owner, sizeof(owner));
+    ASSERT_EQ(recv(peer, replies[0], sizeof(replies[0]), 0), 36);
+    EXPECT_EQ(replies[0][6], 0);
+    close(peer);
+
+    std::string report = nodes_[1]->report();
+    EXPECT_NE(report.find("served=2"), std::string::npos);
+    EXPECT_NE(report.find("duplicates=1"), std::string::npos);
+    EXPECT_TRUE(locals_[1]->has_session(imsi));
+}
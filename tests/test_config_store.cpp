@@ -0,0 +1,198 @@
+#include <gtest/gtest.h>
+#include "config_store.hpp"
+#include <atomic>
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+class ConfigStoreTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        write_config(30, "INFO", R"(["001010123456789"])", 9000);
+        store_ = std::make_unique<ConfigStore>("test_reload_config.json", Config("test_reload_config.json"));
+    }
+
+    void TearDown() override {
+        store_.reset();
+        std::remove("test_reload_config.json");
+    }
+
+    void write_config(int timeout, const std::string& log_level, const std::string& blacklist, int udp_port) {
+        std::ofstream config_file("test_reload_config.json");
+        config_file << "{\n"
+                    << "  \"udp_port\": " << udp_port << ",\n"
+                    << "  \"session_timeout_sec\": " << timeout << ",\n"
+                    << "  \"log_level\": \"" << log_level << "\",\n"
+                    << "  \"rate_limit_per_sec\": 100,\n"
+                    << "  \"blacklist\": " << blacklist << "\n"
+                    << "}";
+    }
+
+    std::unique_ptr<ConfigStore> store_;
+};
+
+TEST_F(ConfigStoreTest, ReloadPublishesNewSnapshot) {
+    auto initial = store_->current();
+    EXPECT_EQ(store_->get_version(), 1u);
+
+    write_config(60, "DEBUG", R"(["001010123456789", "001010000000002"])", 9000);
+    auto result = store_->reload();
+    ASSERT_TRUE(result.ok) << result.error;
+    EXPECT_EQ(result.version, 2u);
+    EXPECT_EQ(store_->get_version(), 2u);
+    EXPECT_EQ(store_->current()->get_session_timeout_sec(), 60);
+    EXPECT_EQ(store_->current()->get_blacklist().size(), 2u);
+    EXPECT_NE(store_->report().find("version=2\n"), std::string::npos);
+    EXPECT_NE(store_->report().find("reloads=1\n"), std::string::npos);
+
+    // Третья версия вытесняет первую, но та остаётся доступна, пока её держит читатель
+    write_config(90, "INFO", "[]", 9000);
+    ASSERT_TRUE(store_->reload().ok);
+    EXPECT_EQ(store_->retired_snapshots(), 1u);
+    EXPECT_EQ(initial->get_session_timeout_sec(), 30);
+    EXPECT_EQ(initial->get_blacklist().size(), 1u);
+    store_->reclaim();
+    EXPECT_EQ(store_->retired_snapshots(), 1u);
+    {
+        auto released = std::move(initial);
+    }
+    store_->reclaim();
+    EXPECT_EQ(store_->retired_snapshots(), 0u);
+}
+
+TEST_F(ConfigStoreTest, UnchangedFileKeepsVersion) {
+    auto result = store_->reload();
+    ASSERT_TRUE(result.ok) << result.error;
+    EXPECT_EQ(result.version, 1u);
+    EXPECT_FALSE(store_->rollback().ok);
+
+    write_config(60, "INFO", R"(["001010123456789"])", 9000);
+    ASSERT_TRUE(store_->reload().ok);
+    for (int i = 0; i < 10; ++i) {
+        result = store_->reload();
+        ASSERT_TRUE(result.ok) << result.error;
+        EXPECT_EQ(result.version, 2u);
+    }
+    EXPECT_EQ(store_->retired_snapshots(), 0u);
+    EXPECT_NE(store_->report().find("reloads=1\n"), std::string::npos);
+    EXPECT_NE(store_->report().find("unchanged_reloads=11\n"), std::string::npos);
+    EXPECT_NE(store_->report().find("rollback_version=1\n"), std::string::npos);
+    // Цель отката — по-прежнему первая версия
+    ASSERT_TRUE(store_->rollback().ok);
+    EXPECT_EQ(store_->get_version(), 1u);
+}
+
+TEST_F(ConfigStoreTest, InvalidFileKeepsCurrentSnapshot) {
+    {
+        std::ofstream config_file("test_reload_config.json");
+        config_file << "{ \"session_timeout_sec\": ";
+    }
+    auto result = store_->reload();
+    EXPECT_FALSE(result.ok);
+    EXPECT_EQ(result.version, 1u);
+    EXPECT_NE(result.error.find("Failed to parse"), std::string::npos);
+
+    write_config(0, "INFO", "[]", 9000);
+    EXPECT_FALSE(store_->reload().ok);
+    write_config(30, "VERBOSE", "[]", 9000);
+    EXPECT_FALSE(store_->reload().ok);
+    EXPECT_EQ(store_->get_version(), 1u);
+    EXPECT_EQ(store_->current()->get_blacklist().size(), 1u);
+    EXPECT_NE(store_->report().find("reload_failures=3\n"), std::string::npos);
+}
+
+TEST_F(ConfigStoreTest, RestartOnlyKeysAreRejected) {
+    write_config(45, "INFO", "[]", 9100);
+    auto result = store_->reload();
+    EXPECT_FALSE(result.ok);
+    EXPECT_EQ(result.error, "Restart required to change: udp_port");
+    EXPECT_EQ(store_->current()->get_session_timeout_sec(), 30);
+}
+
+TEST_F(ConfigStoreTest, FailingHookRollsBack) {
+    std::vector<std::pair<int, int>> applied;
+    store_->on_reload([&applied](const Config& previous, const Config& next) {
+        applied.emplace_back(previous.get_session_timeout_sec(), next.get_session_timeout_sec());
+    });
+    store_->on_reload([](const Config&, const Config& next) {
+        if (next.get_session_timeout_sec() == 99) {
+            throw std::runtime_error("timeout rejected");
+        }
+    });
+
+    write_config(99, "INFO", "[]", 9000);
+    auto result = store_->reload();
+    EXPECT_FALSE(result.ok);
+    EXPECT_EQ(result.version, 1u);
+    EXPECT_NE(result.error.find("timeout rejected"), std::string::npos);
+    EXPECT_EQ(store_->current()->get_session_timeout_sec(), 30);
+    // Первый обработчик применил новый снимок и получил прежний обратно
+    ASSERT_EQ(applied.size(), 2u);
+    EXPECT_EQ(applied[0], std::make_pair(30, 99));
+    EXPECT_EQ(applied[1], std::make_pair(99, 30));
+
+    // Следующая версия получает новый номер
+    write_config(40, "INFO", "[]", 9000);
+    result = store_->reload();
+    ASSERT_TRUE(result.ok) << result.error;
+    EXPECT_EQ(result.version, 3u);
+}
+
+TEST_F(ConfigStoreTest, RollbackRestoresPreviousVersion) {
+    EXPECT_FALSE(store_->rollback().ok);
+
+    write_config(60, "INFO", "[]", 9000);
+    ASSERT_TRUE(store_->reload().ok);
+    write_config(90, "INFO", "[]", 9000);
+    ASSERT_TRUE(store_->reload().ok);
+    EXPECT_EQ(store_->get_version(), 3u);
+
+    auto result = store_->rollback();
+    ASSERT_TRUE(result.ok);
+    EXPECT_EQ(result.version, 2u);
+    EXPECT_EQ(store_->current()->get_session_timeout_sec(), 60);
+    // Откат на один шаг: снимок до предыдущего уже освобождён
+    EXPECT_FALSE(store_->rollback().ok);
+    EXPECT_EQ(store_->get_version(), 2u);
+    EXPECT_NE(store_->report().find("rollback_version=0\n"), std::string::npos);
+
+    write_config(30, "INFO", "[]", 9000);
+    ASSERT_TRUE(store_->reload().ok);
+    EXPECT_EQ(store_->get_version(), 4u);
+    ASSERT_TRUE(store_->rollback().ok);
+    EXPECT_EQ(store_->get_version(), 2u);
+}
+
+TEST_F(ConfigStoreTest, ReadersSeeWholeSnapshotsDuringReloads) {
+    std::atomic<bool> done{ false };
+    std::atomic<long long> torn{ 0 };
+    std::thread reader([this, &done, &torn]() {
+        while (!done) {
+            // Таймаут и размер чёрного списка меняются вместе: в одном снимке они согласованы
+            auto config = store_->current();
+            if (static_cast<size_t>(config->get_session_timeout_sec() / 30) != config->get_blacklist().size()) {
+                ++torn;
+            }
+        }
+    });
+    for (int i = 0; i < 200; ++i) {
+        if (i % 2 == 0) {
+            write_config(60, "INFO", R"(["001010000000001", "001010000000002"])", 9000);
+        }
+        else {
+            write_config(30, "INFO", R"(["001010000000001"])", 9000);
+        }
+        EXPECT_TRUE(store_->reload().ok);
+    }
+    done = true;
+    reader.join();
+    EXPECT_EQ(torn.load(), 0);
+    EXPECT_EQ(store_->get_version(), 201u);
+    // Держатся только действующий снимок и цель отката; остальные освобождаются без читателей
+    store_->reclaim();
+    EXPECT_EQ(store_->retired_snapshots(), 0u);
+}
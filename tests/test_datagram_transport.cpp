@@ -0,0 +1,160 @@
+#include <gtest/gtest.h>
+#include "datagram_transport.hpp"
+#include <cerrno>
+#include <string>
+#include <thread>
+#include <vector>
+#include <arpa/inet.h>
+#include <poll.h>
+#include <unistd.h>
+
+namespace {
+
+// Адрес пира для датаграмм в тестах
+struct sockaddr_in make_peer(uint16_t port) {
+    struct sockaddr_in peer = {};
+    peer.sin_family = AF_INET;
+    peer.sin_addr.s_addr = inet_addr("127.0.0.1");
+    peer.sin_port = htons(port);
+    return peer;
+}
+
+// Готов ли дескриптор к чтению без ожидания
+bool readable(int fd) {
+    struct pollfd pfd = { fd, POLLIN, 0 };
+    return poll(&pfd, 1, 0) == 1;
+}
+
+} // namespace
+
+TEST(DatagramTransportTest, LoopbackDeliversInOrderAndSignalsReadiness) {
+    LoopbackTransport transport;
+    transport.open("127.0.0.1", 0);
+    char buffer[64];
+    struct sockaddr_in peer;
+    socklen_t addr_len;
+    DatagramInfo info;
+    EXPECT_EQ(transport.receive(buffer, sizeof(buffer), peer, addr_len, info), -1);
+    EXPECT_EQ(errno, EAGAIN);
+    EXPECT_FALSE(readable(transport.get_poll_fd()));
+
+    ASSERT_TRUE(transport.inject("first", 5, make_peer(1001)));
+    ASSERT_TRUE(transport.inject("second", 6, make_peer(1002)));
+    EXPECT_TRUE(readable(transport.get_poll_fd()));
+    EXPECT_EQ(transport.get_queued(), 2u);
+
+    ASSERT_EQ(transport.receive(buffer, sizeof(buffer), peer, addr_len, info), 5);
+    EXPECT_EQ(std::string(buffer, 5), "first");
+    EXPECT_EQ(ntohs(peer.sin_port), 1001);
+    EXPECT_EQ(addr_len, sizeof(peer));
+    EXPECT_GT(info.rx_ns, 0);
+    EXPECT_TRUE(readable(transport.get_poll_fd()));
+
+    ASSERT_EQ(transport.receive(buffer, sizeof(buffer), peer, addr_len, info), 6);
+    EXPECT_EQ(std::string(buffer, 6), "second");
+    EXPECT_EQ(ntohs(peer.sin_port), 1002);
+    // Очередь опустела: готовность сброшена до следующего inject()
+    EXPECT_FALSE(readable(transport.get_poll_fd()));
+    EXPECT_EQ(transport.get_injected(), 2u);
+}
+
+TEST(DatagramTransportTest, LoopbackDropsBeyondCapacityAndTruncates) {
+    LoopbackTransport transport(2);
+    EXPECT_TRUE(transport.inject("a", 1, make_peer(1001)));
+    EXPECT_TRUE(transport.inject("0123456789", 10, make_peer(1001)));
+    EXPECT_FALSE(transport.inject("c", 1, make_peer(1001)));
+    EXPECT_EQ(transport.get_dropped(), 1u);
+
+    char buffer[4];
+    struct sockaddr_in peer;
+    socklen_t addr_len;
+    DatagramInfo info;
+    ASSERT_EQ(transport.receive(buffer, sizeof(buffer), peer, addr_len, info), 1);
+    EXPECT_TRUE(info.has_drops);
+    EXPECT_EQ(info.drops, 1u);
+    // Как у UDP: хвост, не поместившийся в буфер, теряется
+    ASSERT_EQ(transport.receive(buffer, sizeof(buffer), peer, addr_len, info), 4);
+    EXPECT_EQ(std::string(buffer, 4), "0123");
+}
+
+TEST(DatagramTransportTest, LoopbackHandsRepliesToHandler) {
+    LoopbackTransport transport;
+    std::vector<std::string> replies;
+    std::vector<uint16_t> ports;
+    transport.set_reply_handler([&](const char* data, size_t length, const struct sockaddr_in& peer) {
+        replies.emplace_back(data, length);
+        ports.push_back(ntohs(peer.sin_port));
+    });
+    struct sockaddr_in peer = make_peer(2001);
+    transport.send("created", 7, peer, sizeof(peer));
+    ASSERT_EQ(replies.size(), 1u);
+    EXPECT_EQ(replies[0], "created");
+    EXPECT_EQ(ports[0], 2001);
+    EXPECT_EQ(transport.get_replies(), 1u);
+}
+
+TEST(DatagramTransportTest, LoopbackReceivesFromConcurrentGenerators) {
+    LoopbackTransport transport(1 << 20);
+    const int generators = 4;
+    const int per_generator = 10000;
+    std::vector<std::thread> threads;
+    for (int g = 0; g < generators; ++g) {
+        threads.emplace_back([&transport, g]() {
+            struct sockaddr_in peer = make_peer(static_cast<uint16_t>(3000 + g));
+            for (int i = 0; i < per_generator; ++i) {
+                transport.inject(&i, sizeof(i), peer);
+            }
+        });
+    }
+    std::vector<int> next(generators, 0);
+    int received = 0;
+    char buffer[16];
+    struct sockaddr_in peer;
+    socklen_t addr_len;
+    DatagramInfo info;
+    while (received < generators * per_generator) {
+        if (transport.receive(buffer, sizeof(buffer), peer, addr_len, info) < 0) {
+            struct pollfd pfd = { transport.get_poll_fd(), POLLIN, 0 };
+            ASSERT_EQ(poll(&pfd, 1, 1000), 1);
+            continue;
+        }
+        // Датаграммы одного генератора приходят в порядке отправки
+        int value;
+        memcpy(&value, buffer, sizeof(value));
+        int generator = ntohs(peer.sin_port) - 3000;
+        ASSERT_EQ(value, next[generator]);
+        ++next[generator];
+        ++received;
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    EXPECT_EQ(transport.get_dropped(), 0u);
+}
+
+TEST(DatagramTransportTest, SocketTransportRoundTrip) {
+    UDPSocketTransport server;
+    server.open("127.0.0.1", 19300);
+    server.enable_receive_timestamps();
+
+    int client = socket(AF_INET, SOCK_DGRAM, 0);
+    ASSERT_GE(client, 0);
+    struct sockaddr_in server_addr = make_peer(19300);
+    sendto(client, "ping", 4, 0, (struct sockaddr*)&server_addr, sizeof(server_addr));
+
+    struct pollfd pfd = { server.get_poll_fd(), POLLIN, 0 };
+    ASSERT_EQ(poll(&pfd, 1, 1000), 1);
+    char buffer[16];
+    struct sockaddr_in peer;
+    socklen_t addr_len;
+    DatagramInfo info;
+    ASSERT_EQ(server.receive(buffer, sizeof(buffer), peer, addr_len, info), 4);
+    EXPECT_EQ(std::string(buffer, 4), "ping");
+    EXPECT_GT(info.rx_ns, 0);
+
+    server.send("pong", 4, peer, addr_len);
+    ssize_t n = recv(client, buffer, sizeof(buffer), 0);
+    ASSERT_EQ(n, 4);
+    EXPECT_EQ(std::string(buffer, 4), "pong");
+    close(client);
+}
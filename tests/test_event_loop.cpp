@@ -0,0 +1,61 @@
+#include <gtest/gtest.h>
+#include "event_loop.hpp"
+#include <chrono>
+#include <csignal>
+#include <thread>
+
+TEST(EventLoopTest, TimerRunsPeriodicallyUntilStop) {
+    EventLoop loop;
+    int ticks = 0;
+    loop.add_timer(std::chrono::milliseconds(5), [&]() {
+        if (++ticks == 5) {
+            loop.stop();
+        }
+    });
+    auto start = std::chrono::steady_clock::now();
+    loop.run();
+    EXPECT_EQ(ticks, 5);
+    EXPECT_GE(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(20));
+}
+
+TEST(EventLoopTest, PostRunsOnLoopThread) {
+    EventLoop loop;
+    std::thread::id loop_thread = std::this_thread::get_id();
+    std::thread::id ran_on;
+    std::thread poster([&]() {
+        loop.post([&]() {
+            ran_on = std::this_thread::get_id();
+            loop.stop();
+        });
+    });
+    loop.run();
+    poster.join();
+    EXPECT_EQ(ran_on, loop_thread);
+}
+
+TEST(EventLoopTest, StopFromAnotherThreadWakesLoopImmediately) {
+    EventLoop loop;
+    // Таймер много длиннее ожидаемой задержки: цикл должен проснуться от eventfd, а не от него
+    loop.add_timer(std::chrono::seconds(10), []() {});
+    std::thread stopper([&]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        loop.stop();
+    });
+    loop.run();
+    auto woke = std::chrono::steady_clock::now();
+    stopper.join();
+    EXPECT_LT(woke - loop.stop_requested_at(), std::chrono::milliseconds(10));
+}
+
+TEST(EventLoopTest, DeliversBlockedSignalThroughSignalfd) {
+    EventLoop loop;
+    int received = 0;
+    loop.handle_signals({ SIGUSR1 }, [&](int signo) {
+        received = signo;
+        loop.stop();
+    });
+    // Сигнал заблокирован и ждёт в signalfd, пока цикл не запущен
+    raise(SIGUSR1);
+    loop.run();
+    EXPECT_EQ(received, SIGUSR1);
+}
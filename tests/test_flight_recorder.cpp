@@ -0,0 +1,180 @@
+#include <gtest/gtest.h>
+#include "flight_recorder.hpp"
+#include <nlohmann/json.hpp>
+#include <atomic>
+#include <csignal>
+#include <cstdio>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+namespace {
+
+// События трассы без метаданных потоков
+std::vector<nlohmann::json> trace_events(const std::string& trace) {
+    std::vector<nlohmann::json> events;
+    auto parsed = nlohmann::json::parse(trace);
+    for (const auto& event : parsed["traceEvents"]) {
+        if (event["ph"] != "M") {
+            events.push_back(event);
+        }
+    }
+    return events;
+}
+
+} // namespace
+
+TEST(FlightRecorderTest, WritesInstantAndSpanEventsAsChromeTrace) {
+    FlightRecorder recorder(16);
+    recorder.instant(FlightEvent::Receive, 42);
+    {
+        FlightSpan span(&recorder, FlightEvent::SessionCreate);
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        span.set_value(1);
+    }
+    {
+        FlightSpan disabled(nullptr, FlightEvent::CdrWrite);
+    }
+    recorder.instant(FlightEvent::Send, 7);
+
+    auto trace = nlohmann::json::parse(recorder.chrome_trace());
+    EXPECT_EQ(trace["displayTimeUnit"], "ns");
+    auto events = trace_events(recorder.chrome_trace());
+    ASSERT_EQ(events.size(), 3u);
+    EXPECT_EQ(events[0]["name"], "receive");
+    EXPECT_EQ(events[0]["ph"], "i");
+    EXPECT_EQ(events[0]["args"]["bytes"], 42);
+    EXPECT_EQ(events[1]["name"], "session_create");
+    EXPECT_EQ(events[1]["ph"], "X");
+    EXPECT_EQ(events[1]["args"]["ok"], 1);
+    // Такты переведены в микросекунды: интервал не короче сна
+    EXPECT_GE(events[1]["dur"].get<double>(), 1900.0);
+    EXPECT_LT(events[1]["dur"].get<double>(), 1000000.0);
+    EXPECT_LE(events[0]["ts"].get<double>(), events[1]["ts"].get<double>());
+    EXPECT_GE(events[2]["ts"].get<double>(), events[1]["ts"].get<double>() + events[1]["dur"].get<double>() - 1.0);
+    EXPECT_EQ(events[2]["tid"], events[0]["tid"]);
+
+    // Метаданные: имя потока для каждого кольца
+    size_t names = 0;
+    for (const auto& event : trace["traceEvents"]) {
+        if (event["ph"] == "M") {
+            EXPECT_EQ(event["name"], "thread_name");
+            EXPECT_EQ(event["tid"], events[0]["tid"]);
+            ++names;
+        }
+    }
+    EXPECT_EQ(names, 1u);
+}
+
+TEST(FlightRecorderTest, RingKeepsOnlyLatestEvents) {
+    FlightRecorder recorder(6);
+    EXPECT_EQ(recorder.get_events_per_thread(), 8u);
+    for (uint64_t i = 0; i < 20; ++i) {
+        recorder.instant(FlightEvent::Enqueue, i);
+    }
+    auto events = trace_events(recorder.chrome_trace());
+    ASSERT_EQ(events.size(), 8u);
+    for (size_t i = 0; i < events.size(); ++i) {
+        EXPECT_EQ(events[i]["args"]["queue_depth"], 12 + i);
+    }
+    EXPECT_NE(recorder.report().find("events_per_thread=8\nthreads=1\nrecorded=20\n"), std::string::npos)
+        << recorder.report();
+
+    // Окно по времени: старые события не попадают в выгрузку
+    std::this_thread::sleep_for(std::chrono::milliseconds(60));
+    recorder.instant(FlightEvent::ExpirySweep, 0);
+    events = trace_events(recorder.chrome_trace(30));
+    ASSERT_EQ(events.size(), 1u);
+    EXPECT_EQ(events[0]["name"], "expiry_sweep");
+}
+
+TEST(FlightRecorderTest, ReadsConsistentlyWhileThreadsWrite) {
+    FlightRecorder recorder(64);
+    const int writers = 4;
+    std::atomic<bool> finished{ false };
+    std::atomic<int> done{ 0 };
+    std::vector<std::thread> threads;
+    for (int w = 0; w < writers; ++w) {
+        threads.emplace_back([&recorder, &done]() {
+            // Значение — номер события потока: у целых событий значения идут подряд
+            for (uint64_t i = 0; i < 20000; ++i) {
+                uint64_t now = FlightRecorder::now();
+                recorder.record(FlightEvent::Send, now, now + i % 3, i);
+            }
+            ++done;
+        });
+    }
+    std::thread reader([&]() {
+        while (!finished) {
+            auto events = trace_events(recorder.chrome_trace());
+            std::map<int, std::vector<uint64_t>> values;
+            for (const auto& event : events) {
+                values[event["tid"].get<int>()].push_back(event["args"]["bytes"].get<uint64_t>());
+            }
+            for (const auto& entry : values) {
+                EXPECT_LE(entry.second.size(), 64u);
+                for (size_t i = 1; i < entry.second.size(); ++i) {
+                    if (entry.second[i] <= entry.second[i - 1]) {
+                        ADD_FAILURE() << "Out of order event in thread " << entry.first;
+                    }
+                }
+            }
+        }
+    });
+    while (done < writers) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    finished = true;
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    reader.join();
+
+    auto events = trace_events(recorder.chrome_trace());
+    std::map<int, std::vector<uint64_t>> values;
+    for (const auto& event : events) {
+        values[event["tid"].get<int>()].push_back(event["args"]["bytes"].get<uint64_t>());
+    }
+    ASSERT_EQ(values.size(), static_cast<size_t>(writers));
+    for (const auto& entry : values) {
+        ASSERT_EQ(entry.second.size(), 64u);
+        EXPECT_EQ(entry.second.front(), 20000u - 64);
+        EXPECT_EQ(entry.second.back(), 19999u);
+    }
+    EXPECT_NE(recorder.report().find("threads=4\nrecorded=80000\n"), std::string::npos) << recorder.report();
+}
+
+TEST(FlightRecorderTest, DumpsTraceToFile) {
+    FlightRecorder recorder(32);
+    recorder.instant(FlightEvent::Receive, 1);
+    ASSERT_TRUE(recorder.dump("test_flight_recorder.json"));
+    std::ifstream file("test_flight_recorder.json");
+    std::stringstream contents;
+    contents << file.rdbuf();
+    EXPECT_EQ(trace_events(contents.str()).size(), 1u);
+    std::remove("test_flight_recorder.json");
+    EXPECT_FALSE(recorder.dump("/nonexistent_dir/trace.json"));
+}
+
+TEST(FlightRecorderTest, DumpsOnFatalSignal) {
+    std::remove("test_flight_recorder_crash.json");
+    EXPECT_EXIT({
+        auto recorder = std::make_shared<FlightRecorder>(32);
+        FlightRecorder::install_crash_handler(recorder, "test_flight_recorder_crash.json");
+        recorder->instant(FlightEvent::Receive, 9);
+        recorder->instant(FlightEvent::Enqueue, 1);
+        std::abort();
+    }, ::testing::KilledBySignal(SIGABRT), "");
+
+    std::ifstream file("test_flight_recorder_crash.json");
+    ASSERT_TRUE(file.is_open());
+    std::stringstream contents;
+    contents << file.rdbuf();
+    auto events = trace_events(contents.str());
+    ASSERT_EQ(events.size(), 2u);
+    EXPECT_EQ(events[0]["name"], "receive");
+    EXPECT_EQ(events[1]["name"], "enqueue");
+    std::remove("test_flight_recorder_crash.json");
+}
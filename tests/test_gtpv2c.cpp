@@ -0,0 +1,220 @@
+#include <gtest/gtest.h>
+#include "gtpv2c.hpp"
+#include <arpa/inet.h>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace gtpv2c;
+
+// F-TEID отправителя для тестов
+static FTEID make_sender() {
+    FTEID sender;
+    sender.interface_type = S5S8_SGW_GTPC;
+    sender.teid = 0x11223344;
+    sender.has_ipv4 = true;
+    sender.ipv4 = inet_addr("10.1.2.3");
+    return sender;
+}
+
+TEST(GTPv2CTest, CreateSessionRequestRoundTrip) {
+    uint8_t buffer[128];
+    size_t length = encode_create_session_request(buffer, sizeof(buffer), 0x123456, "001010123456789", 15, make_sender());
+    ASSERT_GT(length, 0u);
+
+    // Заголовок: версия 2, флаг T, тип 32, длина без первых 4 октетов
+    EXPECT_EQ(buffer[0], 0x48);
+    EXPECT_EQ(buffer[1], CREATE_SESSION_REQUEST);
+    EXPECT_EQ((buffer[2] << 8 | buffer[3]) + 4, static_cast<int>(length));
+
+    MessageView message;
+    ASSERT_EQ(parse(buffer, length, message), ParseResult::OK);
+    EXPECT_EQ(message.type, CREATE_SESSION_REQUEST);
+    EXPECT_TRUE(message.has_teid);
+    EXPECT_EQ(message.teid, 0u);
+    EXPECT_EQ(message.sequence, 0x123456u);
+
+    // Разбор не копирует данные: IE указывают в исходный буфер
+    ASSERT_TRUE(message.imsi.present());
+    EXPECT_GE(message.imsi.value, buffer);
+    EXPECT_LT(message.imsi.value, buffer + length);
+
+    char digits[MAX_IMSI_DIGITS];
+    size_t count = decode_imsi(message.imsi, digits, sizeof(digits));
+    EXPECT_EQ(std::string(digits, count), "001010123456789");
+    // TBCD: младшая тетрада — первая цифра, заполнитель 0xF
+    EXPECT_EQ(message.imsi.value[0], 0x00);
+    EXPECT_EQ(message.imsi.value[7], 0xF9);
+
+    FTEID sender;
+    ASSERT_TRUE(decode_fteid(message.fteid, sender));
+    EXPECT_EQ(sender.interface_type, S5S8_SGW_GTPC);
+    EXPECT_EQ(sender.teid, 0x11223344u);
+    EXPECT_TRUE(sender.has_ipv4);
+    EXPECT_EQ(sender.ipv4, inet_addr("10.1.2.3"));
+}
+
+TEST(GTPv2CTest, ResponsesRoundTrip) {
+    uint8_t buffer[128];
+    uint8_t ipv6[16] = { 0x20, 0x01, 0x0d, 0xb8 };
+    FTEID pgw;
+    pgw.interface_type = S5S8_PGW_GTPC;
+    pgw.teid = 42;
+    pgw.ipv6 = ipv6;
+    size_t length = encode_create_session_response(buffer, sizeof(buffer), 0x11223344, 7, CAUSE_REQUEST_ACCEPTED, &pgw);
+    ASSERT_GT(length, 0u);
+
+    MessageView message;
+    ASSERT_EQ(parse(buffer, length, message), ParseResult::OK);
+    EXPECT_EQ(message.type, CREATE_SESSION_RESPONSE);
+    EXPECT_EQ(message.teid, 0x11223344u);
+    EXPECT_EQ(message.sequence, 7u);
+    uint8_t cause = 0;
+    ASSERT_TRUE(decode_cause(message.cause, cause));
+    EXPECT_EQ(cause, CAUSE_REQUEST_ACCEPTED);
+    // F-TEID PGW имеет instance 1 и не попадает в поле первого экземпляра
+    EXPECT_FALSE(message.fteid.present());
+
+    length = encode_delete_session_response(buffer, sizeof(buffer), 5, 8, CAUSE_CONTEXT_NOT_FOUND);
+    ASSERT_EQ(parse(buffer, length, message), ParseResult::OK);
+    EXPECT_EQ(message.type, DELETE_SESSION_RESPONSE);
+    ASSERT_TRUE(decode_cause(message.cause, cause));
+    EXPECT_EQ(cause, CAUSE_CONTEXT_NOT_FOUND);
+
+    length = encode_delete_session_request(buffer, sizeof(buffer), 5, 9, "123456789012345", 15);
+    ASSERT_EQ(parse(buffer, length, message), ParseResult::OK);
+    EXPECT_EQ(message.type, DELETE_SESSION_REQUEST);
+    EXPECT_EQ(message.teid, 5u);
+}
+
+TEST(GTPv2CTest, PAARoundTrip) {
+    uint8_t buffer[128];
+    uint8_t prefix[16] = { 0x20, 0x01, 0x0d, 0xb8, 0, 0, 0, 7 };
+    FTEID pgw;
+    pgw.interface_type = S5S8_PGW_GTPC;
+    pgw.teid = 1000;
+    PAA paa;
+    paa.has_ipv4 = true;
+    paa.ipv4 = inet_addr("10.45.0.7");
+    paa.ipv6 = prefix;
+    size_t length = encode_create_session_response(buffer, sizeof(buffer), 1, 2, CAUSE_REQUEST_ACCEPTED, &pgw, &paa);
+    ASSERT_GT(length, 0u);
+
+    MessageView message;
+    ASSERT_EQ(parse(buffer, length, message), ParseResult::OK);
+    PAA decoded;
+    ASSERT_TRUE(decode_paa(message.paa, decoded));
+    EXPECT_EQ(message.paa.value[0], PDN_IPV4V6);
+    EXPECT_TRUE(decoded.has_ipv4);
+    EXPECT_EQ(decoded.ipv4, inet_addr("10.45.0.7"));
+    ASSERT_NE(decoded.ipv6, nullptr);
+    EXPECT_EQ(decoded.ipv6_prefix_length, 64);
+    EXPECT_EQ(std::memcmp(decoded.ipv6, prefix, 16), 0);
+
+    // Усечённый PAA не разбирается
+    IEView truncated = message.paa;
+    truncated.length = 10;
+    EXPECT_FALSE(decode_paa(truncated, decoded));
+}
+
+TEST(GTPv2CTest, RejectsMalformedHeaders) {
+    uint8_t buffer[128];
+    size_t length = encode_create_session_request(buffer, sizeof(buffer), 1, "123456789012345", 15, make_sender());
+    MessageView message;
+
+    EXPECT_EQ(parse(buffer, 4, message), ParseResult::TOO_SHORT);
+
+    std::vector<uint8_t> bad_version(buffer, buffer + length);
+    bad_version[0] = 0x28;
+    EXPECT_EQ(parse(bad_version.data(), bad_version.size(), message), ParseResult::BAD_VERSION);
+
+    EXPECT_EQ(parse(buffer, length - 1, message), ParseResult::BAD_LENGTH);
+
+    // IE объявляет длину больше оставшегося сообщения
+    std::vector<uint8_t> bad_ie(buffer, buffer + length);
+    bad_ie[HEADER_SIZE + 2] = 0xFF;
+    EXPECT_EQ(parse(bad_ie.data(), bad_ie.size(), message), ParseResult::BAD_IE);
+}
+
+TEST(GTPv2CTest, EncodeFailsOnSmallBuffer) {
+    uint8_t buffer[64];
+    size_t full = encode_create_session_request(buffer, sizeof(buffer), 1, "123456789012345", 15, make_sender());
+    ASSERT_GT(full, 0u);
+    for (size_t capacity = 0; capacity < full; ++capacity) {
+        size_t length = encode_create_session_request(buffer, capacity, 1, "123456789012345", 15, make_sender());
+        EXPECT_EQ(length, 0u) << "capacity " << capacity;
+    }
+    EXPECT_EQ(encode_create_session_request(buffer, full, 1, "123456789012345", 15, make_sender()), full);
+}
+
+TEST(GTPv2CTest, InvalidImsiDigits) {
+    uint8_t value[] = { 0x21, 0xA3 };
+    IEView ie;
+    ie.value = value;
+    ie.length = sizeof(value);
+    char digits[MAX_IMSI_DIGITS];
+    EXPECT_EQ(decode_imsi(ie, digits, sizeof(digits)), 0u);
+
+    // Заполнитель в младшей тетраде недопустим
+    uint8_t filler_low[] = { 0x21, 0x3F };
+    ie.value = filler_low;
+    EXPECT_EQ(decode_imsi(ie, digits, sizeof(digits)), 0u);
+}
+
+// Fuzz-подобная проверка: усечения, мутации и случайные байты не должны приводить
+// к чтению за границами, а найденные IE обязаны лежать внутри сообщения
+TEST(GTPv2CTest, FuzzParserStaysInBounds) {
+    std::mt19937 rng(12345);
+    uint8_t valid[128];
+    size_t valid_length = encode_create_session_request(valid, sizeof(valid), 99, "123456789012345", 15, make_sender());
+
+    auto check = [](const std::vector<uint8_t>& packet) {
+        MessageView message;
+        if (parse(packet.data(), packet.size(), message) != ParseResult::OK) {
+            return;
+        }
+        ASSERT_LE(message.length, packet.size());
+        for (const IEView* ie : { &message.imsi, &message.cause, &message.fteid, &message.paa }) {
+            if (ie->present()) {
+                ASSERT_GE(ie->value, packet.data());
+                ASSERT_LE(ie->value + ie->length, packet.data() + message.length);
+            }
+        }
+        char digits[MAX_IMSI_DIGITS];
+        decode_imsi(message.imsi, digits, sizeof(digits));
+        uint8_t cause;
+        decode_cause(message.cause, cause);
+        PAA paa;
+        if (decode_paa(message.paa, paa) && paa.ipv6) {
+            ASSERT_LE(paa.ipv6 + 16, message.paa.value + message.paa.length);
+        }
+        FTEID fteid;
+        if (decode_fteid(message.fteid, fteid) && fteid.ipv6) {
+            ASSERT_LE(fteid.ipv6 + 16, message.fteid.value + message.fteid.length);
+        }
+    };
+
+    for (size_t cut = 0; cut <= valid_length; ++cut) {
+        check(std::vector<uint8_t>(valid, valid + cut));
+    }
+    for (int iteration = 0; iteration < 20000; ++iteration) {
+        std::vector<uint8_t> packet(valid, valid + valid_length);
+        int flips = 1 + static_cast<int>(rng() % 4);
+        for (int i = 0; i < flips; ++i) {
+            packet[rng() % packet.size()] = static_cast<uint8_t>(rng());
+        }
+        packet.resize(rng() % (packet.size() + 8));
+        check(packet);
+    }
+    for (int iteration = 0; iteration < 20000; ++iteration) {
+        std::vector<uint8_t> packet(rng() % 64);
+        for (auto& byte : packet) {
+            byte = static_cast<uint8_t>(rng());
+        }
+        if (!packet.empty()) {
+            packet[0] = static_cast<uint8_t>((VERSION << 5) | (packet[0] & 0x1F));
+        }
+        check(packet);
+    }
+}
\ No newline at end of file
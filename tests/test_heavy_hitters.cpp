@@ -0,0 +1,122 @@
+#include <gtest/gtest.h>
+#include "heavy_hitters.hpp"
+#include <arpa/inet.h>
+#include <functional>
+#include <map>
+#include <string>
+
+using namespace std::chrono_literals;
+
+TEST(HeavyHittersTest, SketchNeverUnderestimates) {
+    CountMinSketch sketch;
+    std::map<uint64_t, uint32_t> actual;
+    std::hash<std::string> hasher;
+    for (int i = 0; i < 50000; ++i) {
+        uint64_t hash = hasher(std::to_string(i % 5000 * (i % 7 == 0 ? 1 : 3)));
+        sketch.add(hash);
+        ++actual[hash];
+    }
+    for (const auto& [hash, count] : actual) {
+        EXPECT_GE(sketch.estimate(hash), count);
+    }
+    sketch.decay(1);
+    for (const auto& [hash, count] : actual) {
+        EXPECT_GE(sketch.estimate(hash), count / 2);
+    }
+}
+
+TEST(HeavyHittersTest, FindsHeavyKeysAmongUniqueOnes) {
+    TopKTracker tracker(3, 60s);
+    auto now = std::chrono::steady_clock::now();
+    // Три тяжёлых ключа вперемешку с 20000 ключей, встречающихся по разу
+    for (int i = 0; i < 20000; ++i) {
+        tracker.record("unique-" + std::to_string(i), now);
+        if (i % 10 == 0) {
+            tracker.record("heavy-a", now);
+        }
+        if (i % 20 == 0) {
+            tracker.record("heavy-b", now);
+        }
+        if (i % 40 == 0) {
+            tracker.record("heavy-c", now);
+        }
+    }
+    tracker.publish(now);
+    auto top = tracker.top(now);
+    ASSERT_EQ(top.size(), 3u);
+    EXPECT_EQ(top[0].first, "heavy-a");
+    EXPECT_EQ(top[1].first, "heavy-b");
+    EXPECT_EQ(top[2].first, "heavy-c");
+    // Оценка count-min только завышает частоту
+    EXPECT_GE(top[0].second, 2000u);
+    EXPECT_GE(top[1].second, 1000u);
+    EXPECT_GE(top[2].second, 500u);
+    EXPECT_LT(top[0].second, 2100u);
+    EXPECT_EQ(tracker.total(now), 20000u + 2000u + 1000u + 500u);
+}
+
+TEST(HeavyHittersTest, CountsDecayEveryWindow) {
+    TopKTracker tracker(2, 10s);
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < 400; ++i) {
+        tracker.record("old", start);
+    }
+    tracker.publish(start);
+    ASSERT_EQ(tracker.top(start).size(), 1u);
+    EXPECT_EQ(tracker.top(start)[0].second, 400u);
+
+    // Без новых записей снимок затухает при чтении
+    EXPECT_EQ(tracker.top(start + 25s)[0].second, 100u);
+    EXPECT_EQ(tracker.total(start + 25s), 100u);
+
+    // Новый ключ через два окна обгоняет старого лидера, уже поделённого на 4
+    for (int i = 0; i < 150; ++i) {
+        tracker.record("new", start + 21s);
+    }
+    tracker.publish(start + 21s);
+    auto top = tracker.top(start + 21s);
+    ASSERT_EQ(top.size(), 2u);
+    EXPECT_EQ(top[0].first, "new");
+    EXPECT_EQ(top[0].second, 150u);
+    EXPECT_EQ(top[1].first, "old");
+    EXPECT_EQ(top[1].second, 100u);
+
+    // Через много окон старые частоты обнуляются и пропадают из списка
+    EXPECT_TRUE(tracker.top(start + 2000s).empty());
+}
+
+TEST(HeavyHittersTest, PublishesPeriodicallyWithoutExplicitCall) {
+    TopKTracker tracker(1, 60s);
+    auto now = std::chrono::steady_clock::now();
+    for (uint64_t i = 0; i < TopKTracker::PUBLISH_EVERY; ++i) {
+        tracker.record("flood", now);
+    }
+    auto top = tracker.top(now);
+    ASSERT_EQ(top.size(), 1u);
+    EXPECT_EQ(top[0].second, TopKTracker::PUBLISH_EVERY);
+}
+
+TEST(HeavyHittersTest, ReportsPeersByAddressAndImsis) {
+    HeavyHitters heavy_hitters(2, 60s);
+    auto now = std::chrono::steady_clock::now();
+    struct sockaddr_in peer = {};
+    peer.sin_family = AF_INET;
+    peer.sin_addr.s_addr = inet_addr("192.0.2.7");
+    // Разные порты одного адреса считаются вместе
+    for (int i = 0; i < 30; ++i) {
+        peer.sin_port = htons(static_cast<uint16_t>(10000 + i));
+        heavy_hitters.record_peer(peer, now);
+        heavy_hitters.record_imsi("001010000000042", now);
+    }
+    peer.sin_addr.s_addr = inet_addr("192.0.2.8");
+    heavy_hitters.record_peer(peer, now);
+    heavy_hitters.record_imsi("001010000000043", now);
+    heavy_hitters.publish(now);
+
+    std::string report = heavy_hitters.report();
+    EXPECT_NE(report.find("window_sec=60\n"), std::string::npos);
+    EXPECT_NE(report.find("peer_total=31\n"), std::string::npos);
+    EXPECT_NE(report.find("peer_1=192.0.2.7\npeer_1_count=30\n"), std::string::npos);
+    EXPECT_NE(report.find("peer_2=192.0.2.8\npeer_2_count=1\n"), std::string::npos);
+    EXPECT_NE(report.find("imsi_1=001010000000042\nimsi_1_count=30\n"), std::string::npos);
+}
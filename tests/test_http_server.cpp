@@ -1,177 +1,416 @@
-#include <gtest/gtest.h>
-#include <logger.hpp>
-#include "http_server.hpp"
-#include "session_manager.hpp"
-#include "cdr_logger.hpp"
-#include "udp_server.hpp"
-#include "config.hpp"
-#include <httplib.h>
-#include <thread>
-#include <chrono>
-#include <fstream>
-#include <set>
-#include <atomic>
-#include <iostream>
-
-class HTTPServerTest : public ::testing::Test {
-protected:
-    void SetUp() override {
-        std::ofstream config_file("test_config.json");
-        config_file << R"({
-            "udp_ip": "127.0.0.1",
-            "udp_port": 19000,
-            "session_timeout_sec": 2,
-            "cdr_file": "test_cdr.log",
-            "http_port": 18080,
-            "graceful_shutdown_rate": 10,
-            "log_file": "test.log",
-            "log_level": "INFO",
-            "blacklist": []
-        })";
-        config_file.close();
-
-        Logger::init("test.log", "INFO");
-        config_ = std::make_shared<Config>("test_config.json");
-        logger_ = Logger::get();
-        cdr_logger_ = std::make_shared<CDRLogger>(*config_, logger_);
-        session_manager_ = std::make_shared<SessionManager>(*config_, cdr_logger_);
-        udp_server_ = std::make_shared<UDPServer>(*config_, session_manager_, cdr_logger_);
-        http_server_ = std::make_shared<HTTPServer>(*config_, logger_, session_manager_, [this]() { udp_server_->stop(); }, running_);
-
-        //  
-        session_thread_ = std::thread([this]() { session_manager_->run(); });
-        udp_thread_ = std::thread([this]() { udp_server_->run(); });
-        http_thread_ = std::thread([this]() { http_server_->run(); });
-        std::this_thread::sleep_for(std::chrono::milliseconds(100));
-    }
-
-    void TearDown() override {
-        http_server_->stop();
-        std::this_thread::sleep_for(std::chrono::milliseconds(2000)); //  
-        if (session_thread_.joinable()) {
-            session_thread_.join();
-        }
-        if (udp_thread_.joinable()) {
-            udp_thread_.join();
-        }
-        if (http_thread_.joinable()) {
-            http_thread_.join();
-        }
-        http_server_.reset();
-        udp_server_.reset();
-        session_manager_.reset();
-        cdr_logger_.reset();
-        config_.reset();
-        logger_.reset();
-        std::remove("test_config.json");
-        std::remove("test_cdr.log");
-        //   test.log ,    
-    }
-
-    std::atomic<bool> running_{ true };
-    std::shared_ptr<Config> config_;
-    std::shared_ptr<Logger> logger_;
-    std::shared_ptr<CDRLogger> cdr_logger_;
-    std::shared_ptr<SessionManager> session_manager_;
-    std::shared_ptr<UDPServer> udp_server_;
-    std::shared_ptr<HTTPServer> http_server_;
-    std::thread session_thread_;
-    std::thread udp_thread_;
-    std::thread http_thread_;
-};
-
-TEST_F(HTTPServerTest, CheckSubscriberActive) {
-    session_manager_->create_session("123456789012345");
-
-    httplib::Client cli("127.0.0.1", 18080);
-    auto res = cli.Get("/check_subscriber?imsi=123456789012345");
-    ASSERT_TRUE(res != nullptr);
-    EXPECT_EQ(res->status, 200);
-    EXPECT_EQ(res->body, "active");
-}
-
-TEST_F(HTTPServerTest, CheckSubscriberNotActive) {
-    httplib::Client cli("127.0.0.1", 18080);
-    auto res = cli.Get("/check_subscriber?imsi=999999999999999");
-    ASSERT_TRUE(res != nullptr);
-    EXPECT_EQ(res->status, 200);
-    EXPECT_EQ(res->body, "not active");
-}
-
-TEST_F(HTTPServerTest, StopServer) {
-    httplib::Client cli("127.0.0.1", 18080);
-    auto res = cli.Get("/stop");
-    ASSERT_TRUE(res != nullptr);
-    EXPECT_EQ(res->status, 200);
-    EXPECT_EQ(res->body, "Stopping server...");
-
-    std::this_thread::sleep_for(std::chrono::milliseconds(2000)); //  
-
-    auto res_after = cli.Get("/check_subscriber?imsi=123456789012345");
-    EXPECT_TRUE(res_after == nullptr); //    
-
-    //   test.log
-    std::ifstream log_file("test.log");
-    std::string log_content;
-    std::string line;
-    while (std::getline(log_file, line)) {
-        log_content += line + "\n";
-    }
-    log_file.close();
-    std::cout << "test.log content:\n" << log_content << std::endl;
-
-    // ,    
-    log_file.open("test.log");
-    bool found_stop = false;
-    bool found_session_manager_stop = false;
-    while (std::getline(log_file, line)) {
-        if (line.find("HTTP Server stopped") != std::string::npos) {
-            found_stop = true;
-        }
-        if (line.find("SessionManager stopped") != std::string::npos) {
-            found_session_manager_stop = true;
-        }
-    }
-    EXPECT_TRUE(found_stop) << "HTTP Server stop not logged";
-    EXPECT_TRUE(found_session_manager_stop) << "SessionManager stop not logged";
-
-    //  test.log  
-    std::remove("test.log");
-}
-
-TEST_F(HTTPServerTest, StopWithActiveSessions) {
-    const int num_sessions = 10;
-    std::vector<std::string> imsies(num_sessions);
-
-    //  10 
-    for (int i = 0; i < num_sessions; ++i) {
-        imsies[i] = "123456789" + std::to_string(300000 + i);
-        session_manager_->create_session(imsies[i]);
-    }
-
-    httplib::Client cli("127.0.0.1", 18080);
-    auto res = cli.Get("/stop");
-    ASSERT_TRUE(res != nullptr);
-    EXPECT_EQ(res->status, 200);
-    EXPECT_EQ(res->body, "Stopping server...");
-
-    std::this_thread::sleep_for(std::chrono::milliseconds(2000)); //  
-
-    // ,    
-    for (const auto& imsi : imsies) {
-        EXPECT_FALSE(session_manager_->has_session(imsi)) << "Session not deleted for IMSI: " << imsi;
-    }
-
-    // ,   cdr.log   deleted
-    std::ifstream cdr_file("test_cdr.log");
-    std::string line;
-    std::set<std::string> deleted_imsies;
-    while (std::getline(cdr_file, line)) {
-        for (const auto& imsi : imsies) {
-            if (line.find(imsi + ",deleted") != std::string::npos) {
-                deleted_imsies.insert(imsi);
-            }
-        }
-    }
-    EXPECT_EQ(deleted_imsies.size(), num_sessions) << "Not all IMSI have 'deleted' in cdr.log";
-}
\ No newline at end of file
+#include <gtest/gtest.h>
+#include <logger.hpp>
+#include "http_server.hpp"
+#include "session_manager.hpp"
+#include "cdr_logger.hpp"
+#include "udp_server.hpp"
+#include "config.hpp"
+#include <httplib.h>
+#include <thread>
+#include <chrono>
+#include <fstream>
+#include <set>
+#include <sstream>
+#include <atomic>
+#include <iostream>
+#include <arpa/inet.h>
+
+class HTTPServerTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        std::ofstream config_file("test_config.json");
+        config_file << R"({
+            "udp_ip": "127.0.0.1",
+            "udp_port": 19000,
+            "session_timeout_sec": 2,
+            "cdr_file": "test_cdr.log",
+            "http_port": 18080,
+            "graceful_shutdown_rate": 10,
+            "log_file": "test.log",
+            "log_level": "INFO",
+            "blacklist": []
+        })";
+        config_file.close();
+
+        Logger::init("test.log", "INFO");
+        config_ = std::make_shared<Config>("test_config.json");
+        logger_ = Logger::get();
+        cdr_logger_ = std::make_shared<CDRLogger>(*config_, logger_);
+        session_manager_ = std::make_shared<SessionManager>(*config_, cdr_logger_);
+        udp_server_ = std::make_shared<UDPServer>(*config_, session_manager_, cdr_logger_);
+        http_server_ = std::make_shared<HTTPServer>(*config_, logger_, session_manager_, [this]() { udp_server_->stop(); }, running_);
+        http_server_->set_admission_control(udp_server_->get_admission_control());
+
+        // Запускаем серверы
+        session_thread_ = std::thread([this]() { session_manager_->run(); });
+        udp_thread_ = std::thread([this]() { udp_server_->run(); });
+        http_thread_ = std::thread([this]() { http_server_->run(); });
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    }
+
+    void TearDown() override {
+        http_server_->stop();
+        std::this_thread::sleep_for(std::chrono::milliseconds(2000)); // Увеличиваем задержку
+        if (session_thread_.joinable()) {
+            session_thread_.join();
+        }
+        if (udp_thread_.joinable()) {
+            udp_thread_.join();
+        }
+        if (http_thread_.joinable()) {
+            http_thread_.join();
+        }
+        http_server_.reset();
+        udp_server_.reset();
+        session_manager_.reset();
+        cdr_logger_.reset();
+        config_.reset();
+        logger_.reset();
+        std::remove("test_config.json");
+        std::remove("test_cdr.log");
+        // Не удаляем test.log сразу, чтобы проверить его содержимое
+    }
+
+    std::atomic<bool> running_{ true };
+    std::shared_ptr<Config> config_;
+    std::shared_ptr<Logger> logger_;
+    std::shared_ptr<CDRLogger> cdr_logger_;
+    std::shared_ptr<SessionManager> session_manager_;
+    std::shared_ptr<UDPServer> udp_server_;
+    std::shared_ptr<HTTPServer> http_server_;
+    std::thread session_thread_;
+    std::thread udp_thread_;
+    std::thread http_thread_;
+};
+
+TEST_F(HTTPServerTest, CheckSubscriberActive) {
+    session_manager_->create_session("123456789012345");
+
+    httplib::Client cli("127.0.0.1", 18080);
+    auto res = cli.Get("/check_subscriber?imsi=123456789012345");
+    ASSERT_TRUE(res != nullptr);
+    EXPECT_EQ(res->status, 200);
+    EXPECT_EQ(res->body, "active");
+}
+
+TEST_F(HTTPServerTest, CheckSubscriberNotActive) {
+    httplib::Client cli("127.0.0.1", 18080);
+    auto res = cli.Get("/check_subscriber?imsi=999999999999999");
+    ASSERT_TRUE(res != nullptr);
+    EXPECT_EQ(res->status, 200);
+    EXPECT_EQ(res->body, "not active");
+}
+
+TEST_F(HTTPServerTest, StopServer) {
+    httplib::Client cli("127.0.0.1", 18080);
+    auto res = cli.Get("/stop");
+    ASSERT_TRUE(res != nullptr);
+    EXPECT_EQ(res->status, 200);
+    EXPECT_EQ(res->body, "Stopping server...");
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(2000)); // Увеличиваем задержку
+
+    auto res_after = cli.Get("/check_subscriber?imsi=123456789012345");
+    EXPECT_TRUE(res_after == nullptr); // Сервер должен быть остановлен
+
+    // Проверяем содержимое test.log
+    std::ifstream log_file("test.log");
+    std::string log_content;
+    std::string line;
+    while (std::getline(log_file, line)) {
+        log_content += line + "\n";
+    }
+    log_file.close();
+    std::cout << "test.log content:\n" << log_content << std::endl;
+
+    // Проверяем, что сервер корректно остановился
+    log_file.open("test.log");
+    bool found_stop = false;
+    bool found_session_manager_stop = false;
+    while (std::getline(log_file, line)) {
+        if (line.find("HTTP Server stopped") != std::string::npos) {
+            found_stop = true;
+        }
+        if (line.find("SessionManager stopped") != std::string::npos) {
+            found_session_manager_stop = true;
+        }
+    }
+    EXPECT_TRUE(found_stop) << "HTTP Server stop not logged";
+    EXPECT_TRUE(found_session_manager_stop) << "SessionManager stop not logged";
+
+    // Удаляем test.log после проверки
+    std::remove("test.log");
+}
+
+TEST_F(HTTPServerTest, StopWithActiveSessions) {
+    const int num_sessions = 10;
+    std::vector<std::string> imsies(num_sessions);
+
+    // Создаём 10 сессий
+    for (int i = 0; i < num_sessions; ++i) {
+        imsies[i] = "123456789" + std::to_string(300000 + i);
+        session_manager_->create_session(imsies[i]);
+    }
+
+    httplib::Client cli("127.0.0.1", 18080);
+    auto res = cli.Get("/stop");
+    ASSERT_TRUE(res != nullptr);
+    EXPECT_EQ(res->status, 200);
+    EXPECT_EQ(res->body, "Stopping server...");
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(2000)); // Увеличиваем задержку
+
+    // Проверяем, что все сессии удалены
+    for (const auto& imsi : imsies) {
+        EXPECT_FALSE(session_manager_->has_session(imsi)) << "Session not deleted for IMSI: " << imsi;
+    }
+
+    // Проверяем, что в cdr.log есть записи deleted
+    std::ifstream cdr_file("test_cdr.log");
+    std::string line;
+    std::set<std::string> deleted_imsies;
+    while (std::getline(cdr_file, line)) {
+        for (const auto& imsi : imsies) {
+            if (line.find(imsi + ",deleted") != std::string::npos) {
+                deleted_imsies.insert(imsi);
+            }
+        }
+    }
+    EXPECT_EQ(deleted_imsies.size(), num_sessions) << "Not all IMSI have 'deleted' in cdr.log";
+}
+
+TEST_F(HTTPServerTest, AdmissionLimitsSetAtRuntime) {
+    httplib::Client cli("127.0.0.1", 18080);
+    auto res = cli.Get("/admission/set?rate=50&burst=100&max_queue=500");
+    ASSERT_TRUE(res != nullptr);
+    EXPECT_EQ(res->status, 200);
+    EXPECT_EQ(udp_server_->get_admission_control()->get_rate_per_sec(), 50);
+    EXPECT_EQ(udp_server_->get_admission_control()->get_burst(), 100);
+    EXPECT_EQ(udp_server_->get_admission_control()->get_max_queue_depth(), 500u);
+
+    res = cli.Get("/admission");
+    ASSERT_TRUE(res != nullptr);
+    EXPECT_TRUE(res->body.find("max_queue_depth=500") != std::string::npos);
+    EXPECT_TRUE(res->body.find("rate_limited=") != std::string::npos);
+
+    res = cli.Get("/admission/set?rate=abc");
+    ASSERT_TRUE(res != nullptr);
+    EXPECT_EQ(res->status, 400);
+}
+TEST_F(HTTPServerTest, DeleteSessionAndBatchDelete) {
+    session_manager_->create_session("123456789012345");
+    session_manager_->create_session("123456789012346");
+    session_manager_->create_session("123456789012347");
+
+    httplib::Client cli("127.0.0.1", 18080);
+    auto res = cli.Get("/delete_session?imsi=123456789012345");
+    ASSERT_TRUE(res != nullptr);
+    EXPECT_EQ(res->status, 200);
+    EXPECT_EQ(res->body, "deleted");
+    EXPECT_FALSE(session_manager_->has_session("123456789012345"));
+
+    res = cli.Get("/delete_session?imsi=123456789012345");
+    ASSERT_TRUE(res != nullptr);
+    EXPECT_EQ(res->status, 404);
+
+    // Пакетное удаление: отсутствующий IMSI пропускается
+    res = cli.Post("/delete_sessions", "123456789012346,123456789012347\n999999999999999", "text/plain");
+    ASSERT_TRUE(res != nullptr);
+    EXPECT_EQ(res->status, 200);
+    EXPECT_EQ(res->body, "requested=3\ndeleted=2\n");
+    EXPECT_FALSE(session_manager_->has_session("123456789012346"));
+    EXPECT_FALSE(session_manager_->has_session("123456789012347"));
+
+    res = cli.Get("/delete_sessions");
+    ASSERT_TRUE(res != nullptr);
+    EXPECT_EQ(res->status, 400);
+}
+
+TEST_F(HTTPServerTest, StreamsSessionEventsAndResumes) {
+    auto session_events = std::make_shared<SessionEventStream>(64, 2);
+    cdr_logger_->set_event_stream(session_events);
+    http_server_->set_session_events(session_events);
+
+    // Читаем поток, пока не придут события создания и удаления
+    std::string received;
+    std::thread reader([&received]() {
+        httplib::Client cli("127.0.0.1", 18080);
+        cli.Get("/session_events", [&received](const char* data, size_t len) {
+            received.append(data, len);
+            return received.find("event: deleted") == std::string::npos;
+        });
+    });
+    while (session_events->get_subscriber_count() == 0) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    session_manager_->create_session("123456789012345");
+    session_manager_->delete_session("123456789012345");
+    reader.join();
+    EXPECT_NE(received.find("id: 1\nevent: created\ndata: "), std::string::npos);
+    EXPECT_NE(received.find(",123456789012345,created\n\n"), std::string::npos);
+    EXPECT_NE(received.find("id: 2\nevent: deleted\n"), std::string::npos);
+
+    // Переподключение после первого события отдаёт второе из истории
+    std::string resumed;
+    httplib::Client cli("127.0.0.1", 18080);
+    cli.Get("/session_events?last_event_id=1", [&resumed](const char* data, size_t len) {
+        resumed.append(data, len);
+        return resumed.find("\n\n") == std::string::npos;
+    });
+    EXPECT_EQ(resumed.rfind("id: 2\nevent: deleted\n", 0), 0u);
+
+    auto res = cli.Get("/session_events?last_event_id=abc");
+    ASSERT_TRUE(res != nullptr);
+    EXPECT_EQ(res->status, 400);
+
+    res = cli.Get("/session_events/stats");
+    ASSERT_TRUE(res != nullptr);
+    EXPECT_NE(res->body.find("last_seq=2\n"), std::string::npos);
+}
+
+TEST_F(HTTPServerTest, ExportsSessionsByCursor) {
+    httplib::Client cli("127.0.0.1", 18080);
+    auto res = cli.Get("/sessions/export");
+    ASSERT_TRUE(res != nullptr);
+    EXPECT_EQ(res->status, 503);
+
+    http_server_->set_session_export(session_manager_);
+    for (int i = 0; i < 50; ++i) {
+        session_manager_->create_session(std::to_string(123456789000000LL + i));
+    }
+
+    std::set<std::string> exported;
+    std::string cursor = "0";
+    while (cursor != "end") {
+        res = cli.Get("/sessions/export?limit=10&cursor=" + cursor);
+        ASSERT_TRUE(res != nullptr);
+        ASSERT_EQ(res->status, 200);
+        std::istringstream lines(res->body);
+        std::string line;
+        while (std::getline(lines, line)) {
+            if (line.rfind("next_cursor=", 0) == 0) {
+                cursor = line.substr(12);
+            }
+            else if (line.rfind("session=", 0) == 0) {
+                exported.insert(line.substr(8, line.find(',') - 8));
+            }
+        }
+    }
+    EXPECT_EQ(exported.size(), 50u);
+    EXPECT_EQ(exported.count("123456789000007"), 1u);
+
+    res = cli.Get("/sessions/export?limit=0");
+    ASSERT_TRUE(res != nullptr);
+    EXPECT_EQ(res->status, 400);
+    res = cli.Get("/sessions/export?cursor=abc");
+    ASSERT_TRUE(res != nullptr);
+    EXPECT_EQ(res->status, 400);
+}
+
+TEST_F(HTTPServerTest, ReloadsConfigOverHttp) {
+    auto config_store = std::make_shared<ConfigStore>("test_config.json", *config_);
+    http_server_->set_config_store(config_store);
+    httplib::Client cli("127.0.0.1", 18080);
+
+    // Смена порта требует перезапуска: снимок не меняется
+    std::ofstream config_file("test_config.json");
+    config_file << R"({
+        "udp_ip": "127.0.0.1",
+        "udp_port": 19001,
+        "session_timeout_sec": 5,
+        "cdr_file": "test_cdr.log",
+        "http_port": 18080,
+        "graceful_shutdown_rate": 10,
+        "log_file": "test.log",
+        "log_level": "INFO",
+        "blacklist": []
+    })";
+    config_file.close();
+    // Перезагрузка и откат меняют состояние сервера: только POST
+    auto res = cli.Get("/config/reload");
+    ASSERT_TRUE(res != nullptr);
+    EXPECT_EQ(res->status, 405);
+    res = cli.Post("/config/reload", "", "text/plain");
+    ASSERT_TRUE(res != nullptr);
+    EXPECT_EQ(res->status, 409);
+    EXPECT_EQ(res->body, "error=Restart required to change: udp_port\nversion=1\n");
+
+    config_file.open("test_config.json");
+    config_file << R"({
+        "udp_ip": "127.0.0.1",
+        "udp_port": 19000,
+        "session_timeout_sec": 5,
+        "cdr_file": "test_cdr.log",
+        "http_port": 18080,
+        "graceful_shutdown_rate": 10,
+        "log_file": "test.log",
+        "log_level": "INFO",
+        "blacklist": []
+    })";
+    config_file.close();
+    res = cli.Post("/config/reload", "", "text/plain");
+    ASSERT_TRUE(res != nullptr);
+    EXPECT_EQ(res->status, 200);
+    EXPECT_NE(res->body.find("version=2\n"), std::string::npos);
+    EXPECT_NE(res->body.find("session_timeout_sec=5\n"), std::string::npos);
+
+    res = cli.Post("/config/rollback", "", "text/plain");
+    ASSERT_TRUE(res != nullptr);
+    EXPECT_EQ(res->status, 200);
+    EXPECT_NE(res->body.find("version=1\n"), std::string::npos);
+    EXPECT_NE(res->body.find("session_timeout_sec=2\n"), std::string::npos);
+}
+
+TEST_F(HTTPServerTest, ControlsPacketCaptureOverHttp) {
+    httplib::Client cli("127.0.0.1", 18080);
+    auto res = cli.Get("/capture");
+    ASSERT_TRUE(res != nullptr);
+    EXPECT_EQ(res->status, 503);
+
+    auto capture = std::make_shared<PacketCapture>(8, inet_addr("127.0.0.1"), htons(19000));
+    http_server_->set_packet_capture(capture);
+    res = cli.Get("/capture/start?peer=10.0.0.300");
+    ASSERT_TRUE(res != nullptr);
+    EXPECT_EQ(res->status, 400);
+    EXPECT_FALSE(capture->is_enabled());
+
+    res = cli.Get("/capture/start?peer=10.0.0.1&imsi_prefix=00101");
+    ASSERT_TRUE(res != nullptr);
+    EXPECT_EQ(res->status, 200);
+    EXPECT_NE(res->body.find("enabled=true\npeer=10.0.0.1\nimsi_prefix=00101\n"), std::string::npos) << res->body;
+
+    struct sockaddr_in peer = {};
+    peer.sin_family = AF_INET;
+    peer.sin_addr.s_addr = inet_addr("10.0.0.1");
+    peer.sin_port = htons(2123);
+    std::string imsi = "001010000000001";
+    ASSERT_TRUE(capture->record_request("request", 7, peer, 0, &imsi));
+    capture->record_reply("created", 7, peer);
+
+    res = cli.Get("/capture/stop");
+    ASSERT_TRUE(res != nullptr);
+    EXPECT_NE(res->body.find("enabled=false\n"), std::string::npos);
+
+    res = cli.Get("/capture/pcap");
+    ASSERT_TRUE(res != nullptr);
+    EXPECT_EQ(res->status, 200);
+    EXPECT_EQ(res->get_header_value("Content-Type"), "application/vnd.tcpdump.pcap");
+    // Глобальный заголовок и две записи по 16 + 28 + 7 байт
+    EXPECT_EQ(res->body.size(), 24u + 2 * (16 + 28 + 7));
+    EXPECT_EQ(res->body.substr(res->body.size() - 7), "created");
+}
+
+TEST_F(HTTPServerTest, ReportsLockStatistics) {
+    httplib::Client cli("127.0.0.1", 18080);
+    EXPECT_EQ(session_manager_->get_session_count(), 0u);
+    auto res = cli.Get("/locks");
+    ASSERT_TRUE(res != nullptr);
+    if (!LockRegistry::enabled()) {
+        EXPECT_EQ(res->status, 503);
+        return;
+    }
+    EXPECT_EQ(res->status, 200);
+    EXPECT_NE(res->body.find("session_manager_acquisitions="), std::string::npos) << res->body;
+    EXPECT_NE(res->body.find("udp_server_queue_contended="), std::string::npos);
+    EXPECT_NE(res->body.find("cdr_logger_hold_p99_us="), std::string::npos);
+}
@@ -0,0 +1,137 @@
+#include <gtest/gtest.h>
+#include "ip_pool.hpp"
+#include <algorithm>
+#include <set>
+#include <thread>
+#include <vector>
+
+TEST(IPPoolTest, IPv4PoolSkipsNetworkAndBroadcast) {
+    IPPool pool("10.45.0.0/28", 1);
+    EXPECT_FALSE(pool.is_ipv6());
+    EXPECT_EQ(pool.get_size(), 14u);
+
+    std::set<std::string> addresses;
+    IPAddress address;
+    while (pool.allocate(address)) {
+        addresses.insert(address.to_string());
+    }
+    EXPECT_EQ(addresses.size(), 14u);
+    EXPECT_EQ(addresses.count("10.45.0.0"), 0u);
+    EXPECT_EQ(addresses.count("10.45.0.15"), 0u);
+    EXPECT_EQ(addresses.count("10.45.0.1"), 1u);
+    EXPECT_EQ(pool.in_use(), 14u);
+
+    // Освобождённый адрес выдаётся снова
+    IPPool reference("10.45.0.0/28", 1);
+    ASSERT_TRUE(reference.allocate(address));
+    EXPECT_TRUE(pool.release(address));
+    IPAddress again;
+    ASSERT_TRUE(pool.allocate(again));
+    EXPECT_EQ(again.to_string(), address.to_string());
+}
+
+TEST(IPPoolTest, IPv6PoolAllocatesSlash64Prefixes) {
+    IPPool pool("2001:db8:1::/62", 1);
+    EXPECT_TRUE(pool.is_ipv6());
+    EXPECT_EQ(pool.get_size(), 4u);
+
+    std::set<std::string> prefixes;
+    IPAddress address;
+    while (pool.allocate(address)) {
+        EXPECT_TRUE(address.ipv6);
+        prefixes.insert(address.to_string());
+    }
+    EXPECT_EQ(prefixes.size(), 4u);
+    EXPECT_EQ(prefixes.count("2001:db8:1:3::/64"), 1u);
+
+    // Адрес внутри префикса относится к пулу
+    address.bytes[15] = 1;
+    EXPECT_TRUE(pool.contains(address));
+}
+
+TEST(IPPoolTest, RejectsInvalidPools) {
+    EXPECT_THROW(IPPool("10.45.0.0"), std::runtime_error);
+    EXPECT_THROW(IPPool("10.45.0.0/31"), std::runtime_error);
+    EXPECT_THROW(IPPool("10.45.0.0/4"), std::runtime_error);
+    EXPECT_THROW(IPPool("2001:db8::/32"), std::runtime_error);
+    EXPECT_THROW(IPPool("not.an.ip/16"), std::runtime_error);
+}
+
+TEST(IPPoolTest, PoolSetFallsBackToNextPool) {
+    IPPoolSet pools({ "2001:db8::/63", "10.0.0.0/30", "10.1.0.0/30" }, 1);
+    EXPECT_TRUE(pools.has_ipv4());
+    EXPECT_TRUE(pools.has_ipv6());
+
+    std::vector<IPAddress> addresses(4);
+    for (auto& address : addresses) {
+        ASSERT_TRUE(pools.allocate(false, address));
+    }
+    // Два адреса из первого пула /30, затем два из второго
+    EXPECT_EQ(addresses[2].to_string().rfind("10.1.0.", 0), 0u);
+    IPAddress extra;
+    EXPECT_FALSE(pools.allocate(false, extra));
+
+    EXPECT_TRUE(pools.release(addresses[0]));
+    EXPECT_TRUE(pools.allocate(false, extra));
+    EXPECT_TRUE(pools.allocate(true, extra));
+
+    IPAddress foreign;
+    foreign.bytes = { 192, 168, 0, 1 };
+    EXPECT_FALSE(pools.release(foreign));
+}
+
+TEST(IPPoolTest, ConcurrentAllocateRelease) {
+    IPPool pool("10.64.0.0/20");
+    const int num_threads = 8;
+    std::vector<std::vector<std::string>> held(num_threads);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < num_threads; ++t) {
+        threads.emplace_back([&, t]() {
+            std::vector<IPAddress> batch(100);
+            for (int round = 0; round < 1000; ++round) {
+                for (auto& address : batch) {
+                    ASSERT_TRUE(pool.allocate(address));
+                }
+                if (round + 1 < 1000) {
+                    for (const auto& address : batch) {
+                        pool.release(address);
+                    }
+                }
+            }
+            for (const auto& address : batch) {
+                held[t].push_back(address.to_string());
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    std::vector<std::string> all;
+    for (const auto& addresses : held) {
+        all.insert(all.end(), addresses.begin(), addresses.end());
+    }
+    std::sort(all.begin(), all.end());
+    EXPECT_TRUE(std::adjacent_find(all.begin(), all.end()) == all.end()) << "address held by two threads";
+    EXPECT_EQ(pool.in_use(), all.size());
+}
+
+TEST(IPPoolTest, ReserveMarksAddressInUse) {
+    IPPoolSet pools({ "10.0.0.0/29" }, 1);
+    IPAddress address;
+    address.bytes = { 10, 0, 0, 2 };
+    EXPECT_TRUE(pools.reserve(address));
+    EXPECT_FALSE(pools.reserve(address));
+
+    std::set<std::string> handed_out;
+    IPAddress next;
+    while (pools.allocate(false, next)) {
+        handed_out.insert(next.to_string());
+    }
+    EXPECT_EQ(handed_out.size(), 5u);
+    EXPECT_EQ(handed_out.count("10.0.0.2"), 0u);
+
+    IPAddress foreign;
+    foreign.bytes = { 192, 168, 0, 1 };
+    EXPECT_FALSE(pools.reserve(foreign));
+}
@@ -0,0 +1,94 @@
+#include <gtest/gtest.h>
+#include "latency_stats.hpp"
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace std::chrono_literals;
+
+namespace {
+
+// Значение параметра из отчёта key=value
+double value(const std::string& report, const std::string& key) {
+    std::string lines = "\n" + report;
+    size_t position = lines.find("\n" + key + "=");
+    return position == std::string::npos ? -1 : std::stod(lines.substr(position + key.size() + 2));
+}
+
+} // namespace
+
+TEST(LatencyStatsTest, HistogramPercentilesUseBucketBounds) {
+    LatencyHistogram histogram;
+    EXPECT_EQ(histogram.percentile_us(0.5), 0);
+    for (int i = 0; i < 90; ++i) {
+        histogram.record(3us);
+    }
+    for (int i = 0; i < 9; ++i) {
+        histogram.record(150us);
+    }
+    histogram.record(3s);
+
+    EXPECT_EQ(histogram.get_count(), 100u);
+    EXPECT_EQ(histogram.percentile_us(0.50), 5);
+    EXPECT_EQ(histogram.percentile_us(0.90), 5);
+    EXPECT_EQ(histogram.percentile_us(0.99), 200);
+    // Выше последней границы оценка — максимум
+    EXPECT_EQ(histogram.percentile_us(0.999), 3000000);
+
+    std::string report = histogram.report("stage");
+    EXPECT_EQ(value(report, "stage_count"), 100);
+    EXPECT_EQ(value(report, "stage_max_us"), 3000000);
+    EXPECT_EQ(value(report, "stage_le_2us"), 0);
+    EXPECT_EQ(value(report, "stage_le_5us"), 90);
+    EXPECT_EQ(value(report, "stage_le_200us"), 99);
+    EXPECT_EQ(value(report, "stage_le_1000000us"), 99);
+}
+
+TEST(LatencyStatsTest, BoundaryAndNegativeValues) {
+    LatencyHistogram histogram;
+    histogram.record(10us);                    // Ровно на границе — в корзину этой границы
+    histogram.record(std::chrono::nanoseconds(-500));   // Сдвиг часов назад считается нулём
+    std::string report = histogram.report("x");
+    EXPECT_EQ(value(report, "x_le_1us"), 1);
+    EXPECT_EQ(value(report, "x_le_10us"), 2);
+    EXPECT_EQ(value(report, "x_le_5us"), 1);
+}
+
+TEST(LatencyStatsTest, ConcurrentRecordingKeepsCounts) {
+    LatencyHistogram histogram;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&histogram, t]() {
+            for (int i = 0; i < 10000; ++i) {
+                histogram.record(std::chrono::microseconds(t * 100 + i % 7));
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    std::string report = histogram.report("x");
+    EXPECT_EQ(value(report, "x_count"), 40000);
+    EXPECT_EQ(value(report, "x_le_1000000us"), 40000);
+    EXPECT_EQ(value(report, "x_max_us"), 306);
+}
+
+TEST(LatencyStatsTest, ReportCoversAllStagesAndDrops) {
+    LatencyStats stats;
+    stats.record_socket_wait(20us);
+    stats.record_queue_wait(40us);
+    stats.record_socket_to_reply(90us);
+    stats.record_untimestamped();
+    stats.update_socket_drops(7);
+    stats.update_socket_drops(12);
+
+    std::string report = stats.report();
+    EXPECT_EQ(value(report, "socket_drops"), 12);
+    EXPECT_EQ(value(report, "untimestamped"), 1);
+    // Одна задержка в этапе: оценка — граница корзины, ограниченная максимумом
+    EXPECT_EQ(value(report, "socket_wait_p50_us"), 20);
+    EXPECT_EQ(value(report, "queue_wait_p50_us"), 40);
+    EXPECT_EQ(value(report, "socket_to_reply_p50_us"), 90);
+    EXPECT_EQ(value(report, "socket_to_reply_le_100us"), 1);
+}
@@ -0,0 +1,120 @@
+#include <gtest/gtest.h>
+#include "lock_profiler.hpp"
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <type_traits>
+
+using namespace std::chrono_literals;
+
+namespace {
+
+// Значение параметра из отчёта key=value
+double value(const std::string& report, const std::string& key) {
+    std::string lines = "\n" + report;
+    size_t position = lines.find("\n" + key + "=");
+    return position == std::string::npos ? -1 : std::stod(lines.substr(position + key.size() + 2));
+}
+
+} // namespace
+
+TEST(LockProfilerTest, RegistryKeepsOneStatsPerName) {
+    auto& registry = LockRegistry::instance();
+    LockStats& first = registry.get("test_registry");
+    EXPECT_EQ(&registry.get("test_registry"), &first);
+    EXPECT_NE(&registry.get("test_registry_other"), &first);
+    EXPECT_NE(registry.report().find("test_registry_acquisitions=0\n"), std::string::npos);
+}
+
+#ifdef PGW_LOCK_PROFILING
+
+TEST(LockProfilerTest, CountsUncontendedAcquisitionsAndHoldTime) {
+    ProfiledMutex mutex("test_uncontended");
+    for (int i = 0; i < 9; ++i) {
+        std::lock_guard<ProfiledMutex> lock(mutex);
+    }
+    {
+        std::lock_guard<ProfiledMutex> lock(mutex);
+        std::this_thread::sleep_for(2ms);
+    }
+    ASSERT_TRUE(mutex.try_lock());
+    mutex.unlock();
+
+    const LockStats& stats = LockRegistry::instance().get("test_uncontended");
+    EXPECT_EQ(stats.get_acquisitions(), 11u);
+    EXPECT_EQ(stats.get_contended(), 0u);
+    EXPECT_EQ(stats.get_wait_time().get_count(), 0u);
+    EXPECT_EQ(stats.get_hold_time().get_count(), 11u);
+
+    std::string report = stats.report();
+    EXPECT_EQ(value(report, "test_uncontended_acquisitions"), 11);
+    EXPECT_EQ(value(report, "test_uncontended_contended_ratio"), 0);
+    EXPECT_GE(value(report, "test_uncontended_hold_max_us"), 1900);
+    EXPECT_EQ(value(report, "test_uncontended_wait_count"), 0);
+}
+
+TEST(LockProfilerTest, RecordsWaitWhenLockIsHeld) {
+    ProfiledMutex mutex("test_contended");
+    std::atomic<bool> held{ false };
+    std::thread holder([&]() {
+        std::lock_guard<ProfiledMutex> lock(mutex);
+        held = true;
+        std::this_thread::sleep_for(20ms);
+    });
+    while (!held) {
+        std::this_thread::yield();
+    }
+    EXPECT_FALSE(mutex.try_lock());
+    {
+        std::lock_guard<ProfiledMutex> lock(mutex);
+    }
+    holder.join();
+
+    const LockStats& stats = LockRegistry::instance().get("test_contended");
+    EXPECT_EQ(stats.get_acquisitions(), 2u);
+    EXPECT_EQ(stats.get_contended(), 1u);
+    std::string report = stats.report();
+    EXPECT_EQ(value(report, "test_contended_contended_ratio"), 0.5);
+    EXPECT_EQ(value(report, "test_contended_wait_count"), 1);
+    EXPECT_GE(value(report, "test_contended_wait_max_us"), 10000);
+    EXPECT_GE(value(report, "test_contended_hold_max_us"), 10000);
+}
+
+TEST(LockProfilerTest, ConditionVariableWaitReleasesProfiledLock) {
+    ProfiledMutex mutex("test_condition");
+    ProfiledConditionVariable cond;
+    bool ready = false;
+    std::thread waiter([&]() {
+        ProfiledLock lock(mutex);
+        cond.wait(lock, [&]() { return ready; });
+    });
+    std::this_thread::sleep_for(10ms);
+    {
+        std::lock_guard<ProfiledMutex> lock(mutex);
+        ready = true;
+    }
+    cond.notify_one();
+    waiter.join();
+
+    // Захват ожидающим, повторный захват после пробуждения и захват уведомителем
+    const LockStats& stats = LockRegistry::instance().get("test_condition");
+    EXPECT_GE(stats.get_acquisitions(), 3u);
+    EXPECT_EQ(stats.get_hold_time().get_count(), stats.get_acquisitions());
+    EXPECT_TRUE(LockRegistry::enabled());
+}
+
+#else
+
+TEST(LockProfilerTest, CompilesToPlainMutex) {
+    static_assert(std::is_base_of<std::mutex, ProfiledMutex>::value, "ProfiledMutex must be std::mutex");
+    static_assert(std::is_same<ProfiledConditionVariable, std::condition_variable>::value,
+        "ProfiledConditionVariable must be std::condition_variable");
+    EXPECT_FALSE(LockRegistry::enabled());
+    ProfiledMutex mutex("test_plain");
+    std::lock_guard<ProfiledMutex> lock(mutex);
+    EXPECT_EQ(LockRegistry::instance().get("test_plain").get_acquisitions(), 0u);
+}
+
+#endif
@@ -0,0 +1,186 @@
+#include <gtest/gtest.h>
+#include "packet_capture.hpp"
+#include <atomic>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+#include <arpa/inet.h>
+
+namespace {
+
+struct sockaddr_in make_peer(const char* ip, uint16_t port) {
+    struct sockaddr_in peer = {};
+    peer.sin_family = AF_INET;
+    peer.sin_addr.s_addr = inet_addr(ip);
+    peer.sin_port = htons(port);
+    return peer;
+}
+
+template <typename T>
+T read_at(const std::string& data, size_t offset) {
+    T value;
+    std::memcpy(&value, data.data() + offset, sizeof(value));
+    return value;
+}
+
+} // namespace
+
+TEST(PacketCaptureTest, DisabledCaptureRecordsNothing) {
+    PacketCapture capture(16, inet_addr("127.0.0.1"), htons(9000));
+    EXPECT_FALSE(capture.is_enabled());
+    // Поток приёма не вызывает record_request при выключенном захвате; ответы отсекает сам record_reply
+    capture.record_reply("created", 7, make_peer("10.0.0.1", 2123));
+    EXPECT_TRUE(capture.snapshot().empty());
+    EXPECT_NE(capture.report().find("enabled=false\n"), std::string::npos);
+    EXPECT_NE(capture.report().find("captured=0\n"), std::string::npos);
+}
+
+TEST(PacketCaptureTest, FiltersByPeerAndImsiPrefix) {
+    PacketCapture capture(16, inet_addr("127.0.0.1"), htons(9000));
+    auto wanted = make_peer("10.0.0.1", 2123);
+    auto other_port = make_peer("10.0.0.1", 2124);
+    auto other_host = make_peer("10.0.0.2", 2123);
+    std::string imsi = "001010000000001";
+    std::string other_imsi = "250990000000001";
+
+    capture.start("10.0.0.1:2123", "00101");
+    EXPECT_TRUE(capture.is_enabled());
+    // До разбора IMSI неизвестен: при фильтре по IMSI запрос ждёт декодирования
+    EXPECT_FALSE(capture.record_request("a", 1, wanted, 0, nullptr));
+    EXPECT_TRUE(capture.record_request("a", 1, wanted, 0, &imsi));
+    EXPECT_FALSE(capture.record_request("b", 1, wanted, 0, &other_imsi));
+    EXPECT_FALSE(capture.record_request("c", 1, other_port, 0, &imsi));
+    EXPECT_FALSE(capture.record_request("d", 1, other_host, 0, &imsi));
+    EXPECT_NE(capture.report().find("peer=10.0.0.1:2123\nimsi_prefix=00101\n"), std::string::npos) << capture.report();
+
+    // Без порта подходит любой порт пира; без префикса — любой IMSI, в том числе до разбора
+    capture.start("10.0.0.1", "");
+    EXPECT_TRUE(capture.record_request("e", 1, other_port, 0, nullptr));
+    EXPECT_FALSE(capture.record_request("f", 1, other_host, 0, nullptr));
+    auto packets = capture.snapshot();
+    ASSERT_EQ(packets.size(), 1u);
+    EXPECT_EQ(packets[0].data, "e");
+
+    EXPECT_THROW(capture.start("10.0.0.300", ""), std::invalid_argument);
+    EXPECT_THROW(capture.start("10.0.0.1:70000", ""), std::invalid_argument);
+    EXPECT_THROW(capture.start("", "0010x"), std::invalid_argument);
+    EXPECT_THROW(capture.start("", "0010100000000012"), std::invalid_argument);
+
+    capture.stop();
+    EXPECT_FALSE(capture.is_enabled());
+    EXPECT_EQ(capture.snapshot().size(), 1u);
+}
+
+TEST(PacketCaptureTest, RingKeepsNewestAndTruncatesToSnaplen) {
+    PacketCapture capture(4, inet_addr("127.0.0.1"), htons(9000));
+    capture.start("", "");
+    auto peer = make_peer("10.0.0.1", 2123);
+    for (int i = 0; i < 10; ++i) {
+        std::string payload = std::to_string(i);
+        capture.record_request(payload.data(), payload.size(), peer, 1000 + i, nullptr);
+    }
+    std::string large(PacketCapture::SNAPLEN + 100, 'x');
+    capture.record_reply(large.data(), large.size(), peer);
+
+    auto packets = capture.snapshot();
+    ASSERT_EQ(packets.size(), 4u);
+    EXPECT_EQ(packets[0].data, "7");
+    EXPECT_EQ(packets[0].timestamp_ns, 1007);
+    EXPECT_EQ(packets[2].data, "9");
+    EXPECT_EQ(packets[3].direction, CaptureDirection::Reply);
+    EXPECT_EQ(packets[3].length, large.size());
+    EXPECT_EQ(packets[3].data.size(), PacketCapture::SNAPLEN);
+    EXPECT_NE(capture.report().find("captured=11\nin_ring=4\n"), std::string::npos) << capture.report();
+}
+
+TEST(PacketCaptureTest, FormatsPcapWithIpv4AndUdpHeaders) {
+    CapturedPacket request;
+    request.timestamp_ns = 1700000000123456789LL;
+    request.direction = CaptureDirection::Request;
+    request.peer_addr = inet_addr("10.0.0.1");
+    request.peer_port = htons(2123);
+    request.length = 4;
+    request.data = std::string("\x48\x20\x00\x00", 4);
+    CapturedPacket reply = request;
+    reply.direction = CaptureDirection::Reply;
+    reply.length = 600;
+    reply.data = std::string(PacketCapture::SNAPLEN, 'r');
+
+    std::string pcap = PacketCapture::format_pcap({ request, reply }, inet_addr("192.168.1.5"), htons(9000));
+    ASSERT_EQ(pcap.size(), 24 + (16 + 28 + 4) + (16 + 28 + PacketCapture::SNAPLEN));
+    EXPECT_EQ(read_at<uint32_t>(pcap, 0), 0xa1b23c4du);
+    EXPECT_EQ(read_at<uint32_t>(pcap, 20), 228u);
+
+    // Запись запроса: метка, длины, IPv4 от пира к PGW, UDP 2123 -> 9000
+    EXPECT_EQ(read_at<uint32_t>(pcap, 24), 1700000000u);
+    EXPECT_EQ(read_at<uint32_t>(pcap, 28), 123456789u);
+    EXPECT_EQ(read_at<uint32_t>(pcap, 32), 32u);
+    EXPECT_EQ(read_at<uint32_t>(pcap, 36), 32u);
+    size_t ip = 40;
+    EXPECT_EQ(static_cast<uint8_t>(pcap[ip]), 0x45);
+    EXPECT_EQ(ntohs(read_at<uint16_t>(pcap, ip + 2)), 32);
+    EXPECT_EQ(static_cast<uint8_t>(pcap[ip + 9]), IPPROTO_UDP);
+    EXPECT_EQ(read_at<uint32_t>(pcap, ip + 12), inet_addr("10.0.0.1"));
+    EXPECT_EQ(read_at<uint32_t>(pcap, ip + 16), inet_addr("192.168.1.5"));
+    // Сумма заголовка с верной контрольной суммой даёт 0xFFFF
+    uint32_t sum = 0;
+    for (size_t i = 0; i < 20; i += 2) {
+        sum += ntohs(read_at<uint16_t>(pcap, ip + i));
+    }
+    sum = (sum & 0xFFFF) + (sum >> 16);
+    EXPECT_EQ(sum, 0xFFFFu);
+    EXPECT_EQ(ntohs(read_at<uint16_t>(pcap, ip + 20)), 2123);
+    EXPECT_EQ(ntohs(read_at<uint16_t>(pcap, ip + 22)), 9000);
+    EXPECT_EQ(ntohs(read_at<uint16_t>(pcap, ip + 24)), 12);
+    EXPECT_EQ(pcap.substr(ip + 28, 4), request.data);
+
+    // Ответ идёт обратно, усечённая длина меньше исходной
+    size_t record = ip + 32;
+    EXPECT_EQ(read_at<uint32_t>(pcap, record + 8), 28 + PacketCapture::SNAPLEN);
+    EXPECT_EQ(read_at<uint32_t>(pcap, record + 12), 628u);
+    EXPECT_EQ(read_at<uint32_t>(pcap, record + 16 + 12), inet_addr("192.168.1.5"));
+    EXPECT_EQ(ntohs(read_at<uint16_t>(pcap, record + 16 + 22)), 2123);
+}
+
+TEST(PacketCaptureTest, ConcurrentWritersLeaveOnlyWholeSlots) {
+    PacketCapture capture(64, inet_addr("127.0.0.1"), htons(9000));
+    capture.start("", "");
+    std::atomic<int> finished{ 0 };
+    std::vector<std::thread> writers;
+    for (int w = 0; w < 4; ++w) {
+        writers.emplace_back([&capture, &finished, w]() {
+            auto peer = make_peer("10.0.0.1", static_cast<uint16_t>(3000 + w));
+            // Полезная нагрузка повторяет номер писателя: смесь двух записей в слоте видна по байтам
+            std::string payload(100 + w, static_cast<char>('a' + w));
+            for (int i = 0; i < 20000; ++i) {
+                capture.record_request(payload.data(), payload.size(), peer, 0, nullptr);
+            }
+            ++finished;
+        });
+    }
+    size_t checked = 0;
+    auto check = [&checked](const std::vector<CapturedPacket>& packets) {
+        for (const auto& packet : packets) {
+            int writer = ntohs(packet.peer_port) - 3000;
+            if (writer < 0 || writer >= 4) {
+                ADD_FAILURE() << "unexpected peer port " << ntohs(packet.peer_port);
+                continue;
+            }
+            EXPECT_EQ(packet.data, std::string(100 + writer, static_cast<char>('a' + writer)));
+            ++checked;
+        }
+    };
+    while (finished < 4) {
+        check(capture.snapshot());
+        std::this_thread::yield();
+    }
+    for (auto& writer : writers) {
+        writer.join();
+    }
+    check(capture.snapshot());
+    EXPECT_GE(checked, 64u);
+    EXPECT_EQ(capture.snapshot().size(), 64u);
+    EXPECT_NE(capture.report().find("captured=80000\n"), std::string::npos);
+}
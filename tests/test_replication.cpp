@@ -0,0 +1,191 @@
+#include <gtest/gtest.h>
+#include <logger.hpp>
+#include "replication.hpp"
+#include "session_manager.hpp"
+#include "cdr_logger.hpp"
+#include "config.hpp"
+#include <chrono>
+#include <fstream>
+#include <functional>
+#include <set>
+#include <string>
+#include <thread>
+
+// Основной и резервный узлы в одном процессе, поток репликации через петлевой интерфейс
+class ReplicationTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        std::ofstream config_file("test_replication.json");
+        config_file << R"({
+            "udp_ip": "127.0.0.1",
+            "udp_port": 19000,
+            "session_timeout_sec": 1,
+            "cdr_file": "test_replication_cdr.log",
+            "http_port": 18080,
+            "graceful_shutdown_rate": 0,
+            "log_file": "test.log",
+            "log_level": "INFO",
+            "blacklist": [],
+            "teid_pool_size": 64,
+            "ip_pools": ["10.45.0.0/24"],
+            "replication_address": "127.0.0.1:19400",
+            "replication_batch_ms": 5,
+            "replication_checksum_sec": 1,
+            "replication_takeover_ms": 300
+        })";
+        config_file.close();
+
+        Logger::init("test.log", "INFO");
+        logger_ = Logger::get();
+        config_ = std::make_shared<Config>("test_replication.json");
+        cdr_logger_ = std::make_shared<CDRLogger>(*config_, logger_);
+        active_ = std::make_shared<SessionManager>(*config_, cdr_logger_);
+        sender_ = std::make_shared<ReplicationSender>(*config_, *active_, logger_);
+        active_->set_listener(sender_);
+        sender_->run();
+        receiver_ = std::make_shared<ReplicationReceiver>(*config_, logger_);
+    }
+
+    void TearDown() override {
+        receiver_->stop();
+        sender_->stop();
+        active_->stop();
+        receiver_.reset();
+        active_.reset();
+        sender_.reset();
+        cdr_logger_.reset();
+        config_.reset();
+        std::remove("test_replication.json");
+        std::remove("test_replication_cdr.log");
+        std::remove("test.log");
+    }
+
+    // Значение параметра из отчёта key=value
+    static long long value(const std::string& report, const std::string& key) {
+        size_t position = report.find(key + "=");
+        return position == std::string::npos ? -1 : std::stoll(report.substr(position + key.size() + 1));
+    }
+
+    // Ждёт выполнения условия не дольше timeout
+    static bool eventually(const std::function<bool()>& condition, std::chrono::milliseconds timeout = std::chrono::seconds(5)) {
+        auto deadline = std::chrono::steady_clock::now() + timeout;
+        while (std::chrono::steady_clock::now() < deadline) {
+            if (condition()) {
+                return true;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        return condition();
+    }
+
+    std::shared_ptr<Logger> logger_;
+    std::shared_ptr<Config> config_;
+    std::shared_ptr<CDRLogger> cdr_logger_;
+    std::shared_ptr<SessionManager> active_;
+    std::shared_ptr<ReplicationSender> sender_;
+    std::shared_ptr<ReplicationReceiver> receiver_;
+};
+
+TEST_F(ReplicationTest, StreamsDeltasAndRestoresOnTakeover) {
+    receiver_->run();
+    ASSERT_TRUE(eventually([this] { return value(receiver_->report(), "snapshots") == 1; }));
+
+    SessionResources kept;
+    ASSERT_TRUE(active_->create_session("250010000000001", &kept));
+    ASSERT_TRUE(active_->create_session("250010000000002"));
+    ASSERT_TRUE(active_->create_session("250010000000003"));
+    ASSERT_TRUE(active_->delete_session("250010000000002"));
+    ASSERT_TRUE(eventually([this] { return value(receiver_->report(), "sessions") == 2; }));
+    EXPECT_TRUE(eventually([this] { return value(sender_->report(), "lag_frames") == 0; }));
+    EXPECT_EQ(value(sender_->report(), "deltas_sent"), 4);
+
+    EXPECT_FALSE(receiver_->takeover_ready());
+    EXPECT_TRUE(receiver_->request_takeover());
+    EXPECT_TRUE(receiver_->takeover_ready());
+    std::vector<SessionRecord> records = receiver_->take_over();
+    ASSERT_EQ(records.size(), 2u);
+    EXPECT_EQ(value(receiver_->report(), "sessions"), 0);
+
+    // Новый основной узел продолжает с теми же ресурсами и не выдаёт их повторно
+    SessionManager promoted(*config_, cdr_logger_);
+    EXPECT_EQ(promoted.restore_sessions(records), 2u);
+    EXPECT_TRUE(promoted.has_session("250010000000001"));
+    EXPECT_TRUE(promoted.has_session("250010000000003"));
+    EXPECT_FALSE(promoted.has_session("250010000000002"));
+
+    std::set<uint32_t> teids;
+    for (const auto& record : records) {
+        teids.insert(record.resources.teid);
+        if (record.imsi == "250010000000001") {
+            EXPECT_EQ(record.resources.teid, kept.teid);
+            EXPECT_EQ(record.resources.ipv4, kept.ipv4);
+        }
+    }
+    SessionResources fresh;
+    ASSERT_TRUE(promoted.create_session("250010000000004", &fresh));
+    EXPECT_EQ(teids.count(fresh.teid), 0u);
+    EXPECT_NE(fresh.ipv4, kept.ipv4);
+    promoted.stop();
+}
+
+TEST_F(ReplicationTest, LateStandbyGetsSnapshotAndChecksum) {
+    for (int i = 0; i < 50; ++i) {
+        ASSERT_TRUE(active_->create_session(std::to_string(250010000000100LL + i)));
+    }
+    receiver_->run();
+    ASSERT_TRUE(eventually([this] { return value(receiver_->report(), "sessions") == 50; }));
+    // Контрольная сумма идёт сразу за копией и затем раз в replication_checksum_sec
+    ASSERT_TRUE(eventually([this] { return value(receiver_->report(), "checksum_checks") >= 2; }));
+    EXPECT_EQ(value(receiver_->report(), "checksum_mismatches"), 0);
+    EXPECT_EQ(value(receiver_->report(), "synchronized"), 1);
+    EXPECT_EQ(value(sender_->report(), "snapshots_sent"), 1);
+}
+
+TEST_F(ReplicationTest, ExpiryIsReplicated) {
+    receiver_->run();
+    ASSERT_TRUE(active_->create_session("250010000000201"));
+    ASSERT_TRUE(eventually([this] { return value(receiver_->report(), "sessions") == 1; }));
+    active_->run();
+    EXPECT_TRUE(eventually([this] { return value(receiver_->report(), "sessions") == 0; }));
+}
+
+TEST_F(ReplicationTest, TakesOverAfterActiveIsLost) {
+    receiver_->run();
+    ASSERT_TRUE(eventually([this] { return value(receiver_->report(), "connected") == 1; }));
+    ASSERT_TRUE(active_->create_session("250010000000301"));
+    ASSERT_TRUE(eventually([this] { return value(receiver_->report(), "sessions") == 1; }));
+
+    // Пустые пачки раз в 100 мс держат резерв в курсе при простое
+    std::this_thread::sleep_for(std::chrono::milliseconds(500));
+    EXPECT_FALSE(receiver_->takeover_ready());
+
+    // Последний кадр пришёл не раньше чем за 100 мс до остановки, переключение — через 300 мс после него
+    auto lost = std::chrono::steady_clock::now();
+    sender_->stop();
+    ASSERT_TRUE(eventually([this] { return receiver_->takeover_ready(); }, std::chrono::seconds(2)));
+    EXPECT_GE(std::chrono::steady_clock::now() - lost, std::chrono::milliseconds(200));
+    EXPECT_EQ(receiver_->take_over().size(), 1u);
+}
+
+TEST(ReplicationStandbyTest, WaitsForActiveBeforeAutomaticTakeover) {
+    std::ofstream config_file("test_standby.json");
+    config_file << R"({
+        "log_file": "test.log",
+        "replication_role": "standby",
+        "replication_address": "127.0.0.1:19401",
+        "replication_takeover_ms": 50
+    })";
+    config_file.close();
+    Logger::init("test.log", "INFO");
+    Config config("test_standby.json");
+    EXPECT_EQ(config.get_replication_role(), "standby");
+
+    ReplicationReceiver receiver(config, Logger::get());
+    receiver.run();
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    EXPECT_FALSE(receiver.takeover_ready());
+    EXPECT_NE(receiver.report().find("connected=0"), std::string::npos);
+    receiver.stop();
+    std::remove("test_standby.json");
+    std::remove("test.log");
+}
@@ -0,0 +1,77 @@
+#include <gtest/gtest.h>
+#include "response_cache.hpp"
+#include <arpa/inet.h>
+#include <thread>
+
+// Формирует адрес пира для тестов
+static struct sockaddr_in make_peer(const char* ip, int port) {
+    struct sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = inet_addr(ip);
+    addr.sin_port = htons(port);
+    return addr;
+}
+
+TEST(ResponseCacheTest, ReplaysCompletedResponse) {
+    ResponseCache cache(std::chrono::milliseconds(1000), 16);
+    auto peer = make_peer("127.0.0.1", 40000);
+    std::string response;
+
+    EXPECT_EQ(cache.lookup(peer, "req-1", response), ResponseCache::Lookup::Miss);
+    EXPECT_EQ(cache.lookup(peer, "req-1", response), ResponseCache::Lookup::Pending);
+    cache.complete(peer, "req-1", "created");
+    EXPECT_EQ(cache.lookup(peer, "req-1", response), ResponseCache::Lookup::Hit);
+    EXPECT_EQ(response, "created");
+    EXPECT_EQ(cache.get_replayed(), 1u);
+    EXPECT_EQ(cache.get_suppressed(), 1u);
+}
+
+TEST(ResponseCacheTest, KeyedByPeer) {
+    ResponseCache cache(std::chrono::milliseconds(1000), 16);
+    std::string response;
+    EXPECT_EQ(cache.lookup(make_peer("127.0.0.1", 40000), "req-1", response), ResponseCache::Lookup::Miss);
+    EXPECT_EQ(cache.lookup(make_peer("127.0.0.1", 40001), "req-1", response), ResponseCache::Lookup::Miss);
+    EXPECT_EQ(cache.lookup(make_peer("127.0.0.2", 40000), "req-1", response), ResponseCache::Lookup::Miss);
+}
+
+TEST(ResponseCacheTest, ExpiresAndBounded) {
+    ResponseCache cache(std::chrono::milliseconds(50), 4);
+    auto peer = make_peer("127.0.0.1", 40000);
+    std::string response;
+
+    cache.lookup(peer, "req-1", response);
+    cache.complete(peer, "req-1", "created");
+    std::this_thread::sleep_for(std::chrono::milliseconds(80));
+    EXPECT_EQ(cache.lookup(peer, "req-1", response), ResponseCache::Lookup::Miss);
+
+    for (int i = 0; i < 10; ++i) {
+        cache.lookup(peer, "req-" + std::to_string(i + 2), response);
+    }
+    EXPECT_LE(cache.size(), 4u);
+}
+
+TEST(ResponseCacheTest, ForgetReleasesQueuePosition) {
+    ResponseCache cache(std::chrono::milliseconds(10000), 4);
+    auto peer = make_peer("127.0.0.1", 40000);
+    std::string response;
+
+    cache.lookup(peer, "req-kept", response);
+    cache.complete(peer, "req-kept", "created");
+    // Шторм перегрузки: каждый запрос забывается сразу после регистрации
+    for (int i = 0; i < 1000; ++i) {
+        std::string id = "req-" + std::to_string(i);
+        EXPECT_EQ(cache.lookup(peer, id, response), ResponseCache::Lookup::Miss);
+        cache.forget(peer, id);
+    }
+    EXPECT_EQ(cache.size(), 1u);
+    EXPECT_EQ(cache.lookup(peer, "req-kept", response), ResponseCache::Lookup::Hit);
+    EXPECT_EQ(response, "created");
+}
+
+TEST(ResponseCacheTest, DisabledWithZeroTtl) {
+    ResponseCache cache(std::chrono::milliseconds(0), 16);
+    auto peer = make_peer("127.0.0.1", 40000);
+    std::string response;
+    EXPECT_EQ(cache.lookup(peer, "req-1", response), ResponseCache::Lookup::Miss);
+    EXPECT_EQ(cache.lookup(peer, "req-1", response), ResponseCache::Lookup::Miss);
+}
\ No newline at end of file
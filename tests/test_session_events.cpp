@@ -0,0 +1,104 @@
+#include <gtest/gtest.h>
+#include "session_events.hpp"
+#include <chrono>
+#include <thread>
+
+using namespace std::chrono_literals;
+
+TEST(SessionEventsTest, SubscriberReceivesEventsInOrder) {
+    SessionEventStream stream(16, 2);
+    auto subscription = stream.subscribe();
+    ASSERT_NE(subscription, nullptr);
+    stream.publish("2026-01-01 00:00:00", "001010000000001", "created");
+    stream.publish("2026-01-01 00:00:01", "001010000000001", "deleted");
+
+    auto batch = subscription->wait(0ms);
+    ASSERT_EQ(batch.events.size(), 2u);
+    EXPECT_EQ(batch.events[0]->seq, 1u);
+    EXPECT_EQ(batch.events[0]->action, "created");
+    EXPECT_EQ(batch.events[1]->seq, 2u);
+    EXPECT_EQ(batch.lost, 0u);
+    EXPECT_FALSE(batch.closed);
+    EXPECT_EQ(SessionEventStream::format_sse(batch),
+        "id: 1\nevent: created\ndata: 2026-01-01 00:00:00,001010000000001,created\n\n"
+        "id: 2\nevent: deleted\ndata: 2026-01-01 00:00:01,001010000000001,deleted\n\n");
+}
+
+TEST(SessionEventsTest, WaitWakesOnPublish) {
+    SessionEventStream stream(16, 1);
+    auto subscription = stream.subscribe();
+    std::thread publisher([&stream]() {
+        std::this_thread::sleep_for(20ms);
+        stream.publish("2026-01-01 00:00:00", "001010000000001", "rejected: no resources");
+    });
+    auto start = std::chrono::steady_clock::now();
+    auto batch = subscription->wait(5s);
+    publisher.join();
+    EXPECT_LT(std::chrono::steady_clock::now() - start, 2s);
+    ASSERT_EQ(batch.events.size(), 1u);
+    EXPECT_EQ(batch.events[0]->type(), "rejected");
+
+    // Без событий wait возвращается по таймауту, порция уходит как keepalive
+    batch = subscription->wait(10ms);
+    EXPECT_TRUE(batch.events.empty());
+    EXPECT_EQ(SessionEventStream::format_sse(batch), ": keepalive\n\n");
+}
+
+TEST(SessionEventsTest, ResumesAfterLastEventIdAndReportsGap) {
+    SessionEventStream stream(4, 2);
+    for (int i = 0; i < 10; ++i) {
+        stream.publish("2026-01-01 00:00:00", std::to_string(i), "created");
+    }
+    // В истории события 7..10
+    auto subscription = stream.subscribe(8);
+    auto batch = subscription->wait(0ms);
+    ASSERT_EQ(batch.events.size(), 2u);
+    EXPECT_EQ(batch.events[0]->seq, 9u);
+    EXPECT_EQ(batch.lost, 0u);
+
+    // Клиент отстал дальше истории: события 3..6 потеряны
+    auto late = stream.subscribe(2);
+    batch = late->wait(0ms);
+    EXPECT_EQ(batch.lost, 4u);
+    ASSERT_EQ(batch.events.size(), 4u);
+    EXPECT_EQ(batch.events[0]->seq, 7u);
+    EXPECT_EQ(SessionEventStream::format_sse(batch).rfind("event: lost\ndata: 4\n\n", 0), 0u);
+}
+
+TEST(SessionEventsTest, SlowSubscriberLosesOldestWithoutBlockingPublisher) {
+    SessionEventStream stream(100, 2);
+    auto slow = stream.subscribe();
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < 100000; ++i) {
+        stream.publish("2026-01-01 00:00:00", "001010000000001", "created");
+    }
+    EXPECT_LT(std::chrono::steady_clock::now() - start, 5s);
+
+    auto batch = slow->wait(0ms);
+    ASSERT_EQ(batch.events.size(), 100u);
+    EXPECT_EQ(batch.events.front()->seq, 99901u);
+    EXPECT_EQ(batch.lost, 99900u);
+    EXPECT_NE(stream.report().find("lost=99900\n"), std::string::npos);
+}
+
+TEST(SessionEventsTest, LimitsSubscribersAndClosesStream) {
+    SessionEventStream stream(16, 1);
+    auto first = stream.subscribe();
+    ASSERT_NE(first, nullptr);
+    EXPECT_EQ(stream.subscribe(), nullptr);
+    stream.unsubscribe(first);
+    auto second = stream.subscribe();
+    ASSERT_NE(second, nullptr);
+    EXPECT_EQ(stream.get_subscriber_count(), 1u);
+
+    std::thread closer([&stream]() {
+        std::this_thread::sleep_for(20ms);
+        stream.close();
+    });
+    auto batch = second->wait(5s);
+    closer.join();
+    EXPECT_TRUE(batch.closed);
+    EXPECT_EQ(SessionEventStream::format_sse(batch), "");
+    EXPECT_EQ(stream.subscribe(), nullptr);
+    EXPECT_NE(stream.report().find("rejected_subscriptions=2\n"), std::string::npos);
+}
@@ -1,80 +1,317 @@
-﻿#include <gtest/gtest.h>
-#include <logger.hpp>
-#include "session_manager.hpp"
-#include "cdr_logger.hpp"
-#include "config.hpp"
-#include <thread>
-#include <chrono>
-#include <fstream>
-
-class SessionManagerTest : public ::testing::Test {
-protected:
-    void SetUp() override {
-        std::ofstream config_file("test_config.json");
-        config_file << R"({
-            "udp_ip": "127.0.0.1",
-            "udp_port": 19000,
-            "session_timeout_sec": 2,
-            "cdr_file": "test_cdr.log",
-            "http_port": 18080,
-            "graceful_shutdown_rate": 10,
-            "log_file": "test.log",
-            "log_level": "INFO",
-            "blacklist": ["001010123456789"]
-        })";
-        config_file.close();
-
-        Logger::init("test.log", "INFO");
-        config_ = std::make_shared<Config>("test_config.json");
-        logger_ = Logger::get();
-        cdr_logger_ = std::make_shared<CDRLogger>(*config_, logger_);
-        session_manager_ = std::make_shared<SessionManager>(*config_, cdr_logger_);
-    }
-
-    void TearDown() override {
-        session_manager_->stop();
-        session_manager_.reset();
-        cdr_logger_.reset();
-        config_.reset();
-        logger_.reset();
-        std::remove("test_config.json");
-        std::remove("test.log");
-        std::remove("test_cdr.log");
-    }
-
-    std::shared_ptr<Config> config_;
-    std::shared_ptr<Logger> logger_;
-    std::shared_ptr<CDRLogger> cdr_logger_;
-    std::shared_ptr<SessionManager> session_manager_;
-};
-
-TEST_F(SessionManagerTest, CreateAndCheckSession) {
-    EXPECT_TRUE(session_manager_->create_session("123456789012345"));
-    EXPECT_TRUE(session_manager_->has_session("123456789012345"));
-}
-
-TEST_F(SessionManagerTest, BlacklistSession) {
-    EXPECT_FALSE(session_manager_->create_session("001010123456789"));
-    EXPECT_FALSE(session_manager_->has_session("001010123456789"));
-}
-
-TEST_F(SessionManagerTest, SessionExpiration) {
-    session_manager_->create_session("123456789012345");
-    std::thread cleanup_thread([this]() { session_manager_->run(); });
-    std::this_thread::sleep_for(std::chrono::seconds(3));
-    session_manager_->stop();
-    if (cleanup_thread.joinable()) {
-        cleanup_thread.join();
-    }
-    EXPECT_FALSE(session_manager_->has_session("123456789012345"));
-
-    std::ifstream cdr_file("test_cdr.log");
-    std::string line;
-    bool found_deleted = false;
-    while (std::getline(cdr_file, line)) {
-        if (line.find("123456789012345,deleted") != std::string::npos) {
-            found_deleted = true;
-        }
-    }
-    EXPECT_TRUE(found_deleted) << "Deleted entry not found in cdr.log";
-}
\ No newline at end of file
+#include <gtest/gtest.h>
+#include <logger.hpp>
+#include "session_manager.hpp"
+#include "cdr_logger.hpp"
+#include "config.hpp"
+#include <thread>
+#include <chrono>
+#include <fstream>
+#include <atomic>
+#include <set>
+
+class SessionManagerTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        std::ofstream config_file("test_config.json");
+        config_file << R"({
+            "udp_ip": "127.0.0.1",
+            "udp_port": 19000,
+            "session_timeout_sec": 2,
+            "cdr_file": "test_cdr.log",
+            "http_port": 18080,
+            "graceful_shutdown_rate": 10,
+            "log_file": "test.log",
+            "log_level": "INFO",
+            "blacklist": ["001010123456789"]
+        })";
+        config_file.close();
+
+        Logger::init("test.log", "INFO");
+        config_ = std::make_shared<Config>("test_config.json");
+        logger_ = Logger::get();
+        cdr_logger_ = std::make_shared<CDRLogger>(*config_, logger_);
+        session_manager_ = std::make_shared<SessionManager>(*config_, cdr_logger_);
+    }
+
+    void TearDown() override {
+        session_manager_->stop();
+        session_manager_.reset();
+        cdr_logger_.reset();
+        config_.reset();
+        logger_.reset();
+        std::remove("test_config.json");
+        std::remove("test.log");
+        std::remove("test_cdr.log");
+    }
+
+    std::shared_ptr<Config> config_;
+    std::shared_ptr<Logger> logger_;
+    std::shared_ptr<CDRLogger> cdr_logger_;
+    std::shared_ptr<SessionManager> session_manager_;
+};
+
+TEST_F(SessionManagerTest, CreateAndCheckSession) {
+    EXPECT_TRUE(session_manager_->create_session("123456789012345"));
+    EXPECT_TRUE(session_manager_->has_session("123456789012345"));
+}
+
+TEST_F(SessionManagerTest, DuplicateAttachDoesNotTouchPools) {
+    std::ofstream config_file("test_pool_config.json");
+    config_file << R"({
+        "session_timeout_sec": 30,
+        "cdr_file": "test_pool_cdr.log",
+        "cdr_reject_coalesce_ms": 0,
+        "teid_pool_size": 1,
+        "log_file": "test.log",
+        "log_level": "INFO",
+        "blacklist": []
+    })";
+    config_file.close();
+    {
+        Config config("test_pool_config.json");
+        auto cdr_logger = std::make_shared<CDRLogger>(config, logger_);
+        SessionManager session_manager(config, cdr_logger);
+
+        // Единственный TEID занят: повтор получает "already exists", новый IMSI — "no resources"
+        EXPECT_TRUE(session_manager.create_session("123456789012345"));
+        EXPECT_FALSE(session_manager.create_session("123456789012345"));
+        EXPECT_FALSE(session_manager.create_session("123456789012346"));
+        EXPECT_TRUE(session_manager.delete_session("123456789012345"));
+        EXPECT_TRUE(session_manager.create_session("123456789012346"));
+    }
+
+    std::ifstream cdr("test_pool_cdr.log");
+    std::string content((std::istreambuf_iterator<char>(cdr)), std::istreambuf_iterator<char>());
+    EXPECT_NE(content.find("123456789012345,rejected: session already exists"), std::string::npos);
+    EXPECT_EQ(content.find("123456789012345,rejected: no resources"), std::string::npos);
+    EXPECT_NE(content.find("123456789012346,rejected: no resources"), std::string::npos);
+    std::remove("test_pool_config.json");
+    std::remove("test_pool_cdr.log");
+}
+
+TEST_F(SessionManagerTest, BlacklistSession) {
+    EXPECT_FALSE(session_manager_->create_session("001010123456789"));
+    EXPECT_FALSE(session_manager_->has_session("001010123456789"));
+}
+
+TEST_F(SessionManagerTest, SessionExpiration) {
+    session_manager_->create_session("123456789012345");
+    std::thread cleanup_thread([this]() { session_manager_->run(); });
+    std::this_thread::sleep_for(std::chrono::seconds(3));
+    session_manager_->stop();
+    if (cleanup_thread.joinable()) {
+        cleanup_thread.join();
+    }
+    EXPECT_FALSE(session_manager_->has_session("123456789012345"));
+
+    std::ifstream cdr_file("test_cdr.log");
+    std::string line;
+    bool found_deleted = false;
+    while (std::getline(cdr_file, line)) {
+        if (line.find("123456789012345,deleted") != std::string::npos) {
+            found_deleted = true;
+        }
+    }
+    EXPECT_TRUE(found_deleted) << "Deleted entry not found in cdr.log";
+}
+
+TEST_F(SessionManagerTest, DeleteSession) {
+    EXPECT_TRUE(session_manager_->create_session("123456789012345"));
+    EXPECT_TRUE(session_manager_->delete_session("123456789012345"));
+    EXPECT_FALSE(session_manager_->has_session("123456789012345"));
+    EXPECT_FALSE(session_manager_->delete_session("123456789012345"));
+
+    // После удаления IMSI можно подключить заново
+    SessionResources resources;
+    resources.peer_teid = 0x5157;
+    EXPECT_TRUE(session_manager_->create_session("123456789012345", &resources));
+    std::string imsi;
+    ASSERT_TRUE(session_manager_->find_session_by_teid(resources.teid, imsi));
+    EXPECT_EQ(imsi, "123456789012345");
+    EXPECT_FALSE(session_manager_->find_session_by_teid(resources.teid + 1, imsi));
+    // TEID SGW сохраняется с сессией и возвращается при удалении
+    SessionResources removed;
+    EXPECT_TRUE(session_manager_->delete_session("123456789012345", &removed));
+    EXPECT_EQ(removed.teid, resources.teid);
+    EXPECT_EQ(removed.peer_teid, 0x5157u);
+    EXPECT_FALSE(session_manager_->find_session_by_teid(resources.teid, imsi));
+
+    std::ifstream cdr_file("test_cdr.log");
+    std::string line;
+    int deleted_count = 0;
+    while (std::getline(cdr_file, line)) {
+        if (line.find("123456789012345,deleted") != std::string::npos) {
+            deleted_count++;
+        }
+    }
+    EXPECT_EQ(deleted_count, 2);
+}
+
+TEST_F(SessionManagerTest, BatchDeleteKeepsExpiryOrder) {
+    std::vector<std::string> imsis;
+    for (int i = 0; i < 10; ++i) {
+        imsis.push_back("123456789" + std::to_string(100000 + i));
+        EXPECT_TRUE(session_manager_->create_session(imsis.back()));
+    }
+
+    // Удаляем сессии из начала, середины и конца очереди истечения
+    EXPECT_EQ(session_manager_->delete_sessions({ imsis[0], imsis[5], imsis[9], "999999999999999" }), 3u);
+    EXPECT_FALSE(session_manager_->has_session(imsis[5]));
+    EXPECT_TRUE(session_manager_->has_session(imsis[4]));
+
+    // Оставшиеся сессии истекают по таймауту
+    std::this_thread::sleep_for(std::chrono::milliseconds(2100));
+    session_manager_->cleanup_expired_sessions();
+    for (const auto& imsi : imsis) {
+        EXPECT_FALSE(session_manager_->has_session(imsi)) << imsi;
+    }
+}
+
+// Менеджер на ручных часах: истечение проверяется сдвигом времени, без ожидания
+class SessionManagerClockTest : public SessionManagerTest {
+protected:
+    void SetUp() override {
+        SessionManagerTest::SetUp();
+        clock_ = std::make_shared<ManualClock>();
+        session_manager_ = std::make_shared<SessionManager>(*config_, cdr_logger_, clock_);
+    }
+
+    std::shared_ptr<ManualClock> clock_;
+};
+
+TEST_F(SessionManagerClockTest, ExpiresWhenClockAdvances) {
+    EXPECT_TRUE(session_manager_->create_session("123456789012345"));
+    clock_->advance(std::chrono::milliseconds(1500));
+    EXPECT_TRUE(session_manager_->create_session("123456789012346"));
+
+    clock_->advance(std::chrono::milliseconds(600));
+    EXPECT_EQ(session_manager_->cleanup_expired_sessions(), 1u);
+    EXPECT_FALSE(session_manager_->has_session("123456789012345"));
+    EXPECT_TRUE(session_manager_->has_session("123456789012346"));
+
+    clock_->advance(std::chrono::seconds(2));
+    EXPECT_EQ(session_manager_->cleanup_expired_sessions(), 1u);
+    EXPECT_EQ(session_manager_->get_session_count(), 0u);
+}
+
+TEST_F(SessionManagerClockTest, WallClockJumpDoesNotExpireSessions) {
+    EXPECT_TRUE(session_manager_->create_session("123456789012345"));
+    // Системные часы переведены на сутки вперёд: возраст сессии по монотонным часам не изменился
+    clock_->jump_wall(std::chrono::hours(24));
+    EXPECT_EQ(session_manager_->cleanup_expired_sessions(), 0u);
+    EXPECT_TRUE(session_manager_->has_session("123456789012345"));
+
+    clock_->jump_wall(-std::chrono::hours(48));
+    clock_->advance(std::chrono::milliseconds(2100));
+    EXPECT_EQ(session_manager_->cleanup_expired_sessions(), 1u);
+}
+
+TEST_F(SessionManagerClockTest, MassExpiryInOneCleanup) {
+    const int count = 20000;
+    for (int i = 0; i < count; ++i) {
+        ASSERT_TRUE(session_manager_->create_session(std::to_string(200000000000000LL + i)));
+    }
+    clock_->advance(std::chrono::milliseconds(1000));
+    EXPECT_TRUE(session_manager_->create_session("123456789012345"));
+    clock_->advance(std::chrono::milliseconds(1100));
+    EXPECT_EQ(session_manager_->cleanup_expired_sessions(), static_cast<size_t>(count));
+    EXPECT_EQ(session_manager_->get_session_count(), 1u);
+    EXPECT_TRUE(session_manager_->has_session("123456789012345"));
+}
+
+TEST_F(SessionManagerClockTest, RestoredSessionsKeepTheirAge) {
+    // Сессия создана на основном узле 1,5 с назад по часам реального мира
+    SessionRecord record;
+    record.imsi = "123456789012345";
+    record.creation_time_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+        (clock_->wall_now() - std::chrono::milliseconds(1500)).time_since_epoch()).count();
+    record.resources.teid = 7;
+    EXPECT_EQ(session_manager_->restore_sessions({ record }), 1u);
+
+    clock_->advance(std::chrono::milliseconds(400));
+    EXPECT_EQ(session_manager_->cleanup_expired_sessions(), 0u);
+    clock_->advance(std::chrono::milliseconds(200));
+    EXPECT_EQ(session_manager_->cleanup_expired_sessions(), 1u);
+}
+
+TEST_F(SessionManagerClockTest, ExportPagesCoverEverySessionOnce) {
+    const int count = 5000;
+    for (int i = 0; i < count; ++i) {
+        ASSERT_TRUE(session_manager_->create_session(std::to_string(300000000000000LL + i)));
+    }
+    clock_->advance(std::chrono::milliseconds(500));
+
+    std::set<std::string> exported;
+    size_t cursor = 0;
+    size_t pages = 0;
+    while (cursor < SessionManager::SHARDS) {
+        auto page = session_manager_->export_sessions(cursor, 100);
+        ASSERT_GT(page.next_cursor, cursor);
+        for (const auto& session : page.sessions) {
+            EXPECT_TRUE(exported.insert(session.imsi).second) << session.imsi;
+            // Таймаут 2 с отсчитан от создания, а не от момента выгрузки
+            EXPECT_EQ(session.expires_at_ms - session.creation_time_ms, 2000);
+        }
+        cursor = page.next_cursor;
+        ++pages;
+    }
+    EXPECT_EQ(exported.size(), static_cast<size_t>(count));
+    EXPECT_GE(pages, static_cast<size_t>(count / 200));
+    EXPECT_TRUE(session_manager_->export_sessions(SessionManager::SHARDS, 100).sessions.empty());
+}
+
+TEST_F(SessionManagerTest, ExportRunsAlongsideAttaches) {
+    const int count = 3000;
+    for (int i = 0; i < count; ++i) {
+        ASSERT_TRUE(session_manager_->create_session(std::to_string(400000000000000LL + i)));
+    }
+    // Создание сессий идёт между страницами выгрузки; все сессии, существовавшие до неё, попадают в выгрузку
+    std::atomic<bool> exporting{ true };
+    std::thread attaches([this, &exporting]() {
+        for (int i = 0; exporting; ++i) {
+            session_manager_->create_session(std::to_string(500000000000000LL + i));
+        }
+    });
+    std::set<std::string> exported;
+    for (size_t cursor = 0; cursor < SessionManager::SHARDS;) {
+        auto page = session_manager_->export_sessions(cursor, 50);
+        for (const auto& session : page.sessions) {
+            exported.insert(session.imsi);
+        }
+        cursor = page.next_cursor;
+    }
+    exporting = false;
+    attaches.join();
+    for (int i = 0; i < count; ++i) {
+        EXPECT_EQ(exported.count(std::to_string(400000000000000LL + i)), 1u);
+    }
+}
+
+TEST_F(SessionManagerClockTest, ReloadedTimeoutAndBlacklistApplyWithoutRestart) {
+    auto config_store = std::make_shared<ConfigStore>("test_config.json", *config_);
+    session_manager_->set_config_store(config_store);
+    ASSERT_TRUE(session_manager_->create_session("123456789012345"));
+
+    std::ofstream config_file("test_config.json");
+    config_file << R"({
+        "session_timeout_sec": 10,
+        "cdr_file": "test_cdr.log",
+        "graceful_shutdown_rate": 10,
+        "log_file": "test.log",
+        "log_level": "INFO",
+        "udp_ip": "127.0.0.1",
+        "udp_port": 19000,
+        "http_port": 18080,
+        "blacklist": ["001010123456789", "123456789012346"]
+    })";
+    config_file.close();
+    auto result = config_store->reload();
+    ASSERT_TRUE(result.ok) << result.error;
+
+    // Сессия, созданная до перезагрузки, живёт по новому таймауту
+    clock_->advance(std::chrono::seconds(5));
+    EXPECT_EQ(session_manager_->cleanup_expired_sessions(), 0u);
+    clock_->advance(std::chrono::seconds(6));
+    EXPECT_EQ(session_manager_->cleanup_expired_sessions(), 1u);
+    EXPECT_FALSE(session_manager_->create_session("123456789012346"));
+}
@@ -0,0 +1,74 @@
+#include <gtest/gtest.h>
+#include "subscriber_index.hpp"
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+TEST(SubscriberIndexTest, PackDistinguishesLeadingZeros) {
+    EXPECT_NE(SubscriberIndex::pack("001010123456789"), 0u);
+    EXPECT_NE(SubscriberIndex::pack("001010123456789"), SubscriberIndex::pack("01010123456789"));
+    EXPECT_EQ(SubscriberIndex::pack(""), 0u);
+    EXPECT_EQ(SubscriberIndex::pack("12345678901234a"), 0u);
+    EXPECT_EQ(SubscriberIndex::pack("1234567890123456"), 0u);
+}
+
+TEST(SubscriberIndexTest, InsertEraseAndGrow) {
+    SubscriberIndex index(4);
+    const int count = 10000;
+    for (int i = 0; i < count; ++i) {
+        index.insert(SubscriberIndex::pack(std::to_string(123456789000000LL + i)));
+    }
+    EXPECT_EQ(index.size(), static_cast<size_t>(count));
+    // Читателей нет: заменённые при росте таблицы освобождены сразу
+    EXPECT_EQ(index.retired_tables(), 0u);
+    for (int i = 0; i < count; i += 2) {
+        index.erase(SubscriberIndex::pack(std::to_string(123456789000000LL + i)));
+    }
+    for (int i = 0; i < count; ++i) {
+        bool expected = (i % 2) != 0;
+        EXPECT_EQ(index.contains(SubscriberIndex::pack(std::to_string(123456789000000LL + i))), expected);
+    }
+    index.clear();
+    EXPECT_EQ(index.size(), 0u);
+    EXPECT_FALSE(index.contains(SubscriberIndex::pack("123456789000001")));
+}
+
+// Читатели не должны терять постоянно присутствующий ключ, пока писатель
+// добавляет, удаляет и перестраивает таблицу
+TEST(SubscriberIndexTest, ConcurrentReadersSeeStableKey) {
+    SubscriberIndex index(4);
+    const uint64_t stable = SubscriberIndex::pack("999999999999999");
+    index.insert(stable);
+
+    std::atomic<bool> stop{ false };
+    std::atomic<int> misses{ 0 };
+    std::vector<std::thread> readers;
+    for (int r = 0; r < 4; ++r) {
+        readers.emplace_back([&]() {
+            while (!stop) {
+                if (!index.contains(stable)) {
+                    ++misses;
+                }
+            }
+        });
+    }
+
+    for (int round = 0; round < 20; ++round) {
+        for (int i = 0; i < 2000; ++i) {
+            index.insert(SubscriberIndex::pack(std::to_string(100000000000000LL + i)));
+        }
+        for (int i = 0; i < 2000; ++i) {
+            index.erase(SubscriberIndex::pack(std::to_string(100000000000000LL + i)));
+        }
+    }
+    stop = true;
+    for (auto& reader : readers) {
+        reader.join();
+    }
+    EXPECT_EQ(misses.load(), 0);
+    EXPECT_EQ(index.size(), 1u);
+    // Писатель не ждал читателей; после их ухода отложенные таблицы освобождаются
+    index.reclaim();
+    EXPECT_EQ(index.retired_tables(), 0u);
+}
\ No newline at end of file
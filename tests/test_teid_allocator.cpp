@@ -0,0 +1,79 @@
+#include <gtest/gtest.h>
+#include "teid_allocator.hpp"
+#include <algorithm>
+#include <set>
+#include <thread>
+#include <vector>
+
+TEST(TEIDAllocatorTest, AllocatesUniqueUntilExhausted) {
+    TEIDAllocator allocator(100, 2);
+    std::set<uint32_t> teids;
+    for (int i = 0; i < 100; ++i) {
+        uint32_t teid = allocator.allocate();
+        ASSERT_NE(teid, 0u);
+        EXPECT_LE(teid, 100u);
+        EXPECT_TRUE(teids.insert(teid).second) << "duplicate TEID " << teid;
+    }
+    EXPECT_EQ(allocator.allocate(), 0u);
+    EXPECT_EQ(allocator.in_use(), 100u);
+
+    // Освобождённый TEID снова доступен
+    allocator.release(42);
+    EXPECT_EQ(allocator.allocate(), 42u);
+}
+
+TEST(TEIDAllocatorTest, ConcurrentAllocateRelease) {
+    const uint32_t capacity = 4096;
+    const int num_threads = 8;
+    TEIDAllocator allocator(capacity);
+
+    // Каждый поток многократно выделяет и освобождает пачку TEID, затем оставляет последнюю себе
+    std::vector<std::vector<uint32_t>> held(num_threads);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < num_threads; ++t) {
+        threads.emplace_back([&, t]() {
+            for (int round = 0; round < 2000; ++round) {
+                held[t].clear();
+                for (int i = 0; i < 64; ++i) {
+                    uint32_t teid = allocator.allocate();
+                    if (teid != 0) {
+                        held[t].push_back(teid);
+                    }
+                }
+                if (round + 1 < 2000) {
+                    for (uint32_t teid : held[t]) {
+                        allocator.release(teid);
+                    }
+                }
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    std::vector<uint32_t> all;
+    for (const auto& teids : held) {
+        all.insert(all.end(), teids.begin(), teids.end());
+    }
+    std::sort(all.begin(), all.end());
+    EXPECT_TRUE(std::adjacent_find(all.begin(), all.end()) == all.end()) << "TEID held by two threads";
+    EXPECT_EQ(all.size(), static_cast<size_t>(num_threads * 64));
+    EXPECT_EQ(allocator.in_use(), all.size());
+}
+
+TEST(TEIDAllocatorTest, ReserveSkipsRestoredTeids) {
+    TEIDAllocator allocator(16, 1);
+    allocator.reserve({ 3, 7, 7, 0, 99 });
+    EXPECT_EQ(allocator.in_use(), 2u);
+
+    std::set<uint32_t> handed_out;
+    uint32_t teid;
+    while ((teid = allocator.allocate()) != 0) {
+        handed_out.insert(teid);
+    }
+    EXPECT_EQ(handed_out.size(), 14u);
+    EXPECT_EQ(handed_out.count(3), 0u);
+    EXPECT_EQ(handed_out.count(7), 0u);
+    EXPECT_EQ(allocator.in_use(), 16u);
+}
@@ -0,0 +1,265 @@
+#include <gtest/gtest.h>
+#include <logger.hpp>
+#include "trace_replay.hpp"
+#include "client_config.hpp"
+#include "packet_capture.hpp"
+#include "gtpv2c.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <set>
+#include <sstream>
+#include <thread>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+
+namespace {
+
+template <typename T>
+void append(std::string& out, T value) {
+    out.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+} // namespace
+
+class TraceReplayTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        std::ofstream client_config_file("test_replay_client_config.json");
+        client_config_file << R"({
+            "server_ip": "127.0.0.1",
+            "server_port": 19500,
+            "log_file": "test_replay_client.log",
+            "log_level": "ERROR"
+        })";
+        client_config_file.close();
+        Logger::init("test_replay_client.log", "ERROR");
+        config_ = std::make_shared<ClientConfig>("test_replay_client_config.json");
+    }
+
+    void TearDown() override {
+        config_.reset();
+        std::remove("test_replay_client_config.json");
+        std::remove("test_replay_client.log");
+        std::remove("test_trace.csv");
+        std::remove("test_trace.pcap");
+    }
+
+    std::shared_ptr<ClientConfig> config_;
+};
+
+TEST_F(TraceReplayTest, ParsesCsvWithHeaderAndDeletes) {
+    std::istringstream csv(
+        "time,imsi,action\n"
+        "100.500,001010000000002,create\n"
+        "100.000,001010000000001\n"
+        "\n"
+        "101.25,001010000000001,delete\n");
+    auto records = TraceLoader::parse_csv(csv);
+    ASSERT_EQ(records.size(), 3u);
+    // Записи упорядочены по времени, отсчёт от первой
+    EXPECT_EQ(records[0].offset_ns, 0);
+    EXPECT_EQ(records[0].datagram, TraceLoader::encode_request("001010000000001", false));
+    EXPECT_EQ(records[1].offset_ns, 500000000);
+    EXPECT_EQ(records[2].offset_ns, 1250000000);
+    EXPECT_EQ(records[2].datagram, TraceLoader::encode_request("001010000000001", true));
+    EXPECT_EQ(static_cast<uint8_t>(records[2].datagram[0]), 0xFF);
+
+    std::istringstream bad_action("0,001010000000001,attach\n");
+    EXPECT_THROW(TraceLoader::parse_csv(bad_action), std::runtime_error);
+    std::istringstream bad_imsi("0,001010000000001\n1,12345\n");
+    EXPECT_THROW(TraceLoader::parse_csv(bad_imsi), std::runtime_error);
+}
+
+TEST_F(TraceReplayTest, SpreadsCdrRecordsAcrossTheirSecond) {
+    std::istringstream cdr(
+        "2026-03-01 10:00:00,001010000000001,created\n"
+        "2026-03-01 10:00:00,001010000000002,rejected: session already exists\n"
+        "2026-03-01 10:00:00,001010000000003,created\n"
+        "2026-03-01 10:00:02,001010000000001,deleted\n");
+    auto records = TraceLoader::parse_cdr(cdr);
+    ASSERT_EQ(records.size(), 4u);
+    EXPECT_EQ(records[0].offset_ns, 0);
+    EXPECT_EQ(records[1].offset_ns, 333333333);
+    EXPECT_EQ(records[2].offset_ns, 666666666);
+    EXPECT_EQ(records[3].offset_ns, 2000000000);
+    EXPECT_EQ(records[1].datagram, TraceLoader::encode_request("001010000000002", false));
+    EXPECT_EQ(records[3].datagram, TraceLoader::encode_request("001010000000001", true));
+
+    std::istringstream bad("2026-03-01 10:00:00,001010000000001,expired\n");
+    EXPECT_THROW(TraceLoader::parse_cdr(bad), std::runtime_error);
+}
+
+TEST_F(TraceReplayTest, ExpandsCoalescedCdrRejects) {
+    // Первый отказ, затем сводная строка трёх повторов с 10:00:01 по 10:00:03, записанная после created
+    std::istringstream cdr(
+        "2026-03-01 10:00:00,001010000000002,rejected: session already exists\n"
+        "2026-03-01 10:00:02,001010000000001,created\n"
+        "2026-03-01 10:00:04,001010000000002,rejected: session already exists; repeated=3; "
+        "first=2026-03-01 10:00:01; last=2026-03-01 10:00:03\n");
+    auto records = TraceLoader::parse_cdr(cdr);
+    ASSERT_EQ(records.size(), 5u);
+    auto reject = TraceLoader::encode_request("001010000000002", false);
+    EXPECT_EQ(records[0].offset_ns, 0);
+    EXPECT_EQ(records[1].offset_ns, 1000000000);
+    EXPECT_EQ(records[1].datagram, reject);
+    // Секунда 10:00:02: повтор и created из файла, created записан раньше
+    EXPECT_EQ(records[2].offset_ns, 2000000000);
+    EXPECT_EQ(records[2].datagram, TraceLoader::encode_request("001010000000001", false));
+    EXPECT_EQ(records[3].offset_ns, 2500000000);
+    EXPECT_EQ(records[3].datagram, reject);
+    EXPECT_EQ(records[4].offset_ns, 3000000000);
+
+    std::istringstream bad("2026-03-01 10:00:04,001010000000002,rejected: no resources; repeated=x; "
+        "first=2026-03-01 10:00:01; last=2026-03-01 10:00:03\n");
+    EXPECT_THROW(TraceLoader::parse_cdr(bad), std::runtime_error);
+}
+
+TEST_F(TraceReplayTest, EncodesGtpv2cRequestsWithFreshSequences) {
+    std::istringstream csv("0,001010000000001,create\n10,001010000000001,create\n20,001010000000001,delete\n");
+    auto records = TraceLoader::parse_csv(csv, "gtpv2c");
+    std::istringstream cdr(
+        "2026-03-01 10:00:00,001010000000002,created\n"
+        "2026-03-01 10:00:04,001010000000002,rejected: session already exists; repeated=2; "
+        "first=2026-03-01 10:00:01; last=2026-03-01 10:00:02\n");
+    auto cdr_records = TraceLoader::parse_cdr(cdr, "gtpv2c");
+    ASSERT_EQ(records.size(), 3u);
+    ASSERT_EQ(cdr_records.size(), 3u);
+
+    // Повторный attach — новый запрос, а не ретрансмиссия: номера последовательности различны
+    const uint8_t expected_types[] = { gtpv2c::CREATE_SESSION_REQUEST, gtpv2c::CREATE_SESSION_REQUEST,
+        gtpv2c::DELETE_SESSION_REQUEST };
+    for (const auto* trace : { &records, &cdr_records }) {
+        std::set<uint32_t> sequences;
+        for (size_t i = 0; i < trace->size(); ++i) {
+            const auto& datagram = (*trace)[i].datagram;
+            gtpv2c::MessageView message;
+            ASSERT_EQ(gtpv2c::parse(reinterpret_cast<const uint8_t*>(datagram.data()), datagram.size(), message),
+                gtpv2c::ParseResult::OK);
+            EXPECT_EQ(message.type, trace == &records ? expected_types[i] : static_cast<uint8_t>(gtpv2c::CREATE_SESSION_REQUEST));
+            EXPECT_NE(message.sequence, 0u);
+            sequences.insert(message.sequence);
+            char imsi[16];
+            ASSERT_EQ(gtpv2c::decode_imsi(message.imsi, imsi, sizeof(imsi)), 15u);
+            EXPECT_EQ(std::string(imsi, 15), trace == &records ? "001010000000001" : "001010000000002");
+        }
+        EXPECT_EQ(sequences.size(), trace->size());
+    }
+
+    std::istringstream bad_imsi("0,001010000000001,create\n1,12345,create\n");
+    EXPECT_THROW(TraceLoader::parse_csv(bad_imsi, "gtpv2c"), std::runtime_error);
+}
+
+TEST_F(TraceReplayTest, ReadsRequestsFromServerCapture) {
+    // Выгрузка /capture/pcap: запросы к порту 19500 и ответы сервера
+    CapturedPacket request;
+    request.timestamp_ns = 1700000000000000000LL;
+    request.peer_addr = inet_addr("10.0.0.1");
+    request.peer_port = htons(2123);
+    request.data = TraceLoader::encode_request("001010000000001", false);
+    request.length = static_cast<uint32_t>(request.data.size());
+    CapturedPacket reply = request;
+    reply.direction = CaptureDirection::Reply;
+    reply.timestamp_ns += 100000;
+    reply.data = "created";
+    reply.length = 7;
+    CapturedPacket retransmit = request;
+    retransmit.timestamp_ns += 250000000;
+    std::string pcap = PacketCapture::format_pcap({ request, reply, retransmit }, inet_addr("127.0.0.1"), htons(19500));
+    {
+        std::ofstream file("test_trace.pcap", std::ios::binary);
+        file << pcap;
+    }
+    EXPECT_EQ(TraceLoader::detect_format("test_trace.pcap"), TraceFormat::Pcap);
+    auto records = TraceLoader::load("test_trace.pcap", 19500);
+    ASSERT_EQ(records.size(), 2u);
+    EXPECT_EQ(records[0].datagram, request.data);
+    EXPECT_EQ(records[1].offset_ns, 250000000);
+
+    // tcpdump на Ethernet: микросекундные метки, кадр с заголовком Ethernet
+    std::string ethernet;
+    append<uint32_t>(ethernet, 0xa1b2c3d4);
+    append<uint16_t>(ethernet, 2);
+    append<uint16_t>(ethernet, 4);
+    append<uint32_t>(ethernet, 0);
+    append<uint32_t>(ethernet, 0);
+    append<uint32_t>(ethernet, 65535);
+    append<uint32_t>(ethernet, 1);
+    std::string frame(12, '\0');
+    frame += std::string("\x08\x00", 2);
+    frame += pcap.substr(24 + 16, 28 + request.data.size());   // IPv4 и UDP из первой записи
+    for (uint32_t usec : { 10u, 30u }) {
+        append<uint32_t>(ethernet, 1700000000);
+        append<uint32_t>(ethernet, usec);
+        append<uint32_t>(ethernet, static_cast<uint32_t>(frame.size()));
+        append<uint32_t>(ethernet, static_cast<uint32_t>(frame.size()));
+        ethernet += frame;
+    }
+    ethernet += std::string("\x01\x02", 2);  // Оборванная запись в конце файла
+    records = TraceLoader::parse_pcap(ethernet, 19500);
+    ASSERT_EQ(records.size(), 2u);
+    EXPECT_EQ(records[1].offset_ns, 20000);
+    EXPECT_EQ(records[1].datagram, request.data);
+    EXPECT_TRUE(TraceLoader::parse_pcap(ethernet, 9000).empty());
+}
+
+TEST_F(TraceReplayTest, ReplaysWithScaledTimingAndReportsLateness) {
+    // Сервер-заглушка отвечает на каждую датаграмму
+    int server_fd = socket(AF_INET, SOCK_DGRAM, 0);
+    ASSERT_GE(server_fd, 0);
+    struct sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = inet_addr("127.0.0.1");
+    addr.sin_port = htons(19500);
+    ASSERT_EQ(bind(server_fd, (struct sockaddr*)&addr, sizeof(addr)), 0);
+    struct timeval tv = { 0, 100000 };
+    setsockopt(server_fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    std::atomic<bool> serving{ true };
+    std::atomic<int> received{ 0 };
+    std::thread server([&]() {
+        char buffer[256];
+        while (serving) {
+            struct sockaddr_in peer;
+            socklen_t peer_len = sizeof(peer);
+            ssize_t n = recvfrom(server_fd, buffer, sizeof(buffer), 0, (struct sockaddr*)&peer, &peer_len);
+            if (n > 0) {
+                ++received;
+                sendto(server_fd, "created", 7, 0, (struct sockaddr*)&peer, peer_len);
+            }
+        }
+    });
+
+    std::ofstream csv("test_trace.csv");
+    csv << "0.000,001010000000001\n0.100,001010000000002\n0.100,001010000000003\n0.300,001010000000001,delete\n";
+    csv.close();
+    EXPECT_EQ(TraceLoader::detect_format("test_trace.csv"), TraceFormat::Csv);
+    auto records = TraceLoader::load("test_trace.csv", 19500);
+
+    TraceReplayer replayer(*config_, Logger::get());
+    auto start = std::chrono::steady_clock::now();
+    auto report = replayer.replay(records, 2.0);
+    double elapsed_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    serving = false;
+    server.join();
+    close(server_fd);
+
+    EXPECT_EQ(report.records, 4u);
+    EXPECT_EQ(report.sent, 4u);
+    EXPECT_EQ(report.replies, 4u);
+    EXPECT_EQ(received.load(), 4);
+    // При ускорении 2 трасса в 300 мс идёт 150 мс
+    EXPECT_DOUBLE_EQ(report.intended_ms, 150.0);
+    EXPECT_GE(report.achieved_ms, 149.0);
+    EXPECT_LT(report.achieved_ms, 250.0);
+    EXPECT_GE(elapsed_ms, 150.0);
+    EXPECT_GE(report.lateness_p50_us, 0.0);
+    EXPECT_LE(report.lateness_p50_us, report.lateness_max_us);
+    std::string text = TraceReplayer::format_report(report);
+    EXPECT_NE(text.find("sent=4\nsend_errors=0\nreplies=4\nspeed=2.0\nintended_ms=150.0\n"), std::string::npos) << text;
+
+    EXPECT_THROW(replayer.replay(records, 0), std::invalid_argument);
+}
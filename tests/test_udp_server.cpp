@@ -1,126 +1,797 @@
-#include <gtest/gtest.h>
-#include <logger.hpp>
-#include "udp_server.hpp"
-#include "session_manager.hpp"
-#include "cdr_logger.hpp"
-#include "config.hpp"
-#include <thread>
-#include <sys/socket.h>
-#include <netinet/in.h>
-#include <arpa/inet.h>
-#include <unistd.h>
-
-//    IMSI  BCD
-std::string encode_bcd(const std::string& imsi) {
-    std::string bcd;
-    for (size_t i = 0; i < imsi.size(); i += 2) {
-        char byte = ((imsi[i] - '0') << 4);
-        if (i + 1 < imsi.size()) {
-            byte |= (imsi[i + 1] - '0');
-        }
-        else {
-            byte |= 0xF;
-        }
-        bcd.push_back(byte);
-    }
-    return bcd;
-}
-
-class UDPServerTest : public ::testing::Test {
-protected:
-    void SetUp() override {
-        std::ofstream config_file("test_config.json");
-        config_file << R"({
-            "udp_ip": "127.0.0.1",
-            "udp_port": 19000,
-            "session_timeout_sec": 2,
-            "cdr_file": "test_cdr.log",
-            "http_port": 18080,
-            "graceful_shutdown_rate": 10,
-            "log_file": "test.log",
-            "log_level": "INFO",
-            "blacklist": ["001010123456789"]
-        })";
-        config_file.close();
-
-        Logger::init("test.log", "INFO");
-        config_ = std::make_shared<Config>("test_config.json");
-        logger_ = Logger::get();
-        cdr_logger_ = std::make_shared<CDRLogger>(*config_, logger_);
-        session_manager_ = std::make_shared<SessionManager>(*config_, cdr_logger_);
-        udp_server_ = std::make_shared<UDPServer>(*config_, session_manager_, cdr_logger_);
-    }
-
-    void TearDown() override {
-        udp_server_->stop();
-        udp_server_.reset();
-        session_manager_.reset();
-        cdr_logger_.reset();
-        config_.reset();
-        logger_.reset();
-        std::remove("test_config.json");
-        std::remove("test.log");
-        std::remove("test_cdr.log");
-    }
-
-    std::shared_ptr<Config> config_;
-    std::shared_ptr<Logger> logger_;
-    std::shared_ptr<CDRLogger> cdr_logger_;
-    std::shared_ptr<SessionManager> session_manager_;
-    std::shared_ptr<UDPServer> udp_server_;
-};
-
-TEST_F(UDPServerTest, MultiThreadedRequestHandling) {
-    std::thread server_thread([this]() { udp_server_->run(); });
-    std::this_thread::sleep_for(std::chrono::milliseconds(100));
-
-    int sockfd = socket(AF_INET, SOCK_DGRAM, 0);
-    ASSERT_GE(sockfd, 0);
-
-    struct sockaddr_in server_addr = {};
-    server_addr.sin_family = AF_INET;
-    server_addr.sin_addr.s_addr = inet_addr("127.0.0.1");
-    server_addr.sin_port = htons(19000);
-
-    std::vector<std::thread> clients;
-    const int num_clients = 10;
-    char buffer[256];
-
-    for (int i = 0; i < num_clients; ++i) {
-        std::string imsi = "12345678901234" + std::to_string(i);
-        std::string bcd_imsi = encode_bcd(imsi);
-        clients.emplace_back([bcd_imsi, sockfd, &server_addr]() {
-            sendto(sockfd, bcd_imsi.c_str(), bcd_imsi.size(), 0, (struct sockaddr*)&server_addr, sizeof(server_addr));
-            char response[256];
-            struct sockaddr_in from;
-            socklen_t from_len = sizeof(from);
-            ssize_t n = recvfrom(sockfd, response, sizeof(response) - 1, 0, (struct sockaddr*)&from, &from_len);
-            if (n > 0) {
-                response[n] = '\0';
-                EXPECT_STREQ(response, "created");
-            }
-            });
-    }
-
-    for (auto& client : clients) {
-        if (client.joinable()) {
-            client.join();
-        }
-    }
-
-    close(sockfd);
-    udp_server_->stop();
-    if (server_thread.joinable()) {
-        server_thread.join();
-    }
-
-    std::ifstream cdr_file("test_cdr.log");
-    std::string line;
-    int created_count = 0;
-    while (std::getline(cdr_file, line)) {
-        if (line.find(",created") != std::string::npos) {
-            created_count++;
-        }
-    }
-    EXPECT_EQ(created_count, num_clients);
-}
\ No newline at end of file
+#include <gtest/gtest.h>
+#include <logger.hpp>
+#include "udp_server.hpp"
+#include "session_manager.hpp"
+#include "cdr_logger.hpp"
+#include "config.hpp"
+#include "gtpv2c.hpp"
+#include <nlohmann/json.hpp>
+#include <set>
+#include <thread>
+#include <map>
+#include <mutex>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+
+// Функция для кодирования IMSI в BCD
+std::string encode_bcd(const std::string& imsi) {
+    std::string bcd;
+    for (size_t i = 0; i < imsi.size(); i += 2) {
+        char byte = ((imsi[i] - '0') << 4);
+        if (i + 1 < imsi.size()) {
+            byte |= (imsi[i + 1] - '0');
+        }
+        else {
+            byte |= 0xF;
+        }
+        bcd.push_back(byte);
+    }
+    return bcd;
+}
+
+class UDPServerTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        std::ofstream config_file("test_config.json");
+        config_file << R"({
+            "udp_ip": "127.0.0.1",
+            "udp_port": 19000,
+            "session_timeout_sec": 2,
+            "cdr_file": "test_cdr.log",
+            "http_port": 18080,
+            "graceful_shutdown_rate": 10,
+            "log_file": "test.log",
+            "log_level": "INFO",
+            "protocol": ")" << protocol() << R"(",
+            "blacklist": ["001010123456789"],
+            "worker_threads_min": 1,
+            "worker_threads_max": 3,
+            "worker_grow_wait_us": 0,
+            "worker_shrink_idle_ms": 0)" << extra_config() << R"(
+        })";
+        config_file.close();
+
+        Logger::init("test.log", "INFO");
+        config_ = std::make_shared<Config>("test_config.json");
+        logger_ = Logger::get();
+        cdr_logger_ = std::make_shared<CDRLogger>(*config_, logger_);
+        session_manager_ = std::make_shared<SessionManager>(*config_, cdr_logger_);
+        udp_server_ = std::make_shared<UDPServer>(*config_, session_manager_, cdr_logger_);
+    }
+
+    void TearDown() override {
+        udp_server_->stop();
+        udp_server_.reset();
+        session_manager_.reset();
+        cdr_logger_.reset();
+        config_.reset();
+        logger_.reset();
+        std::remove("test_config.json");
+        std::remove("test.log");
+        std::remove("test_cdr.log");
+    }
+
+    // Протокол UDP-интерфейса для фикстуры
+    virtual std::string protocol() const { return "bcd"; }
+
+    // Дополнительные параметры конфигурации (с ведущей запятой)
+    virtual std::string extra_config() const { return ""; }
+
+    std::shared_ptr<Config> config_;
+    std::shared_ptr<Logger> logger_;
+    std::shared_ptr<CDRLogger> cdr_logger_;
+    std::shared_ptr<SessionManager> session_manager_;
+    std::shared_ptr<UDPServer> udp_server_;
+};
+
+TEST_F(UDPServerTest, MultiThreadedRequestHandling) {
+    std::thread server_thread([this]() { udp_server_->run(); });
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+    int sockfd = socket(AF_INET, SOCK_DGRAM, 0);
+    ASSERT_GE(sockfd, 0);
+
+    struct sockaddr_in server_addr = {};
+    server_addr.sin_family = AF_INET;
+    server_addr.sin_addr.s_addr = inet_addr("127.0.0.1");
+    server_addr.sin_port = htons(19000);
+
+    std::vector<std::thread> clients;
+    const int num_clients = 10;
+    char buffer[256];
+
+    for (int i = 0; i < num_clients; ++i) {
+        std::string imsi = "12345678901234" + std::to_string(i);
+        std::string bcd_imsi = encode_bcd(imsi);
+        clients.emplace_back([bcd_imsi, sockfd, &server_addr]() {
+            sendto(sockfd, bcd_imsi.c_str(), bcd_imsi.size(), 0, (struct sockaddr*)&server_addr, sizeof(server_addr));
+            char response[256];
+            struct sockaddr_in from;
+            socklen_t from_len = sizeof(from);
+            ssize_t n = recvfrom(sockfd, response, sizeof(response) - 1, 0, (struct sockaddr*)&from, &from_len);
+            if (n > 0) {
+                response[n] = '\0';
+                EXPECT_STREQ(response, "created");
+            }
+            });
+    }
+
+    for (auto& client : clients) {
+        if (client.joinable()) {
+            client.join();
+        }
+    }
+
+    close(sockfd);
+    udp_server_->stop();
+    if (server_thread.joinable()) {
+        server_thread.join();
+    }
+
+    std::ifstream cdr_file("test_cdr.log");
+    std::string line;
+    int created_count = 0;
+    while (std::getline(cdr_file, line)) {
+        if (line.find(",created") != std::string::npos) {
+            created_count++;
+        }
+    }
+    EXPECT_EQ(created_count, num_clients);
+}
+
+TEST_F(UDPServerTest, RetransmissionReplaysOriginalResponse) {
+    std::thread server_thread([this]() { udp_server_->run(); });
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+    int sockfd = socket(AF_INET, SOCK_DGRAM, 0);
+    ASSERT_GE(sockfd, 0);
+    struct timeval tv = { 1, 0 };
+    setsockopt(sockfd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+
+    struct sockaddr_in server_addr = {};
+    server_addr.sin_family = AF_INET;
+    server_addr.sin_addr.s_addr = inet_addr("127.0.0.1");
+    server_addr.sin_port = htons(19000);
+
+    // Исходный запрос и две повторные передачи с того же сокета
+    std::string bcd_imsi = encode_bcd("123456789012399");
+    for (int attempt = 0; attempt < 3; ++attempt) {
+        sendto(sockfd, bcd_imsi.c_str(), bcd_imsi.size(), 0, (struct sockaddr*)&server_addr, sizeof(server_addr));
+        char response[256];
+        ssize_t n = recvfrom(sockfd, response, sizeof(response) - 1, 0, nullptr, nullptr);
+        ASSERT_GT(n, 0);
+        response[n] = '\0';
+        EXPECT_STREQ(response, "created");
+    }
+
+    close(sockfd);
+    udp_server_->stop();
+    if (server_thread.joinable()) {
+        server_thread.join();
+    }
+    EXPECT_EQ(udp_server_->get_response_cache().get_replayed(), 2u);
+
+    std::ifstream cdr_file("test_cdr.log");
+    std::string line;
+    int cdr_lines = 0;
+    while (std::getline(cdr_file, line)) {
+        if (line.find("123456789012399") != std::string::npos) {
+            cdr_lines++;
+        }
+    }
+    EXPECT_EQ(cdr_lines, 1);
+}
+
+TEST_F(UDPServerTest, DeleteSessionAndReattach) {
+    std::thread server_thread([this]() { udp_server_->run(); });
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+    int sockfd = socket(AF_INET, SOCK_DGRAM, 0);
+    ASSERT_GE(sockfd, 0);
+    struct timeval tv = { 1, 0 };
+    setsockopt(sockfd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+
+    struct sockaddr_in server_addr = {};
+    server_addr.sin_family = AF_INET;
+    server_addr.sin_addr.s_addr = inet_addr("127.0.0.1");
+    server_addr.sin_port = htons(19000);
+
+    std::string create = encode_bcd("123456789012388");
+    std::string remove = std::string(1, static_cast<char>(UDPServer::BCD_DELETE_MARKER)) + create;
+    // Повторное создание после удаления не должно получить ответ из кэша ретрансмиссий
+    const std::pair<std::string, const char*> steps[] = {
+        { create, "created" },
+        { remove, "deleted" },
+        { create, "created" },
+        { remove, "deleted" },
+        { std::string(1, static_cast<char>(UDPServer::BCD_DELETE_MARKER)) + encode_bcd("123456789012377"), "not found" },
+    };
+    for (const auto& step : steps) {
+        sendto(sockfd, step.first.data(), step.first.size(), 0, (struct sockaddr*)&server_addr, sizeof(server_addr));
+        char response[256];
+        ssize_t n = recvfrom(sockfd, response, sizeof(response) - 1, 0, nullptr, nullptr);
+        ASSERT_GT(n, 0);
+        response[n] = '\0';
+        EXPECT_STREQ(response, step.second);
+    }
+
+    close(sockfd);
+    udp_server_->stop();
+    if (server_thread.joinable()) {
+        server_thread.join();
+    }
+    EXPECT_FALSE(session_manager_->has_session("123456789012388"));
+
+    std::ifstream cdr_file("test_cdr.log");
+    std::string line;
+    int created_count = 0;
+    int deleted_count = 0;
+    while (std::getline(cdr_file, line)) {
+        if (line.find("123456789012388,created") != std::string::npos) created_count++;
+        if (line.find("123456789012388,deleted") != std::string::npos) deleted_count++;
+    }
+    EXPECT_EQ(created_count, 2);
+    EXPECT_EQ(deleted_count, 2);
+}
+
+TEST_F(UDPServerTest, WorkerPoolGrowsAndParksWhileServing) {
+    std::thread server_thread([this]() { udp_server_->run(); });
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+    int sockfd = socket(AF_INET, SOCK_DGRAM, 0);
+    ASSERT_GE(sockfd, 0);
+    struct timeval tv = { 1, 0 };
+    setsockopt(sockfd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    struct sockaddr_in server_addr = {};
+    server_addr.sin_family = AF_INET;
+    server_addr.sin_addr.s_addr = inet_addr("127.0.0.1");
+    server_addr.sin_port = htons(19000);
+
+    long long next_imsi = 123456789012500LL;
+    auto exchange = [&]() {
+        std::string request = encode_bcd(std::to_string(next_imsi++));
+        sendto(sockfd, request.data(), request.size(), 0, (struct sockaddr*)&server_addr, sizeof(server_addr));
+        char response[256];
+        ssize_t n = recvfrom(sockfd, response, sizeof(response) - 1, 0, nullptr, nullptr);
+        response[n > 0 ? n : 0] = '\0';
+        return std::string(response);
+    };
+    auto workers = [this]() {
+        std::string report = udp_server_->get_worker_pool_sizer()->report();
+        return std::stoi(report.substr(report.find("workers=") + 8));
+    };
+
+    // Порог ожидания 0: каждый интервал с запросами — перегрузка, пул растёт через интервал до max
+    ASSERT_EQ(workers(), 1);
+    for (int expected : { 1, 2, 2, 3, 3, 3 }) {
+        ASSERT_EQ(exchange(), "created");
+        udp_server_->adjust_workers();
+        EXPECT_EQ(workers(), expected);
+    }
+
+    // Без запросов пул отдаёт по потоку за тик после начала простоя; лишние потоки паркуются.
+    // Паузы: рабочий поток учитывает время обработки уже после ответа, оно не должно попасть в короткий интервал
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    udp_server_->adjust_workers();
+    EXPECT_EQ(workers(), 2);
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    udp_server_->adjust_workers();
+    EXPECT_EQ(workers(), 1);
+    for (int i = 0; i < 3; ++i) {
+        EXPECT_EQ(exchange(), "created");
+    }
+
+    close(sockfd);
+    udp_server_->stop();
+    if (server_thread.joinable()) {
+        server_thread.join();
+    }
+}
+
+TEST_F(UDPServerTest, MeasuresLatencyFromKernelTimestamps) {
+    std::thread server_thread([this]() { udp_server_->run(); });
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+    int sockfd = socket(AF_INET, SOCK_DGRAM, 0);
+    ASSERT_GE(sockfd, 0);
+    struct timeval tv = { 1, 0 };
+    setsockopt(sockfd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    struct sockaddr_in server_addr = {};
+    server_addr.sin_family = AF_INET;
+    server_addr.sin_addr.s_addr = inet_addr("127.0.0.1");
+    server_addr.sin_port = htons(19000);
+
+    // Неверный IMSI тоже получает ответ из рабочего потока и попадает в задержку до ответа
+    const std::string imsis[] = { "123456789012701", "123456789012702", "12345" };
+    for (const auto& imsi : imsis) {
+        std::string request = encode_bcd(imsi);
+        sendto(sockfd, request.data(), request.size(), 0, (struct sockaddr*)&server_addr, sizeof(server_addr));
+        char response[256];
+        ASSERT_GT(recvfrom(sockfd, response, sizeof(response), 0, nullptr, nullptr), 0);
+    }
+    close(sockfd);
+    udp_server_->stop();
+    if (server_thread.joinable()) {
+        server_thread.join();
+    }
+
+    const LatencyStats& stats = *udp_server_->get_latency_stats();
+    EXPECT_EQ(stats.get_socket_wait().get_count(), 3u);
+    EXPECT_EQ(stats.get_queue_wait().get_count(), 3u);
+    EXPECT_EQ(stats.get_socket_to_reply().get_count(), 3u);
+    EXPECT_EQ(stats.get_socket_drops(), 0u);
+    std::string report = stats.report();
+    EXPECT_NE(report.find("untimestamped=0\n"), std::string::npos);
+    // Путь до ответа включает ожидание в сокете и в очереди
+    EXPECT_GE(stats.get_socket_to_reply().percentile_us(1.0), stats.get_queue_wait().percentile_us(0.01));
+}
+
+TEST_F(UDPServerTest, ServesInjectedRequestsOverLoopbackTransport) {
+    // Второй сервер на том же конфиге, но без сокета: датаграммы приходят из памяти
+    auto transport = std::make_shared<LoopbackTransport>();
+    std::mutex replies_mutex;
+    std::map<uint16_t, std::vector<std::string>> replies;
+    transport->set_reply_handler([&](const char* data, size_t length, const struct sockaddr_in& peer) {
+        std::lock_guard<std::mutex> lock(replies_mutex);
+        replies[ntohs(peer.sin_port)].emplace_back(data, length);
+    });
+    UDPServer loopback_server(*config_, session_manager_, cdr_logger_, transport);
+    std::thread server_thread([&loopback_server]() { loopback_server.run(); });
+
+    const int requests = 200;
+    for (int i = 0; i < requests; ++i) {
+        std::string request = encode_bcd(std::to_string(123456789013000LL + i));
+        struct sockaddr_in peer = {};
+        peer.sin_family = AF_INET;
+        peer.sin_addr.s_addr = inet_addr("10.0.0.1");
+        peer.sin_port = htons(static_cast<uint16_t>(20000 + i));
+        ASSERT_TRUE(transport->inject(request.data(), request.size(), peer));
+    }
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (transport->get_replies() < static_cast<uint64_t>(requests) && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    ASSERT_EQ(transport->get_replies(), static_cast<uint64_t>(requests));
+
+    // Повтор запроса первого пира отвечается из кэша ретрансмиссий
+    std::string retransmit = encode_bcd("123456789013000");
+    struct sockaddr_in first = {};
+    first.sin_family = AF_INET;
+    first.sin_addr.s_addr = inet_addr("10.0.0.1");
+    first.sin_port = htons(20000);
+    ASSERT_TRUE(transport->inject(retransmit.data(), retransmit.size(), first));
+    deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (transport->get_replies() < static_cast<uint64_t>(requests) + 1 && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    loopback_server.stop();
+    server_thread.join();
+
+    ASSERT_EQ(replies.size(), static_cast<size_t>(requests));
+    for (const auto& [port, answers] : replies) {
+        for (const auto& answer : answers) {
+            EXPECT_EQ(answer, "created") << "peer port " << port;
+        }
+    }
+    EXPECT_EQ(replies[20000].size(), 2u);
+    EXPECT_EQ(loopback_server.get_response_cache().get_replayed(), 1u);
+    EXPECT_EQ(loopback_server.get_latency_stats()->get_socket_to_reply().get_count(), static_cast<uint64_t>(requests));
+    EXPECT_TRUE(session_manager_->has_session("123456789013199"));
+}
+
+TEST_F(UDPServerTest, TracksHeavyHittersOnIngest) {
+    auto transport = std::make_shared<LoopbackTransport>();
+    UDPServer loopback_server(*config_, session_manager_, cdr_logger_, transport);
+    std::thread server_thread([&loopback_server]() { loopback_server.run(); });
+
+    // Один пир повторяет свой запрос, остальные шлют по одному
+    std::string flood = encode_bcd("123456789014000");
+    struct sockaddr_in flooder = {};
+    flooder.sin_family = AF_INET;
+    flooder.sin_addr.s_addr = inet_addr("192.0.2.66");
+    flooder.sin_port = htons(2123);
+    for (int i = 0; i < 50; ++i) {
+        ASSERT_TRUE(transport->inject(flood.data(), flood.size(), flooder));
+        std::string request = encode_bcd(std::to_string(123456789014100LL + i));
+        struct sockaddr_in peer = flooder;
+        peer.sin_addr.s_addr = htonl(0x0A000001 + i);
+        ASSERT_TRUE(transport->inject(request.data(), request.size(), peer));
+    }
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (transport->get_queued() > 0 && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    // Уходя в ожидание, поток приёма публикует снимок
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    std::string report = loopback_server.get_heavy_hitters()->report();
+    loopback_server.stop();
+    server_thread.join();
+
+    EXPECT_NE(report.find("peer_total=100\n"), std::string::npos) << report;
+    EXPECT_NE(report.find("peer_1=192.0.2.66\npeer_1_count=50\n"), std::string::npos) << report;
+    EXPECT_NE(report.find("imsi_1=123456789014000\nimsi_1_count=50\n"), std::string::npos) << report;
+}
+
+TEST_F(UDPServerTest, CapturesFilteredRequestsWithReplies) {
+    auto transport = std::make_shared<LoopbackTransport>();
+    UDPServer loopback_server(*config_, session_manager_, cdr_logger_, transport);
+    std::thread server_thread([&loopback_server]() { loopback_server.run(); });
+    auto capture = loopback_server.get_packet_capture();
+    capture->start("", "12345678901500");
+
+    struct sockaddr_in peer = {};
+    peer.sin_family = AF_INET;
+    peer.sin_addr.s_addr = inet_addr("10.0.0.7");
+    peer.sin_port = htons(2123);
+    // Под фильтр попадают IMSI 1234567890150x, остальные не сохраняются
+    for (int i = 0; i < 20; ++i) {
+        std::string request = encode_bcd(std::to_string(123456789014990LL + i));
+        ASSERT_TRUE(transport->inject(request.data(), request.size(), peer));
+    }
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (transport->get_replies() < 20 && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    loopback_server.stop();
+    server_thread.join();
+
+    auto packets = capture->snapshot();
+    ASSERT_EQ(packets.size(), 20u);
+    size_t requests = 0;
+    for (const auto& packet : packets) {
+        EXPECT_EQ(packet.peer_addr, peer.sin_addr.s_addr);
+        if (packet.direction == CaptureDirection::Request) {
+            ++requests;
+        }
+        else {
+            EXPECT_EQ(packet.data, "created");
+        }
+    }
+    EXPECT_EQ(requests, 10u);
+    EXPECT_EQ(packets.front().data, encode_bcd("123456789015000"));
+}
+
+TEST_F(UDPServerTest, FlightRecorderTracesRequestPipeline) {
+    auto recorder = std::make_shared<FlightRecorder>(256);
+    auto transport = std::make_shared<LoopbackTransport>();
+    UDPServer loopback_server(*config_, session_manager_, cdr_logger_, transport);
+    loopback_server.set_flight_recorder(recorder);
+    cdr_logger_->set_flight_recorder(recorder);
+    session_manager_->set_flight_recorder(recorder);
+    std::thread server_thread([&loopback_server]() { loopback_server.run(); });
+
+    struct sockaddr_in peer = {};
+    peer.sin_family = AF_INET;
+    peer.sin_addr.s_addr = inet_addr("10.0.0.8");
+    peer.sin_port = htons(2123);
+    std::string create = encode_bcd("123456789016001");
+    std::string remove = std::string(1, static_cast<char>(UDPServer::BCD_DELETE_MARKER)) + create;
+    ASSERT_TRUE(transport->inject(create.data(), create.size(), peer));
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (transport->get_replies() < 1 && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    ASSERT_TRUE(transport->inject(remove.data(), remove.size(), peer));
+    while (transport->get_replies() < 2 && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    session_manager_->cleanup_expired_sessions();
+    loopback_server.stop();
+    server_thread.join();
+
+    auto trace = nlohmann::json::parse(recorder->chrome_trace());
+    std::map<std::string, int> counts;
+    std::set<int> tids;
+    for (const auto& event : trace["traceEvents"]) {
+        if (event["ph"] == "M") {
+            continue;
+        }
+        ++counts[event["name"].get<std::string>()];
+        tids.insert(event["tid"].get<int>());
+        if (event["ph"] == "X") {
+            EXPECT_GE(event["dur"].get<double>(), 0.0);
+        }
+        if (event["name"] == "session_create" || event["name"] == "session_delete") {
+            EXPECT_EQ(event["args"]["ok"], 1);
+        }
+    }
+    EXPECT_EQ(counts["receive"], 2);
+    EXPECT_EQ(counts["enqueue"], 2);
+    EXPECT_EQ(counts["session_create"], 1);
+    EXPECT_EQ(counts["session_delete"], 1);
+    EXPECT_EQ(counts["cdr_write"], 2);
+    EXPECT_EQ(counts["send"], 2);
+    EXPECT_EQ(counts["expiry_sweep"], 1);
+    // Приём, рабочий поток и поток теста пишут в свои кольца
+    EXPECT_GE(tids.size(), 3u);
+}
+
+class UDPServerGTPTest : public UDPServerTest {
+protected:
+    std::string protocol() const override { return "gtpv2c"; }
+};
+
+TEST_F(UDPServerGTPTest, CreateSessionRequestOverGTPv2C) {
+    std::thread server_thread([this]() { udp_server_->run(); });
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+    int sockfd = socket(AF_INET, SOCK_DGRAM, 0);
+    ASSERT_GE(sockfd, 0);
+    struct timeval tv = { 1, 0 };
+    setsockopt(sockfd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+
+    struct sockaddr_in server_addr = {};
+    server_addr.sin_family = AF_INET;
+    server_addr.sin_addr.s_addr = inet_addr("127.0.0.1");
+    server_addr.sin_port = htons(19000);
+
+    gtpv2c::FTEID sender;
+    sender.interface_type = gtpv2c::S5S8_SGW_GTPC;
+    sender.teid = 0xABCD;
+
+    // Создание, повторная попытка с новым номером последовательности и IMSI из чёрного списка
+    struct Case { const char* imsi; uint32_t sequence; uint8_t cause; };
+    Case cases[] = {
+        { "123456789012345", 1, gtpv2c::CAUSE_REQUEST_ACCEPTED },
+        { "123456789012345", 2, gtpv2c::CAUSE_REQUEST_REJECTED },
+        { "001010123456789", 3, gtpv2c::CAUSE_REQUEST_REJECTED },
+    };
+    for (const auto& c : cases) {
+        uint8_t request[128];
+        size_t length = gtpv2c::encode_create_session_request(request, sizeof(request), c.sequence, c.imsi, 15, sender);
+        sendto(sockfd, request, length, 0, (struct sockaddr*)&server_addr, sizeof(server_addr));
+
+        uint8_t reply[256];
+        ssize_t n = recvfrom(sockfd, reply, sizeof(reply), 0, nullptr, nullptr);
+        ASSERT_GT(n, 0);
+        gtpv2c::MessageView message;
+        ASSERT_EQ(gtpv2c::parse(reply, static_cast<size_t>(n), message), gtpv2c::ParseResult::OK);
+        EXPECT_EQ(message.type, gtpv2c::CREATE_SESSION_RESPONSE);
+        EXPECT_EQ(message.sequence, c.sequence);
+        EXPECT_EQ(message.teid, 0xABCDu);
+        uint8_t cause = 0;
+        ASSERT_TRUE(gtpv2c::decode_cause(message.cause, cause));
+        EXPECT_EQ(cause, c.cause) << "sequence " << c.sequence;
+        // Принятый запрос получает адрес UE из пула по умолчанию
+        gtpv2c::PAA paa;
+        EXPECT_EQ(gtpv2c::decode_paa(message.paa, paa), cause == gtpv2c::CAUSE_REQUEST_ACCEPTED);
+        if (cause == gtpv2c::CAUSE_REQUEST_ACCEPTED) {
+            EXPECT_TRUE(paa.has_ipv4);
+            EXPECT_EQ(ntohl(paa.ipv4) >> 16, (10u << 8) | 45u);
+        }
+    }
+
+    // Мусор отбрасывается без ответа
+    sendto(sockfd, "garbage", 7, 0, (struct sockaddr*)&server_addr, sizeof(server_addr));
+    uint8_t reply[256];
+    tv = { 0, 200000 };
+    setsockopt(sockfd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    EXPECT_LT(recvfrom(sockfd, reply, sizeof(reply), 0, nullptr, nullptr), 0);
+
+    close(sockfd);
+    udp_server_->stop();
+    if (server_thread.joinable()) {
+        server_thread.join();
+    }
+    EXPECT_TRUE(session_manager_->has_session("123456789012345"));
+}
+
+TEST_F(UDPServerGTPTest, DeleteSessionRequestOverGTPv2C) {
+    session_manager_->create_session("123456789012345");
+    std::thread server_thread([this]() { udp_server_->run(); });
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+    int sockfd = socket(AF_INET, SOCK_DGRAM, 0);
+    ASSERT_GE(sockfd, 0);
+    struct timeval tv = { 1, 0 };
+    setsockopt(sockfd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+
+    struct sockaddr_in server_addr = {};
+    server_addr.sin_family = AF_INET;
+    server_addr.sin_addr.s_addr = inet_addr("127.0.0.1");
+    server_addr.sin_port = htons(19000);
+
+    // Первое удаление успешно, второе — контекст уже не найден
+    uint8_t expected[] = { gtpv2c::CAUSE_REQUEST_ACCEPTED, gtpv2c::CAUSE_CONTEXT_NOT_FOUND };
+    for (uint32_t sequence = 1; sequence <= 2; ++sequence) {
+        uint8_t request[128];
+        size_t length = gtpv2c::encode_delete_session_request(request, sizeof(request), 1, sequence, "123456789012345", 15);
+        sendto(sockfd, request, length, 0, (struct sockaddr*)&server_addr, sizeof(server_addr));
+
+        uint8_t reply[256];
+        ssize_t n = recvfrom(sockfd, reply, sizeof(reply), 0, nullptr, nullptr);
+        ASSERT_GT(n, 0);
+        gtpv2c::MessageView message;
+        ASSERT_EQ(gtpv2c::parse(reply, static_cast<size_t>(n), message), gtpv2c::ParseResult::OK);
+        EXPECT_EQ(message.type, gtpv2c::DELETE_SESSION_RESPONSE);
+        EXPECT_EQ(message.sequence, sequence);
+        uint8_t cause = 0;
+        ASSERT_TRUE(gtpv2c::decode_cause(message.cause, cause));
+        EXPECT_EQ(cause, expected[sequence - 1]);
+    }
+
+    close(sockfd);
+    udp_server_->stop();
+    if (server_thread.joinable()) {
+        server_thread.join();
+    }
+    EXPECT_FALSE(session_manager_->has_session("123456789012345"));
+}
+
+// SGW удаляет сессию по TEID управления PGW из F-TEID ответа на создание, без IE IMSI;
+// ответ адресован TEID SGW из F-TEID запроса создания
+TEST_F(UDPServerGTPTest, DeletesSessionByControlTeid) {
+    std::thread server_thread([this]() { udp_server_->run(); });
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+    int sockfd = socket(AF_INET, SOCK_DGRAM, 0);
+    ASSERT_GE(sockfd, 0);
+    struct timeval tv = { 1, 0 };
+    setsockopt(sockfd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+
+    struct sockaddr_in server_addr = {};
+    server_addr.sin_family = AF_INET;
+    server_addr.sin_addr.s_addr = inet_addr("127.0.0.1");
+    server_addr.sin_port = htons(19000);
+
+    auto exchange = [&](const uint8_t* request, size_t length, gtpv2c::MessageView& message, uint8_t* reply) {
+        sendto(sockfd, request, length, 0, (struct sockaddr*)&server_addr, sizeof(server_addr));
+        ssize_t n = recvfrom(sockfd, reply, 256, 0, nullptr, nullptr);
+        ASSERT_GT(n, 0);
+        ASSERT_EQ(gtpv2c::parse(reply, static_cast<size_t>(n), message), gtpv2c::ParseResult::OK);
+    };
+
+    gtpv2c::FTEID sender;
+    sender.interface_type = gtpv2c::S5S8_SGW_GTPC;
+    sender.teid = 0x5157;
+    uint8_t request[128];
+    uint8_t reply[256];
+    gtpv2c::MessageView message;
+    size_t length = gtpv2c::encode_create_session_request(request, sizeof(request), 1, "123456789012345", 15, sender);
+    exchange(request, length, message, reply);
+    // F-TEID PGW — instance 1: MessageView хранит только instance 0, ищем IE в теле ответа
+    uint32_t pgw_teid = 0;
+    for (size_t pos = gtpv2c::HEADER_SIZE; pos + gtpv2c::IE_HEADER_SIZE <= message.length;) {
+        size_t ie_length = (static_cast<size_t>(reply[pos + 1]) << 8) | reply[pos + 2];
+        if (reply[pos] == gtpv2c::IE_FTEID && (reply[pos + 3] & 0x0F) == 1) {
+            gtpv2c::IEView ie;
+            ie.value = reply + pos + gtpv2c::IE_HEADER_SIZE;
+            ie.length = static_cast<uint16_t>(ie_length);
+            gtpv2c::FTEID pgw;
+            ASSERT_TRUE(gtpv2c::decode_fteid(ie, pgw));
+            pgw_teid = pgw.teid;
+        }
+        pos += gtpv2c::IE_HEADER_SIZE + ie_length;
+    }
+    ASSERT_NE(pgw_teid, 0u);
+
+    // Первое удаление по TEID успешно, второе — контекст не найден
+    uint8_t expected[] = { gtpv2c::CAUSE_REQUEST_ACCEPTED, gtpv2c::CAUSE_CONTEXT_NOT_FOUND };
+    uint32_t expected_teid[] = { 0x5157, 0 };
+    for (uint32_t sequence = 2; sequence <= 3; ++sequence) {
+        length = gtpv2c::encode_delete_session_request(request, sizeof(request), pgw_teid, sequence, nullptr, 0);
+        exchange(request, length, message, reply);
+        EXPECT_EQ(message.type, gtpv2c::DELETE_SESSION_RESPONSE);
+        EXPECT_EQ(message.sequence, sequence);
+        EXPECT_EQ(message.teid, expected_teid[sequence - 2]);
+        uint8_t cause = 0;
+        ASSERT_TRUE(gtpv2c::decode_cause(message.cause, cause));
+        EXPECT_EQ(cause, expected[sequence - 2]) << "sequence " << sequence;
+    }
+    EXPECT_FALSE(session_manager_->has_session("123456789012345"));
+
+    // Без TEID и без IMSI удалять нечего: IE IMSI обязателен
+    length = gtpv2c::encode_delete_session_request(request, sizeof(request), 0, 4, nullptr, 0);
+    exchange(request, length, message, reply);
+    uint8_t cause = 0;
+    ASSERT_TRUE(gtpv2c::decode_cause(message.cause, cause));
+    EXPECT_EQ(cause, gtpv2c::CAUSE_MANDATORY_IE_MISSING);
+
+    close(sockfd);
+    udp_server_->stop();
+    if (server_thread.joinable()) {
+        server_thread.join();
+    }
+}
+
+TEST_F(UDPServerGTPTest, DistinguishesMalformedAndMissingImsi) {
+    std::thread server_thread([this]() { udp_server_->run(); });
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+    int sockfd = socket(AF_INET, SOCK_DGRAM, 0);
+    ASSERT_GE(sockfd, 0);
+    struct timeval tv = { 1, 0 };
+    setsockopt(sockfd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+
+    struct sockaddr_in server_addr = {};
+    server_addr.sin_family = AF_INET;
+    server_addr.sin_addr.s_addr = inet_addr("127.0.0.1");
+    server_addr.sin_port = htons(19000);
+
+    gtpv2c::FTEID sender;
+    sender.interface_type = gtpv2c::S5S8_SGW_GTPC;
+    sender.teid = 0xABCD;
+
+    // IE IMSI с тетрадой 0xA — испорчен (69); IE другого типа вместо IMSI — IMSI отсутствует (70)
+    uint8_t expected[] = { gtpv2c::CAUSE_MANDATORY_IE_INCORRECT, gtpv2c::CAUSE_MANDATORY_IE_MISSING };
+    for (uint32_t sequence = 1; sequence <= 2; ++sequence) {
+        uint8_t request[128];
+        size_t length = gtpv2c::encode_create_session_request(request, sizeof(request), sequence, "123456789012345", 15, sender);
+        gtpv2c::MessageView parsed;
+        ASSERT_EQ(gtpv2c::parse(request, length, parsed), gtpv2c::ParseResult::OK);
+        size_t imsi_offset = static_cast<size_t>(parsed.imsi.value - request);
+        if (sequence == 1) {
+            request[imsi_offset] = 0xAA;
+        }
+        else {
+            request[imsi_offset - 4] = 0xFE;    // Тип IE в его заголовке
+        }
+        sendto(sockfd, request, length, 0, (struct sockaddr*)&server_addr, sizeof(server_addr));
+
+        uint8_t reply[256];
+        ssize_t n = recvfrom(sockfd, reply, sizeof(reply), 0, nullptr, nullptr);
+        ASSERT_GT(n, 0);
+        gtpv2c::MessageView message;
+        ASSERT_EQ(gtpv2c::parse(reply, static_cast<size_t>(n), message), gtpv2c::ParseResult::OK);
+        EXPECT_EQ(message.sequence, sequence);
+        uint8_t cause = 0;
+        ASSERT_TRUE(gtpv2c::decode_cause(message.cause, cause));
+        EXPECT_EQ(cause, expected[sequence - 1]) << "sequence " << sequence;
+    }
+
+    close(sockfd);
+    udp_server_->stop();
+    if (server_thread.joinable()) {
+        server_thread.join();
+    }
+}
+
+class UDPServerBusyPollTest : public UDPServerTest {
+protected:
+    std::string extra_config() const override { return R"(, "busy_poll": true, "busy_poll_idle_ms": 50)"; }
+};
+
+TEST_F(UDPServerBusyPollTest, ServesWhileSpinningAndAfterFallback) {
+    std::thread server_thread([this]() { udp_server_->run(); });
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+    int sockfd = socket(AF_INET, SOCK_DGRAM, 0);
+    ASSERT_GE(sockfd, 0);
+    struct timeval tv = { 1, 0 };
+    setsockopt(sockfd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    struct sockaddr_in server_addr = {};
+    server_addr.sin_family = AF_INET;
+    server_addr.sin_addr.s_addr = inet_addr("127.0.0.1");
+    server_addr.sin_port = htons(19000);
+    auto exchange = [&](const std::string& imsi) {
+        std::string request = encode_bcd(imsi);
+        sendto(sockfd, request.data(), request.size(), 0, (struct sockaddr*)&server_addr, sizeof(server_addr));
+        char response[256];
+        ssize_t n = recvfrom(sockfd, response, sizeof(response) - 1, 0, nullptr, nullptr);
+        response[n > 0 ? n : 0] = '\0';
+        return std::string(response);
+    };
+
+    // Простой дольше busy_poll_idle_ms уже был: поток приёма перешёл к ожиданию и проснулся на запрос
+    EXPECT_EQ(exchange("123456789012601"), "created");
+    uint64_t fallbacks = udp_server_->get_busy_poll_fallbacks();
+    EXPECT_GE(fallbacks, 1u);
+
+    // Запросы чаще порога простоя обслуживаются опросом, без новых переходов к ожиданию
+    for (int i = 0; i < 5; ++i) {
+        EXPECT_EQ(exchange(std::to_string(123456789012610LL + i)), "created");
+    }
+    EXPECT_EQ(udp_server_->get_busy_poll_fallbacks(), fallbacks);
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(150));
+    EXPECT_EQ(exchange("123456789012602"), "created");
+    EXPECT_EQ(udp_server_->get_busy_poll_fallbacks(), fallbacks + 1);
+
+    close(sockfd);
+    udp_server_->stop();
+    if (server_thread.joinable()) {
+        server_thread.join();
+    }
+}
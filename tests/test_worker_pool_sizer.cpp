@@ -0,0 +1,98 @@
+#include <gtest/gtest.h>
+#include "worker_pool_sizer.hpp"
+#include <chrono>
+#include <string>
+
+using namespace std::chrono_literals;
+
+namespace {
+
+// Значение параметра из отчёта key=value
+double value(const std::string& report, const std::string& key) {
+    std::string lines = "\n" + report;
+    size_t position = lines.find("\n" + key + "=");
+    return position == std::string::npos ? -1 : std::stod(lines.substr(position + key.size() + 2));
+}
+
+} // namespace
+
+TEST(WorkerPoolSizerTest, StartsAtMinAndResolvesMaxFromCores) {
+    WorkerPoolSizer sizer(2, 0, 1000us, 2000ms);
+    EXPECT_EQ(sizer.get_target(), 2u);
+    EXPECT_GE(sizer.get_max(), 2u);
+}
+
+TEST(WorkerPoolSizerTest, GrowsAfterSustainedQueueWait) {
+    WorkerPoolSizer sizer(2, 4, 1000us, 2000ms);
+    auto now = std::chrono::steady_clock::now();
+
+    // Одного интервала с долгим ожиданием недостаточно
+    sizer.record_dequeue(5ms);
+    EXPECT_EQ(sizer.adjust(0, now += 100ms), 2u);
+    sizer.record_dequeue(5ms);
+    EXPECT_EQ(sizer.adjust(0, now += 100ms), 3u);
+
+    // Выдержка отсчитывается заново после роста; выше max пул не растёт
+    sizer.record_dequeue(5ms);
+    EXPECT_EQ(sizer.adjust(0, now += 100ms), 3u);
+    sizer.record_dequeue(5ms);
+    EXPECT_EQ(sizer.adjust(0, now += 100ms), 4u);
+    for (int i = 0; i < 4; ++i) {
+        sizer.record_dequeue(5ms);
+        EXPECT_EQ(sizer.adjust(0, now += 100ms), 4u);
+    }
+    EXPECT_EQ(value(sizer.report(), "grows"), 2);
+}
+
+TEST(WorkerPoolSizerTest, GrowsOnQueueDepth) {
+    WorkerPoolSizer sizer(1, 2, 1000us, 2000ms);
+    auto now = std::chrono::steady_clock::now();
+    size_t depth = WorkerPoolSizer::GROW_DEPTH_PER_WORKER + 1;
+    sizer.adjust(depth, now += 100ms);
+    EXPECT_EQ(sizer.adjust(depth, now += 100ms), 2u);
+}
+
+TEST(WorkerPoolSizerTest, ShrinksOnlyAfterSustainedIdle) {
+    WorkerPoolSizer sizer(1, 4, 1000us, 500ms);
+    auto now = std::chrono::steady_clock::now();
+    for (int i = 0; i < 4; ++i) {
+        sizer.adjust(100, now += 100ms);
+    }
+    ASSERT_EQ(sizer.get_target(), 3u);
+
+    // Загрузка 50% — не простой, пул сохраняет размер
+    for (int i = 0; i < 10; ++i) {
+        sizer.record_busy(150ms);
+        EXPECT_EQ(sizer.adjust(0, now += 100ms), 3u);
+    }
+
+    // Простой: первый поток отдаётся через shrink_idle, следующий — ещё через shrink_idle
+    for (int i = 0; i < 5; ++i) {
+        sizer.adjust(0, now += 100ms);
+    }
+    EXPECT_EQ(sizer.adjust(0, now += 100ms), 2u);
+    for (int i = 0; i < 4; ++i) {
+        EXPECT_EQ(sizer.adjust(0, now += 100ms), 2u);
+    }
+    EXPECT_EQ(sizer.adjust(0, now += 100ms), 1u);
+    for (int i = 0; i < 10; ++i) {
+        EXPECT_EQ(sizer.adjust(0, now += 100ms), 1u);
+    }
+    EXPECT_EQ(value(sizer.report(), "shrinks"), 2);
+}
+
+TEST(WorkerPoolSizerTest, ReportsUtilizationAndWait) {
+    WorkerPoolSizer sizer(2, 2, 1000us, 2000ms);
+    auto now = std::chrono::steady_clock::now();
+    sizer.adjust(0, now);
+    sizer.record_dequeue(100us);
+    sizer.record_dequeue(300us);
+    sizer.record_busy(100ms);
+    sizer.adjust(3, now + 100ms);
+    std::string report = sizer.report();
+    EXPECT_EQ(value(report, "workers"), 2);
+    EXPECT_DOUBLE_EQ(value(report, "utilization"), 0.5);
+    EXPECT_DOUBLE_EQ(value(report, "avg_wait_us"), 200);
+    EXPECT_EQ(value(report, "queue_depth"), 3);
+    EXPECT_EQ(value(report, "processed"), 2);
+}